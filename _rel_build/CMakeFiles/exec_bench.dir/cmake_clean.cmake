@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/exec_bench.dir/bench/exec_bench.cpp.o"
+  "CMakeFiles/exec_bench.dir/bench/exec_bench.cpp.o.d"
+  "bin/exec_bench"
+  "bin/exec_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/exec_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
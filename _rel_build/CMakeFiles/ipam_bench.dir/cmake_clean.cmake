@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ipam_bench.dir/bench/ipam_bench.cpp.o"
+  "CMakeFiles/ipam_bench.dir/bench/ipam_bench.cpp.o.d"
+  "bin/ipam_bench"
+  "bin/ipam_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ipam_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/lazy_bench.dir/bench/lazy_bench.cpp.o"
+  "CMakeFiles/lazy_bench.dir/bench/lazy_bench.cpp.o.d"
+  "bin/lazy_bench"
+  "bin/lazy_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/lazy_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,45 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/cgroup/cgroup.cpp" "CMakeFiles/mydocker.dir/cgroup/cgroup.cpp.o" "gcc" "CMakeFiles/mydocker.dir/cgroup/cgroup.cpp.o.d"
+  "/root/repo/cgroup/cpualloc.cpp" "CMakeFiles/mydocker.dir/cgroup/cpualloc.cpp.o" "gcc" "CMakeFiles/mydocker.dir/cgroup/cpualloc.cpp.o.d"
+  "/root/repo/cgroup/numa.cpp" "CMakeFiles/mydocker.dir/cgroup/numa.cpp.o" "gcc" "CMakeFiles/mydocker.dir/cgroup/numa.cpp.o.d"
+  "/root/repo/cgroup/stats.cpp" "CMakeFiles/mydocker.dir/cgroup/stats.cpp.o" "gcc" "CMakeFiles/mydocker.dir/cgroup/stats.cpp.o.d"
+  "/root/repo/common/message.cpp" "CMakeFiles/mydocker.dir/common/message.cpp.o" "gcc" "CMakeFiles/mydocker.dir/common/message.cpp.o.d"
+  "/root/repo/common/sha256.cpp" "CMakeFiles/mydocker.dir/common/sha256.cpp.o" "gcc" "CMakeFiles/mydocker.dir/common/sha256.cpp.o.d"
+  "/root/repo/common/utils.cpp" "CMakeFiles/mydocker.dir/common/utils.cpp.o" "gcc" "CMakeFiles/mydocker.dir/common/utils.cpp.o.d"
+  "/root/repo/container/container.cpp" "CMakeFiles/mydocker.dir/container/container.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/container.cpp.o.d"
+  "/root/repo/container/exec.cpp" "CMakeFiles/mydocker.dir/container/exec.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/exec.cpp.o.d"
+  "/root/repo/container/pool.cpp" "CMakeFiles/mydocker.dir/container/pool.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/pool.cpp.o.d"
+  "/root/repo/container/run.cpp" "CMakeFiles/mydocker.dir/container/run.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/run.cpp.o.d"
+  "/root/repo/container/spawn.cpp" "CMakeFiles/mydocker.dir/container/spawn.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/spawn.cpp.o.d"
+  "/root/repo/container/store.cpp" "CMakeFiles/mydocker.dir/container/store.cpp.o" "gcc" "CMakeFiles/mydocker.dir/container/store.cpp.o.d"
+  "/root/repo/daemon/daemon.cpp" "CMakeFiles/mydocker.dir/daemon/daemon.cpp.o" "gcc" "CMakeFiles/mydocker.dir/daemon/daemon.cpp.o.d"
+  "/root/repo/filesystem/filesystem.cpp" "CMakeFiles/mydocker.dir/filesystem/filesystem.cpp.o" "gcc" "CMakeFiles/mydocker.dir/filesystem/filesystem.cpp.o.d"
+  "/root/repo/filesystem/snapshot.cpp" "CMakeFiles/mydocker.dir/filesystem/snapshot.cpp.o" "gcc" "CMakeFiles/mydocker.dir/filesystem/snapshot.cpp.o.d"
+  "/root/repo/image/image.cpp" "CMakeFiles/mydocker.dir/image/image.cpp.o" "gcc" "CMakeFiles/mydocker.dir/image/image.cpp.o.d"
+  "/root/repo/image/lazy.cpp" "CMakeFiles/mydocker.dir/image/lazy.cpp.o" "gcc" "CMakeFiles/mydocker.dir/image/lazy.cpp.o.d"
+  "/root/repo/image/lazyfs.cpp" "CMakeFiles/mydocker.dir/image/lazyfs.cpp.o" "gcc" "CMakeFiles/mydocker.dir/image/lazyfs.cpp.o.d"
+  "/root/repo/image/squashfs.cpp" "CMakeFiles/mydocker.dir/image/squashfs.cpp.o" "gcc" "CMakeFiles/mydocker.dir/image/squashfs.cpp.o.d"
+  "/root/repo/image/tar.cpp" "CMakeFiles/mydocker.dir/image/tar.cpp.o" "gcc" "CMakeFiles/mydocker.dir/image/tar.cpp.o.d"
+  "/root/repo/logging/logging.cpp" "CMakeFiles/mydocker.dir/logging/logging.cpp.o" "gcc" "CMakeFiles/mydocker.dir/logging/logging.cpp.o.d"
+  "/root/repo/network/firewall.cpp" "CMakeFiles/mydocker.dir/network/firewall.cpp.o" "gcc" "CMakeFiles/mydocker.dir/network/firewall.cpp.o.d"
+  "/root/repo/network/ipam.cpp" "CMakeFiles/mydocker.dir/network/ipam.cpp.o" "gcc" "CMakeFiles/mydocker.dir/network/ipam.cpp.o.d"
+  "/root/repo/network/netlink.cpp" "CMakeFiles/mydocker.dir/network/netlink.cpp.o" "gcc" "CMakeFiles/mydocker.dir/network/netlink.cpp.o.d"
+  "/root/repo/network/network.cpp" "CMakeFiles/mydocker.dir/network/network.cpp.o" "gcc" "CMakeFiles/mydocker.dir/network/network.cpp.o.d"
+  "/root/repo/supervisor/supervisor.cpp" "CMakeFiles/mydocker.dir/supervisor/supervisor.cpp.o" "gcc" "CMakeFiles/mydocker.dir/supervisor/supervisor.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,63 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mydocker.dir/cgroup/cgroup.cpp.o"
+  "CMakeFiles/mydocker.dir/cgroup/cgroup.cpp.o.d"
+  "CMakeFiles/mydocker.dir/cgroup/cpualloc.cpp.o"
+  "CMakeFiles/mydocker.dir/cgroup/cpualloc.cpp.o.d"
+  "CMakeFiles/mydocker.dir/cgroup/numa.cpp.o"
+  "CMakeFiles/mydocker.dir/cgroup/numa.cpp.o.d"
+  "CMakeFiles/mydocker.dir/cgroup/stats.cpp.o"
+  "CMakeFiles/mydocker.dir/cgroup/stats.cpp.o.d"
+  "CMakeFiles/mydocker.dir/common/message.cpp.o"
+  "CMakeFiles/mydocker.dir/common/message.cpp.o.d"
+  "CMakeFiles/mydocker.dir/common/sha256.cpp.o"
+  "CMakeFiles/mydocker.dir/common/sha256.cpp.o.d"
+  "CMakeFiles/mydocker.dir/common/utils.cpp.o"
+  "CMakeFiles/mydocker.dir/common/utils.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/container.cpp.o"
+  "CMakeFiles/mydocker.dir/container/container.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/exec.cpp.o"
+  "CMakeFiles/mydocker.dir/container/exec.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/pool.cpp.o"
+  "CMakeFiles/mydocker.dir/container/pool.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/run.cpp.o"
+  "CMakeFiles/mydocker.dir/container/run.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/spawn.cpp.o"
+  "CMakeFiles/mydocker.dir/container/spawn.cpp.o.d"
+  "CMakeFiles/mydocker.dir/container/store.cpp.o"
+  "CMakeFiles/mydocker.dir/container/store.cpp.o.d"
+  "CMakeFiles/mydocker.dir/daemon/daemon.cpp.o"
+  "CMakeFiles/mydocker.dir/daemon/daemon.cpp.o.d"
+  "CMakeFiles/mydocker.dir/filesystem/filesystem.cpp.o"
+  "CMakeFiles/mydocker.dir/filesystem/filesystem.cpp.o.d"
+  "CMakeFiles/mydocker.dir/filesystem/snapshot.cpp.o"
+  "CMakeFiles/mydocker.dir/filesystem/snapshot.cpp.o.d"
+  "CMakeFiles/mydocker.dir/image/image.cpp.o"
+  "CMakeFiles/mydocker.dir/image/image.cpp.o.d"
+  "CMakeFiles/mydocker.dir/image/lazy.cpp.o"
+  "CMakeFiles/mydocker.dir/image/lazy.cpp.o.d"
+  "CMakeFiles/mydocker.dir/image/lazyfs.cpp.o"
+  "CMakeFiles/mydocker.dir/image/lazyfs.cpp.o.d"
+  "CMakeFiles/mydocker.dir/image/squashfs.cpp.o"
+  "CMakeFiles/mydocker.dir/image/squashfs.cpp.o.d"
+  "CMakeFiles/mydocker.dir/image/tar.cpp.o"
+  "CMakeFiles/mydocker.dir/image/tar.cpp.o.d"
+  "CMakeFiles/mydocker.dir/logging/logging.cpp.o"
+  "CMakeFiles/mydocker.dir/logging/logging.cpp.o.d"
+  "CMakeFiles/mydocker.dir/network/firewall.cpp.o"
+  "CMakeFiles/mydocker.dir/network/firewall.cpp.o.d"
+  "CMakeFiles/mydocker.dir/network/ipam.cpp.o"
+  "CMakeFiles/mydocker.dir/network/ipam.cpp.o.d"
+  "CMakeFiles/mydocker.dir/network/netlink.cpp.o"
+  "CMakeFiles/mydocker.dir/network/netlink.cpp.o.d"
+  "CMakeFiles/mydocker.dir/network/network.cpp.o"
+  "CMakeFiles/mydocker.dir/network/network.cpp.o.d"
+  "CMakeFiles/mydocker.dir/supervisor/supervisor.cpp.o"
+  "CMakeFiles/mydocker.dir/supervisor/supervisor.cpp.o.d"
+  "libmydocker.a"
+  "libmydocker.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mydocker.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/net_bench.dir/bench/net_bench.cpp.o"
+  "CMakeFiles/net_bench.dir/bench/net_bench.cpp.o.d"
+  "bin/net_bench"
+  "bin/net_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/net_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
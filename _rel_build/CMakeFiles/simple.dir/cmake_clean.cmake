@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/simple.dir/simpleDocker.cpp.o"
+  "CMakeFiles/simple.dir/simpleDocker.cpp.o.d"
+  "bin/simple"
+  "bin/simple.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/simple.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
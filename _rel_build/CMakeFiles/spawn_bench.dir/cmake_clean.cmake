@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/spawn_bench.dir/bench/spawn_bench.cpp.o"
+  "CMakeFiles/spawn_bench.dir/bench/spawn_bench.cpp.o.d"
+  "bin/spawn_bench"
+  "bin/spawn_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/spawn_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
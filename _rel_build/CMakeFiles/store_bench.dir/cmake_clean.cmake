@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/store_bench.dir/bench/store_bench.cpp.o"
+  "CMakeFiles/store_bench.dir/bench/store_bench.cpp.o.d"
+  "bin/store_bench"
+  "bin/store_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/store_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tar_bench.dir/bench/tar_bench.cpp.o"
+  "CMakeFiles/tar_bench.dir/bench/tar_bench.cpp.o.d"
+  "bin/tar_bench"
+  "bin/tar_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tar_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/workspace_stress.dir/bench/workspace_stress.cpp.o"
+  "CMakeFiles/workspace_stress.dir/bench/workspace_stress.cpp.o.d"
+  "bin/workspace_stress"
+  "bin/workspace_stress.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/workspace_stress.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
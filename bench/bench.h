@@ -0,0 +1,82 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mount.h>
+#include "common/utils.h"
+
+// ==================== 基准测试公共工具 ====================
+// 基准测试程序直接链接核心库（mydocker），与 simple 使用同一份实现。
+// 需要root运行；会修改主机状态的程序先进入私有挂载命名空间，
+// 把状态目录替换为tmpfs，退出后不留下任何记录（见 isolate_directory）。
+
+inline double bench_elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 百分位数（输入无需排序）
+inline double bench_percentile(std::vector<double> samples, int percent) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[(samples.size() - 1) * percent / 100];
+}
+
+// 输出一组延迟样本（毫秒）：数量、p50、p99、最大值
+inline void bench_report(const std::string& label, const std::vector<double>& samples_ms) {
+    double max = samples_ms.empty() ? 0 : *std::max_element(samples_ms.begin(), samples_ms.end());
+    printf("%-32s n=%-7zu p50=%9.3f ms  p99=%9.3f ms  max=%9.3f ms\n", label.c_str(), samples_ms.size(),
+           bench_percentile(samples_ms, 50), bench_percentile(samples_ms, 99), max);
+    fflush(stdout);
+}
+
+// 把标准输出重定向到 /dev/null，返回原来的文件描述符
+inline int silence_stdout() {
+    fflush(stdout);
+    std::cout.flush();
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+    return saved;
+}
+
+inline void restore_stdout(int saved) {
+    fflush(stdout);
+    std::cout.flush();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+// 进入私有挂载命名空间，并在 path 上挂载空的tmpfs（只对本进程及其子进程可见）
+inline bool isolate_directory(const std::string& path) {
+    if (unshare(CLONE_NEWNS) != 0 || mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) != 0) {
+        fprintf(stderr, "[Bench] Failed to create mount namespace: %s\n", strerror(errno));
+        return false;
+    }
+    std::string dir = path;
+    while (dir.size() > 1 && dir.back() == '/') {
+        dir.pop_back();
+    }
+    // 逐级创建目录
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+        create_directory_if_not_exists(dir.substr(0, pos));
+        if (pos == std::string::npos) break;
+    }
+    if (mount("tmpfs", dir.c_str(), "tmpfs", 0, "mode=0755") != 0) {
+        fprintf(stderr, "[Bench] Failed to mount tmpfs on %s: %s\n", dir.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,154 @@
+// exec基准测试：在一个运行中的容器里反复执行 sh -c "exit 0"，比较三种exec路径：
+//   原实现：打开 /proc/<pid>/ns/* 逐个setns，putenv 容器环境变量，在当前进程中直接exec；
+//   pidfd：exec_container 直接进入容器（一次 setns(pidfd)，fork后执行，加入容器cgroup）；
+//   helper：exec_container 经由 run --exec-helper 的常驻辅助进程执行。
+// 每次exec都在新fork出的客户端进程中进行，与每次调用 simple exec 一样不复用任何状态。
+// 用法：exec_bench [每种方式的次数，默认200] [镜像，默认busybox]
+#include "bench.h"
+#include "common/constants.h"
+#include "container/container.h"
+#include "container/exec.h"
+#include "container/run.h"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+static const std::string BENCH_CONTAINER = "exec-bench";
+
+// 原实现：查找容器记录得到PID，逐个打开并进入命名空间，修改自身环境变量后在本进程中exec
+static int legacy_exec(const std::string& name, const std::vector<std::string>& command) {
+    ContainerInfo info;
+    if (!find_container_info(name, info)) {
+        return 1;
+    }
+    pid_t pid = atoi(info.pid.c_str());
+    static const char* namespaces[] = {"ipc", "uts", "net", "pid", "mnt"};
+    for (const char* ns : namespaces) {
+        std::string path = "/proc/" + std::to_string(pid) + "/ns/" + ns;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || setns(fd, 0) != 0) {
+            return 1;
+        }
+        close(fd);
+    }
+    std::ifstream environ_file("/proc/" + std::to_string(pid) + "/environ");
+    std::string variable;
+    while (std::getline(environ_file, variable, '\0')) {
+        putenv(strdup(variable.c_str()));
+    }
+    std::vector<char*> argv;
+    for (const auto& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    return 127;
+}
+
+// fork一个客户端进程执行 exec_path，返回从fork到客户端退出的耗时；失败时返回负数
+template <typename ExecPath>
+static double timed_client(ExecPath exec_path) {
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(exec_path());
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return bench_elapsed_ms(start);
+}
+
+template <typename ExecPath>
+static std::vector<double> measure(int count, ExecPath exec_path, int& errors) {
+    std::vector<double> samples;
+    int saved = silence_stdout();
+    for (int i = 0; i < count; ++i) {
+        double elapsed = timed_client(exec_path);
+        if (elapsed < 0) {
+            errors++;
+        } else {
+            samples.push_back(elapsed);
+        }
+    }
+    restore_stdout(saved);
+    return samples;
+}
+
+// 在子进程中前台运行容器（不经过supervisor），等待其记录为运行中
+static pid_t start_bench_container(const std::string& image, ContainerInfo& info) {
+    pid_t runner = fork();
+    if (runner == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        RunOptions options;
+        options.container_name = BENCH_CONTAINER;
+        options.image = image;
+        options.command = {"/bin/sleep", "3600"};
+        _exit(run_container(options) == 0 ? 0 : 1);
+    }
+    for (int i = 0; i < 100; ++i) {
+        if (find_container_info(BENCH_CONTAINER, info) && info.status == RUNNING && !info.pid.empty()) {
+            return runner;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 200;
+    std::string image = argc > 2 ? argv[2] : DEFAULT_IMAGE;
+    if (count <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [execs_per_mode] [image]" << std::endl;
+        return 1;
+    }
+    // 容器记录和工作空间位于tmpfs，容器退出后不留下记录
+    if (!isolate_directory(CONTAINER_INFO_PATH) || !isolate_directory(WORKSPACE_ROOT)) {
+        return 1;
+    }
+    ContainerInfo info;
+    pid_t runner = start_bench_container(image, info);
+    if (runner < 0) {
+        std::cerr << "[Bench] Failed to start container " << BENCH_CONTAINER << std::endl;
+        return 1;
+    }
+    pid_t container_pid = atoi(info.pid.c_str());
+    printf("[Bench] %d execs per mode in container %s (PID %d)\n", count, BENCH_CONTAINER.c_str(), container_pid);
+
+    ExecOptions options;
+    options.name = BENCH_CONTAINER;
+    options.command = {"/bin/sh", "-c", "exit 0"};
+    int errors = 0;
+    bench_report("exec (setns per namespace)", measure(count, [&]() {
+        return legacy_exec(options.name, options.command);
+    }, errors));
+    bench_report("exec (pidfd)", measure(count, [&]() { return exec_container(options); }, errors));
+
+    int saved = silence_stdout();
+    bool helper = start_exec_helper(BENCH_CONTAINER);
+    restore_stdout(saved);
+    if (helper) {
+        bench_report("exec (exec helper)", measure(count, [&]() { return exec_container(options); }, errors));
+    } else {
+        std::cerr << "[Bench] Failed to start exec helper" << std::endl;
+        errors++;
+    }
+
+    // 停止容器，前台运行的子进程随后清理工作空间、cgroup和记录；辅助进程随容器退出
+    StopOptions stop;
+    stop.names = {BENCH_CONTAINER};
+    stop.timeout = 1;
+    saved = silence_stdout();
+    stop_containers(stop);
+    restore_stdout(saved);
+    waitpid(runner, nullptr, 0);
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
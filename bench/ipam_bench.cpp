@@ -0,0 +1,108 @@
+// IPAM基准测试：在子网（默认/16，约65k地址）上分配直到耗尽、乱序全部释放、再完整分配一轮，
+// 每次操作都经过mmap位图存储，校验地址不重复且均在子网内。
+// 用法：ipam_bench [子网，默认10.200.0.0/16]
+#include "bench.h"
+#include "common/constants.h"
+#include "common/structures.h"
+#include "network/ipam.h"
+#include <iostream>
+#include <random>
+#include <cstdlib>
+
+// 分配直到返回空地址，校验每个地址唯一且为可用主机地址
+static std::vector<std::string> allocate_all(IPAMAllocator& allocator, const std::string& subnet,
+                                             const std::string& label, int& errors) {
+    uint32_t network;
+    int prefix_len;
+    parse_cidr(subnet, network, prefix_len);
+    size_t size = size_t(1) << (32 - prefix_len);
+    std::vector<char> seen(size, 0);
+
+    std::vector<std::string> ips;
+    std::vector<double> samples;
+    // 分配器每次分配都输出日志，计时期间丢弃
+    int saved = silence_stdout();
+    auto phase = std::chrono::steady_clock::now();
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        std::string ip = allocator.allocate(subnet);
+        samples.push_back(bench_elapsed_ms(start));
+        if (ip.empty()) break;
+        uint32_t addr;
+        if (!ipv4_from_string(ip, addr) || addr - network >= size || seen[addr - network]) {
+            std::cerr << "[Bench] Invalid or duplicate address: " << ip << std::endl;
+            errors++;
+            continue;
+        }
+        seen[addr - network] = 1;
+        ips.push_back(ip);
+    }
+    double total = bench_elapsed_ms(phase);
+    restore_stdout(saved);
+    // 最后一次是耗尽时的失败分配
+    double exhausted = samples.back();
+    samples.pop_back();
+    bench_report(label, samples);
+    printf("%-32s %zu addresses in %.1f ms, allocate on full pool %.3f ms\n", "", ips.size(), total, exhausted);
+    return ips;
+}
+
+static void release_all(IPAMAllocator& allocator, const std::string& subnet, const std::vector<std::string>& ips,
+                        const std::string& label, int& errors) {
+    std::vector<double> samples;
+    int saved = silence_stdout();
+    auto phase = std::chrono::steady_clock::now();
+    for (const auto& ip : ips) {
+        auto start = std::chrono::steady_clock::now();
+        if (!allocator.release(subnet, ip)) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    double total = bench_elapsed_ms(phase);
+    restore_stdout(saved);
+    bench_report(label, samples);
+    printf("%-32s %zu addresses in %.1f ms\n", "", ips.size(), total);
+}
+
+int main(int argc, char* argv[]) {
+    std::string subnet = argc > 1 ? argv[1] : "10.200.0.0/16";
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len) || prefix_len < 8 || prefix_len > 30) {
+        std::cerr << "Usage: " << argv[0] << " [subnet, /8 to /30]" << std::endl;
+        return 1;
+    }
+    if (!isolate_directory(CONTAINER_INFO_PATH)) {
+        return 1;
+    }
+    IPAMAllocator allocator(CONTAINER_INFO_PATH + "ipam_bench.db");
+    printf("[Bench] IPAM pool %s (%s on tmpfs)\n", subnet.c_str(), allocator.store_path().c_str());
+    if (!allocator.init_subnet(subnet)) {
+        std::cerr << "[Bench] Failed to initialize subnet " << subnet << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    // 网络地址、网关和广播地址不可分配
+    size_t expected = (size_t(1) << (32 - prefix_len)) - 3;
+    std::vector<std::string> ips = allocate_all(allocator, subnet, "allocate (empty -> full)", errors);
+    if (ips.size() != expected) {
+        std::cerr << "[Bench] Allocated " << ips.size() << " addresses, expected " << expected << std::endl;
+        errors++;
+    }
+
+    std::mt19937 rng(42);
+    std::shuffle(ips.begin(), ips.end(), rng);
+    release_all(allocator, subnet, ips, "release (random order)", errors);
+
+    // 第二轮：分配游标已回绕，释放后的地址应全部可再分配
+    ips = allocate_all(allocator, subnet, "allocate (after release)", errors);
+    if (ips.size() != expected) {
+        std::cerr << "[Bench] Reallocated " << ips.size() << " addresses, expected " << expected << std::endl;
+        errors++;
+    }
+    release_all(allocator, subnet, ips, "release (allocation order)", errors);
+    if (!allocator.remove_subnet(subnet)) errors++;
+
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// 按需加载层基准测试：从空的镜像存储开始，比较容器第一次exec前的耗时
+//   解压模式：复制层tar包（代替下载）+ prepare_image 解压全部层 + 启动容器执行 sh -c "exit 0"
+//   按需模式：lazy pull 只下载TOC + prepare_image 挂载FUSE层 + 启动容器（读取时才取块）
+// 镜像先被推送到隔离的仓库目录；每轮使用全新的镜像存储和块缓存（tmpfs），互不复用。
+// 用法：lazy_bench [镜像，默认busybox] [轮数，默认5]
+#include "bench.h"
+#include "common/constants.h"
+#include "container/run.h"
+#include "image/image.h"
+#include "image/lazy.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+static const std::string STAGING_DIR = "/tmp/mydocker-lazy-bench/";
+
+static bool copy_file(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    out << in.rdbuf();
+    return in && out.good();
+}
+
+// 把暂存的层tar包和清单放入空的镜像存储
+static bool populate_image_store(const std::string& image, const std::vector<std::string>& layers) {
+    if (!create_directory_if_not_exists(IMAGE_STORE_URL + "blobs")) {
+        return false;
+    }
+    for (const auto& layer : layers) {
+        if (!copy_file(STAGING_DIR + layer, layer_blob_path(layer))) {
+            return false;
+        }
+    }
+    return write_image_manifest(image, layers);
+}
+
+// 在空的镜像存储（叠加在当前存储之上的tmpfs）中执行一轮，结束后卸载
+template <typename Fetch>
+static bool run_cold(const std::string& image, const std::vector<std::string>& layers, Fetch fetch,
+                     double& prepare_ms, double& total_ms) {
+    if (!isolate_directory(IMAGE_STORE_URL)) {
+        return false;
+    }
+    RunOptions options;
+    options.image = image;
+    options.command = {"/bin/sh", "-c", "exit 0"};
+    std::vector<std::string> prepared;
+
+    int saved = silence_stdout();
+    auto start = std::chrono::steady_clock::now();
+    bool ok = fetch() && prepare_image(image, prepared);
+    prepare_ms = bench_elapsed_ms(start);
+    ok = ok && run_container(options) == 0;
+    total_ms = bench_elapsed_ms(start);
+    restore_stdout(saved);
+
+    // 卸载FUSE层（其服务进程随之退出），再移除本轮的镜像存储
+    for (const auto& layer : layers) {
+        if (lazy_layer_pulled(layer)) {
+            umount2(lazy_layer_mount_path(layer).c_str(), MNT_DETACH);
+        }
+    }
+    umount2(IMAGE_STORE_URL.c_str(), MNT_DETACH);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::string image = argc > 1 ? argv[1] : DEFAULT_IMAGE;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+    if (runs <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [image] [runs]" << std::endl;
+        return 1;
+    }
+    // 只读取主机上的清单并暂存层tar包（不解压也不挂载），之后镜像存储、仓库目录、容器记录和工作空间都替换为tmpfs
+    std::vector<std::string> layers;
+    if (!read_image_manifest(image, layers) || !isolate_directory(STAGING_DIR)) {
+        std::cerr << "[Bench] Image not found: " << image << std::endl;
+        return 1;
+    }
+    size_t blob_bytes = 0;
+    for (const auto& layer : layers) {
+        if (!copy_file(layer_blob_path(layer), STAGING_DIR + layer)) {
+            std::cerr << "[Bench] Layer " << layer.substr(0, 12) << " has no tar blob" << std::endl;
+            return 1;
+        }
+        std::ifstream blob(STAGING_DIR + layer, std::ios::binary | std::ios::ate);
+        blob_bytes += blob.tellg();
+    }
+    if (!isolate_directory(IMAGE_STORE_URL) || !isolate_directory(LAZY_REGISTRY_URL) ||
+        !isolate_directory(CONTAINER_INFO_PATH) || !isolate_directory(WORKSPACE_ROOT)) {
+        return 1;
+    }
+    int saved = silence_stdout();
+    bool pushed = populate_image_store(image, layers) && lazy_push_image(image);
+    restore_stdout(saved);
+    if (!pushed) {
+        std::cerr << "[Bench] Failed to push " << image << " to " << LAZY_REGISTRY_URL << std::endl;
+        return 1;
+    }
+    printf("[Bench] %s: %zu layers, %.1f MB of layer blobs, %d cold runs per mode\n", image.c_str(), layers.size(),
+           blob_bytes / 1048576.0, runs);
+
+    int errors = 0;
+    std::vector<double> extracted_prepare, extracted_total, lazy_prepare, lazy_total;
+    for (int i = 0; i < runs; ++i) {
+        double prepare_ms, total_ms;
+        if (run_cold(image, layers, [&]() { return populate_image_store(image, layers); }, prepare_ms, total_ms)) {
+            extracted_prepare.push_back(prepare_ms);
+            extracted_total.push_back(total_ms);
+        } else {
+            errors++;
+        }
+        if (run_cold(image, layers, [&]() { return lazy_pull_image(image); }, prepare_ms, total_ms)) {
+            lazy_prepare.push_back(prepare_ms);
+            lazy_total.push_back(total_ms);
+        } else {
+            errors++;
+        }
+    }
+    bench_report("fetch+prepare (extracted)", extracted_prepare);
+    bench_report("first exec done (extracted)", extracted_total);
+    bench_report("fetch+prepare (lazy)", lazy_prepare);
+    bench_report("first exec done (lazy)", lazy_total);
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// 网络后端基准测试：分别用 shell（ip命令）和 netlink 后端启动N个带网络的容器，
+// 统计容器网络配置（veth、MAC、IP、路由）和完整启动-退出周期的 p50/p99。
+// 用法：net_bench [每个后端的容器数量，默认20] [镜像，默认busybox]
+#include "bench.h"
+#include "common/constants.h"
+#include "container/run.h"
+#include "network/network.h"
+#include "filesystem/filesystem.h"
+#include <iostream>
+#include <cstdlib>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static const std::string BENCH_NETWORK = "mdbench0";
+static const std::string BENCH_SUBNET = "10.231.0.0/16";
+
+// 创建一个位于新网络命名空间中的空闲进程，代替容器进程接收veth
+static pid_t spawn_netns_holder() {
+    int ready[2];
+    if (pipe(ready) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        if (unshare(CLONE_NEWNET) != 0) _exit(1);
+        close(ready[1]);
+        pause();
+        _exit(0);
+    }
+    close(ready[1]);
+    char byte;
+    // 子进程关闭写端（进入新命名空间或退出）后读到EOF
+    while (read(ready[0], &byte, 1) > 0) {}
+    close(ready[0]);
+    return pid;
+}
+
+// 只测量网络配置阶段：每次为一个新的网络命名空间配置veth并随后释放
+static std::vector<double> measure_network_setup(int count, int& errors) {
+    std::vector<double> samples;
+    for (int i = 0; i < count; ++i) {
+        std::string id = generate_container_id();
+        // setup_container_network 会写入容器的 etc/resolv.conf
+        create_directory_if_not_exists(get_workspace(id).root);
+        create_directory_if_not_exists(get_workspace(id).mount_point);
+        create_directory_if_not_exists(get_workspace(id).mount_point + "etc");
+        pid_t holder = spawn_netns_holder();
+        if (holder < 0) {
+            errors++;
+            continue;
+        }
+
+        std::string ip;
+        int saved = silence_stdout();
+        auto start = std::chrono::steady_clock::now();
+        bool ok = setup_container_network(id, BENCH_NETWORK, ip, holder);
+        double elapsed = bench_elapsed_ms(start);
+        if (ok) {
+            release_container_network(id, BENCH_NETWORK, ip, false);
+        }
+        restore_stdout(saved);
+
+        kill(holder, SIGKILL);
+        waitpid(holder, nullptr, 0);
+        remove_directory_recursive(get_workspace(id).root);
+        if (ok) {
+            samples.push_back(elapsed);
+        } else {
+            errors++;
+        }
+    }
+    return samples;
+}
+
+// 完整周期：run_container 启动容器执行 sh -c "exit 0"，等待退出并清理
+static std::vector<double> measure_container_runs(int count, const std::string& image, int& errors) {
+    RunOptions options;
+    options.network_name = BENCH_NETWORK;
+    options.image = image;
+    options.command = {"/bin/sh", "-c", "exit 0"};
+    std::vector<double> samples;
+    for (int i = 0; i < count; ++i) {
+        int saved = silence_stdout();
+        auto start = std::chrono::steady_clock::now();
+        int result = run_container(options);
+        double elapsed = bench_elapsed_ms(start);
+        restore_stdout(saved);
+        if (result == 0) {
+            samples.push_back(elapsed);
+        } else {
+            errors++;
+        }
+    }
+    return samples;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 20;
+    std::string image = argc > 2 ? argv[2] : DEFAULT_IMAGE;
+    if (count <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [containers_per_backend] [image]" << std::endl;
+        return 1;
+    }
+    // 容器记录、网络配置和IPAM位于tmpfs，工作空间同样隔离；网桥和veth仍在主机网络命名空间中创建
+    if (!isolate_directory(CONTAINER_INFO_PATH) || !isolate_directory(WORKSPACE_ROOT)) {
+        return 1;
+    }
+    int saved = silence_stdout();
+    network_create("bridge", BENCH_SUBNET, BENCH_NETWORK);
+    restore_stdout(saved);
+    if (load_network_config(BENCH_NETWORK).name.empty()) {
+        std::cerr << "[Bench] Failed to create network " << BENCH_NETWORK << std::endl;
+        return 1;
+    }
+    printf("[Bench] %d containers per backend on %s (%s), image %s\n", count, BENCH_NETWORK.c_str(),
+           BENCH_SUBNET.c_str(), image.c_str());
+
+    int errors = 0;
+    for (const std::string backend : {"shell", "netlink"}) {
+        set_network_backend(backend);
+        bench_report("network setup (" + backend + ")", measure_network_setup(count, errors));
+        bench_report("run sh -c exit (" + backend + ")", measure_container_runs(count, image, errors));
+    }
+
+    saved = silence_stdout();
+    delete_bridge_network(BENCH_NETWORK);
+    restore_stdout(saved);
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
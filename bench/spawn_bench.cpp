@@ -0,0 +1,123 @@
+// 进程创建基准测试：比较三种创建容器进程的方式（命名空间与 run 相同）：
+//   clone + 1MB堆栈 + 写cgroup.procs（原实现）、clone3 + 写cgroup.procs、clone3 + CLONE_INTO_CGROUP。
+// 子进程阻塞在启动管道上，与 run 一样在进入cgroup后才放行，然后立即退出。
+// 分别统计创建耗时（进程已位于cgroup中）和创建到回收的总耗时。
+// 用法：spawn_bench [每种方式的次数，默认200]
+#include "bench.h"
+#include "common/constants.h"
+#include "cgroup/cgroup.h"
+#include "container/spawn.h"
+#include <iostream>
+#include <cstdlib>
+#include <sched.h>
+#include <sys/wait.h>
+
+static const int NAMESPACE_FLAGS = CLONE_NEWUTS | CLONE_NEWPID | CLONE_NEWNS | CLONE_NEWNET | CLONE_NEWIPC;
+
+enum class SpawnMode {
+    LegacyClone,    // clone()，每次分配1MB栈，waitpid回收
+    Clone3,         // clone3(CLONE_PIDFD)，再写入cgroup.procs
+    Clone3Cgroup,   // clone3(CLONE_PIDFD | CLONE_INTO_CGROUP)
+};
+
+struct StartPipe {
+    int read_fd;
+    int write_fd;
+};
+
+// 等待父进程关闭启动管道后退出
+static int child_main(void* arg) {
+    StartPipe* start = static_cast<StartPipe*>(arg);
+    close(start->write_fd);
+    char byte;
+    while (read(start->read_fd, &byte, 1) > 0) {}
+    return 0;
+}
+
+static bool spawn_once(SpawnMode mode, const std::string& cgroup_id, double& spawn_ms, double& total_ms) {
+    StartPipe start;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return false;
+    start.read_fd = fds[0];
+    start.write_fd = fds[1];
+
+    auto begin = std::chrono::steady_clock::now();
+    SpawnedProcess process;
+    bool ok;
+    if (mode == SpawnMode::LegacyClone) {
+        char* stack = new char[STACK_SIZE];
+        process.pid = clone(child_main, stack + STACK_SIZE, NAMESPACE_FLAGS | SIGCHLD, &start);
+        delete[] stack;
+        ok = process.pid > 0 && attach_container_cgroup(cgroup_id, process.pid);
+    } else {
+        int cgroup_fd = mode == SpawnMode::Clone3Cgroup ? open_container_cgroup(cgroup_id) : -1;
+        ok = spawn_container(child_main, &start, NAMESPACE_FLAGS, cgroup_fd, process);
+        if (cgroup_fd >= 0) close(cgroup_fd);
+        if (ok && !process.in_cgroup) {
+            ok = attach_container_cgroup(cgroup_id, process.pid);
+        }
+    }
+    spawn_ms = bench_elapsed_ms(begin);
+
+    close(start.read_fd);
+    close(start.write_fd);
+    if (process.pid <= 0) {
+        return false;
+    }
+    int status = 0;
+    if (process.pidfd >= 0) {
+        wait_pidfd(process.pidfd, status);
+        close(process.pidfd);
+    } else {
+        waitpid(process.pid, &status, 0);
+    }
+    total_ms = bench_elapsed_ms(begin);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 200;
+    if (count <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [spawns_per_mode]" << std::endl;
+        return 1;
+    }
+    std::string cgroup_id = "spawn-bench-" + generate_container_id();
+    int saved = silence_stdout();
+    bool created = create_container_cgroup(cgroup_id, CgroupLimits());
+    restore_stdout(saved);
+    if (!created) {
+        std::cerr << "[Bench] Failed to create cgroup " << container_cgroup_path(cgroup_id) << std::endl;
+        return 1;
+    }
+    printf("[Bench] %d spawns per mode into %s\n", count, container_cgroup_path(cgroup_id).c_str());
+
+    const std::pair<SpawnMode, std::string> modes[] = {
+        {SpawnMode::LegacyClone, "clone+stack"},
+        {SpawnMode::Clone3, "clone3+cgroup.procs"},
+        {SpawnMode::Clone3Cgroup, "clone3+INTO_CGROUP"},
+    };
+    int errors = 0;
+    for (const auto& mode : modes) {
+        std::vector<double> spawn_samples, total_samples;
+        // 写入cgroup.procs时会输出日志，计时期间丢弃
+        saved = silence_stdout();
+        for (int i = 0; i < count; ++i) {
+            double spawn_ms = 0, total_ms = 0;
+            if (spawn_once(mode.first, cgroup_id, spawn_ms, total_ms)) {
+                spawn_samples.push_back(spawn_ms);
+                total_samples.push_back(total_ms);
+            } else {
+                errors++;
+            }
+        }
+        restore_stdout(saved);
+        bench_report(mode.second + " spawn", spawn_samples);
+        bench_report(mode.second + " spawn+reap", total_samples);
+    }
+
+    saved = silence_stdout();
+    remove_container_cgroup(cgroup_id);
+    restore_stdout(saved);
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// 容器元数据存储基准测试：N个容器的写入、按名称/ID查找、ps扫描、更新，
+// 以及创建/删除交替（rm churn）前后的未命中查找延迟（新名称写入时的查找路径）。
+// 用法：store_bench [容器数量，默认10000] [交替次数，默认为容器数量的4倍]
+#include "bench.h"
+#include "common/constants.h"
+#include "container/store.h"
+#include <iostream>
+#include <random>
+#include <cstdlib>
+#include <unistd.h>
+
+static ContainerInfo make_container(int index) {
+    ContainerInfo info;
+    info.id = generate_container_id();
+    info.name = "bench-" + std::to_string(index);
+    info.pid = std::to_string(10000 + index);
+    info.command = "/bin/sh -c sleep 1000";
+    info.created_time = "Sat Oct 17 12:00:00 2026";
+    info.status = RUNNING;
+    info.network_name = "bench0";
+    info.ip_address = "10.0." + std::to_string(index / 250) + "." + std::to_string(index % 250 + 2);
+    info.cgroup_path = "mydocker/" + info.id;
+    return info;
+}
+
+// 查找 count 个不存在的名称，返回各次延迟
+static std::vector<double> measure_misses(int count) {
+    std::vector<double> samples;
+    ContainerInfo info;
+    for (int i = 0; i < count; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        bool found = store_get("missing-" + std::to_string(i), info);
+        samples.push_back(bench_elapsed_ms(start));
+        if (found) {
+            std::cerr << "[Bench] Unexpected hit for a missing name" << std::endl;
+        }
+    }
+    return samples;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    int churn = argc > 2 ? atoi(argv[2]) : count * 4;
+    if (count <= 0 || churn < 0) {
+        std::cerr << "Usage: " << argv[0] << " [container_count] [churn_cycles]" << std::endl;
+        return 1;
+    }
+    if (!isolate_directory(CONTAINER_INFO_PATH)) {
+        return 1;
+    }
+    printf("[Bench] Container store with %d containers (%s on tmpfs)\n", count, CONTAINER_INFO_PATH.c_str());
+
+    std::vector<ContainerInfo> containers;
+    for (int i = 0; i < count; ++i) {
+        containers.push_back(make_container(i));
+    }
+    std::mt19937 rng(42);
+    int errors = 0;
+
+    // 写入
+    std::vector<double> samples;
+    auto phase = std::chrono::steady_clock::now();
+    for (const auto& info : containers) {
+        auto start = std::chrono::steady_clock::now();
+        if (!store_put(info)) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("put (new)", samples);
+    printf("%-32s %.1f ms total\n", "", bench_elapsed_ms(phase));
+
+    // 按名称、按ID查找（随机顺序）
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    samples.clear();
+    ContainerInfo found;
+    for (int i : order) {
+        auto start = std::chrono::steady_clock::now();
+        if (!store_get(containers[i].name, found) || found.id != containers[i].id) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("get by name", samples);
+    samples.clear();
+    for (int i : order) {
+        auto start = std::chrono::steady_clock::now();
+        if (!store_get(containers[i].id, found) || found.name != containers[i].name) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("get by id", samples);
+
+    // ps：顺序扫描
+    samples.clear();
+    for (int i = 0; i < 20; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (store_list().size() != static_cast<size_t>(count)) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("list (ps)", samples);
+
+    // 更新一半容器的状态
+    samples.clear();
+    for (int i = 0; i < count / 2; ++i) {
+        ContainerInfo& info = containers[order[i]];
+        info.status = EXITED;
+        info.exit_code = "0";
+        auto start = std::chrono::steady_clock::now();
+        if (!store_put(info)) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("put (update)", samples);
+
+    // 创建/删除交替：存活容器数不变，删除标记在索引中累积
+    bench_report("get missing (before churn)", measure_misses(2000));
+    std::vector<double> put_samples, delete_samples;
+    int next_index = count;
+    for (int i = 0; i < churn; ++i) {
+        size_t victim = rng() % containers.size();
+        auto start = std::chrono::steady_clock::now();
+        if (!store_delete(containers[victim].name)) errors++;
+        delete_samples.push_back(bench_elapsed_ms(start));
+        containers[victim] = make_container(next_index++);
+        start = std::chrono::steady_clock::now();
+        if (!store_put(containers[victim])) errors++;
+        put_samples.push_back(bench_elapsed_ms(start));
+    }
+    bench_report("churn: delete", delete_samples);
+    bench_report("churn: put (new name)", put_samples);
+    bench_report("get missing (after churn)", measure_misses(2000));
+
+    // 校验最终状态
+    std::vector<ContainerInfo> listed = store_list();
+    if (listed.size() != containers.size()) {
+        std::cerr << "[Bench] list returned " << listed.size() << " containers, expected " << containers.size()
+                  << std::endl;
+        errors++;
+    }
+    for (const auto& info : containers) {
+        if (!store_get(info.name, found) || found.id != info.id || found.status != info.status) errors++;
+    }
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// tar基准测试：进程内tar读写（image/tar.h）与 system("tar ...") 的打包、解压耗时对比，
+// 分别测试未压缩和gzip，解压结果用 diff -r 与源目录比对。
+// 用法：tar_bench [源目录，默认生成测试目录树] [重复次数，默认3]
+// 默认测试目录树：200个目录、4000个文件，共约160MB，内容为可压缩的文本
+#include "bench.h"
+#include "image/tar.h"
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstdlib>
+#include <sys/stat.h>
+
+static const std::string BENCH_ROOT = "/tmp/mydocker-tar-bench";
+
+// 生成测试目录树：文件大小在1KB到80KB之间，内容由随机单词组成
+static bool generate_tree(const std::string& root) {
+    static const char* words[] = {"container", "layer", "overlay", "namespace", "cgroup", "image", "mount",
+                                  "bridge", "veth", "commit", "0", "1", "2", "3", "\n"};
+    std::mt19937 rng(42);
+    for (int d = 0; d < 200; ++d) {
+        std::string dir = root + "/dir" + std::to_string(d);
+        if (mkdir(dir.c_str(), 0755) != 0) return false;
+        for (int f = 0; f < 20; ++f) {
+            std::ofstream out(dir + "/file" + std::to_string(f) + ".txt");
+            size_t size = 1024 + rng() % (80 * 1024);
+            std::string content;
+            while (content.size() < size) {
+                content += words[rng() % (sizeof(words) / sizeof(words[0]))];
+                content += ' ';
+            }
+            out << content;
+            if (!out) return false;
+        }
+        symlink(("file0.txt"), (dir + "/link").c_str());
+    }
+    return true;
+}
+
+static off_t file_size(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+static bool run_command(const std::string& command) {
+    return system(command.c_str()) == 0;
+}
+
+// 把一个操作执行 repeat 次，返回各次耗时；before 在每次计时前执行（清理目标）
+template <typename Operation, typename Prepare>
+static std::vector<double> measure(int repeat, Prepare before, Operation operation, int& errors) {
+    std::vector<double> samples;
+    for (int i = 0; i < repeat; ++i) {
+        before();
+        auto start = std::chrono::steady_clock::now();
+        if (!operation()) errors++;
+        samples.push_back(bench_elapsed_ms(start));
+    }
+    return samples;
+}
+
+int main(int argc, char* argv[]) {
+    std::string source = argc > 1 ? argv[1] : "";
+    int repeat = argc > 2 ? atoi(argv[2]) : 3;
+    if (repeat <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [source_dir] [repeat]" << std::endl;
+        return 1;
+    }
+    // 归档和解压目录位于tmpfs，只比较CPU开销，不受磁盘影响
+    if (!isolate_directory(BENCH_ROOT)) {
+        return 1;
+    }
+    if (source.empty()) {
+        source = BENCH_ROOT + "/source";
+        if (mkdir(source.c_str(), 0755) != 0 || !generate_tree(source)) {
+            std::cerr << "[Bench] Failed to generate test tree" << std::endl;
+            return 1;
+        }
+    }
+    std::string dest = BENCH_ROOT + "/dest";
+    std::string reset_dest = "rm -rf " + dest + " && mkdir " + dest;
+    std::string native_tar = BENCH_ROOT + "/native.tar";
+    std::string native_gz = BENCH_ROOT + "/native.tar.gz";
+    std::string system_tar = BENCH_ROOT + "/system.tar";
+    std::string system_gz = BENCH_ROOT + "/system.tar.gz";
+    auto nothing = []() {};
+    auto clear_dest = [&]() { run_command(reset_dest); };
+    int errors = 0;
+
+    printf("[Bench] tar of %s, %d runs each\n", source.c_str(), repeat);
+    bench_report("create tar (native)", measure(repeat, nothing, [&]() {
+        return tar_create(source, native_tar, TarCompression::None);
+    }, errors));
+    bench_report("create tar (system tar)", measure(repeat, nothing, [&]() {
+        return run_command("tar -cf " + system_tar + " -C " + source + " .");
+    }, errors));
+    bench_report("extract tar (native)", measure(repeat, clear_dest, [&]() {
+        return tar_extract(native_tar, dest);
+    }, errors));
+    if (!run_command("diff -r " + source + " " + dest)) errors++;
+    bench_report("extract tar (system tar)", measure(repeat, clear_dest, [&]() {
+        return run_command("tar -xf " + system_tar + " -C " + dest);
+    }, errors));
+    printf("%-32s native %lld bytes, system %lld bytes\n", "tar size", (long long)file_size(native_tar),
+           (long long)file_size(system_tar));
+
+    if (tar_gzip_supported()) {
+        bench_report("create tar.gz (native)", measure(repeat, nothing, [&]() {
+            return tar_create(source, native_gz, TarCompression::Gzip);
+        }, errors));
+        bench_report("create tar.gz (system tar -z)", measure(repeat, nothing, [&]() {
+            return run_command("tar -czf " + system_gz + " -C " + source + " .");
+        }, errors));
+        // 本程序写出的分块gzip可并行解压；普通gzip只能顺序解压
+        bench_report("extract tar.gz (native)", measure(repeat, clear_dest, [&]() {
+            return tar_extract(native_gz, dest);
+        }, errors));
+        if (!run_command("diff -r " + source + " " + dest)) errors++;
+        bench_report("extract system tar.gz (native)", measure(repeat, clear_dest, [&]() {
+            return tar_extract(system_gz, dest);
+        }, errors));
+        if (!run_command("diff -r " + source + " " + dest)) errors++;
+        bench_report("extract tar.gz (system tar -z)", measure(repeat, clear_dest, [&]() {
+            return run_command("tar -xzf " + native_gz + " -C " + dest);
+        }, errors));
+        printf("%-32s native %lld bytes, system %lld bytes\n", "tar.gz size", (long long)file_size(native_gz),
+               (long long)file_size(system_gz));
+    } else {
+        printf("[Bench] gzip not supported in this build, skipping tar.gz\n");
+    }
+
+    printf("[Bench] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// 并发压力测试：多个线程同时创建/删除容器工作空间（OverlayFS），
+// 再分多轮并行启动并回收副本容器（run --replicas），每一步后检查是否残留挂载、目录和容器记录。
+// 用法：workspace_stress [工作空间数量，默认200] [副本轮数，默认5] [每轮副本数，默认20] [镜像，默认busybox]
+#include "bench.h"
+#include "common/constants.h"
+#include "container/run.h"
+#include "container/store.h"
+#include "filesystem/filesystem.h"
+#include "image/image.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+
+// WORKSPACE_ROOT 下仍然存在的挂载点数量（不含隔离用的tmpfs本身）
+static int leftover_mounts() {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    int count = 0;
+    while (std::getline(mountinfo, line)) {
+        std::istringstream fields(line);
+        std::string id, parent, devices, root, mount_point;
+        fields >> id >> parent >> devices >> root >> mount_point;
+        if (mount_point.compare(0, WORKSPACE_ROOT.size(), WORKSPACE_ROOT) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// WORKSPACE_ROOT 下残留的容器目录数量
+static int leftover_directories() {
+    DIR* dir = opendir(WORKSPACE_ROOT.c_str());
+    if (!dir) return 0;
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+static int check_leftovers(const std::string& stage) {
+    int mounts = leftover_mounts();
+    int dirs = leftover_directories();
+    size_t records = store_list().size();
+    if (mounts == 0 && dirs == 0 && records == 0) {
+        return 0;
+    }
+    std::cerr << "[Stress] Leftovers after " << stage << ": " << mounts << " mounts, " << dirs
+              << " workspace directories, " << records << " container records" << std::endl;
+    return 1;
+}
+
+// 阶段一：所有线程同时创建并删除工作空间
+static int stress_workspaces(int count, const std::vector<std::string>& lower_dirs) {
+    unsigned worker_count = std::max(4u, std::thread::hardware_concurrency() * 2);
+    std::atomic<int> next_index(0);
+    std::atomic<int> errors(0);
+    std::mutex samples_mutex;
+    std::vector<double> create_samples, delete_samples;
+
+    int saved = silence_stdout();
+    auto phase = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&]() {
+            std::vector<double> created, deleted;
+            while (next_index.fetch_add(1) < count) {
+                Workspace workspace = get_workspace(generate_container_id());
+                auto start = std::chrono::steady_clock::now();
+                bool ok = new_workspace(workspace, lower_dirs, {"", "", false});
+                created.push_back(bench_elapsed_ms(start));
+                // 挂载点应能看到镜像内容
+                if (!ok || access((workspace.mount_point + "bin/sh").c_str(), F_OK) != 0) {
+                    errors++;
+                }
+                start = std::chrono::steady_clock::now();
+                delete_workspace(workspace);
+                deleted.push_back(bench_elapsed_ms(start));
+            }
+            std::lock_guard<std::mutex> lock(samples_mutex);
+            create_samples.insert(create_samples.end(), created.begin(), created.end());
+            delete_samples.insert(delete_samples.end(), deleted.begin(), deleted.end());
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double total = bench_elapsed_ms(phase);
+    restore_stdout(saved);
+    bench_report("new_workspace", create_samples);
+    bench_report("delete_workspace", delete_samples);
+    printf("%-32s %d workspaces with %u threads in %.1f ms\n", "", count, worker_count, total);
+    return errors + check_leftovers("workspace churn");
+}
+
+// 阶段二：多轮并行启动并回收副本容器
+static int stress_replicas(int rounds, int replicas, const std::string& image) {
+    RunOptions options;
+    options.image = image;
+    options.replicas = replicas;
+    options.container_name = "stress";
+    options.command = {"/bin/sh", "-c", "exit 0"};
+    int errors = 0;
+    std::vector<double> samples;
+    for (int round = 0; round < rounds; ++round) {
+        int saved = silence_stdout();
+        auto start = std::chrono::steady_clock::now();
+        int result = run_replicas(options);
+        samples.push_back(bench_elapsed_ms(start));
+        restore_stdout(saved);
+        if (result != 0) errors++;
+        errors += check_leftovers("replica round " + std::to_string(round + 1));
+    }
+    bench_report("run_replicas (" + std::to_string(replicas) + " per round)", samples);
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    int workspaces = argc > 1 ? atoi(argv[1]) : 200;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    int replicas = argc > 3 ? atoi(argv[3]) : 20;
+    std::string image = argc > 4 ? argv[4] : DEFAULT_IMAGE;
+    if (workspaces < 0 || rounds < 0 || replicas <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [workspaces] [replica_rounds] [replicas_per_round] [image]" << std::endl;
+        return 1;
+    }
+    // 容器记录和工作空间位于tmpfs；镜像层和cgroup使用主机上的真实路径
+    if (!isolate_directory(CONTAINER_INFO_PATH) || !isolate_directory(WORKSPACE_ROOT)) {
+        return 1;
+    }
+    std::vector<std::string> layers;
+    int saved = silence_stdout();
+    bool prepared = prepare_image(image, layers);
+    restore_stdout(saved);
+    if (!prepared) {
+        std::cerr << "[Stress] Failed to prepare image " << image << std::endl;
+        return 1;
+    }
+    printf("[Stress] %d workspaces, %d rounds of %d replicas, image %s\n", workspaces, rounds, replicas,
+           image.c_str());
+
+    int errors = stress_workspaces(workspaces, layer_lower_dirs(layers));
+    errors += stress_replicas(rounds, replicas, image);
+    printf("[Stress] %s (%d errors)\n", errors == 0 ? "OK" : "FAILED", errors);
+    return errors == 0 ? 0 : 1;
+}
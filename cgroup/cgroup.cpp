@@ -1,55 +1,277 @@
 #include "cgroup.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
 #include "common/constants.h"
 
-// 设置 cgroup 资源限制（内存、cpu.shares、cpuset）
-void setup_cgroup(pid_t pid, size_t mem_limit_bytes, const std::string& cpu_shares, const std::string& cpuset) {
-    std::cout << "[CGroup] Setting up resource limits for PID " << pid << std::endl;
-    
-    // memory
-    std::string mem_path = CGROUP_ROOT + "/memory/" + CGROUP_NAME;
-    mkdir(mem_path.c_str(), 0755);
-    std::ofstream mem_limit(mem_path + "/memory.limit_in_bytes");
-    mem_limit << mem_limit_bytes;
-    mem_limit.close();
-    std::ofstream mem_procs(mem_path + "/cgroup.procs");
-    mem_procs << pid;
-    mem_procs.close();
-    std::cout << "[CGroup] Memory limit set to " << mem_limit_bytes / (1024*1024) << "MB" << std::endl;
-    
-    // cpu.shares - CPU权重控制（软限制） 示例：1024
-    // 作用：设置进程相对于其他进程的CPU使用权重，不是绝对限制
-    // 特点：当CPU空闲时可以使用更多资源，竞争时按权重分配
-    if (!cpu_shares.empty()) {
-        std::string cpu_path = CGROUP_ROOT + "/cpu/" + CGROUP_NAME;
-        mkdir(cpu_path.c_str(), 0755);
-        std::ofstream cpu_share(cpu_path + "/cpu.shares");
-        cpu_share << cpu_shares;  // 默认1024，设置512表示获得一半CPU时间
-        cpu_share.close();
-        std::ofstream cpu_procs(cpu_path + "/cgroup.procs");
-        cpu_procs << pid;
-        cpu_procs.close();
-        std::cout << "[CGroup] CPU shares set to " << cpu_shares << std::endl;
-    }
-    
-    // cpuset - CPU核心绑定（硬限制） 示例："0" "0,2" "0-3"
-    // 作用：将进程绑定到指定的CPU核心上运行
-    // 特点：硬性限制，进程只能在指定核心上运行，提高缓存命中率
-    if (!cpuset.empty()) {
-        std::string cpuset_path = CGROUP_ROOT + "/cpuset/" + CGROUP_NAME;
-        mkdir(cpuset_path.c_str(), 0755);
-        // 必须先写入 cpuset.mems，否则 cpuset.cpus 无法设置
-        std::ofstream mems(cpuset_path + "/cpuset.mems");
-        mems << "0";  // 指定内存节点，通常设为0（第一个NUMA节点）
-        mems.close();
-        std::ofstream cpus(cpuset_path + "/cpuset.cpus");
-        cpus << cpuset;  // 格式："0"(单核) "0,2"(多核) "0-3"(范围)
-        cpus.close();
-        std::ofstream cpuset_procs(cpuset_path + "/cgroup.procs");
-        cpuset_procs << pid;
-        cpuset_procs.close();
-        std::cout << "[CGroup] CPU set to " << cpuset << std::endl;
-    }
-}
\ No newline at end of file
+// v1下容器cgroup所在的子系统
+static const std::vector<std::string> V1_CONTROLLERS = {"memory", "cpu", "cpuacct", "cpuset", "blkio", "pids"};
+// v2下需要在父cgroup中启用的控制器
+static const std::vector<std::string> V2_CONTROLLERS = {"cpu", "cpuset", "io", "memory", "pids"};
+
+bool cgroup_v2_enabled() {
+    struct statfs fs;
+    return statfs(CGROUP_ROOT.c_str(), &fs) == 0 && fs.f_type == CGROUP2_SUPER_MAGIC;
+}
+
+std::string container_cgroup_path(const std::string& container_id) {
+    return CGROUP_NAME + "/" + container_id;
+}
+
+// 写入cgroup控制文件
+static bool write_cgroup_file(const std::string& path, const std::string& value) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "[CGroup] Failed to open " << path << std::endl;
+        return false;
+    }
+    file << value;
+    file.close();
+    if (file.fail()) {
+        std::cerr << "[CGroup] Failed to write '" << value << "' to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 写入一项资源限制并输出日志
+static bool set_limit(const std::string& dir, const std::string& file, const std::string& value) {
+    if (!write_cgroup_file(dir + "/" + file, value)) {
+        return false;
+    }
+    std::cout << "[CGroup] " << file << " set to " << value << std::endl;
+    return true;
+}
+
+static std::string read_cgroup_file(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    return value;
+}
+
+static bool make_cgroup_dir(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror(("[CGroup] mkdir " + path).c_str());
+        return false;
+    }
+    return true;
+}
+
+// v1 cpu.shares（2-262144）与 v2 cpu.weight（1-10000）之间的换算
+static std::string shares_to_weight(const std::string& shares) {
+    unsigned long value = strtoul(shares.c_str(), nullptr, 10);
+    value = std::max(2ul, std::min(262144ul, value));
+    return std::to_string(1 + ((value - 2) * 9999) / 262142);
+}
+
+static std::string weight_to_shares(const std::string& weight) {
+    unsigned long value = strtoul(weight.c_str(), nullptr, 10);
+    value = std::max(1ul, std::min(10000ul, value));
+    return std::to_string(2 + ((value - 1) * 262142) / 9999);
+}
+
+// 在父cgroup中启用子树控制器（不可用的控制器会被跳过）
+static void enable_v2_controllers(const std::string& parent) {
+    std::string available = " " + read_cgroup_file(parent + "/cgroup.controllers") + " ";
+    std::string enabled = " " + read_cgroup_file(parent + "/cgroup.subtree_control") + " ";
+    for (const auto& controller : V2_CONTROLLERS) {
+        if (available.find(" " + controller + " ") == std::string::npos ||
+            enabled.find(" " + controller + " ") != std::string::npos) {
+            continue;
+        }
+        std::ofstream file(parent + "/cgroup.subtree_control");
+        file << "+" << controller;
+    }
+}
+
+static bool create_v2_cgroup(const std::string& container_id, const CgroupLimits& limits) {
+    std::string parent = CGROUP_ROOT + "/" + CGROUP_NAME;
+    std::string path = CGROUP_ROOT + "/" + container_cgroup_path(container_id);
+    enable_v2_controllers(CGROUP_ROOT);
+    if (!make_cgroup_dir(parent)) {
+        return false;
+    }
+    enable_v2_controllers(parent);
+    if (!make_cgroup_dir(path)) {
+        return false;
+    }
+
+    bool ok = true;
+    if (limits.memory_max > 0) ok &= set_limit(path, "memory.max", std::to_string(limits.memory_max));
+    if (limits.memory_high > 0) ok &= set_limit(path, "memory.high", std::to_string(limits.memory_high));
+    if (!limits.cpu_max.empty()) ok &= set_limit(path, "cpu.max", limits.cpu_max);
+    std::string weight = !limits.cpu_weight.empty() ? limits.cpu_weight
+                         : !limits.cpu_shares.empty() ? shares_to_weight(limits.cpu_shares) : "";
+    if (!weight.empty()) ok &= set_limit(path, "cpu.weight", weight);
+    if (!limits.cpuset.empty()) ok &= set_limit(path, "cpuset.cpus", limits.cpuset);
+    if (!limits.cpuset_mems.empty()) ok &= set_limit(path, "cpuset.mems", limits.cpuset_mems);
+    if (!limits.io_max.empty()) ok &= set_limit(path, "io.max", limits.io_max);
+    if (!limits.pids_max.empty()) ok &= set_limit(path, "pids.max", limits.pids_max);
+    return ok;
+}
+
+// v1 blkio：将 io.max 格式拆分为 blkio.throttle.* 文件
+static bool write_v1_io_limits(const std::string& path, const std::string& io_max) {
+    std::istringstream iss(io_max);
+    std::string device, item;
+    iss >> device;
+    bool ok = true;
+    while (iss >> item) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) continue;
+        std::string key = item.substr(0, equals);
+        std::string value = item.substr(equals + 1);
+        if (value == "max") value = "0";
+        std::string file = key == "rbps" ? "read_bps_device" : key == "wbps" ? "write_bps_device"
+                         : key == "riops" ? "read_iops_device" : key == "wiops" ? "write_iops_device" : "";
+        if (!file.empty()) {
+            ok &= set_limit(path, "blkio.throttle." + file, device + " " + value);
+        }
+    }
+    return ok;
+}
+
+static bool create_v1_cgroup(const std::string& container_id, const CgroupLimits& limits) {
+    auto controller_path = [&](const std::string& controller) {
+        std::string parent = CGROUP_ROOT + "/" + controller + "/" + CGROUP_NAME;
+        make_cgroup_dir(parent);
+        if (controller == "cpuset") {
+            // cpuset子cgroup创建前父cgroup的cpus/mems必须非空
+            if (read_cgroup_file(parent + "/cpuset.cpus").empty()) {
+                write_cgroup_file(parent + "/cpuset.cpus", read_cgroup_file(CGROUP_ROOT + "/cpuset/cpuset.cpus"));
+            }
+            if (read_cgroup_file(parent + "/cpuset.mems").empty()) {
+                write_cgroup_file(parent + "/cpuset.mems", read_cgroup_file(CGROUP_ROOT + "/cpuset/cpuset.mems"));
+            }
+        }
+        std::string path = parent + "/" + container_id;
+        make_cgroup_dir(path);
+        return path;
+    };
+
+    // cpuacct不设置限制，仅用于 stats 统计CPU用量
+    controller_path("cpuacct");
+
+    bool ok = true;
+    if (limits.memory_max > 0 || limits.memory_high > 0) {
+        std::string path = controller_path("memory");
+        if (limits.memory_max > 0) ok &= set_limit(path, "memory.limit_in_bytes", std::to_string(limits.memory_max));
+        if (limits.memory_high > 0) ok &= set_limit(path, "memory.soft_limit_in_bytes", std::to_string(limits.memory_high));
+    }
+
+    // cpu.shares - CPU权重控制（软限制），cpu.cfs_quota_us/cpu.cfs_period_us - CPU带宽（硬限制）
+    std::string shares = !limits.cpu_shares.empty() ? limits.cpu_shares
+                         : !limits.cpu_weight.empty() ? weight_to_shares(limits.cpu_weight) : "";
+    if (!shares.empty() || !limits.cpu_max.empty()) {
+        std::string path = controller_path("cpu");
+        if (!shares.empty()) ok &= set_limit(path, "cpu.shares", shares);
+        if (!limits.cpu_max.empty()) {
+            std::istringstream iss(limits.cpu_max);
+            std::string quota, period = "100000";
+            iss >> quota >> period;
+            ok &= set_limit(path, "cpu.cfs_period_us", period);
+            ok &= set_limit(path, "cpu.cfs_quota_us", quota == "max" ? "-1" : quota);
+        }
+    }
+
+    // cpuset - CPU核心和内存节点绑定（硬限制），v1下两者都必须非空才能加入进程
+    if (!limits.cpuset.empty() || !limits.cpuset_mems.empty()) {
+        std::string path = controller_path("cpuset");
+        std::string parent = CGROUP_ROOT + "/cpuset/" + CGROUP_NAME;
+        ok &= set_limit(path, "cpuset.mems", !limits.cpuset_mems.empty() ? limits.cpuset_mems
+                                             : read_cgroup_file(parent + "/cpuset.mems"));
+        ok &= set_limit(path, "cpuset.cpus", !limits.cpuset.empty() ? limits.cpuset
+                                             : read_cgroup_file(parent + "/cpuset.cpus"));
+    }
+
+    if (!limits.io_max.empty()) {
+        ok &= write_v1_io_limits(controller_path("blkio"), limits.io_max);
+    }
+    if (!limits.pids_max.empty()) {
+        ok &= set_limit(controller_path("pids"), "pids.max", limits.pids_max);
+    }
+    return ok;
+}
+
+bool create_container_cgroup(const std::string& container_id, const CgroupLimits& limits) {
+    std::cout << "[CGroup] Creating cgroup " << container_cgroup_path(container_id)
+              << (cgroup_v2_enabled() ? " (v2)" : " (v1)") << std::endl;
+    if (cgroup_v2_enabled()) {
+        return create_v2_cgroup(container_id, limits);
+    }
+    return create_v1_cgroup(container_id, limits);
+}
+
+int open_container_cgroup(const std::string& container_id) {
+    if (!cgroup_v2_enabled()) {
+        return -1;
+    }
+    std::string path = CGROUP_ROOT + "/" + container_cgroup_path(container_id);
+    return open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+bool attach_container_cgroup(const std::string& container_id, pid_t pid) {
+    std::string relative = container_cgroup_path(container_id);
+    if (cgroup_v2_enabled()) {
+        return write_cgroup_file(CGROUP_ROOT + "/" + relative + "/cgroup.procs", std::to_string(pid));
+    }
+    bool ok = true;
+    for (const auto& controller : V1_CONTROLLERS) {
+        std::string path = CGROUP_ROOT + "/" + controller + "/" + relative;
+        if (access(path.c_str(), F_OK) == 0) {
+            ok &= write_cgroup_file(path + "/cgroup.procs", std::to_string(pid));
+        }
+    }
+    std::cout << "[CGroup] Added PID " << pid << " to " << relative << std::endl;
+    return ok;
+}
+
+std::vector<int> open_container_cgroup_procs(const std::string& container_id) {
+    std::vector<int> fds;
+    std::string relative = container_cgroup_path(container_id);
+    std::vector<std::string> paths;
+    if (cgroup_v2_enabled()) {
+        paths.push_back(CGROUP_ROOT + "/" + relative);
+    } else {
+        for (const auto& controller : V1_CONTROLLERS) {
+            paths.push_back(CGROUP_ROOT + "/" + controller + "/" + relative);
+        }
+    }
+    for (const auto& path : paths) {
+        int fd = open((path + "/cgroup.procs").c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            fds.push_back(fd);
+        }
+    }
+    return fds;
+}
+
+bool container_cgroup_exists(const std::string& container_id) {
+    std::string relative = container_cgroup_path(container_id);
+    // v1下cpuacct目录总会创建
+    std::string path = cgroup_v2_enabled() ? CGROUP_ROOT + "/" + relative
+                                           : CGROUP_ROOT + "/cpuacct/" + relative;
+    return access(path.c_str(), F_OK) == 0;
+}
+
+void remove_container_cgroup(const std::string& container_id) {
+    std::string relative = container_cgroup_path(container_id);
+    if (cgroup_v2_enabled()) {
+        rmdir((CGROUP_ROOT + "/" + relative).c_str());
+        return;
+    }
+    for (const auto& controller : V1_CONTROLLERS) {
+        rmdir((CGROUP_ROOT + "/" + controller + "/" + relative).c_str());
+    }
+}
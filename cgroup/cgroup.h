@@ -2,9 +2,51 @@
 #define CGROUP_H
 
 #include <string>
+#include <vector>
 #include <sys/types.h>
 
-// cgroup资源限制管理
-void setup_cgroup(pid_t pid, size_t mem_limit_bytes, const std::string& cpu_shares, const std::string& cpuset);
+// ==================== cgroup资源限制管理 ====================
+// 每个容器使用独立的cgroup：<CGROUP_ROOT>/<CGROUP_NAME>/<容器ID>
+//   cgroup v2（统一层级）：memory.max/memory.high、cpu.max、cpu.weight、io.max、pids.max、cpuset.cpus/mems
+//   cgroup v1：回退到各子系统下的同名目录，限制写入对应的 v1 文件
+// v2 下先创建并配置cgroup，再通过 clone3(CLONE_INTO_CGROUP) 直接在其中创建容器进程。
 
-#endif // CGROUP_H
\ No newline at end of file
+// 容器的资源限制，空字符串/0表示不限制
+struct CgroupLimits {
+    size_t memory_max = 0;      // 字节
+    size_t memory_high = 0;     // 字节，超过后内核开始回收内存并限流
+    std::string cpu_max;        // "<quota> <period>"（微秒）
+    std::string cpu_weight;     // 1-10000，v2的CPU权重
+    std::string cpu_shares;     // v1的CPU权重（v2下换算为cpu.weight）
+    std::string cpuset;         // "0-3"
+    std::string cpuset_mems;    // 内存节点，"0"；为空时使用全部节点
+    std::string io_max;         // "<major:minor> rbps=<n> wbps=<n> riops=<n> wiops=<n>"
+    std::string pids_max;       // 最大进程数
+};
+
+// 是否为cgroup v2统一层级
+bool cgroup_v2_enabled();
+
+// 容器cgroup相对于层级根目录的路径（<CGROUP_NAME>/<容器ID>），记录在容器信息中
+std::string container_cgroup_path(const std::string& container_id);
+
+// 创建容器cgroup并写入资源限制
+bool create_container_cgroup(const std::string& container_id, const CgroupLimits& limits);
+
+// 打开容器的v2 cgroup目录，用于 clone3(CLONE_INTO_CGROUP)；v1或失败时返回-1
+int open_container_cgroup(const std::string& container_id);
+
+// 将已创建的进程加入容器cgroup（clone3无法直接放入时使用）
+bool attach_container_cgroup(const std::string& container_id, pid_t pid);
+
+// 打开容器cgroup（v1为各层级）的 cgroup.procs，用于已离开主机挂载命名空间的进程
+// 写入"0"将自身加入cgroup；文件描述符为 O_CLOEXEC
+std::vector<int> open_container_cgroup_procs(const std::string& container_id);
+
+// 容器cgroup是否存在
+bool container_cgroup_exists(const std::string& container_id);
+
+// 删除容器cgroup（容器进程退出后调用）
+void remove_container_cgroup(const std::string& container_id);
+
+#endif // CGROUP_H
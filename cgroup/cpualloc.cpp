@@ -0,0 +1,360 @@
+#include "cpualloc.h"
+#include "cgroup.h"
+#include "numa.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+
+static const std::string CPU_ROOT = "/sys/devices/system/cpu";
+// 分配后cgroup尚未创建的时间窗口，超过后cgroup不存在的记录视为过期
+static const time_t STALE_ALLOCATION_SECONDS = 60;
+
+// ==================== 拓扑 ====================
+
+// 每个在线CPU所属的物理核心和LLC域（均以其中编号最小的CPU标识）
+struct CpuTopology {
+    int cpu;
+    int core;
+    int llc;
+};
+
+static std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+static int first_cpu(const std::string& list, int fallback) {
+    std::vector<int> cpus = parse_cpu_list(list);
+    return cpus.empty() ? fallback : cpus.front();
+}
+
+// 最后一级缓存：级别最高的数据/统一缓存
+static int read_llc(int cpu) {
+    std::string base = CPU_ROOT + "/cpu" + std::to_string(cpu) + "/cache/index";
+    int best_level = -1;
+    int llc = cpu;
+    for (int index = 0; access((base + std::to_string(index)).c_str(), F_OK) == 0; ++index) {
+        std::string dir = base + std::to_string(index);
+        if (read_line(dir + "/type") == "Instruction") continue;
+        int level = atoi(read_line(dir + "/level").c_str());
+        if (level > best_level) {
+            best_level = level;
+            llc = first_cpu(read_line(dir + "/shared_cpu_list"), cpu);
+        }
+    }
+    return llc;
+}
+
+static std::vector<CpuTopology> read_cpu_topology() {
+    std::vector<CpuTopology> topology;
+    for (int cpu : parse_cpu_list(read_line(CPU_ROOT + "/online"))) {
+        std::string dir = CPU_ROOT + "/cpu" + std::to_string(cpu) + "/topology";
+        topology.push_back({cpu, first_cpu(read_line(dir + "/thread_siblings_list"), cpu), read_llc(cpu)});
+    }
+    return topology;
+}
+
+// ==================== 占用表 ====================
+// CPUSET_MAP_FILE 每行一条分配记录：<容器ID> <exclusive|shared> <CPU列表> <分配时间>
+
+struct CpuAllocation {
+    std::string container_id;
+    bool exclusive = false;
+    std::vector<int> cpus;
+    time_t allocated_at = 0;
+};
+
+// 对占用表加排他锁，返回锁文件描述符
+static int lock_cpu_map() {
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+    int fd = open(CPUSET_LOCK_FILE.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("[CPU] Failed to open cpuset lock file");
+        return -1;
+    }
+    if (flock(fd, LOCK_EX) != 0) {
+        perror("[CPU] flock failed");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void unlock_cpu_map(int fd) {
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+static std::vector<CpuAllocation> read_cpu_map() {
+    std::vector<CpuAllocation> allocations;
+    std::ifstream file(CPUSET_MAP_FILE);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        CpuAllocation allocation;
+        std::string mode, cpus;
+        if (!(iss >> allocation.container_id >> mode >> cpus >> allocation.allocated_at)) {
+            continue;
+        }
+        allocation.exclusive = mode == "exclusive";
+        allocation.cpus = parse_cpu_list(cpus);
+        allocations.push_back(allocation);
+    }
+    return allocations;
+}
+
+// 写入临时文件后rename，读者不会看到写了一半的占用表
+static bool write_cpu_map(const std::vector<CpuAllocation>& allocations) {
+    std::string temp_path = CPUSET_MAP_FILE + ".tmp";
+    std::ofstream file(temp_path, std::ios::trunc);
+    for (const auto& allocation : allocations) {
+        file << allocation.container_id << " " << (allocation.exclusive ? "exclusive" : "shared") << " "
+             << format_cpu_list(allocation.cpus) << " " << allocation.allocated_at << "\n";
+    }
+    file.close();
+    if (file.fail() || rename(temp_path.c_str(), CPUSET_MAP_FILE.c_str()) != 0) {
+        std::cerr << "[CPU] Failed to write " << CPUSET_MAP_FILE << std::endl;
+        unlink(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 清除容器cgroup已不存在的记录（进程异常退出未释放）
+static void prune_stale_allocations(std::vector<CpuAllocation>& allocations) {
+    time_t now = time(nullptr);
+    auto stale = [&](const CpuAllocation& allocation) {
+        if (now - allocation.allocated_at < STALE_ALLOCATION_SECONDS ||
+            container_cgroup_exists(allocation.container_id)) {
+            return false;
+        }
+        std::cout << "[CPU] Released stale allocation of " << allocation.container_id << std::endl;
+        return true;
+    };
+    allocations.erase(std::remove_if(allocations.begin(), allocations.end(), stale), allocations.end());
+}
+
+// ==================== 分配策略 ====================
+
+struct CpuUsage {
+    bool exclusive = false;
+    int shared = 0;
+};
+
+// 独占：选择全部线程空闲的物理核心；优先放入能容纳请求且空闲线程最少的LLC域（best fit），
+// 大块空闲的LLC域留给后续的大请求；没有单个LLC域放得下时跨域分配
+static std::vector<int> pick_exclusive(const std::vector<CpuTopology>& topology,
+                                       const std::map<int, CpuUsage>& usage,
+                                       const std::set<int>& allowed, int count) {
+    std::map<int, std::vector<int>> cores;   // 核心 -> 线程
+    std::map<int, int> core_llc;
+    for (const auto& cpu : topology) {
+        cores[cpu.core].push_back(cpu.cpu);
+        core_llc[cpu.core] = cpu.llc;
+    }
+
+    std::map<int, std::vector<int>> domains; // LLC域 -> 可用核心
+    std::map<int, int> domain_threads;
+    for (const auto& core : cores) {
+        bool usable = true;
+        for (int cpu : core.second) {
+            auto it = usage.find(cpu);
+            bool busy = it != usage.end() && (it->second.exclusive || it->second.shared > 0);
+            if (busy || allowed.count(cpu) == 0) usable = false;
+        }
+        if (usable) {
+            domains[core_llc[core.first]].push_back(core.first);
+            domain_threads[core_llc[core.first]] += core.second.size();
+        }
+    }
+
+    std::vector<int> order;
+    int best = -1;
+    for (const auto& domain : domain_threads) {
+        if (domain.second >= count && (best < 0 || domain.second < domain_threads[best])) {
+            best = domain.first;
+        }
+    }
+    if (best >= 0) {
+        order.push_back(best);
+    } else {
+        for (const auto& domain : domain_threads) order.push_back(domain.first);
+        std::sort(order.begin(), order.end(),
+                  [&](int a, int b) { return domain_threads[a] > domain_threads[b]; });
+        if (order.size() > 1) {
+            std::cout << "[CPU] No single LLC domain has " << count << " free CPUs, spanning domains" << std::endl;
+        }
+    }
+
+    std::vector<int> picked;
+    for (int llc : order) {
+        for (int core : domains[llc]) {
+            if (static_cast<int>(picked.size()) >= count) break;
+            picked.insert(picked.end(), cores[core].begin(), cores[core].end());
+        }
+    }
+    if (static_cast<int>(picked.size()) < count) {
+        return {};
+    }
+    std::sort(picked.begin(), picked.end());
+    return picked;
+}
+
+// 共享：在未被独占的CPU中，优先选择需要新占用空闲核心最少、平均负载最低的LLC域；
+// 域内先使用已有共享容器的物理核心上负载最低的线程，再按"每个物理核心一个线程"的顺序使用空闲核心
+static std::vector<int> pick_shared(const std::vector<CpuTopology>& topology,
+                                    const std::map<int, CpuUsage>& usage,
+                                    const std::set<int>& allowed, int count) {
+    std::map<int, std::vector<const CpuTopology*>> domains;
+    std::vector<const CpuTopology*> all;
+    for (const auto& cpu : topology) {
+        auto it = usage.find(cpu.cpu);
+        if (allowed.count(cpu.cpu) == 0 || (it != usage.end() && it->second.exclusive)) continue;
+        domains[cpu.llc].push_back(&cpu);
+        all.push_back(&cpu);
+    }
+    auto shared_of = [&](int cpu) {
+        auto it = usage.find(cpu);
+        return it == usage.end() ? 0 : it->second.shared;
+    };
+    // 已被共享容器使用的物理核心，其空闲线程也不能再独占分配
+    std::set<int> shared_cores;
+    for (const auto& cpu : topology) {
+        if (shared_of(cpu.cpu) > 0) shared_cores.insert(cpu.core);
+    }
+
+    const std::vector<const CpuTopology*>* chosen = nullptr;
+    int best_new = 0;
+    double best_load = 0;
+    for (const auto& domain : domains) {
+        if (static_cast<int>(domain.second.size()) < count) continue;
+        int in_use = 0, load = 0;
+        for (const CpuTopology* cpu : domain.second) {
+            in_use += shared_cores.count(cpu->core);
+            load += shared_of(cpu->cpu);
+        }
+        int new_cpus = std::max(0, count - in_use);
+        double average = static_cast<double>(load) / domain.second.size();
+        if (chosen == nullptr || new_cpus < best_new || (new_cpus == best_new && average < best_load)) {
+            chosen = &domain.second;
+            best_new = new_cpus;
+            best_load = average;
+        }
+    }
+    if (chosen == nullptr) {
+        if (static_cast<int>(all.size()) < count) return {};
+        chosen = &all;
+    }
+
+    // 线程在其物理核心中的序号，用于优先占用不同的物理核心
+    std::map<int, int> thread_index;
+    std::map<int, int> core_threads;
+    for (const auto& cpu : topology) {
+        thread_index[cpu.cpu] = core_threads[cpu.core]++;
+    }
+    std::vector<const CpuTopology*> candidates = *chosen;
+    std::sort(candidates.begin(), candidates.end(), [&](const CpuTopology* a, const CpuTopology* b) {
+        bool pooled_a = shared_cores.count(a->core) > 0, pooled_b = shared_cores.count(b->core) > 0;
+        if (pooled_a != pooled_b) return pooled_a;
+        int shared_a = shared_of(a->cpu), shared_b = shared_of(b->cpu);
+        if (shared_a != shared_b) return shared_a < shared_b;
+        if (thread_index[a->cpu] != thread_index[b->cpu]) return thread_index[a->cpu] < thread_index[b->cpu];
+        return a->cpu < b->cpu;
+    });
+
+    std::vector<int> picked;
+    for (int i = 0; i < count; ++i) {
+        picked.push_back(candidates[i]->cpu);
+    }
+    std::sort(picked.begin(), picked.end());
+    return picked;
+}
+
+bool allocate_container_cpus(const std::string& container_id, const CpuRequest& request, std::string& cpus) {
+    std::vector<CpuTopology> topology = read_cpu_topology();
+    std::set<int> allowed;
+    for (const auto& cpu : topology) {
+        if (request.allowed.empty() ||
+            std::find(request.allowed.begin(), request.allowed.end(), cpu.cpu) != request.allowed.end()) {
+            allowed.insert(cpu.cpu);
+        }
+    }
+    if (request.count < 1 || topology.empty()) {
+        std::cerr << "[CPU] Invalid CPU request" << std::endl;
+        return false;
+    }
+
+    int lock_fd = lock_cpu_map();
+    if (lock_fd < 0) {
+        return false;
+    }
+    std::vector<CpuAllocation> allocations = read_cpu_map();
+    prune_stale_allocations(allocations);
+
+    std::map<int, CpuUsage> usage;
+    for (const auto& allocation : allocations) {
+        for (int cpu : allocation.cpus) {
+            if (allocation.exclusive) {
+                usage[cpu].exclusive = true;
+            } else {
+                usage[cpu].shared++;
+            }
+        }
+    }
+
+    std::vector<int> picked = request.exclusive ? pick_exclusive(topology, usage, allowed, request.count)
+                                                : pick_shared(topology, usage, allowed, request.count);
+    if (picked.empty()) {
+        std::cerr << "[CPU] Not enough " << (request.exclusive ? "free" : "unreserved") << " CPUs for "
+                  << request.count << (request.exclusive ? " exclusive" : " shared") << " CPU(s)" << std::endl;
+        unlock_cpu_map(lock_fd);
+        return false;
+    }
+
+    CpuAllocation allocation;
+    allocation.container_id = container_id;
+    allocation.exclusive = request.exclusive;
+    allocation.cpus = picked;
+    allocation.allocated_at = time(nullptr);
+    allocations.push_back(allocation);
+    bool ok = write_cpu_map(allocations);
+    unlock_cpu_map(lock_fd);
+    if (!ok) {
+        return false;
+    }
+
+    cpus = format_cpu_list(picked);
+    std::cout << "[CPU] Allocated " << (request.exclusive ? "exclusive" : "shared") << " CPUs " << cpus
+              << " to " << container_id << std::endl;
+    return true;
+}
+
+void release_container_cpus(const std::string& container_id) {
+    int lock_fd = lock_cpu_map();
+    if (lock_fd < 0) {
+        return;
+    }
+    std::vector<CpuAllocation> allocations = read_cpu_map();
+    auto owned = [&](const CpuAllocation& allocation) { return allocation.container_id == container_id; };
+    auto it = std::remove_if(allocations.begin(), allocations.end(), owned);
+    if (it != allocations.end()) {
+        allocations.erase(it, allocations.end());
+        if (write_cpu_map(allocations)) {
+            std::cout << "[CPU] Released CPUs of " << container_id << std::endl;
+        }
+    }
+    unlock_cpu_map(lock_fd);
+}
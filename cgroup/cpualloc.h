@@ -0,0 +1,27 @@
+#ifndef CPUALLOC_H
+#define CPUALLOC_H
+
+#include <string>
+#include <vector>
+
+// ==================== CPU核心分配（--cpuset auto） ====================
+// 全局核心占用表记录每个容器分配到的CPU，所有进程通过锁文件（flock）串行化读写。
+// 拓扑从 /sys/devices/system/cpu/cpu<N>/topology（SMT兄弟线程）
+// 和 cache/index<K>（最后一级缓存的共享CPU）读取：
+//   独占：按整个物理核心分配（含全部SMT线程），优先放入恰好能容纳的LLC域，减少缓存干扰；
+//   共享：优先复用已被共享容器占用、负载最低的CPU，把空闲核心留给独占容器。
+// 容器 stop/rm 或启动失败时释放；占用表中cgroup已不存在的过期记录在下次分配时清除。
+
+struct CpuRequest {
+    int count = 1;              // 需要的逻辑CPU数
+    bool exclusive = false;     // 独占（不与其他容器共享核心）
+    std::vector<int> allowed;   // 可选的CPU（如NUMA节点），为空表示全部在线CPU
+};
+
+// 为容器分配CPU并写入占用表，cpus 返回 cpuset.cpus 格式
+bool allocate_container_cpus(const std::string& container_id, const CpuRequest& request, std::string& cpus);
+
+// 释放容器占用的CPU，容器没有分配记录时不做任何事
+void release_container_cpus(const std::string& container_id);
+
+#endif // CPUALLOC_H
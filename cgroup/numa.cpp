@@ -0,0 +1,194 @@
+#include "numa.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+
+static const std::string NODE_ROOT = "/sys/devices/system/node";
+static const std::string CPU_ONLINE = "/sys/devices/system/cpu/online";
+
+static std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty()) continue;
+        char* end;
+        long first = strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (*end == '-') {
+            last = strtol(end + 1, &end, 10);
+        }
+        if (*end != '\0' || end == item.c_str() || first < 0 || last < first) {
+            return {};
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::string list;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!list.empty()) list += ",";
+        list += std::to_string(cpus[i]);
+        if (j > i) list += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return list;
+}
+
+// 节点meminfo中的 "Node <N> MemFree: <kB> kB"
+static size_t read_node_mem_free(int node) {
+    std::ifstream file(NODE_ROOT + "/node" + std::to_string(node) + "/meminfo");
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t pos = line.find("MemFree:");
+        if (pos != std::string::npos) {
+            return strtoull(line.c_str() + pos + strlen("MemFree:"), nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// 无NUMA信息时的系统空闲内存
+static size_t read_system_mem_free() {
+    std::ifstream file("/proc/meminfo");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, strlen("MemFree:"), "MemFree:") == 0) {
+            return strtoull(line.c_str() + strlen("MemFree:"), nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+std::vector<NumaNode> numa_topology() {
+    std::vector<NumaNode> nodes;
+    DIR* dir = opendir(NODE_ROOT.c_str());
+    if (dir != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            const char* name = entry->d_name;
+            if (strncmp(name, "node", 4) != 0 || !isdigit(static_cast<unsigned char>(name[4]))) {
+                continue;
+            }
+            NumaNode node;
+            node.id = atoi(name + 4);
+            node.cpus = parse_cpu_list(read_line(NODE_ROOT + "/" + name + "/cpulist"));
+            node.mem_free_kb = read_node_mem_free(node.id);
+            nodes.push_back(node);
+        }
+        closedir(dir);
+    }
+
+    if (nodes.empty()) {
+        NumaNode node;
+        node.cpus = parse_cpu_list(read_line(CPU_ONLINE));
+        node.mem_free_kb = read_system_mem_free();
+        nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end(),
+              [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return nodes;
+}
+
+static std::vector<int> intersect(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> result;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+std::string numa_mems_for_cpus(const std::vector<NumaNode>& nodes, const std::string& cpuset) {
+    std::vector<int> cpus = parse_cpu_list(cpuset);
+    std::vector<int> mems;
+    for (const auto& node : nodes) {
+        if (!intersect(node.cpus, cpus).empty()) {
+            mems.push_back(node.id);
+        }
+    }
+    return format_cpu_list(mems);
+}
+
+bool numa_place(const std::vector<NumaNode>& nodes, const std::string& mode, const std::string& cpuset,
+                const std::vector<std::string>& placed_mems, NumaPlacement& placement) {
+    placement = NumaPlacement();
+    std::vector<int> requested = parse_cpu_list(cpuset);
+    if (!cpuset.empty() && requested.empty()) {
+        std::cerr << "[NUMA] Invalid cpuset: " << cpuset << std::endl;
+        return false;
+    }
+
+    if (mode.empty()) {
+        // 仅指定 --cpuset：内存节点跟随CPU
+        placement.cpus = cpuset;
+        placement.mems = numa_mems_for_cpus(nodes, cpuset);
+        return true;
+    }
+
+    // 候选节点：有CPU且与 --cpuset 相交（纯内存节点不参与放置）
+    std::vector<const NumaNode*> candidates;
+    for (const auto& node : nodes) {
+        if (node.cpus.empty()) continue;
+        if (!requested.empty() && intersect(node.cpus, requested).empty()) continue;
+        candidates.push_back(&node);
+    }
+
+    const NumaNode* chosen = nullptr;
+    if (mode == "auto") {
+        double best_load = 0;
+        for (const NumaNode* node : candidates) {
+            int count = 0;
+            for (const auto& mems : placed_mems) {
+                std::vector<int> placed = parse_cpu_list(mems);
+                if (std::binary_search(placed.begin(), placed.end(), node->id)) ++count;
+            }
+            double load = static_cast<double>(count) / node->cpus.size();
+            if (chosen == nullptr || load < best_load ||
+                (load == best_load && node->mem_free_kb > chosen->mem_free_kb)) {
+                chosen = node;
+                best_load = load;
+            }
+        }
+    } else {
+        char* end;
+        long id = strtol(mode.c_str(), &end, 10);
+        if (*end != '\0' || end == mode.c_str()) {
+            std::cerr << "[NUMA] Invalid --numa value: " << mode << " (expected 'auto' or a node id)" << std::endl;
+            return false;
+        }
+        for (const NumaNode* node : candidates) {
+            if (node->id == id) chosen = node;
+        }
+    }
+
+    if (chosen == nullptr) {
+        std::cerr << "[NUMA] No NUMA node with CPUs matches --numa " << mode
+                  << (cpuset.empty() ? "" : " and --cpuset " + cpuset) << std::endl;
+        return false;
+    }
+
+    placement.node = chosen->id;
+    placement.cpus = format_cpu_list(requested.empty() ? chosen->cpus : intersect(chosen->cpus, requested));
+    placement.mems = std::to_string(chosen->id);
+    std::cout << "[NUMA] Placed on node " << chosen->id << " (cpus " << placement.cpus
+              << ", " << chosen->mem_free_kb / 1024 << " MB free)" << std::endl;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// ==================== NUMA拓扑与放置 ====================
+// 从 /sys/devices/system/node/node<N>/{cpulist,meminfo} 读取各节点的CPU和空闲内存。
+// --cpuset 指定的CPU所在节点即为容器的 cpuset.mems，使内存从本地节点分配；
+// --numa auto 选择负载最低的节点，把容器的CPU和内存都限定在该节点上。
+// 内核未提供NUMA信息时视为只有节点0，包含全部在线CPU。
+
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;      // 节点上的CPU编号（升序）
+    size_t mem_free_kb = 0;     // 节点空闲内存
+};
+
+// 容器的放置结果
+struct NumaPlacement {
+    int node = -1;              // --numa 选中的节点，-1表示未指定
+    std::string cpus;           // cpuset.cpus
+    std::string mems;           // cpuset.mems
+};
+
+// 读取NUMA拓扑，按节点编号升序
+std::vector<NumaNode> numa_topology();
+
+// 解析/生成CPU列表格式（"0-3,8,10-11"），非法时返回空
+std::vector<int> parse_cpu_list(const std::string& list);
+std::string format_cpu_list(const std::vector<int>& cpus);
+
+// cpuset中的CPU所属节点（cpuset.mems格式），无法对应到任何节点时返回空
+std::string numa_mems_for_cpus(const std::vector<NumaNode>& nodes, const std::string& cpuset);
+
+// 计算容器放置：mode 为 "auto"、节点编号或空（仅由 cpuset 推导 mems）。
+// cpuset 非空时只在与其相交的节点中选择，CPU取两者交集；
+// placed_mems 为已放置容器的 cpuset.mems，auto模式按"每CPU容器数"选择最空闲的节点，
+// 相同时选择空闲内存最多的节点
+bool numa_place(const std::vector<NumaNode>& nodes, const std::string& mode, const std::string& cpuset,
+                const std::vector<std::string>& placed_mems, NumaPlacement& placement);
+
+#endif // NUMA_H
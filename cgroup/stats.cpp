@@ -0,0 +1,393 @@
+#include "stats.h"
+#include "cgroup.h"
+#include "common/constants.h"
+#include "common/structures.h"
+#include "container/container.h"
+#include <iostream>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 每个容器需要采样的统计文件
+enum StatFile {
+    STAT_MEMORY_CURRENT,
+    STAT_MEMORY_STAT,
+    STAT_CPU_USAGE,         // 仅v1：cpuacct.usage（v2的用量在cpu.stat中）
+    STAT_CPU_STAT,
+    STAT_IO_STAT,
+    STAT_PIDS_CURRENT,
+    STAT_CPU_PRESSURE,
+    STAT_MEMORY_PRESSURE,
+    STAT_IO_PRESSURE,
+    STAT_FILE_COUNT
+};
+
+// 一次采样的结果
+struct StatSample {
+    std::chrono::steady_clock::time_point time;
+    uint64_t memory = 0;
+    uint64_t anon = 0;
+    uint64_t file = 0;
+    uint64_t cpu_usec = 0;
+    uint64_t nr_throttled = 0;
+    uint64_t throttled_usec = 0;
+    uint64_t io_read = 0;
+    uint64_t io_write = 0;
+    uint64_t pids = 0;
+    double psi[3] = {-1, -1, -1};   // cpu/memory/io 的 some avg10
+    bool has_pids = false;
+};
+
+static volatile sig_atomic_t stats_stop_requested = 0;
+
+static void handle_stats_signal(int) {
+    stats_stop_requested = 1;
+}
+
+// 从统计文件内容中查找 "key value" 行
+static uint64_t stat_value(const char* content, const char* key) {
+    size_t key_len = strlen(key);
+    for (const char* line = content; line && *line; ) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ' ') {
+            return strtoull(line + key_len + 1, nullptr, 10);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return 0;
+}
+
+// io.stat（v2）：每个设备一行 "maj:min rbytes=N wbytes=N rios=N wios=N ..."
+static void parse_io_stat_v2(const char* content, uint64_t& read_bytes, uint64_t& write_bytes) {
+    for (const char* p = strstr(content, "rbytes="); p; p = strstr(p + 1, "rbytes=")) {
+        read_bytes += strtoull(p + 7, nullptr, 10);
+    }
+    for (const char* p = strstr(content, "wbytes="); p; p = strstr(p + 1, "wbytes=")) {
+        write_bytes += strtoull(p + 7, nullptr, 10);
+    }
+}
+
+// blkio.throttle.io_service_bytes（v1）：每个设备多行 "maj:min Read N"
+static void parse_io_stat_v1(const char* content, uint64_t& read_bytes, uint64_t& write_bytes) {
+    for (const char* p = strstr(content, " Read "); p; p = strstr(p + 1, " Read ")) {
+        read_bytes += strtoull(p + 6, nullptr, 10);
+    }
+    for (const char* p = strstr(content, " Write "); p; p = strstr(p + 1, " Write ")) {
+        write_bytes += strtoull(p + 7, nullptr, 10);
+    }
+}
+
+// PSI：第一行 "some avg10=0.00 avg60=0.00 avg300=0.00 total=N"
+static double parse_psi_avg10(const char* content) {
+    const char* p = strstr(content, "some avg10=");
+    return p ? strtod(p + 11, nullptr) : -1;
+}
+
+// 单个容器的统计文件集合，文件只打开一次
+class ContainerStats {
+public:
+    ContainerStats(const ContainerInfo& info) : info(info), v2(cgroup_v2_enabled()), memory_limit(0), has_prev(false) {
+        for (int& fd : fds) fd = -1;
+    }
+    ~ContainerStats() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+    ContainerStats(const ContainerStats&) = delete;
+    ContainerStats& operator=(const ContainerStats&) = delete;
+
+    bool open_files();
+    bool sample(StatSample& sample);
+    void render(const StatSample& current);
+    void remember(const StatSample& current) {
+        prev = current;
+        has_prev = true;
+    }
+
+    ContainerInfo info;
+
+private:
+    bool read_file(StatFile file, char* buffer, size_t size);
+
+    bool v2;
+    int fds[STAT_FILE_COUNT];
+    uint64_t memory_limit;
+    StatSample prev;
+    bool has_prev;
+};
+
+bool ContainerStats::open_files() {
+    std::string relative = info.cgroup_path.find('/') != std::string::npos ? info.cgroup_path
+                                                                            : container_cgroup_path(info.id);
+    const char* names[STAT_FILE_COUNT];
+    std::string dirs[STAT_FILE_COUNT];
+    if (v2) {
+        std::string dir = CGROUP_ROOT + "/" + relative + "/";
+        const char* v2_names[STAT_FILE_COUNT] = {"memory.current", "memory.stat", nullptr, "cpu.stat", "io.stat",
+                                                 "pids.current", "cpu.pressure", "memory.pressure", "io.pressure"};
+        for (int i = 0; i < STAT_FILE_COUNT; ++i) {
+            names[i] = v2_names[i];
+            dirs[i] = dir;
+        }
+    } else {
+        const char* v1_names[STAT_FILE_COUNT] = {"memory.usage_in_bytes", "memory.stat", "cpuacct.usage",
+                                                 "cpu.stat", "blkio.throttle.io_service_bytes", "pids.current",
+                                                 "cpu.pressure", nullptr, nullptr};
+        const char* v1_controllers[STAT_FILE_COUNT] = {"memory", "memory", "cpuacct", "cpu", "blkio",
+                                                       "pids", "cpu", nullptr, nullptr};
+        for (int i = 0; i < STAT_FILE_COUNT; ++i) {
+            names[i] = v1_names[i];
+            if (v1_controllers[i]) {
+                dirs[i] = CGROUP_ROOT + "/" + v1_controllers[i] + "/" + relative + "/";
+            }
+        }
+    }
+
+    bool any_open = false;
+    for (int i = 0; i < STAT_FILE_COUNT; ++i) {
+        if (names[i] != nullptr) {
+            fds[i] = open((dirs[i] + names[i]).c_str(), O_RDONLY | O_CLOEXEC);
+            any_open |= fds[i] >= 0;
+        }
+    }
+
+    // 内存上限只读取一次
+    std::string limit_file = v2 ? CGROUP_ROOT + "/" + relative + "/memory.max"
+                                : CGROUP_ROOT + "/memory/" + relative + "/memory.limit_in_bytes";
+    FILE* limit = fopen(limit_file.c_str(), "r");
+    if (limit) {
+        char value[32] = {0};
+        if (fgets(value, sizeof(value), limit) && strncmp(value, "max", 3) != 0) {
+            memory_limit = strtoull(value, nullptr, 10);
+        }
+        fclose(limit);
+    }
+    return any_open;
+}
+
+bool ContainerStats::read_file(StatFile file, char* buffer, size_t size) {
+    if (fds[file] < 0) {
+        return false;
+    }
+    ssize_t n = pread(fds[file], buffer, size - 1, 0);
+    if (n < 0) {
+        return false;
+    }
+    buffer[n] = '\0';
+    return true;
+}
+
+bool ContainerStats::sample(StatSample& sample) {
+    char buffer[8192];
+    sample = StatSample();
+    sample.time = std::chrono::steady_clock::now();
+
+    if (!read_file(STAT_MEMORY_CURRENT, buffer, sizeof(buffer))) {
+        return false; // cgroup已被删除
+    }
+    sample.memory = strtoull(buffer, nullptr, 10);
+    if (read_file(STAT_MEMORY_STAT, buffer, sizeof(buffer))) {
+        sample.anon = stat_value(buffer, v2 ? "anon" : "rss");
+        sample.file = stat_value(buffer, v2 ? "file" : "cache");
+    }
+    if (read_file(STAT_CPU_STAT, buffer, sizeof(buffer))) {
+        sample.nr_throttled = stat_value(buffer, "nr_throttled");
+        if (v2) {
+            sample.cpu_usec = stat_value(buffer, "usage_usec");
+            sample.throttled_usec = stat_value(buffer, "throttled_usec");
+        } else {
+            sample.throttled_usec = stat_value(buffer, "throttled_time") / 1000;
+        }
+    }
+    if (!v2 && read_file(STAT_CPU_USAGE, buffer, sizeof(buffer))) {
+        sample.cpu_usec = strtoull(buffer, nullptr, 10) / 1000;
+    }
+    if (read_file(STAT_IO_STAT, buffer, sizeof(buffer))) {
+        if (v2) {
+            parse_io_stat_v2(buffer, sample.io_read, sample.io_write);
+        } else {
+            parse_io_stat_v1(buffer, sample.io_read, sample.io_write);
+        }
+    }
+    if (read_file(STAT_PIDS_CURRENT, buffer, sizeof(buffer))) {
+        sample.pids = strtoull(buffer, nullptr, 10);
+        sample.has_pids = true;
+    }
+    const StatFile pressure_files[3] = {STAT_CPU_PRESSURE, STAT_MEMORY_PRESSURE, STAT_IO_PRESSURE};
+    for (int i = 0; i < 3; ++i) {
+        if (read_file(pressure_files[i], buffer, sizeof(buffer))) {
+            sample.psi[i] = parse_psi_avg10(buffer);
+        }
+    }
+    return true;
+}
+
+static std::string format_bytes(double bytes) {
+    const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    int unit = 0;
+    while (bytes >= 1024 && unit < 4) {
+        bytes /= 1024;
+        unit++;
+    }
+    char text[32];
+    snprintf(text, sizeof(text), unit == 0 ? "%.0f%s" : "%.1f%s", bytes, units[unit]);
+    return text;
+}
+
+static std::string format_psi(const double psi[3]) {
+    std::string text;
+    for (int i = 0; i < 3; ++i) {
+        char value[16];
+        if (psi[i] < 0) {
+            snprintf(value, sizeof(value), "-");
+        } else {
+            snprintf(value, sizeof(value), "%.1f", psi[i]);
+        }
+        text += (i > 0 ? "/" : "") + std::string(value);
+    }
+    return text;
+}
+
+void ContainerStats::render(const StatSample& current) {
+    // 速率基于与上一次采样的差值，第一次采样没有速率
+    std::string cpu = "-", io_read = "-", io_write = "-", throttled = "-";
+    if (has_prev) {
+        double seconds = std::chrono::duration<double>(current.time - prev.time).count();
+        if (seconds > 0) {
+            char value[32];
+            snprintf(value, sizeof(value), "%.2f%%", (current.cpu_usec - prev.cpu_usec) / (seconds * 1e4));
+            cpu = value;
+            io_read = format_bytes((current.io_read - prev.io_read) / seconds) + "/s";
+            io_write = format_bytes((current.io_write - prev.io_write) / seconds) + "/s";
+            snprintf(value, sizeof(value), "%llu/%.0fms",
+                     static_cast<unsigned long long>(current.nr_throttled - prev.nr_throttled),
+                     (current.throttled_usec - prev.throttled_usec) / 1000.0);
+            throttled = value;
+        }
+    }
+    std::string memory = format_bytes(current.memory) + " / " +
+                         (memory_limit > 0 ? format_bytes(memory_limit) : std::string("max"));
+    char memory_percent[16] = "-";
+    if (memory_limit > 0) {
+        snprintf(memory_percent, sizeof(memory_percent), "%.2f%%", current.memory * 100.0 / memory_limit);
+    }
+    std::string pids = current.has_pids ? std::to_string(current.pids) : "-";
+
+    printf("%-12s %-12s %-8s %-22s %-7s %-10s %-10s %-5s %-11s %-11s %-12s %-14s\n",
+           info.id.substr(0, 12).c_str(), info.name.substr(0, 12).c_str(), cpu.c_str(), memory.c_str(),
+           memory_percent, format_bytes(current.anon).c_str(), format_bytes(current.file).c_str(), pids.c_str(),
+           io_read.c_str(), io_write.c_str(), throttled.c_str(), format_psi(current.psi).c_str());
+}
+
+static void print_stats_header() {
+    printf("%-12s %-12s %-8s %-22s %-7s %-10s %-10s %-5s %-11s %-11s %-12s %-14s\n",
+           "ID", "NAME", "CPU %", "MEM USAGE / LIMIT", "MEM %", "ANON", "FILE", "PIDS",
+           "IO READ", "IO WRITE", "THROTTLED", "PSI cpu/mem/io");
+}
+
+// 需要统计的容器：指定的容器，或全部运行中的容器
+static std::vector<ContainerInfo> select_containers(const StatsOptions& options) {
+    std::vector<ContainerInfo> selected;
+    if (options.containers.empty()) {
+        for (const auto& info : load_all_container_infos()) {
+            if (info.status == RUNNING) {
+                selected.push_back(info);
+            }
+        }
+        return selected;
+    }
+    for (const auto& name : options.containers) {
+        ContainerInfo info;
+        if (find_container_info(name, info)) {
+            selected.push_back(info);
+        } else {
+            std::cerr << "[Stats] Container not found: " << name << std::endl;
+        }
+    }
+    return selected;
+}
+
+bool parse_stats_options(int argc, char* argv[], StatsOptions& options) {
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-stream") == 0) {
+            options.stream = false;
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            options.interval_ms = atoi(argv[++i]);
+        } else {
+            options.containers.push_back(argv[i]);
+        }
+    }
+    if (options.interval_ms < 10) {
+        std::cerr << "[Error] Invalid interval" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int show_container_stats(const StatsOptions& options) {
+    struct sigaction sa = {};
+    sa.sa_handler = handle_stats_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    // 容器列表每隔约2秒重新扫描一次，期间复用已打开的统计文件
+    int rescan_ticks = std::max(1, 2000 / options.interval_ms);
+    std::map<std::string, std::unique_ptr<ContainerStats>> monitors;
+    for (int tick = 0; !stats_stop_requested; ++tick) {
+        if (tick % rescan_ticks == 0) {
+            std::map<std::string, std::unique_ptr<ContainerStats>> current;
+            for (const auto& info : select_containers(options)) {
+                auto it = monitors.find(info.id);
+                if (it != monitors.end()) {
+                    current[info.id] = std::move(it->second);
+                    continue;
+                }
+                std::unique_ptr<ContainerStats> monitor(new ContainerStats(info));
+                if (monitor->open_files()) {
+                    current[info.id] = std::move(monitor);
+                }
+            }
+            monitors.swap(current);
+        }
+
+        // 第一轮只采样用于计算速率；非流式模式在第二轮输出后退出
+        if (tick > 0) {
+            if (options.stream) {
+                printf("\033[H\033[2J");
+            }
+            print_stats_header();
+        }
+        for (auto it = monitors.begin(); it != monitors.end(); ) {
+            StatSample sample;
+            if (!it->second->sample(sample)) {
+                it = monitors.erase(it); // 容器已退出
+                continue;
+            }
+            if (tick > 0) {
+                it->second->render(sample);
+            }
+            it->second->remember(sample);
+            ++it;
+        }
+        fflush(stdout);
+        if (tick > 0 && !options.stream) {
+            break;
+        }
+        if (monitors.empty() && !options.stream) {
+            std::cout << "No running containers found." << std::endl;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.interval_ms));
+    }
+    return 0;
+}
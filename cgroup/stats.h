@@ -0,0 +1,25 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+
+// ==================== 容器资源统计 ====================
+// 从每个容器的cgroup读取 memory.current、memory.stat、cpu.stat、io.stat、pids.current
+// 和 PSI（cpu/memory/io.pressure），计算CPU使用率、IO速率等并周期性输出。
+// 统计文件在容器被发现时打开一次，之后每次采样只用 pread 从偏移0重新读取，
+// 不重复打开文件；cgroup v1 下读取对应的 v1 文件（没有的统计项显示为"-"）。
+
+struct StatsOptions {
+    std::vector<std::string> containers;   // 为空表示全部运行中的容器
+    int interval_ms = 1000;
+    bool stream = true;                    // false时只输出一次
+};
+
+// 解析 stats 命令参数：[--no-stream] [--interval <ms>] [container...]
+bool parse_stats_options(int argc, char* argv[], StatsOptions& options);
+
+// 输出容器资源统计
+int show_container_stats(const StatsOptions& options);
+
+#endif // STATS_H
@@ -6,22 +6,60 @@
 // Stack size for container processes
 #define STACK_SIZE (1024 * 1024)
 
-// cgroup 路径和名称
+// cgroup 路径和名称：每个容器使用 <CGROUP_ROOT>/[子系统/]<CGROUP_NAME>/<容器ID>
 const std::string CGROUP_ROOT = "/sys/fs/cgroup";
-const std::string CGROUP_NAME = "simple_demo";
+const std::string CGROUP_NAME = "mydocker";
 
 // 文件系统路径配置
 const std::string ROOT_URL = "/home/qianyifan/";
-const std::string MNT_URL = "/home/qianyifan/mnt/";
 const std::string BUSYBOX_URL = "/home/qianyifan/busybox/";
 const std::string BUSYBOX_TAR_URL = "/home/qianyifan/busybox.tar";
-const std::string WRITE_LAYER_URL = "/home/qianyifan/writeLayer/";
-const std::string WORK_DIR_URL = "/home/qianyifan/work/";
+// 镜像层存储：blobs/<digest>（层tar包）、layers/<digest>（解压后的只读层）、manifests/<镜像名>
+const std::string IMAGE_STORE_URL = "/home/qianyifan/images/";
+const std::string DEFAULT_IMAGE = "busybox";
+// commit/导入时是否用分块gzip压缩层tar包（需要zlib，解压时多核并行）
+const bool COMPRESS_LAYERS = true;
+// 按需加载的镜像层：本地目录代替镜像仓库（blobs/<digest> 为可随机访问的层归档，manifests/<镜像名>），
+// 文件内容按 LAZY_CHUNK_SIZE 分块存储，读取时才下载到共享的块缓存 IMAGE_STORE_URL/chunks/
+const std::string LAZY_REGISTRY_URL = "/home/qianyifan/registry/";
+const size_t LAZY_CHUNK_SIZE = 1024 * 1024;
+// 容器工作空间根目录，每个容器使用 <root>/<容器ID>/{mnt,upper,work}
+const std::string WORKSPACE_ROOT = "/home/qianyifan/containers/";
 
 // 容器信息存储路径
 const std::string CONTAINER_INFO_PATH = "/var/run/mydocker/";
 const std::string CONFIG_NAME = "config.json";
 const std::string CONTAINER_LOG_FILE = "container.log";
+// 容器日志：按大小轮转（container.log.1 ...），每个日志文件有对应的 .idx 索引
+const size_t LOG_MAX_SIZE = 10 * 1024 * 1024;
+const int LOG_MAX_FILES = 5;
+const std::string LOG_INDEX_SUFFIX = ".idx";
+const std::string CONTAINER_DAEMON_SOCKET = "/var/run/mydocker/mydocker.sock";
+// 单线程服务端（状态守护进程、监管进程）等待客户端发完请求的最长时间，超时断开该客户端；
+// 状态守护进程的客户端也以此作为收发超时，超时后回退到直接读写存储
+const int CLIENT_REQUEST_TIMEOUT_MS = 1000;
+// 预热容器池服务的socket及默认池大小
+const std::string CONTAINER_POOL_SOCKET = "/var/run/mydocker/pool.sock";
+const int DEFAULT_POOL_SIZE = 4;
+// 主机级监管进程：socket、单实例锁、自动启动时的输出文件
+const std::string SUPERVISOR_SOCKET = "/var/run/mydocker/supervisor.sock";
+const std::string SUPERVISOR_LOCK_FILE = "/var/run/mydocker/supervisor.lock";
+const std::string SUPERVISOR_LOG_FILE = "/var/run/mydocker/supervisor.log";
+// stop：SIGTERM后等待的默认秒数，超时后发送SIGKILL
+const int STOP_TIMEOUT_SECONDS = 10;
+// 容器的启动参数（位于容器信息目录），重启时按原参数重新运行
+const std::string RESTART_SPEC_FILE = "restart.spec";
+// 容器exec辅助进程的socket（位于容器信息目录）
+const std::string EXEC_HELPER_SOCKET = "exec.sock";
+// 重启退避：从 RESTART_DELAY_MIN_MS 起每次加倍，运行超过 RESTART_RESET_SECONDS 后重置
+const int RESTART_DELAY_MIN_MS = 100;
+const int RESTART_DELAY_MAX_MS = 10000;
+const int RESTART_RESET_SECONDS = 10;
+// --cpuset auto 的全局核心占用表及其锁文件
+const std::string CPUSET_MAP_FILE = "/var/run/mydocker/cpuset.map";
+const std::string CPUSET_LOCK_FILE = "/var/run/mydocker/cpuset.lock";
+// 容器元数据存储："binary"（内存映射记录文件 + 哈希索引）或 "json"（每个容器一个 config.json）
+const std::string CONTAINER_STORE_BACKEND = "binary";
 
 // 容器状态
 const std::string RUNNING = "running";
@@ -30,9 +68,13 @@ const std::string EXITED = "exited";
 
 // 网络相关常量
 const std::string DEFAULT_NETWORK_PATH = "/var/run/mydocker/network/network/";
-const std::string IPAM_DEFAULT_ALLOCATOR_PATH = "/var/run/mydocker/network/ipam/subnet.json";
+const std::string IPAM_DEFAULT_ALLOCATOR_PATH = "/var/run/mydocker/network/ipam/subnet.db";
 const std::string DEFAULT_BRIDGE_NAME = "mydocker0";
 const std::string DEFAULT_SUBNET = "192.168.1.0/24";
+// 网络配置后端："netlink"（直接使用rtnetlink，不创建子进程）或 "shell"（调用ip命令）。
+// 默认值可由环境变量 MYDOCKER_NET_BACKEND 或 run 的 --net-backend 参数覆盖
+const std::string DEFAULT_NETWORK_BACKEND = "netlink";
+const std::string NETWORK_BACKEND_ENV = "MYDOCKER_NET_BACKEND";
 
 // 字符集用于生成随机ID
 const std::string RANDOM_CHARS = "abcdefghijklmnopqrstuvwxyz0123456789";
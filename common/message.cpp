@@ -0,0 +1,97 @@
+#include "message.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// 单条消息的最大长度（argv + env）
+static const size_t MESSAGE_MAX = 64 * 1024;
+
+std::string join_fields(const std::vector<std::string>& fields) {
+    std::string payload;
+    for (const auto& field : fields) {
+        payload += field;
+        payload += '\0';
+    }
+    return payload;
+}
+
+std::vector<std::string> split_fields(const std::string& payload) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (start < payload.size()) {
+        size_t end = payload.find('\0', start);
+        if (end == std::string::npos) end = payload.size();
+        fields.push_back(payload.substr(start, end - start));
+        start = end + 1;
+    }
+    return fields;
+}
+
+bool send_message(int fd, const std::string& payload, const std::vector<int>& fds) {
+    struct iovec iov = {const_cast<char*>(payload.data()), payload.size()};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+    if (!fds.empty()) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(payload.size());
+}
+
+bool receive_message(int fd, std::string& payload, std::vector<int>& fds) {
+    std::vector<char> buffer(MESSAGE_MAX);
+    struct iovec iov = {buffer.data(), buffer.size()};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    payload.assign(buffer.data(), n);
+
+    fds.clear();
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            int received[3];
+            memcpy(received, CMSG_DATA(cmsg), sizeof(int) * std::min<size_t>(count, 3));
+            fds.assign(received, received + std::min<size_t>(count, 3));
+        }
+    }
+    if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        for (int received : fds) close(received);
+        fds.clear();
+        return false;
+    }
+    return true;
+}
+
+void close_fds(std::vector<int>& fds) {
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+    fds.clear();
+}
@@ -0,0 +1,23 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include <string>
+#include <vector>
+
+// ==================== 本地socket消息收发 ====================
+// 池服务和监管进程使用 SOCK_SEQPACKET，一条消息即一个请求/响应，
+// 字段以'\0'分隔，最多可附带3个文件描述符（SCM_RIGHTS）。
+
+std::string join_fields(const std::vector<std::string>& fields);
+std::vector<std::string> split_fields(const std::string& payload);
+
+// 发送一条消息，可附带文件描述符
+bool send_message(int fd, const std::string& payload, const std::vector<int>& fds = {});
+
+// 接收一条消息及附带的文件描述符，对端关闭时返回false
+bool receive_message(int fd, std::string& payload, std::vector<int>& fds);
+
+// 关闭并清空文件描述符列表（跳过-1）
+void close_fds(std::vector<int>& fds);
+
+#endif // MESSAGE_H
@@ -0,0 +1,28 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// SHA-256 摘要计算（用于镜像层的内容寻址）
+class Sha256 {
+public:
+    Sha256();
+    void update(const void* data, size_t length);
+    // 返回64位十六进制摘要，调用后对象不可再更新
+    std::string final_hex();
+
+private:
+    void transform(const uint8_t block[64]);
+
+    uint32_t state[8];
+    uint64_t total_length;
+    uint8_t buffer[64];
+    size_t buffer_length;
+};
+
+// 计算文件的SHA-256摘要，失败返回空字符串
+std::string sha256_file(const std::string& path);
+
+#endif // SHA256_H
@@ -12,6 +12,14 @@ struct VolumeInfo {
     bool valid;
 };
 
+// 容器工作空间路径（按容器ID区分，互不冲突）
+struct Workspace {
+    std::string root;         // WORKSPACE_ROOT/<id>/
+    std::string mount_point;  // OverlayFS 挂载点（容器根目录）
+    std::string upper_dir;    // 写入层
+    std::string work_dir;     // OverlayFS 工作目录
+};
+
 // 网络相关结构
 struct NetworkInfo {
     std::string name;
@@ -40,15 +48,26 @@ struct ContainerInfo {
     std::string command;
     std::string created_time;
     std::string status;
+    std::string network_name;   // 所属网络
+    std::string ip_address;     // 分配的IP地址
+    std::string port_mapping;   // 端口映射，逗号分隔，如 "8080:80,8443:443"
+    std::string volume;         // host_path:container_path
+    std::string cgroup_path;    // cgroup路径（相对于cgroup根目录）
+    std::string cpuset_cpus;    // 放置的CPU（cpuset.cpus），未绑定时为空
+    std::string cpuset_mems;    // 放置的NUMA内存节点（cpuset.mems）
+    std::string pid_start_time; // 容器进程启动时间（/proc/<pid>/stat），用于识别PID复用
+    std::string exit_code;      // 退出码（监管进程观察到退出后写入，无法获取时为空）
+    std::string restart_count;  // 按重启策略自动重启的次数
 };
 
-// IP分配管理结构
+// IP分配管理结构（位图存储在内存映射的 subnet.db 中，多进程通过 flock 互斥）
 struct IPAMAllocator {
-    std::string subnet_file_path;
-    std::map<std::string, std::string> subnets; // subnet -> allocation bitmap
-    IPAMAllocator();
-    bool load();
-    bool save();
+    std::string subnet_file_path;   // 为空时使用 IPAM_DEFAULT_ALLOCATOR_PATH
+    IPAMAllocator() = default;
+    explicit IPAMAllocator(const std::string& path) : subnet_file_path(path) {}
+    const std::string& store_path() const;
+    bool init_subnet(const std::string& subnet);
+    bool remove_subnet(const std::string& subnet);
     std::string allocate(const std::string& subnet);
     bool release(const std::string& subnet, const std::string& ip);
 };
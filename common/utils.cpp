@@ -3,20 +3,26 @@
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
+#include <random>
+#include <algorithm>
 #include <sys/stat.h>
 #include <sys/mount.h>
 #include <unistd.h>
 #include <errno.h>
 #include <cstdio>
+#include <cstring>
+#include <ftw.h>
 
 // ==================== 基础工具函数 ====================
 
 // 生成随机字符串作为容器ID
+// 每个线程独立的随机数引擎（避免同一秒内重复播种导致生成相同ID）
 std::string generate_container_id(int length) {
+    thread_local std::mt19937_64 engine(std::random_device{}());
+    std::uniform_int_distribution<size_t> distribution(0, RANDOM_CHARS.length() - 1);
     std::string result;
-    srand(time(nullptr));
     for (int i = 0; i < length; ++i) {
-        result += RANDOM_CHARS[rand() % RANDOM_CHARS.length()];
+        result += RANDOM_CHARS[distribution(engine)];
     }
     return result;
 }
@@ -46,16 +52,54 @@ bool path_exists(const std::string& path) {
     return (stat(path.c_str(), &buffer) == 0);
 }
 
-// 创建目录（如果不存在）
-// Todo: make this used in other parts of the code
+// 创建目录（如果不存在），逐级创建，不启动子进程
 bool create_directory_if_not_exists(const std::string& path) {
     struct stat buffer;
-    if (stat(path.c_str(), &buffer) == -1) {
-        std::string mkdir_cmd = "mkdir -p " + path;
-        if (system(mkdir_cmd.c_str()) != 0) {
-            std::cerr << "[Common] Failed to create directory: " << path << std::endl;
+    if (stat(path.c_str(), &buffer) == 0) {
+        return S_ISDIR(buffer.st_mode);
+    }
+    
+    size_t pos = 0;
+    while (pos != std::string::npos) {
+        pos = path.find('/', pos + 1);
+        std::string component = path.substr(0, pos);
+        if (component.empty()) continue;
+        if (mkdir(component.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "[Common] Failed to create directory: " << path << ": " << strerror(errno) << std::endl;
             return false;
         }
     }
     return true;
 }
+
+// nftw 回调：删除文件或空目录
+static int remove_entry(const char* path, const struct stat*, int, struct FTW*) {
+    if (remove(path) != 0) {
+        std::cerr << "[Common] Failed to remove " << path << ": " << strerror(errno) << std::endl;
+    }
+    return 0;
+}
+
+// 递归删除目录，不跨越挂载点（避免误删仍挂载的volume内容）
+bool remove_directory_recursive(const std::string& path) {
+    if (!path_exists(path)) {
+        return true;
+    }
+    nftw(path.c_str(), remove_entry, 64, FTW_DEPTH | FTW_PHYS | FTW_MOUNT);
+    return !path_exists(path);
+}
+
+void close_other_fds(std::vector<int> keep) {
+    std::sort(keep.begin(), keep.end());
+    unsigned next = 3;
+    for (int fd : keep) {
+        if (fd < static_cast<int>(next)) {
+            continue;
+        }
+        if (static_cast<unsigned>(fd) > next) {
+            close_range(next, fd - 1, 0);
+        }
+        next = fd + 1;
+    }
+    close_range(next, ~0U, 0);
+}
@@ -19,4 +19,10 @@ bool path_exists(const std::string& path);
 // 创建目录（如果不存在）
 bool create_directory_if_not_exists(const std::string& path);
 
+// 递归删除目录（不跨越挂载点）
+bool remove_directory_recursive(const std::string& path);
+
+// 关闭除 keep 以外的所有文件描述符（3及以上），用于后台常驻进程
+void close_other_fds(std::vector<int> keep);
+
 #endif // UTILS_H
\ No newline at end of file
@@ -3,6 +3,14 @@
 #include "logging/logging.h"
 #include "common/utils.h"
 #include "network/network.h"
+#include "daemon/daemon.h"
+#include "store.h"
+#include "filesystem/filesystem.h"
+#include "image/image.h"
+#include "cgroup/cgroup.h"
+#include "cgroup/cpualloc.h"
+#include "spawn.h"
+#include "supervisor/supervisor.h"
 #include <iostream>
 #include <fstream>
 #include <ctime>
@@ -14,6 +22,10 @@
 #include <fcntl.h>
 #include <sched.h>
 #include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <dirent.h>
 
 // 记录容器信息
 std::string record_container_info(pid_t container_pid, const std::vector<std::string>& command_array, 
@@ -40,6 +52,7 @@ std::string record_container_info(pid_t container_pid, const std::vector<std::st
     container_info.id = container_id;
     container_info.name = container_name;
     container_info.pid = std::to_string(container_pid);
+    container_info.pid_start_time = process_start_time(container_pid);
     container_info.command = command;
     container_info.created_time = created_time;
     container_info.status = RUNNING;
@@ -50,24 +63,12 @@ std::string record_container_info(pid_t container_pid, const std::vector<std::st
         return "";
     }
     
-    // 写入配置文件（简化的JSON格式）
-    std::string config_file = dir_path + CONFIG_NAME;
-    std::ofstream config_stream(config_file);
-    if (config_stream.is_open()) {
-        config_stream << "{\n";
-        config_stream << "  \"id\": \"" << container_info.id << "\",\n";
-        config_stream << "  \"name\": \"" << container_info.name << "\",\n";
-        config_stream << "  \"pid\": \"" << container_info.pid << "\",\n";
-        config_stream << "  \"command\": \"" << container_info.command << "\",\n";
-        config_stream << "  \"createTime\": \"" << container_info.created_time << "\",\n";
-        config_stream << "  \"status\": \"" << container_info.status << "\"\n";
-        config_stream << "}\n";
-        config_stream.close();
-        std::cout << "[Container] Container info recorded: " << config_file << std::endl;
-    } else {
+    // 写入配置文件（守护进程在线时由守护进程持久化并更新索引）
+    if (!save_container_info(container_info)) {
         std::cerr << "[Container] Failed to create config file" << std::endl;
         return "";
     }
+    std::cout << "[Container] Container info recorded: " << dir_path + CONFIG_NAME << std::endl;
     
     // 创建空的日志文件
     create_container_log_file(dir_path);
@@ -80,13 +81,140 @@ void delete_container_info(const std::string& container_name) {
     std::cout << "[Container] Deleting container info: " << container_name << std::endl;
     
     std::string dir_path = CONTAINER_INFO_PATH + container_name;
-    std::string rm_cmd = "rm -rf " + dir_path;
-    
-    if (system(rm_cmd.c_str()) != 0) {
+    if (!remove_directory_recursive(dir_path)) {
         std::cerr << "[Container] Failed to delete container info directory" << std::endl;
     } else {
         std::cout << "[Container] Container info deleted successfully" << std::endl;
     }
+    erase_container_info(container_name);
+    daemon_delete(container_name);
+}
+
+// 写入容器配置文件（简化的JSON格式）
+bool write_container_config(const ContainerInfo& container_info) {
+    std::string dir_path = CONTAINER_INFO_PATH + container_info.name + "/";
+    if (!create_directory_if_not_exists(dir_path)) {
+        return false;
+    }
+    
+    std::ofstream config_stream(dir_path + CONFIG_NAME);
+    if (!config_stream.is_open()) {
+        return false;
+    }
+    config_stream << "{\n";
+    config_stream << "  \"id\": \"" << container_info.id << "\",\n";
+    config_stream << "  \"name\": \"" << container_info.name << "\",\n";
+    config_stream << "  \"pid\": \"" << container_info.pid << "\",\n";
+    config_stream << "  \"command\": \"" << container_info.command << "\",\n";
+    config_stream << "  \"createTime\": \"" << container_info.created_time << "\",\n";
+    config_stream << "  \"status\": \"" << container_info.status << "\",\n";
+    config_stream << "  \"network\": \"" << container_info.network_name << "\",\n";
+    config_stream << "  \"ipAddress\": \"" << container_info.ip_address << "\",\n";
+    config_stream << "  \"portMapping\": \"" << container_info.port_mapping << "\",\n";
+    config_stream << "  \"volume\": \"" << container_info.volume << "\",\n";
+    config_stream << "  \"cgroupPath\": \"" << container_info.cgroup_path << "\",\n";
+    config_stream << "  \"cpusetCpus\": \"" << container_info.cpuset_cpus << "\",\n";
+    config_stream << "  \"cpusetMems\": \"" << container_info.cpuset_mems << "\",\n";
+    config_stream << "  \"pidStartTime\": \"" << container_info.pid_start_time << "\",\n";
+    config_stream << "  \"exitCode\": \"" << container_info.exit_code << "\",\n";
+    config_stream << "  \"restartCount\": \"" << container_info.restart_count << "\"\n";
+    config_stream << "}\n";
+    config_stream.close();
+    return true;
+}
+
+// 按 CONTAINER_STORE_BACKEND 持久化容器信息
+bool persist_container_info(const ContainerInfo& container_info) {
+    if (CONTAINER_STORE_BACKEND == "binary") {
+        return store_put(container_info);
+    }
+    return write_container_config(container_info);
+}
+
+// 从持久化存储读取容器信息（binary 后端支持按名称或ID查找）
+bool load_container_info(const std::string& container_name, ContainerInfo& container_info) {
+    if (CONTAINER_STORE_BACKEND == "binary") {
+        return store_get(container_name, container_info);
+    }
+    
+    std::string config_file = CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME;
+    if (!path_exists(config_file)) {
+        return false;
+    }
+    container_info = parse_container_config(config_file);
+    return !container_info.id.empty();
+}
+
+// 从持久化存储读取全部容器信息
+std::vector<ContainerInfo> load_all_container_infos() {
+    if (CONTAINER_STORE_BACKEND == "binary") {
+        return store_list();
+    }
+    return scan_container_configs();
+}
+
+// 从持久化存储删除容器信息（json 后端随容器目录一起删除）
+void erase_container_info(const std::string& container_name) {
+    if (CONTAINER_STORE_BACKEND == "binary") {
+        store_delete(container_name);
+    }
+}
+
+// 保存容器信息：优先交给守护进程，守护进程未运行时直接写存储
+bool save_container_info(const ContainerInfo& container_info) {
+    if (daemon_put(container_info)) {
+        return true;
+    }
+    return persist_container_info(container_info);
+}
+
+// 查找容器信息：优先查询守护进程的内存索引，否则读取存储
+bool find_container_info(const std::string& container_name, ContainerInfo& container_info) {
+    bool found = false;
+    if (daemon_get(container_name, container_info, found)) {
+        return found;
+    }
+    return load_container_info(container_name, container_info);
+}
+
+// 更新容器的网络、卷和cgroup等运行时信息
+bool update_container_runtime_info(const std::string& container_name, const ContainerInfo& runtime_info) {
+    ContainerInfo container_info;
+    if (!find_container_info(container_name, container_info)) {
+        std::cerr << "[Container] Container not found: " << container_name << std::endl;
+        return false;
+    }
+    container_info.network_name = runtime_info.network_name;
+    container_info.ip_address = runtime_info.ip_address;
+    container_info.port_mapping = runtime_info.port_mapping;
+    container_info.volume = runtime_info.volume;
+    container_info.cgroup_path = runtime_info.cgroup_path;
+    container_info.cpuset_cpus = runtime_info.cpuset_cpus;
+    container_info.cpuset_mems = runtime_info.cpuset_mems;
+    return save_container_info(container_info);
+}
+
+// 扫描容器信息目录，读取所有容器配置
+std::vector<ContainerInfo> scan_container_configs() {
+    std::vector<ContainerInfo> containers;
+    DIR* dir = opendir(CONTAINER_INFO_PATH.c_str());
+    if (dir == nullptr) {
+        return containers;
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        std::string config_file = CONTAINER_INFO_PATH + entry->d_name + "/" + CONFIG_NAME;
+        if (path_exists(config_file)) {
+            ContainerInfo info = parse_container_config(config_file);
+            if (!info.id.empty()) {
+                containers.push_back(info);
+            }
+        }
+    }
+    closedir(dir);
+    return containers;
 }
 
 // 解析容器配置文件
@@ -126,6 +254,46 @@ ContainerInfo parse_container_config(const std::string& config_file) {
             size_t start = line.find('"', line.find(':')) + 1;
             size_t end = line.find('"', start);
             container_info.status = line.substr(start, end - start);
+        } else if (line.find("\"network\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.network_name = line.substr(start, end - start);
+        } else if (line.find("\"ipAddress\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.ip_address = line.substr(start, end - start);
+        } else if (line.find("\"portMapping\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.port_mapping = line.substr(start, end - start);
+        } else if (line.find("\"volume\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.volume = line.substr(start, end - start);
+        } else if (line.find("\"cgroupPath\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.cgroup_path = line.substr(start, end - start);
+        } else if (line.find("\"cpusetCpus\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.cpuset_cpus = line.substr(start, end - start);
+        } else if (line.find("\"cpusetMems\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.cpuset_mems = line.substr(start, end - start);
+        } else if (line.find("\"pidStartTime\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.pid_start_time = line.substr(start, end - start);
+        } else if (line.find("\"exitCode\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.exit_code = line.substr(start, end - start);
+        } else if (line.find("\"restartCount\":") != std::string::npos) {
+            size_t start = line.find('"', line.find(':')) + 1;
+            size_t end = line.find('"', start);
+            container_info.restart_count = line.substr(start, end - start);
         }
     }
     
@@ -137,38 +305,12 @@ ContainerInfo parse_container_config(const std::string& config_file) {
 void list_containers() {
     std::cout << "[Container] Listing all containers..." << std::endl;
     
-    // 检查容器信息目录是否存在
-    if (!path_exists(CONTAINER_INFO_PATH)) {
-        std::cout << "No containers found." << std::endl;
-        return;
-    }
-    
-    // 使用ls命令获取目录列表
-    std::string ls_cmd = "ls " + CONTAINER_INFO_PATH + " 2>/dev/null";
-    FILE* pipe = popen(ls_cmd.c_str(), "r");
-    if (!pipe) {
-        std::cerr << "[Container] Failed to list container directories" << std::endl;
-        return;
-    }
-    
+    // 守护进程在线时直接使用其内存索引，否则读取存储
     std::vector<ContainerInfo> containers;
-    char buffer[256];
-    
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        std::string container_name(buffer);
-        container_name.pop_back(); // 移除换行符
-        
-        std::string config_file = CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME;
-        if (path_exists(config_file)) {
-            ContainerInfo info = parse_container_config(config_file);
-            if (!info.id.empty()) {
-                containers.push_back(info);
-            }
-        }
+    if (!daemon_list(containers)) {
+        containers = load_all_container_infos();
     }
     
-    pclose(pipe);
-    
     // 打印容器列表
     if (containers.empty()) {
         std::cout << "No containers found." << std::endl;
@@ -191,192 +333,182 @@ void list_containers() {
     }
 }
 
-// 获取容器PID
-std::string get_container_pid(const std::string& container_name) {
-    std::string config_file = CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME;
-    
-    if (!path_exists(config_file)) {
-        std::cerr << "[Exec] Container config file not found: " << config_file << std::endl;
-        return "";
+bool parse_stop_options(int argc, char* argv[], StopOptions& options) {
+    for (int i = 2; i < argc; ++i) {
+        if ((strcmp(argv[i], "--time") == 0 || strcmp(argv[i], "-t") == 0) && i + 1 < argc) {
+            char* end;
+            long timeout = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || end == argv[i] || timeout < 0 || timeout > 24 * 3600) {
+                std::cerr << "[Error] Invalid stop timeout: " << argv[i] << std::endl;
+                return false;
+            }
+            options.timeout = static_cast<int>(timeout);
+        } else if (strcmp(argv[i], "--all") == 0 || strcmp(argv[i], "-a") == 0) {
+            options.all = true;
+        } else {
+            options.names.push_back(argv[i]);
+        }
     }
-    
-    ContainerInfo container_info = parse_container_config(config_file);
-    if (container_info.pid.empty()) {
-        std::cerr << "[Exec] Failed to get container PID" << std::endl;
-        return "";
+    if (options.all == !options.names.empty()) {
+        std::cerr << "[Error] Specify container names or --all" << std::endl;
+        return false;
     }
-    
-    return container_info.pid;
+    return true;
 }
 
-// 获取容器的环境变量
-std::vector<std::string> get_container_envs(const std::string& container_pid) {
-    std::vector<std::string> envs;
-    std::string environ_path = "/proc/" + container_pid + "/environ";
-    
-    std::ifstream environ_file(environ_path, std::ios::binary);
-    if (!environ_file.is_open()) {
-        std::cerr << "[Exec] Failed to open environ file: " << environ_path << std::endl;
-        return envs;
-    }
-    
-    std::string content((std::istreambuf_iterator<char>(environ_file)),
-                        std::istreambuf_iterator<char>());
-    environ_file.close();
-    
-    // 按\0分割环境变量
-    size_t start = 0;
-    size_t pos = 0;
-    while ((pos = content.find('\0', start)) != std::string::npos) {
-        if (pos > start) {
-            std::string env_var = content.substr(start, pos - start);
-            if (!env_var.empty()) {
-                envs.push_back(env_var);
+// 正在停止的容器
+struct StopTarget {
+    ContainerInfo info;
+    int pidfd = -1;
+    bool supervised = false;    // 由监管进程在退出后更新记录
+    bool exited = false;
+    bool killed = false;
+};
+
+// SIGKILL后等待退出的时间
+static const int STOP_KILL_WAIT_MS = 5000;
+// 等待监管进程写回记录的时间
+static const int STOP_RECORD_WAIT_MS = 2000;
+
+// 在所有未退出目标的pidfd上等待，直到全部退出或超时，返回是否全部退出
+static bool wait_stop_targets(std::vector<StopTarget>& targets, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        std::vector<struct pollfd> fds;
+        std::vector<StopTarget*> waiting;
+        for (auto& target : targets) {
+            if (target.pidfd >= 0 && !target.exited) {
+                fds.push_back({target.pidfd, POLLIN, 0});
+                waiting.push_back(&target);
             }
         }
-        start = pos + 1;
-    }
-    
-    // 处理最后一个环境变量（如果没有以\0结尾）
-    if (start < content.length()) {
-        std::string env_var = content.substr(start);
-        if (!env_var.empty()) {
-            envs.push_back(env_var);
+        if (fds.empty()) {
+            return true;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        int ready = poll(fds.data(), fds.size(), static_cast<int>(remaining));
+        if (ready < 0 && errno != EINTR) {
+            perror("[Stop] poll failed");
+            return false;
+        }
+        for (size_t i = 0; ready > 0 && i < fds.size(); ++i) {
+            if (fds[i].revents != 0) {
+                waiting[i]->exited = true;
+            }
         }
     }
-    
-    std::cout << "[Exec] Found " << envs.size() << " environment variables" << std::endl;
-    return envs;
 }
 
-// 进入容器命名空间执行命令
-void exec_container(const std::string& container_name, const std::vector<std::string>& exec_cmd) {
-    std::cout << "[Exec] Executing command in container: " << container_name << std::endl;
-    
-    // 获取容器PID
-    std::string container_pid = get_container_pid(container_name);
-    if (container_pid.empty()) {
-        std::cerr << "[Exec] Failed to get container PID" << std::endl;
+// 进程退出后更新记录。监管进程负责的容器等待其写回（含退出码），避免与其清理互相覆盖
+static void finish_stop_target(const StopTarget& target) {
+    const std::string& name = target.info.name;
+    ContainerInfo current;
+    if (target.supervised) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(STOP_RECORD_WAIT_MS);
+        while (find_container_info(name, current) && current.id == target.info.id && current.status == RUNNING &&
+               std::chrono::steady_clock::now() < deadline) {
+            usleep(10 * 1000);
+        }
+        if (current.status == RUNNING) {
+            std::cerr << "[Stop] Supervisor has not updated container " << name << " yet" << std::endl;
+        }
         return;
     }
-    
-    std::cout << "[Exec] Container PID: " << container_pid << std::endl;
-    
-    // 构建命令字符串
-    std::string cmd_str = "";
-    for (size_t i = 0; i < exec_cmd.size(); ++i) {
-        cmd_str += exec_cmd[i];
-        if (i < exec_cmd.size() - 1) {
-            cmd_str += " ";
-        }
+    if (!find_container_info(name, current) || current.id != target.info.id || current.status != RUNNING) {
+        return;
     }
-    
-    std::cout << "[Exec] Command: " << cmd_str << std::endl;
-    
-    // 进入容器的各个命名空间
-    std::vector<std::string> namespaces = {"ipc", "uts", "net", "pid", "mnt"};
-    
-    for (const auto& ns : namespaces) {
-        std::string ns_path = "/proc/" + container_pid + "/ns/" + ns;
-        int fd = open(ns_path.c_str(), O_RDONLY);
-        
-        if (fd == -1) {
-            std::cerr << "[Exec] Failed to open namespace: " << ns_path << std::endl;
-            continue;
+    current.status = STOPPED;
+    current.pid = "";
+    current.pid_start_time = "";
+    // 释放 --cpuset auto 分配的CPU
+    release_container_cpus(current.id);
+    if (!save_container_info(current)) {
+        std::cerr << "[Stop] Failed to update container config: " << name << std::endl;
+    }
+}
+
+bool stop_containers(const StopOptions& options) {
+    std::vector<StopTarget> targets;
+    bool ok = true;
+    if (options.all) {
+        for (const auto& info : load_all_container_infos()) {
+            if (info.status == RUNNING) {
+                targets.push_back(StopTarget());
+                targets.back().info = info;
+            }
         }
-        
-        if (setns(fd, 0) == -1) {
-            std::cerr << "[Exec] Failed to enter namespace: " << ns << std::endl;
-            perror("setns");
-        } else {
-            std::cout << "[Exec] Entered namespace: " << ns << std::endl;
+    } else {
+        for (const auto& name : options.names) {
+            StopTarget target;
+            if (!find_container_info(name, target.info)) {
+                std::cerr << "[Stop] Container not found: " << name << std::endl;
+                ok = false;
+            } else if (target.info.status != RUNNING) {
+                std::cout << "[Stop] Container " << name << " is not running" << std::endl;
+            } else {
+                targets.push_back(target);
+            }
         }
-        
-        close(fd);
     }
 
-    // 切换到容器的根目录
-    if (chdir("/") != 0) {
-        perror("[Exec] Failed to chdir to container root");
-        return;
+    if (targets.empty()) {
+        return ok;
     }
 
-    std::cout << "[Exec] Changed working directory to container root" << std::endl;
-    
-    // 获取容器的环境变量
-    std::vector<std::string> container_envs = get_container_envs(container_pid);
-    
-    // 设置容器的环境变量
-    for (const auto& env_var : container_envs) {
-        std::cout << "[Exec] Setting environment variable: " << env_var << std::endl;
-        if (putenv(strdup(env_var.c_str())) != 0) {
-            std::cerr << "[Exec] Failed to set environment variable: " << env_var << std::endl;
+    // 先通知监管进程不再重启，再通过pidfd发送SIGTERM：
+    // 打开pidfd时校验启动时间，PID已被其他进程复用时不会误杀
+    for (auto& target : targets) {
+        target.supervised = notify_supervisor_stop(target.info.name);
+        target.pidfd = open_process_pidfd(atoi(target.info.pid.c_str()), target.info.pid_start_time);
+        if (target.pidfd < 0) {
+            if (errno != ESRCH) {
+                std::cerr << "[Stop] Failed to open container process " << target.info.name << ": "
+                          << strerror(errno) << std::endl;
+                ok = false;
+                continue;
+            }
+            target.exited = true; // 进程已退出
+        } else if (!send_pidfd_signal(target.pidfd, SIGTERM) && errno != ESRCH) {
+            std::cerr << "[Stop] Failed to signal container " << target.info.name << ": " << strerror(errno)
+                      << std::endl;
         }
     }
-    
-    // 执行命令
-    std::vector<char*> args;
-    for (const auto& arg : exec_cmd) {
-        args.push_back(const_cast<char*>(arg.c_str()));
-    }
-    args.push_back(nullptr);
-    
-    if (execvp(args[0], args.data()) == -1) {
-        perror("[Exec] execvp failed");
-    }
-}
+    std::cout << "[Stop] Sent SIGTERM to " << targets.size() << " containers, waiting up to " << options.timeout
+              << "s" << std::endl;
 
-// 停止容器
-void stop_container(const std::string& container_name) {
-    std::cout << "[Stop] Stopping container: " << container_name << std::endl;
-    
-    // 获取容器PID
-    std::string container_pid = get_container_pid(container_name);
-    if (container_pid.empty()) {
-        std::cerr << "[Stop] Failed to get container PID" << std::endl;
-        return;
-    }
-    
-    std::cout << "[Stop] Container PID: " << container_pid << std::endl;
-    
-    // 转换PID为整数
-    pid_t pid = std::stoi(container_pid);
-    
-    // 发送SIGTERM信号停止容器
-    if (kill(pid, SIGTERM) == -1) {
-        perror("[Stop] Failed to stop container");
-        return;
-    }
-    
-    std::cout << "[Stop] SIGTERM signal sent to container" << std::endl;
-    
-    // 更新容器状态为stopped
-    ContainerInfo container_info = parse_container_config(CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME);
-    if (container_info.id.empty()) {
-        std::cerr << "[Stop] Failed to read container info" << std::endl;
-        return;
+    // 所有容器共用一个等待期限，超时后对剩余容器发送SIGKILL
+    if (!wait_stop_targets(targets, options.timeout * 1000)) {
+        for (auto& target : targets) {
+            if (target.pidfd >= 0 && !target.exited) {
+                std::cout << "[Stop] Container " << target.info.name << " did not exit in " << options.timeout
+                          << "s, sending SIGKILL" << std::endl;
+                send_pidfd_signal(target.pidfd, SIGKILL);
+                target.killed = true;
+            }
+        }
+        wait_stop_targets(targets, STOP_KILL_WAIT_MS);
     }
-    
-    container_info.status = STOPPED;
-    container_info.pid = "";
-    
-    // 写回配置文件
-    std::string config_file = CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME;
-    std::ofstream config_stream(config_file);
-    if (config_stream.is_open()) {
-        config_stream << "{\n";
-        config_stream << "  \"id\": \"" << container_info.id << "\",\n";
-        config_stream << "  \"name\": \"" << container_info.name << "\",\n";
-        config_stream << "  \"pid\": \"" << container_info.pid << "\",\n";
-        config_stream << "  \"command\": \"" << container_info.command << "\",\n";
-        config_stream << "  \"createTime\": \"" << container_info.created_time << "\",\n";
-        config_stream << "  \"status\": \"" << container_info.status << "\"\n";
-        config_stream << "}\n";
-        config_stream.close();
-        std::cout << "[Stop] Container status updated to stopped" << std::endl;
-    } else {
-        std::cerr << "[Stop] Failed to update container config" << std::endl;
+
+    for (auto& target : targets) {
+        if (target.pidfd >= 0) {
+            close(target.pidfd);
+        }
+        if (!target.exited) {
+            if (target.pidfd >= 0) {
+                std::cerr << "[Stop] Container " << target.info.name << " is still running" << std::endl;
+            }
+            ok = false;
+            continue;
+        }
+        finish_stop_target(target);
+        std::cout << "[Stop] Container " << target.info.name << " stopped" << (target.killed ? " (killed)" : "")
+                  << std::endl;
     }
+    return ok;
 }
 
 // 删除容器
@@ -384,8 +516,8 @@ void remove_container(const std::string& container_name) {
     std::cout << "[Remove] Removing container: " << container_name << std::endl;
     
     // 检查容器状态
-    ContainerInfo container_info = parse_container_config(CONTAINER_INFO_PATH + container_name + "/" + CONFIG_NAME);
-    if (container_info.id.empty()) {
+    ContainerInfo container_info;
+    if (!find_container_info(container_name, container_info)) {
         std::cerr << "[Remove] Container not found: " << container_name << std::endl;
         return;
     }
@@ -395,45 +527,63 @@ void remove_container(const std::string& container_name) {
         return;
     }
     
-    // 清理网络资源
-    std::string veth_host = "veth" + container_info.id.substr(0, 5);
-    if (interface_exists(veth_host)) {
-        std::string delete_veth_cmd = "ip link delete " + veth_host;
-        if (system(delete_veth_cmd.c_str()) == 0) {
-            std::cout << "[Remove] Cleaned up network interface: " << veth_host << std::endl;
-        } else {
-            std::cerr << "[Remove] Failed to clean up network interface: " << veth_host << std::endl;
-        }
+    // 清理网络资源：veth、端口映射链、IP地址
+    release_container_network(container_info.id, container_info.network_name, container_info.ip_address,
+                              !container_info.port_mapping.empty());
+    
+    // 删除容器工作空间
+    VolumeInfo volume_info = {"", "", false};
+    if (!container_info.volume.empty()) {
+        volume_info = parse_volume(container_info.volume);
     }
+    delete_workspace(get_workspace(container_info.id), volume_info);
     
-    // 释放容器IP地址（从容器配置中读取网络信息）
-    // Todo: 注意：这里需要扩展容器配置以包含网络信息，目前简化处理
-    // 在实际实现中，应该在容器配置中保存网络名称和分配的IP
-    std::cout << "[Remove] Note: IP address cleanup requires container network info in config" << std::endl;
+    // 删除容器cgroup
+    remove_container_cgroup(container_info.id);
+    release_container_cpus(container_info.id);
     
     // 删除容器信息目录
-    std::string container_dir = CONTAINER_INFO_PATH + container_name;
-    std::string rm_cmd = "rm -rf " + container_dir;
-    
-    if (system(rm_cmd.c_str()) == 0) {
+    std::string container_dir = CONTAINER_INFO_PATH + container_info.name;
+    if (remove_directory_recursive(container_dir)) {
+        erase_container_info(container_info.name);
+        daemon_delete(container_info.name);
         std::cout << "[Remove] Container removed successfully: " << container_name << std::endl;
     } else {
         std::cerr << "[Remove] Failed to remove container directory" << std::endl;
     }
 }
 
-// Commit功能：将容器保存为镜像
-void commit_container(const std::string& image_name) {
+// Commit功能：将容器的写入层保存为新镜像层，新镜像 = 原镜像各层 + 新层
+void commit_container(const std::string& container_id, const std::string& image_name, bool running) {
     std::cout << "[Commit] Committing container to image: " << image_name << std::endl;
     
-    std::string image_tar = ROOT_URL + image_name + ".tar";
-    std::string tar_cmd = "tar -czf " + image_tar + " -C " + MNT_URL + " .";
+    Workspace workspace = get_workspace(container_id);
+    std::vector<std::string> layers;
+    if (!load_workspace_layers(workspace.root, layers)) {
+        std::cerr << "[Commit] Failed to read image layers of container " << container_id << std::endl;
+        return;
+    }
+    
+    // 容器已停止：卸载OverlayFS后写入层不再被使用，可以直接冻结为镜像层
+    bool frozen = !running && delete_mount_point(workspace);
+    std::string digest = commit_layer(workspace.upper_dir, frozen);
+    if (digest.empty()) {
+        std::cerr << "[Commit] Failed to create layer" << std::endl;
+        return;
+    }
+    layers.push_back(digest);
     
-    std::cout << "[Commit] Creating tar archive: " << image_tar << std::endl;
+    if (!path_exists(workspace.upper_dir)) {
+        // 写入层已成为镜像层：容器改为以它为最上层只读层，重新创建空的写入层
+        if (!save_workspace_layers(workspace.root, layers) || !create_write_layer(workspace)) {
+            std::cerr << "[Commit] Failed to recreate write layer of container " << container_id << std::endl;
+        }
+    }
     
-    if (system(tar_cmd.c_str()) != 0) {
-        std::cerr << "[Commit] Failed to create tar archive" << std::endl;
+    if (write_image_manifest(image_name, layers)) {
+        std::cout << "[Commit] Container committed successfully: " << image_name
+                  << " (" << layers.size() << " layers, top " << digest.substr(0, 12) << ")" << std::endl;
     } else {
-        std::cout << "[Commit] Container committed successfully to: " << image_tar << std::endl;
+        std::cerr << "[Commit] Failed to write image manifest" << std::endl;
     }
-}
\ No newline at end of file
+}
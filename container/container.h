@@ -5,22 +5,40 @@
 #include <vector>
 #include <sys/types.h>
 #include "common/structures.h"
+#include "common/constants.h"
 
 // 容器信息管理
 std::string record_container_info(pid_t container_pid, const std::vector<std::string>& command_array, 
                                   const std::string& container_name, const std::string& container_id);
 void delete_container_info(const std::string& container_name);
 ContainerInfo parse_container_config(const std::string& config_file);
+bool write_container_config(const ContainerInfo& container_info);
+bool save_container_info(const ContainerInfo& container_info);
+bool find_container_info(const std::string& container_name, ContainerInfo& container_info);
+bool update_container_runtime_info(const std::string& container_name, const ContainerInfo& runtime_info);
+
+// 持久化存储（按 CONTAINER_STORE_BACKEND 选择 json 或 binary）
+bool persist_container_info(const ContainerInfo& container_info);
+bool load_container_info(const std::string& container_name, ContainerInfo& container_info);
+std::vector<ContainerInfo> load_all_container_infos();
+void erase_container_info(const std::string& container_name);
+std::vector<ContainerInfo> scan_container_configs();
 void list_containers();
 
 // 容器操作
-std::string get_container_pid(const std::string& container_name);
-std::vector<std::string> get_container_envs(const std::string& container_pid);
-void exec_container(const std::string& container_name, const std::vector<std::string>& exec_cmd);
-void stop_container(const std::string& container_name);
+// stop 参数：容器名列表或 --all，--time 为SIGTERM后等待的秒数
+struct StopOptions {
+    std::vector<std::string> names;
+    bool all = false;
+    int timeout = STOP_TIMEOUT_SECONDS;
+};
+bool parse_stop_options(int argc, char* argv[], StopOptions& options);
+// 并发停止多个容器：同时发送SIGTERM，通过pidfd等待退出，超时后SIGKILL；
+// 观察到进程退出后才更新状态。全部停止时返回true
+bool stop_containers(const StopOptions& options);
 void remove_container(const std::string& container_name);
 
-// Commit功能：将容器保存为镜像
-void commit_container(const std::string& image_name);
+// Commit功能：将容器保存为镜像。容器已停止（running为false）时写入层直接冻结为镜像层
+void commit_container(const std::string& container_id, const std::string& image_name, bool running);
 
 #endif // CONTAINER_H
\ No newline at end of file
@@ -0,0 +1,611 @@
+#include "exec.h"
+#include "container.h"
+#include "cgroup/cgroup.h"
+#include "common/constants.h"
+#include "common/message.h"
+#include "common/utils.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include <sys/un.h>
+
+// exec 进入的命名空间，与 run 创建容器时使用的一致
+static const int EXEC_NAMESPACES = CLONE_NEWNS | CLONE_NEWUTS | CLONE_NEWIPC | CLONE_NEWNET | CLONE_NEWPID;
+// 容器环境变量中没有PATH时的默认搜索路径
+static const char* DEFAULT_EXEC_PATH = "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin:/bin";
+
+// 读取进程的环境变量（/proc/<pid>/environ，以'\0'分隔）
+static bool read_process_environ(pid_t pid, std::vector<std::string>& env) {
+    std::string path = "/proc/" + std::to_string(pid) + "/environ";
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::string content;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, n);
+    }
+    close(fd);
+    if (n < 0) {
+        return false;
+    }
+    size_t start = 0;
+    while (start < content.size()) {
+        size_t end = content.find('\0', start);
+        if (end == std::string::npos) {
+            end = content.size();
+        }
+        if (end > start) {
+            env.push_back(content.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool open_exec_target(const std::string& container_name, ExecTarget& target) {
+    ContainerInfo info;
+    if (!find_container_info(container_name, info)) {
+        std::cerr << "[Exec] Container not found: " << container_name << std::endl;
+        return false;
+    }
+    if (info.status != RUNNING || info.pid.empty()) {
+        std::cerr << "[Exec] Container " << container_name << " is not running" << std::endl;
+        return false;
+    }
+    target.name = info.name;
+    target.id = info.id;
+    target.pid = atoi(info.pid.c_str());
+    // 校验启动时间：记录中的PID可能已被其他进程复用
+    target.pidfd = open_process_pidfd(target.pid, info.pid_start_time);
+    if (target.pidfd < 0) {
+        std::cerr << "[Exec] Container process " << target.pid << " is gone: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (!read_process_environ(target.pid, target.env)) {
+        perror("[Exec] Failed to read container environment");
+        close_exec_target(target);
+        return false;
+    }
+    target.cgroup_fd = open_container_cgroup(target.id);
+    target.cgroup_procs = open_container_cgroup_procs(target.id);
+    if (target.cgroup_procs.empty()) {
+        std::cerr << "[Exec] Warning: cgroup of container " << container_name << " not found" << std::endl;
+    }
+    return true;
+}
+
+void close_exec_target(ExecTarget& target) {
+    if (target.pidfd >= 0) {
+        close(target.pidfd);
+        target.pidfd = -1;
+    }
+    if (target.cgroup_fd >= 0) {
+        close(target.cgroup_fd);
+        target.cgroup_fd = -1;
+    }
+    for (int fd : target.cgroup_procs) {
+        close(fd);
+    }
+    target.cgroup_procs.clear();
+}
+
+bool enter_container_namespaces(const ExecTarget& target) {
+    if (setns(target.pidfd, EXEC_NAMESPACES) == 0) {
+        return true;
+    }
+    if (errno != EINVAL) {
+        perror("[Exec] setns failed");
+        return false;
+    }
+
+    // 内核不支持 setns(pidfd)（5.8之前）：逐个进入 /proc/<pid>/ns/*。
+    // 先全部打开，进入挂载命名空间后 /proc 就是容器内的了
+    std::vector<std::string> namespaces = {"ipc", "uts", "net", "pid", "mnt"};
+    std::vector<int> fds;
+    for (const auto& ns : namespaces) {
+        std::string path = "/proc/" + std::to_string(target.pid) + "/ns/" + ns;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "[Exec] Failed to open namespace " << path << ": " << strerror(errno) << std::endl;
+            break;
+        }
+        fds.push_back(fd);
+    }
+    bool ok = fds.size() == namespaces.size();
+    for (size_t i = 0; ok && i < fds.size(); ++i) {
+        if (setns(fds[i], 0) != 0) {
+            std::cerr << "[Exec] Failed to enter namespace " << namespaces[i] << ": " << strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+    for (int fd : fds) {
+        close(fd);
+    }
+    return ok;
+}
+
+// 子进程参数：argv/envp 在父进程中构造好，子进程只做系统调用
+struct ExecChildArgs {
+    char** argv;
+    char** envp;
+    const char* path;                   // 可执行文件搜索路径
+    const int* stdio;
+    const std::vector<int>* cgroup_procs;   // 非空时写入"0"加入cgroup
+};
+
+// 按 path 搜索可执行文件并执行（execvp 使用的是调用者自身的PATH，这里使用容器的）
+static void exec_in_path(const char* path, char* const argv[], char* const envp[]) {
+    const char* file = argv[0];
+    if (strchr(file, '/') != nullptr) {
+        execve(file, argv, envp);
+        return;
+    }
+    int saved_errno = ENOENT;
+    std::string dirs = path;
+    size_t start = 0;
+    while (start <= dirs.size()) {
+        size_t end = dirs.find(':', start);
+        if (end == std::string::npos) {
+            end = dirs.size();
+        }
+        std::string dir = end > start ? dirs.substr(start, end - start) : ".";
+        std::string candidate = dir + "/" + file;
+        execve(candidate.c_str(), argv, envp);
+        if (errno == EACCES) {
+            saved_errno = EACCES;
+        } else if (errno != ENOENT && errno != ENOTDIR) {
+            saved_errno = errno;
+            break;
+        }
+        start = end + 1;
+    }
+    errno = saved_errno;
+}
+
+static int exec_child(void* arg) {
+    ExecChildArgs* args = static_cast<ExecChildArgs*>(arg);
+    if (args->cgroup_procs != nullptr) {
+        for (int fd : *args->cgroup_procs) {
+            if (write(fd, "0", 1) != 1) {
+                perror("[Exec] Failed to join container cgroup");
+                return 126;
+            }
+        }
+    }
+    if (args->stdio != nullptr) {
+        for (int i = 0; i < 3; ++i) {
+            if (args->stdio[i] >= 0 && args->stdio[i] != i && dup2(args->stdio[i], i) < 0) {
+                perror("[Exec] dup2 failed");
+                return 126;
+            }
+        }
+    }
+    if (chdir("/") != 0) {
+        perror("[Exec] Failed to chdir to container root");
+        return 126;
+    }
+    exec_in_path(args->path, args->argv, args->envp);
+    int error = errno;
+    std::cerr << "[Exec] " << args->argv[0] << ": " << strerror(error) << std::endl;
+    return error == ENOENT ? 127 : 126;
+}
+
+// 合并环境变量：overrides 覆盖 base 中的同名变量
+static std::vector<std::string> merge_env(const std::vector<std::string>& base,
+                                          const std::vector<std::string>& overrides) {
+    std::vector<std::string> merged = base;
+    for (const auto& var : overrides) {
+        std::string key = var.substr(0, var.find('=') + 1);
+        auto it = std::find_if(merged.begin(), merged.end(),
+                               [&](const std::string& existing) { return existing.compare(0, key.size(), key) == 0; });
+        if (it != merged.end()) {
+            *it = var;
+        } else {
+            merged.push_back(var);
+        }
+    }
+    return merged;
+}
+
+bool spawn_exec_process(const ExecTarget& target, const std::vector<std::string>& command,
+                        const std::vector<std::string>& env, const int* stdio, SpawnedProcess& process) {
+    std::vector<std::string> merged;
+    if (!env.empty()) {
+        merged = merge_env(target.env, env);
+    }
+    const std::vector<std::string>& envs = env.empty() ? target.env : merged;
+    std::vector<char*> argv;
+    for (const auto& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    std::vector<char*> envp;
+    const char* path = DEFAULT_EXEC_PATH;
+    for (const auto& var : envs) {
+        envp.push_back(const_cast<char*>(var.c_str()));
+        if (var.compare(0, 5, "PATH=") == 0) {
+            path = var.c_str() + 5;
+        }
+    }
+    envp.push_back(nullptr);
+
+    ExecChildArgs args;
+    args.argv = argv.data();
+    args.envp = envp.data();
+    args.path = path;
+    args.stdio = stdio;
+    // v2 优先通过 CLONE_INTO_CGROUP 直接创建在容器cgroup中；v1 由子进程在exec前自行加入
+    args.cgroup_procs = target.cgroup_fd < 0 ? &target.cgroup_procs : nullptr;
+    if (!spawn_container(exec_child, &args, 0, target.cgroup_fd, process)) {
+        perror("[Exec] Failed to create process");
+        return false;
+    }
+    if (target.cgroup_fd >= 0 && !process.in_cgroup) {
+        std::string pid = std::to_string(process.pid);
+        for (int fd : target.cgroup_procs) {
+            if (write(fd, pid.c_str(), pid.size()) < 0) {
+                perror("[Exec] Failed to attach process to container cgroup");
+            }
+        }
+    }
+    return true;
+}
+
+int exec_exit_code(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return 1;
+}
+
+bool parse_exec_options(int argc, char* argv[], ExecOptions& options) {
+    int i = 2;
+    for (; i + 1 < argc && strcmp(argv[i], "-e") == 0; i += 2) {
+        if (strchr(argv[i + 1], '=') == nullptr) {
+            std::cerr << "[Error] Invalid environment variable: " << argv[i + 1] << std::endl;
+            return false;
+        }
+        options.env.push_back(argv[i + 1]);
+    }
+    if (i + 1 >= argc) {
+        std::cerr << "[Error] Usage: exec [-e KEY=VALUE]... <container_name> <command...>" << std::endl;
+        return false;
+    }
+    options.name = argv[i++];
+    options.command.assign(argv + i, argv + argc);
+    return true;
+}
+
+static std::string exec_helper_socket_path(const std::string& container_name) {
+    return CONTAINER_INFO_PATH + container_name + "/" + EXEC_HELPER_SOCKET;
+}
+
+static bool exec_helper_address(const std::string& container_name, struct sockaddr_un& addr) {
+    std::string path = exec_helper_socket_path(container_name);
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+// 辅助进程中正在执行的命令
+struct HelperCommand {
+    int conn = -1;              // 客户端连接，断开后为-1
+    SpawnedProcess process;
+};
+
+// 处理EXEC请求：EXEC <环境变量个数> <KEY=VALUE...> <argv...>，附带3个标准流
+static bool start_helper_command(const ExecTarget& target, const std::vector<std::string>& fields,
+                                 std::vector<int>& fds, HelperCommand& command, std::string& error) {
+    char* end = nullptr;
+    size_t env_count = fields.size() > 1 ? strtoul(fields[1].c_str(), &end, 10) : 0;
+    if (fields.size() < 2 || *end != '\0' || fields.size() < 3 + env_count || fds.size() != 3) {
+        close_fds(fds);
+        error = "invalid request";
+        return false;
+    }
+    std::vector<std::string> env(fields.begin() + 2, fields.begin() + 2 + env_count);
+    std::vector<std::string> argv(fields.begin() + 2 + env_count, fields.end());
+    int stdio[3] = {fds[0], fds[1], fds[2]};
+    bool ok = spawn_exec_process(target, argv, env, stdio, command.process);
+    if (!ok) {
+        error = strerror(errno);
+    }
+    close_fds(fds);
+    return ok;
+}
+
+// 辅助进程主循环：已进入容器命名空间，等待请求、命令退出和容器退出
+static void run_exec_helper(const ExecTarget& target, int listen_fd, int dir_fd) {
+    std::vector<int> pending;               // 已连接、尚未收到请求
+    std::vector<HelperCommand> commands;
+    bool container_running = true;
+    while (container_running || !commands.empty()) {
+        // 布局：[listen, 容器pidfd] + pending连接 + 每条命令的 (pidfd, 连接)
+        std::vector<struct pollfd> fds;
+        fds.push_back({container_running ? listen_fd : -1, POLLIN, 0});
+        fds.push_back({container_running ? target.pidfd : -1, POLLIN, 0});
+        for (int conn : pending) {
+            fds.push_back({conn, POLLIN, 0});
+        }
+        for (const auto& command : commands) {
+            fds.push_back({command.process.pidfd, POLLIN, 0});
+            fds.push_back({command.conn, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        std::vector<int> still_pending;
+        std::vector<HelperCommand> started;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            int conn = pending[i];
+            if (fds[2 + i].revents == 0) {
+                still_pending.push_back(conn);
+                continue;
+            }
+            std::string payload;
+            std::vector<int> received;
+            std::string error;
+            HelperCommand command;
+            if (!receive_message(conn, payload, received)) {
+                close(conn);
+                continue;
+            }
+            std::vector<std::string> fields = split_fields(payload);
+            if (!fields.empty() && fields[0] == "EXEC" && start_helper_command(target, fields, received, command, error)) {
+                command.conn = conn;
+                started.push_back(command);
+                continue;
+            }
+            close_fds(received);
+            send_message(conn, "ERR " + (error.empty() ? std::string("invalid request") : error));
+            close(conn);
+        }
+
+        size_t base = 2 + pending.size();
+        std::vector<HelperCommand> running;
+        for (size_t i = 0; i < commands.size(); ++i) {
+            HelperCommand& command = commands[i];
+            if (fds[base + 2 * i + 1].revents != 0) {
+                std::string payload;
+                std::vector<int> received;
+                if (receive_message(command.conn, payload, received)) {
+                    close_fds(received);
+                    std::vector<std::string> fields = split_fields(payload);
+                    if (fields.size() == 2 && fields[0] == "SIGNAL") {
+                        send_pidfd_signal(command.process.pidfd, atoi(fields[1].c_str()));
+                    }
+                } else {
+                    // 客户端已退出，没有人等待命令结果
+                    send_pidfd_signal(command.process.pidfd, SIGKILL);
+                    close(command.conn);
+                    command.conn = -1;
+                }
+            }
+            if (fds[base + 2 * i].revents != 0) {
+                int status = 0;
+                std::string reply = wait_pidfd(command.process.pidfd, status)
+                                        ? "EXIT " + std::to_string(exec_exit_code(status)) : "ERR wait failed";
+                close(command.process.pidfd);
+                if (command.conn >= 0) {
+                    send_message(command.conn, reply);
+                    close(command.conn);
+                }
+                continue;
+            }
+            running.push_back(command);
+        }
+        running.insert(running.end(), started.begin(), started.end());
+        commands.swap(running);
+
+        if (container_running && fds[0].revents != 0) {
+            int conn = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (conn >= 0) {
+                still_pending.push_back(conn);
+            }
+        }
+        pending.swap(still_pending);
+
+        // 容器退出：不再接受请求，其PID命名空间中的命令会被内核终止，回收后退出
+        if (container_running && fds[1].revents != 0) {
+            container_running = false;
+            unlinkat(dir_fd, EXEC_HELPER_SOCKET.c_str(), 0);
+            close(listen_fd);
+            for (int conn : pending) {
+                send_message(conn, "ERR container exited");
+                close(conn);
+            }
+            pending.clear();
+        }
+    }
+}
+
+bool start_exec_helper(const std::string& container_name) {
+    ExecTarget target;
+    if (!open_exec_target(container_name, target)) {
+        return false;
+    }
+    // 进入容器挂载命名空间后无法再访问主机路径：socket和信息目录在此之前打开
+    struct sockaddr_un addr;
+    std::string path = exec_helper_socket_path(container_name);
+    int dir_fd = open((CONTAINER_INFO_PATH + container_name).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (dir_fd < 0 || listen_fd < 0 || !exec_helper_address(container_name, addr) ||
+        bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        chmod(path.c_str(), 0600) != 0 || listen(listen_fd, SOMAXCONN) != 0) {
+        perror("[Exec] Failed to create exec helper socket");
+        if (dir_fd >= 0) close(dir_fd);
+        if (listen_fd >= 0) close(listen_fd);
+        unlink(path.c_str());
+        close_exec_target(target);
+        return false;
+    }
+
+    // 两次fork：辅助进程交给init（或监管进程）接管，与容器一样在 run -d 退出后继续运行
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        setsid();
+        if (fork() != 0) {
+            _exit(0);
+        }
+        signal(SIGINT, SIG_IGN);
+        signal(SIGHUP, SIG_IGN);
+        signal(SIGPIPE, SIG_IGN);
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+        int null_fd = open("/dev/null", O_RDWR);
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        std::vector<int> keep = {listen_fd, dir_fd, target.pidfd, target.cgroup_fd};
+        keep.insert(keep.end(), target.cgroup_procs.begin(), target.cgroup_procs.end());
+        close_other_fds(keep);
+        if (!enter_container_namespaces(target)) {
+            unlinkat(dir_fd, EXEC_HELPER_SOCKET.c_str(), 0);
+            _exit(1);
+        }
+        run_exec_helper(target, listen_fd, dir_fd);
+        _exit(0);
+    }
+    close(listen_fd);
+    close(dir_fd);
+    close_exec_target(target);
+    if (pid < 0) {
+        perror("[Exec] fork failed");
+        unlink(path.c_str());
+        return false;
+    }
+    waitpid(pid, nullptr, 0);
+    std::cout << "[Exec] Exec helper listening on " << path << std::endl;
+    return true;
+}
+
+// 通过exec辅助进程执行命令；容器没有辅助进程时返回false
+static bool exec_via_helper(const ExecOptions& options, int& exit_code) {
+    struct sockaddr_un addr;
+    if (!exec_helper_address(options.name, addr)) {
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<std::string> fields = {"EXEC", std::to_string(options.env.size())};
+    fields.insert(fields.end(), options.env.begin(), options.env.end());
+    fields.insert(fields.end(), options.command.begin(), options.command.end());
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        !send_message(fd, join_fields(fields), {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO})) {
+        close(fd);
+        return false;
+    }
+
+    // 命令不在本进程的进程组中，终端信号由本进程转发
+    sigset_t mask, old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGQUIT);
+    sigprocmask(SIG_BLOCK, &mask, &old_mask);
+    int signal_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+
+    exit_code = 1;
+    while (true) {
+        struct pollfd fds[2] = {{fd, POLLIN, 0}, {signal_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("[Exec] poll failed");
+            break;
+        }
+        struct signalfd_siginfo siginfo;
+        if ((fds[1].revents & POLLIN) && read(signal_fd, &siginfo, sizeof(siginfo)) == sizeof(siginfo)) {
+            send_message(fd, join_fields({"SIGNAL", std::to_string(siginfo.ssi_signo)}));
+        }
+        if (fds[0].revents == 0) {
+            continue;
+        }
+        std::string reply;
+        std::vector<int> received;
+        if (!receive_message(fd, reply, received)) {
+            std::cerr << "[Exec] Exec helper closed the connection" << std::endl;
+            break;
+        }
+        close_fds(received);
+        if (reply.compare(0, 5, "EXIT ") == 0) {
+            exit_code = atoi(reply.c_str() + 5);
+        } else {
+            std::cerr << "[Exec] Exec helper failed: " << reply.substr(reply.find(' ') + 1) << std::endl;
+            exit_code = 126;
+        }
+        break;
+    }
+    if (signal_fd >= 0) {
+        close(signal_fd);
+    }
+    close(fd);
+    sigprocmask(SIG_SETMASK, &old_mask, nullptr);
+    return true;
+}
+
+int exec_container(const ExecOptions& options) {
+    int exit_code = 0;
+    if (exec_via_helper(options, exit_code)) {
+        return exit_code;
+    }
+
+    ExecTarget target;
+    if (!open_exec_target(options.name, target)) {
+        return 1;
+    }
+    if (!enter_container_namespaces(target)) {
+        close_exec_target(target);
+        return 1;
+    }
+    SpawnedProcess process;
+    bool spawned = spawn_exec_process(target, options.command, options.env, nullptr, process);
+    close_exec_target(target);
+    if (!spawned) {
+        return 1;
+    }
+
+    // 与 system() 相同：终端的Ctrl-C由命令处理，等待期间本进程忽略
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    int status = 0;
+    bool waited = process.pidfd >= 0 ? wait_pidfd(process.pidfd, status)
+                                     : waitpid(process.pid, &status, 0) == process.pid;
+    if (process.pidfd >= 0) {
+        close(process.pidfd);
+    }
+    if (!waited) {
+        perror("[Exec] Failed to wait for command");
+        return 1;
+    }
+    return exec_exit_code(status);
+}
@@ -0,0 +1,71 @@
+#ifndef EXEC_H
+#define EXEC_H
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "spawn.h"
+
+// ==================== 在运行中的容器内执行命令 ====================
+// 进入容器所需的句柄在执行前一次性打开：
+//   - 容器init进程的pidfd：setns(pidfd, CLONE_NEWNS|CLONE_NEWPID|...) 一次调用进入全部命名空间
+//   - 容器cgroup：v2为目录fd（clone3(CLONE_INTO_CGROUP)），v1为各层级的 cgroup.procs
+//   - 容器init进程的环境变量，直接作为新进程的envp，不修改调用者自身的环境
+// setns 进入PID命名空间只对之后创建的子进程生效，因此命令总是在 fork 出的子进程中执行。
+//
+// 频繁exec的容器（探针、sidecar命令）可以用 run --exec-helper 启动一个常驻辅助进程：
+// 它启动时打开上述句柄并进入容器命名空间，之后在 <容器信息目录>/exec.sock 上接受请求，
+// 每次exec只需在容器中fork一次，不再重复查找记录、进入命名空间和解析环境变量。
+// 辅助进程不加入容器cgroup（否则会计入容器的内存/进程数限制，并使容器退出后cgroup无法删除），
+// 只持有cgroup句柄，创建的子进程照常加入。容器退出后辅助进程删除socket并退出。
+// 协议（SOCK_SEQPACKET，每个连接执行一条命令，字段以'\0'分隔）：
+//   EXEC <环境变量个数> <KEY=VALUE...> <argv...>   附带客户端的 stdin/stdout/stderr
+//        -> 命令退出后返回 "EXIT <退出码>"，失败时返回 "ERR <原因>"
+//   SIGNAL <信号>                                   转发客户端收到的信号
+// 命令结束前客户端断开连接时，辅助进程以SIGKILL终止命令。
+
+// 容器exec的目标
+struct ExecTarget {
+    std::string name;
+    std::string id;
+    pid_t pid = -1;
+    int pidfd = -1;                     // 容器init进程的pidfd
+    int cgroup_fd = -1;                 // v2 cgroup目录，v1为-1
+    std::vector<int> cgroup_procs;      // cgroup.procs，子进程写入"0"加入（v1，或v2无法直接创建在cgroup中时）
+    std::vector<std::string> env;       // 容器init进程的环境变量
+};
+
+// 打开容器的pidfd、cgroup并读取环境变量（必须在进入容器挂载命名空间之前调用）
+bool open_exec_target(const std::string& container_name, ExecTarget& target);
+
+// 关闭 ExecTarget 持有的文件描述符
+void close_exec_target(ExecTarget& target);
+
+// 调用进程进入容器的命名空间；PID命名空间只对之后创建的子进程生效
+bool enter_container_namespaces(const ExecTarget& target);
+
+// 已进入容器命名空间后：创建加入容器cgroup的子进程执行命令。
+// 子进程的环境变量为容器init进程的环境变量，env（KEY=VALUE）覆盖同名变量；
+// stdio 非空时为子进程的 stdin/stdout/stderr
+bool spawn_exec_process(const ExecTarget& target, const std::vector<std::string>& command,
+                        const std::vector<std::string>& env, const int* stdio, SpawnedProcess& process);
+
+// 将 waitpid 格式的状态转换为命令的退出码（被信号终止时为128+信号）
+int exec_exit_code(int status);
+
+// exec 参数：exec [-e KEY=VALUE]... <容器名> <命令...>
+struct ExecOptions {
+    std::string name;
+    std::vector<std::string> command;
+    std::vector<std::string> env;
+};
+bool parse_exec_options(int argc, char* argv[], ExecOptions& options);
+
+// 为容器启动常驻的exec辅助进程（容器已记录且正在运行）
+bool start_exec_helper(const std::string& container_name);
+
+// exec 命令：在容器中执行命令并等待其退出，返回命令的退出码。
+// 容器有exec辅助进程时通过它执行，否则直接进入容器执行
+int exec_container(const ExecOptions& options);
+
+#endif // EXEC_H
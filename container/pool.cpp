@@ -0,0 +1,612 @@
+#include "pool.h"
+#include "container.h"
+#include "common/constants.h"
+#include "common/structures.h"
+#include "common/utils.h"
+#include "network/network.h"
+#include "filesystem/filesystem.h"
+#include "cgroup/cgroup.h"
+#include "cgroup/cpualloc.h"
+#include "image/image.h"
+#include "spawn.h"
+#include "common/message.h"
+#include <iostream>
+#include <deque>
+#include <map>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/signalfd.h>
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 池配置摘要：影响预热步骤的参数必须与池一致
+static std::string pool_profile(const RunOptions& options) {
+    return options.image + "|" + options.network_name + "|" + std::to_string(options.mem_limit) + "|" +
+           std::to_string(options.mem_high) + "|" + options.cpu_shares + "|" + options.cpus + "|" +
+           options.cpu_weight + "|" + options.cpuset + "|" + options.numa + "|" + (options.cpu_exclusive ? "x" : "") + "|" + options.io_max + "|" + options.pids_limit + "|" +
+           options.volume_str + "|" + std::to_string(options.log_options.max_size) + "|" +
+           std::to_string(options.log_options.max_files);
+}
+
+// ==================== 预热容器进程 ====================
+
+struct PoolChildArgs {
+    std::string root_path;  // 容器工作空间的挂载点
+    int control_fd;         // 子进程端：接收启动请求
+    int peer_fd;            // 服务进程端：子进程中需要关闭
+};
+
+// 预热容器的init进程：提前完成挂载，然后阻塞等待命令
+static int pooled_container_init(void* arg) {
+    PoolChildArgs* args = static_cast<PoolChildArgs*>(arg);
+    close(args->peer_fd);
+
+    // 服务进程通过signalfd接收信号，子进程需要恢复默认的信号掩码
+    sigset_t empty;
+    sigemptyset(&empty);
+    sigprocmask(SIG_SETMASK, &empty, nullptr);
+
+    setup_mount(args->root_path);
+    std::cout.flush();
+
+    // 消息格式：<env数量> <env...> <argv...>，附带 stdin/stdout/stderr
+    std::string payload;
+    std::vector<int> fds;
+    if (!receive_message(args->control_fd, payload, fds)) {
+        _exit(0); // 池服务关闭，容器未被使用
+    }
+    close(args->control_fd);
+
+    std::vector<std::string> fields = split_fields(payload);
+    size_t env_count = fields.empty() ? 0 : strtoul(fields[0].c_str(), nullptr, 10);
+    if (fds.size() != 3 || fields.size() < 2 + env_count) {
+        _exit(127);
+    }
+    for (int i = 0; i < 3; ++i) {
+        dup2(fds[i], i);
+    }
+    close_fds(fds);
+
+    for (size_t i = 1; i <= env_count; ++i) {
+        putenv(strdup(fields[i].c_str()));
+    }
+    std::vector<char*> child_args;
+    for (size_t i = 1 + env_count; i < fields.size(); ++i) {
+        child_args.push_back(const_cast<char*>(fields[i].c_str()));
+    }
+    child_args.push_back(nullptr);
+
+    execvp(child_args[0], child_args.data());
+    perror("execvp failed");
+    _exit(127);
+}
+
+// ==================== 池服务 ====================
+
+// 池中等待使用的容器
+struct PooledContainer {
+    std::string id;
+    pid_t pid = -1;
+    int pidfd = -1;         // 用于发送信号，不受PID复用影响
+    int control_fd = -1;
+    std::string ip;
+    CgroupLimits limits;    // 含NUMA放置结果
+};
+
+// 已从池中取出、正在运行的容器
+struct PooledRun {
+    std::string id;
+    std::string name;
+    std::string ip;
+    bool detach = false;
+    bool port_mapping = false;
+    int client_fd = -1;     // 非detach模式下等待退出码的客户端
+};
+
+class ContainerPool {
+public:
+    ContainerPool(const RunOptions& options, int size) : options(options), size(size) {}
+
+    bool init();
+    int serve();
+
+private:
+    bool warm_container();
+    void handle_request(int client_fd);
+    void reap_children();
+    void cleanup_container(const std::string& id, const std::string& ip, bool port_mapping = false);
+    void shutdown();
+
+    RunOptions options;
+    int size;
+    std::string profile;
+    std::vector<std::string> layers;
+    std::vector<std::string> lower_dirs;
+    VolumeInfo volume_info;
+    NetworkInfo network;
+    CgroupLimits limits;
+
+    std::deque<PooledContainer> idle;
+    std::map<pid_t, PooledRun> running;
+};
+
+bool ContainerPool::init() {
+    profile = pool_profile(options);
+    volume_info = options.volume_str.empty() ? VolumeInfo{"", "", false} : parse_volume(options.volume_str);
+    if (!prepare_image(options.image, layers)) {
+        return false;
+    }
+    lower_dirs = layer_lower_dirs(layers);
+    network = prepare_network(options);
+    if (!options.network_name.empty() && network.name.empty()) {
+        return false;
+    }
+    limits = cgroup_limits(options);
+    return true;
+}
+
+// 预热一个容器：工作空间、命名空间、cgroup、网络
+bool ContainerPool::warm_container() {
+    auto start = std::chrono::steady_clock::now();
+    PooledContainer container;
+    container.id = generate_container_id();
+
+    Workspace workspace = get_workspace(container.id);
+    if (!new_workspace(workspace, lower_dirs, volume_info)) {
+        std::cerr << "[Pool] Failed to create workspace" << std::endl;
+        return false;
+    }
+    save_workspace_layers(workspace.root, layers);
+
+    // 池中空闲容器尚未记录，放置时与运行中的容器一起计入节点负载
+    std::vector<std::string> placements;
+    if (options.numa == "auto") {
+        placements = running_numa_placements();
+        for (const auto& pooled : idle) {
+            placements.push_back(pooled.limits.cpuset_mems);
+        }
+    }
+    container.limits = limits;
+    if (!place_container(options, container.id, placements, container.limits)) {
+        delete_workspace(workspace, volume_info);
+        return false;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        perror("[Pool] socketpair failed");
+        delete_workspace(workspace, volume_info);
+        release_container_cpus(container.id);
+        return false;
+    }
+    create_container_cgroup(container.id, container.limits);
+    int cgroup_fd = open_container_cgroup(container.id);
+    PoolChildArgs args = {workspace.mount_point, fds[1], fds[0]};
+    SpawnedProcess process;
+    bool spawned = spawn_container(pooled_container_init, &args,
+                                   CLONE_NEWUTS | CLONE_NEWPID | CLONE_NEWNS |
+                                   CLONE_NEWNET | CLONE_NEWIPC,
+                                   cgroup_fd, process);
+    if (cgroup_fd >= 0) close(cgroup_fd);
+    close(fds[1]);
+    if (!spawned) {
+        perror("[Pool] clone failed");
+        close(fds[0]);
+        cleanup_container(container.id, "");
+        return false;
+    }
+    container.pid = process.pid;
+    container.pidfd = process.pidfd;
+    container.control_fd = fds[0];
+
+    if (!process.in_cgroup) {
+        attach_container_cgroup(container.id, container.pid);
+    }
+
+    if (!network.name.empty()) {
+        std::string ip = allocate_ip(network.ip_range);
+        if (!ip.empty() && setup_container_network(container.id, network.name, ip, container.pid)) {
+            container.ip = ip;
+        } else {
+            // IP分配失败时没有可释放的地址；网络配置失败时 setup_container_network 已归还
+            std::cerr << "[Pool] Failed to setup container network" << std::endl;
+            send_pidfd_signal(container.pidfd, SIGKILL);
+            close(container.pidfd);
+            close(container.control_fd);
+            waitpid(container.pid, nullptr, 0);
+            cleanup_container(container.id, "");
+            return false;
+        }
+    }
+
+    idle.push_back(container);
+    printf("[Pool] Warmed container %s in %.2f ms (%zu/%d ready)\n",
+           container.id.c_str(), elapsed_ms(start), idle.size(), size);
+    fflush(stdout);
+    return true;
+}
+
+// 清理未运行或已退出容器的网络、工作空间、cgroup和CPU
+void ContainerPool::cleanup_container(const std::string& id, const std::string& ip, bool port_mapping) {
+    release_container_network(id, network.name, ip, port_mapping);
+    delete_workspace(get_workspace(id), volume_info);
+    remove_container_cgroup(id);
+    release_container_cpus(id);
+}
+
+void ContainerPool::handle_request(int client_fd) {
+    auto start = std::chrono::steady_clock::now();
+    std::string payload;
+    std::vector<int> client_stdio;
+    if (!receive_message(client_fd, payload, client_stdio)) {
+        close(client_fd);
+        return;
+    }
+
+    // RUN <profile> <name> <detach> <env数量> <env...> <端口数量> <端口...> <argv...>
+    std::vector<std::string> fields = split_fields(payload);
+    size_t env_count = fields.size() > 4 ? strtoul(fields[4].c_str(), nullptr, 10) : 0;
+    size_t port_index = 5 + env_count;
+    size_t port_count = fields.size() > port_index ? strtoul(fields[port_index].c_str(), nullptr, 10) : 0;
+    size_t argv_index = port_index + 1 + port_count;
+    if (fields.size() <= argv_index || fields[0] != "RUN") {
+        send_message(client_fd, "ERR invalid request");
+        close_fds(client_stdio);
+        close(client_fd);
+        return;
+    }
+    if (fields[1] != profile) {
+        send_message(client_fd, "ERR pool configuration mismatch");
+        close_fds(client_stdio);
+        close(client_fd);
+        return;
+    }
+    bool detach = fields[3] == "1";
+    std::vector<std::string> env_vars(fields.begin() + 5, fields.begin() + port_index);
+    std::vector<std::string> ports(fields.begin() + port_index + 1, fields.begin() + argv_index);
+    std::vector<std::string> command(fields.begin() + argv_index, fields.end());
+    if (!detach && client_stdio.size() != 3) {
+        send_message(client_fd, "ERR missing stdio");
+        close_fds(client_stdio);
+        close(client_fd);
+        return;
+    }
+
+    // 池已用完时同步预热一个（冷启动）
+    if (idle.empty()) {
+        std::cout << "[Pool] Pool is empty, warming a container on demand" << std::endl;
+        if (!warm_container()) {
+            send_message(client_fd, "ERR failed to create container");
+            close_fds(client_stdio);
+            close(client_fd);
+            return;
+        }
+    }
+    PooledContainer container = idle.front();
+    idle.pop_front();
+
+    PooledRun run;
+    run.id = container.id;
+    run.name = fields[2].empty() ? container.id : fields[2];
+    run.ip = container.ip;
+    run.detach = detach;
+
+    std::string recorded_name = record_container_info(container.pid, command, run.name, run.id);
+    ContainerInfo runtime_info;
+    runtime_info.volume = options.volume_str;
+    runtime_info.cgroup_path = container_cgroup_path(run.id);
+    runtime_info.cpuset_cpus = container.limits.cpuset;
+    runtime_info.cpuset_mems = container.limits.cpuset_mems;
+    if (!container.ip.empty()) {
+        runtime_info.network_name = network.name;
+        runtime_info.ip_address = container.ip;
+        if (!ports.empty() && setup_port_mapping(run.id, container.ip, ports)) {
+            run.port_mapping = true;
+            for (const auto& mapping : ports) {
+                if (!runtime_info.port_mapping.empty()) runtime_info.port_mapping += ",";
+                runtime_info.port_mapping += mapping;
+            }
+        }
+    }
+    if (!recorded_name.empty()) {
+        update_container_runtime_info(run.name, runtime_info);
+    }
+
+    // detach模式：输出写入日志管道，由日志收集进程写入文件；否则直接使用客户端的标准输入输出
+    std::vector<int> stdio = client_stdio;
+    if (detach) {
+        close_fds(client_stdio);
+        std::string log_path = CONTAINER_INFO_PATH + run.name + "/" + CONTAINER_LOG_FILE;
+        int out_fd = -1, err_fd = -1;
+        start_log_collector(log_path, options.log_options, out_fd, err_fd);
+        int null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        stdio = {null_fd, out_fd, err_fd};
+    }
+
+    std::vector<std::string> child_fields = {std::to_string(env_vars.size())};
+    child_fields.insert(child_fields.end(), env_vars.begin(), env_vars.end());
+    child_fields.insert(child_fields.end(), command.begin(), command.end());
+    bool sent = stdio[0] >= 0 && stdio[1] >= 0 && stdio[2] >= 0 &&
+                send_message(container.control_fd, join_fields(child_fields), stdio);
+    close_fds(stdio);
+    close(container.control_fd);
+
+    if (!sent) {
+        std::cerr << "[Pool] Failed to hand over request to container " << run.id << std::endl;
+        send_message(client_fd, "ERR failed to start container");
+        close(client_fd);
+        send_pidfd_signal(container.pidfd, SIGKILL);
+        close(container.pidfd);
+        run.detach = false; // 由reap_children清理
+        running[container.pid] = run;
+        return;
+    }
+
+    close(container.pidfd); // 之后由reap_children通过waitpid回收
+    send_message(client_fd, "OK " + run.name + " " + std::to_string(container.pid));
+    if (detach) {
+        close(client_fd);
+    } else {
+        run.client_fd = client_fd;
+    }
+    running[container.pid] = run;
+
+    printf("[Pool] Started %s (PID %d) from pool in %.2f ms (%zu/%d ready)\n",
+           run.name.c_str(), container.pid, elapsed_ms(start), idle.size(), size);
+    fflush(stdout);
+}
+
+// 回收退出的容器进程
+void ContainerPool::reap_children() {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+        auto run_it = running.find(pid);
+        if (run_it != running.end()) {
+            PooledRun& run = run_it->second;
+            std::cout << "[Pool] Container " << run.name << " exited with status: " << exit_code << std::endl;
+            if (run.client_fd >= 0) {
+                send_message(run.client_fd, "EXIT " + std::to_string(exit_code));
+                close(run.client_fd);
+            }
+            // detach容器保留记录和工作空间，由 rm 命令清理
+            if (!run.detach) {
+                cleanup_container(run.id, run.ip, run.port_mapping);
+                delete_container_info(run.name);
+            } else {
+                ContainerInfo info;
+                if (find_container_info(run.name, info) && info.id == run.id && info.status == RUNNING) {
+                    info.status = EXITED;
+                    info.pid = "";
+                    info.pid_start_time = "";
+                    info.exit_code = std::to_string(exit_code);
+                    save_container_info(info);
+                }
+            }
+            running.erase(run_it);
+            continue;
+        }
+
+        for (auto it = idle.begin(); it != idle.end(); ++it) {
+            if (it->pid == pid) {
+                std::cerr << "[Pool] Pooled container " << it->id << " exited unexpectedly" << std::endl;
+                close(it->control_fd);
+                close(it->pidfd);
+                cleanup_container(it->id, it->ip);
+                idle.erase(it);
+                break;
+            }
+        }
+    }
+}
+
+// 销毁池中未使用的容器；已取出的容器继续运行
+void ContainerPool::shutdown() {
+    std::cout << "[Pool] Shutting down, releasing " << idle.size() << " pooled containers" << std::endl;
+    for (const auto& container : idle) {
+        close(container.control_fd); // 子进程收到EOF后退出
+    }
+    for (const auto& container : idle) {
+        waitpid(container.pid, nullptr, 0);
+        close(container.pidfd);
+        cleanup_container(container.id, container.ip);
+    }
+    idle.clear();
+    for (auto& pair : running) {
+        if (pair.second.client_fd >= 0) {
+            close(pair.second.client_fd);
+        }
+    }
+    if (!running.empty()) {
+        std::cout << "[Pool] " << running.size() << " containers started from the pool are still running" << std::endl;
+    }
+}
+
+int ContainerPool::serve() {
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+    int listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        perror("[Pool] socket failed");
+        return 1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, CONTAINER_POOL_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(CONTAINER_POOL_SOCKET.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        perror("[Pool] Failed to listen on socket");
+        close(listen_fd);
+        return 1;
+    }
+
+    // 信号统一通过signalfd在主循环中处理
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    int signal_fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "[Pool] Listening on " << CONTAINER_POOL_SOCKET << " with pool size " << size << std::endl;
+    bool stop_requested = false;
+    int warm_failures = 0;
+    while (!stop_requested) {
+        // 池未满时在空闲间隙补充（优先处理请求）；连续失败后降低重试频率
+        int timeout = -1;
+        if (static_cast<int>(idle.size()) < size) {
+            timeout = warm_failures > 0 ? 1000 : 0;
+        }
+        struct pollfd fds[2] = {{signal_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}};
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("[Pool] poll failed");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                if (info.ssi_signo == SIGINT || info.ssi_signo == SIGTERM) {
+                    stop_requested = true;
+                }
+            }
+            reap_children();
+        }
+        if (fds[1].revents & POLLIN) {
+            int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd >= 0) {
+                handle_request(client_fd);
+            }
+        }
+        if (ready == 0 && !stop_requested) {
+            warm_failures = warm_container() ? 0 : warm_failures + 1;
+        }
+    }
+
+    close(listen_fd);
+    unlink(CONTAINER_POOL_SOCKET.c_str());
+    shutdown();
+    close(signal_fd);
+    std::cout << "[Pool] Stopped" << std::endl;
+    return 0;
+}
+
+int run_pool_server(const RunOptions& options, int pool_size) {
+    std::cout << "[Pool] Starting container pool (" << pool_size << " containers, image "
+              << options.image << ")..." << std::endl;
+    ContainerPool pool(options, pool_size);
+    if (!pool.init()) {
+        std::cerr << "[Pool] Failed to initialize pool" << std::endl;
+        return 1;
+    }
+    return pool.serve();
+}
+
+bool parse_pool_options(int argc, char* argv[], RunOptions& options, int& pool_size) {
+    pool_size = DEFAULT_POOL_SIZE;
+    // 去掉 --size 后交给 run 的参数解析
+    std::vector<char*> run_argv = {argv[0]};
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            pool_size = atoi(argv[++i]);
+        } else {
+            run_argv.push_back(argv[i]);
+        }
+    }
+    if (pool_size < 1) {
+        std::cerr << "[Error] Invalid pool size" << std::endl;
+        return false;
+    }
+    if (!parse_run_options(run_argv.size(), run_argv.data(), options, false)) {
+        return false;
+    }
+    if (!options.command.empty()) {
+        std::cerr << "[Error] Unexpected argument: " << options.command[0] << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==================== 客户端 ====================
+
+bool run_pooled_container(const RunOptions& options, int& exit_code) {
+    if (!options.commit_image.empty()) {
+        std::cerr << "[Pool] --commit is not supported for pooled containers" << std::endl;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, CONTAINER_POOL_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "[Pool] Pool server is not running" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    std::vector<std::string> fields = {"RUN", pool_profile(options), options.container_name,
+                                       options.detach_mode ? "1" : "0", std::to_string(options.env_vars.size())};
+    fields.insert(fields.end(), options.env_vars.begin(), options.env_vars.end());
+    fields.push_back(std::to_string(options.port_mapping.size()));
+    fields.insert(fields.end(), options.port_mapping.begin(), options.port_mapping.end());
+    fields.insert(fields.end(), options.command.begin(), options.command.end());
+
+    std::vector<int> stdio;
+    if (!options.detach_mode) {
+        stdio = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    }
+    std::string reply;
+    std::vector<int> unused;
+    if (!send_message(fd, join_fields(fields), stdio) || !receive_message(fd, reply, unused)) {
+        std::cerr << "[Pool] Failed to send request to pool server" << std::endl;
+        close(fd);
+        return false;
+    }
+    if (reply.compare(0, 3, "OK ") != 0) {
+        std::cerr << "[Pool] Pool server refused request: " << reply << std::endl;
+        close(fd);
+        return false;
+    }
+    // "OK <name> <pid>"
+    std::string started = reply.substr(3);
+    size_t space = started.rfind(' ');
+    printf("[Pool] Warm start: container %s (PID %s) started in %.2f ms\n", started.substr(0, space).c_str(),
+           started.substr(space + 1).c_str(), elapsed_ms(start));
+    fflush(stdout);
+
+    exit_code = 0;
+    if (!options.detach_mode) {
+        // 等待容器退出
+        if (receive_message(fd, reply, unused) && reply.compare(0, 5, "EXIT ") == 0) {
+            exit_code = atoi(reply.c_str() + 5);
+        } else {
+            std::cerr << "[Pool] Lost connection to pool server" << std::endl;
+            exit_code = 1;
+        }
+    }
+    close(fd);
+    return true;
+}
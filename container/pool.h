@@ -0,0 +1,30 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <string>
+#include "run.h"
+
+// ==================== 预热容器池 ====================
+// 池服务进程预先创建 K 个容器：克隆命名空间、挂载OverlayFS并完成pivot_root、
+// 加入cgroup、配置veth。预热容器阻塞在控制socket上，收到请求后只需
+// 接收 argv/env 和标准输入输出的fd，然后直接 execvp。
+// 容器被取走后，服务进程在空闲时于后台补充，池中容器始终保持 K 个。
+//
+// 协议（SOCK_SEQPACKET，每个连接一个请求，字段以'\0'分隔）：
+//   RUN <profile> <name> <detach> <env数量> <env...> <端口数量> <端口...> <argv...>
+//   非detach模式时随请求通过SCM_RIGHTS传递客户端的 stdin/stdout/stderr
+//   -> "OK <name> <pid>" 或 "ERR <原因>"
+//   非detach模式下容器退出时再发送 "EXIT <退出码>"
+// profile 由镜像、网络、资源限制和volume组成，与池配置不一致的请求会被拒绝。
+
+// 以前台方式运行池服务，options中的镜像、网络、资源限制和volume作用于池中所有容器
+int run_pool_server(const RunOptions& options, int pool_size);
+
+// 解析 pool 命令参数（--size 以及 run 的配置参数）
+bool parse_pool_options(int argc, char* argv[], RunOptions& options, int& pool_size);
+
+// 客户端：从池中启动容器。池服务未运行或配置不匹配时返回false（调用者回退到冷启动），
+// 成功时exit_code为容器退出码（detach模式为0）
+bool run_pooled_container(const RunOptions& options, int& exit_code);
+
+#endif // POOL_H
@@ -0,0 +1,753 @@
+#include "run.h"
+#include "container.h"
+#include "common/constants.h"
+#include "common/structures.h"
+#include "common/utils.h"
+#include "logging/logging.h"
+#include "network/network.h"
+#include "filesystem/filesystem.h"
+#include "cgroup/cgroup.h"
+#include "cgroup/numa.h"
+#include "cgroup/cpualloc.h"
+#include "image/image.h"
+#include "spawn.h"
+#include "exec.h"
+#include "supervisor/supervisor.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// 容器参数结构体
+struct ContainerArgs {
+    char** child_args;
+    bool detach_mode;
+    int log_stdout_fd = -1;     // detach模式：日志管道写端
+    int log_stderr_fd = -1;
+    std::vector<std::string> env_vars;
+    std::string root_path;      // 容器工作空间的挂载点
+    int start_pipe_fd = -1;     // 读端：父进程完成配置后写入一个字节
+    int start_pipe_peer = -1;   // 写端：子进程中需要关闭
+    int ready_pipe_fd = -1;     // 就绪管道写端（O_CLOEXEC）：exec成功时自动关闭，失败时写入errno
+};
+
+// 容器初始化进程，设置文件系统并执行用户命令
+static int container_init(void* arg) {
+    ContainerArgs* container_args = (ContainerArgs*)arg;
+    char** child_args = container_args->child_args;
+
+    // 等待父进程完成记录、cgroup和网络配置
+    if (container_args->start_pipe_fd >= 0) {
+        close(container_args->start_pipe_peer);
+        char ready;
+        ssize_t n;
+        do {
+            n = read(container_args->start_pipe_fd, &ready, 1);
+        } while (n < 0 && errno == EINTR);
+        close(container_args->start_pipe_fd);
+        if (n != 1) {
+            _exit(1); // 父进程放弃启动
+        }
+    }
+
+    std::cout << "[Container] Container init process started" << std::endl;
+
+    // 在detach模式下，标准输出和标准错误写入日志管道，由日志收集进程写入文件
+    if (container_args->detach_mode) {
+        setup_log_redirection(container_args->log_stdout_fd, container_args->log_stderr_fd);
+    }
+
+    // 挂载必要的文件系统
+    setup_mount(container_args->root_path);
+
+    // 设置环境变量
+    for (const auto& env_var : container_args->env_vars) {
+        std::cout << "[Container] Setting environment variable: " << env_var << std::endl;
+        if (putenv(strdup(env_var.c_str())) != 0) {
+            std::cerr << "[Container] Failed to set environment variable: " << env_var << std::endl;
+        }
+    }
+
+    std::cout << "[Container] Executing command: " << child_args[0] << std::endl;
+
+    // 执行用户指定的命令
+    if (execvp(child_args[0], child_args) != 0) {
+        int exec_errno = errno;
+        perror("execvp failed");
+        if (container_args->ready_pipe_fd >= 0 &&
+            write(container_args->ready_pipe_fd, &exec_errno, sizeof(exec_errno)) < 0) {
+            perror("[Container] Failed to report exec error");
+        }
+        return -1;
+    }
+
+    return 0;
+}
+
+bool parse_run_options(int argc, char* argv[], RunOptions& options, bool require_command) {
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "run") == 0) {
+        first = 2; // 兼容 "run" 子命令写法
+    }
+
+    for (int i = first; i < argc; ++i) {
+        if (strcmp(argv[i], "--mem") == 0 && i + 1 < argc) {
+            options.mem_limit = atoi(argv[++i]) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--mem-high") == 0 && i + 1 < argc) {
+            options.mem_high = atoi(argv[++i]) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            options.cpu_shares = argv[++i];
+        } else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+            options.cpus = argv[++i];
+        } else if (strcmp(argv[i], "--cpu-weight") == 0 && i + 1 < argc) {
+            options.cpu_weight = argv[++i];
+        } else if (strcmp(argv[i], "--io-max") == 0 && i + 1 < argc) {
+            options.io_max = argv[++i];
+        } else if (strcmp(argv[i], "--pids") == 0 && i + 1 < argc) {
+            options.pids_limit = argv[++i];
+        } else if (strcmp(argv[i], "--cpuset") == 0 && i + 1 < argc) {
+            options.cpuset = argv[++i];
+        } else if (strcmp(argv[i], "--numa") == 0 && i + 1 < argc) {
+            options.numa = argv[++i];
+        } else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
+            options.volume_str = argv[++i];
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            options.env_vars.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--net") == 0 && i + 1 < argc) {
+            options.network_name = argv[++i];
+        } else if (strcmp(argv[i], "--net-backend") == 0 && i + 1 < argc) {
+            options.network_backend = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            options.port_mapping.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--commit") == 0 && i + 1 < argc) {
+            options.commit_image = argv[++i];
+        } else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            options.container_name = argv[++i];
+        } else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            options.image = argv[++i];
+        } else if (strcmp(argv[i], "--replicas") == 0 && i + 1 < argc) {
+            options.replicas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--log-max-size") == 0 && i + 1 < argc) {
+            options.log_options.max_size = static_cast<size_t>(atoi(argv[++i])) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--restart") == 0 && i + 1 < argc) {
+            options.restart_policy = argv[++i];
+        } else if (strcmp(argv[i], "--log-max-files") == 0 && i + 1 < argc) {
+            options.log_options.max_files = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            options.detach_mode = true;
+        } else if (strcmp(argv[i], "--cpu-exclusive") == 0) {
+            options.cpu_exclusive = true;
+        } else if (strcmp(argv[i], "--warm") == 0) {
+            options.warm = true;
+        } else if (strcmp(argv[i], "--exec-helper") == 0) {
+            options.exec_helper = true;
+        } else {
+            options.command.push_back(argv[i]);
+        }
+    }
+
+    if (require_command && options.command.empty()) {
+        std::cerr << "[Error] No command specified" << std::endl;
+        return false;
+    }
+    if (options.replicas < 1) {
+        std::cerr << "[Error] Invalid replica count" << std::endl;
+        return false;
+    }
+    if (!options.network_backend.empty() && !set_network_backend(options.network_backend)) {
+        return false;
+    }
+    RestartPolicy policy;
+    if (!parse_restart_policy(options.restart_policy, policy)) {
+        return false;
+    }
+    if (policy.mode != RestartPolicy::NO && (!options.detach_mode || options.warm)) {
+        std::cerr << "[Error] --restart requires -d and cannot be combined with --warm" << std::endl;
+        return false;
+    }
+    if (options.exec_helper && (!options.detach_mode || options.warm)) {
+        std::cerr << "[Error] --exec-helper requires -d and cannot be combined with --warm" << std::endl;
+        return false;
+    }
+    if (options.log_options.max_size == 0 || options.log_options.max_files < 1) {
+        std::cerr << "[Error] Invalid log rotation settings" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// CPU带宽周期（微秒），--cpus 按该周期换算为配额
+static const long CPU_PERIOD_US = 100000;
+
+CgroupLimits cgroup_limits(const RunOptions& options) {
+    CgroupLimits limits;
+    limits.memory_max = options.mem_limit;
+    limits.memory_high = options.mem_high;
+    limits.cpu_shares = options.cpu_shares;
+    limits.cpu_weight = options.cpu_weight;
+    limits.cpuset = options.cpuset == "auto" ? "" : options.cpuset;
+    limits.io_max = options.io_max;
+    limits.pids_max = options.pids_limit;
+    if (!options.cpus.empty()) {
+        long quota = static_cast<long>(atof(options.cpus.c_str()) * CPU_PERIOD_US);
+        if (quota > 0) {
+            limits.cpu_max = std::to_string(quota) + " " + std::to_string(CPU_PERIOD_US);
+        }
+    }
+    return limits;
+}
+
+std::vector<std::string> running_numa_placements() {
+    std::vector<std::string> placements;
+    for (const auto& info : load_all_container_infos()) {
+        if (info.status == RUNNING && !info.cpuset_mems.empty()) {
+            placements.push_back(info.cpuset_mems);
+        }
+    }
+    return placements;
+}
+
+bool place_container(const RunOptions& options, const std::string& container_id,
+                     std::vector<std::string>& placements, CgroupLimits& limits) {
+    if (options.numa.empty() && options.cpuset.empty()) {
+        return true;
+    }
+    bool auto_cpus = options.cpuset == "auto";
+    std::vector<NumaNode> nodes = numa_topology();
+    NumaPlacement placement;
+    if (!numa_place(nodes, options.numa, auto_cpus ? "" : options.cpuset, placements, placement)) {
+        return false;
+    }
+    if (auto_cpus) {
+        // 在选中的NUMA节点（未指定时为全部CPU）中分配，内存节点跟随分配到的CPU
+        CpuRequest request;
+        request.count = options.cpus.empty() ? 1 : std::max(1, static_cast<int>(ceil(atof(options.cpus.c_str()))));
+        request.exclusive = options.cpu_exclusive;
+        request.allowed = parse_cpu_list(placement.cpus);
+        if (!allocate_container_cpus(container_id, request, placement.cpus)) {
+            return false;
+        }
+        placement.mems = numa_mems_for_cpus(nodes, placement.cpus);
+    }
+    limits.cpuset = placement.cpus;
+    limits.cpuset_mems = placement.mems;
+    if (!placement.mems.empty()) {
+        placements.push_back(placement.mems);
+    }
+    return true;
+}
+
+// 共享步骤：检查网络（默认网桥不存在时创建），返回网络配置
+NetworkInfo prepare_network(const RunOptions& options) {
+    NetworkInfo network;
+    if (options.network_name.empty()) {
+        return network;
+    }
+
+    // 确保默认网络存在
+    if (options.network_name == DEFAULT_BRIDGE_NAME) {
+        create_bridge_network(DEFAULT_BRIDGE_NAME, DEFAULT_SUBNET);
+    }
+
+    network = load_network_config(options.network_name);
+    if (network.name.empty()) {
+        std::cerr << "[Network] Network not found: " << options.network_name << std::endl;
+    }
+    return network;
+}
+
+// 单个容器的启动状态
+struct ContainerLaunch {
+    std::string id;
+    std::string name;
+    pid_t pid = -1;
+    int pidfd = -1;         // 容器进程的pidfd，用于等待和发送信号
+    int start_pipe = -1;    // 写端，配置完成后通知子进程继续
+    int ready_pipe = -1;    // 读端，容器exec后读到EOF
+    bool in_cgroup = false; // 是否已通过clone3直接创建在容器cgroup中
+    CgroupLimits limits;    // 含NUMA放置结果
+    std::string ip;         // 分配到的容器IP，启动失败时需归还
+    ContainerArgs args;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point ready;
+};
+
+// 创建容器进程（容器cgroup需已创建），子进程阻塞直到 release_container 被调用
+static bool clone_container(const RunOptions& options, char** child_args, ContainerLaunch& launch) {
+    int pipe_fds[2];
+    int ready_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        perror("[Main] pipe failed");
+        return false;
+    }
+    if (pipe2(ready_fds, O_CLOEXEC) != 0) {
+        perror("[Main] pipe failed");
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return false;
+    }
+
+    launch.args.child_args = child_args;
+    launch.args.detach_mode = options.detach_mode;
+    launch.args.env_vars = options.env_vars;
+    launch.args.root_path = get_workspace(launch.id).mount_point;
+    launch.args.start_pipe_fd = pipe_fds[0];
+    launch.args.start_pipe_peer = pipe_fds[1];
+    launch.args.ready_pipe_fd = ready_fds[1];
+
+    if (options.detach_mode &&
+        !start_log_collector(CONTAINER_INFO_PATH + launch.name + "/" + CONTAINER_LOG_FILE, options.log_options,
+                             launch.args.log_stdout_fd, launch.args.log_stderr_fd)) {
+        std::cerr << "[Main] Failed to start log collector" << std::endl;
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        close(ready_fds[0]);
+        close(ready_fds[1]);
+        return false;
+    }
+
+    int cgroup_fd = open_container_cgroup(launch.id);
+    SpawnedProcess process;
+    bool spawned = spawn_container(container_init, &launch.args,
+                                   CLONE_NEWUTS | CLONE_NEWPID | CLONE_NEWNS |
+                                   CLONE_NEWNET | CLONE_NEWIPC,
+                                   cgroup_fd, process);
+    if (cgroup_fd >= 0) close(cgroup_fd);
+    close(pipe_fds[0]);
+    close(ready_fds[1]);
+    if (launch.args.log_stdout_fd >= 0) {
+        // 写端只由容器持有，容器退出后收集进程读到EOF并退出
+        close(launch.args.log_stdout_fd);
+        close(launch.args.log_stderr_fd);
+    }
+    if (!spawned) {
+        perror("clone failed");
+        close(pipe_fds[1]);
+        close(ready_fds[0]);
+        return false;
+    }
+    launch.pid = process.pid;
+    launch.pidfd = process.pidfd;
+    launch.in_cgroup = process.in_cgroup;
+    launch.start_pipe = pipe_fds[1];
+    launch.ready_pipe = ready_fds[0];
+    return true;
+}
+
+// 通知子进程继续执行
+static void release_container(ContainerLaunch& launch) {
+    char ready = 1;
+    if (write(launch.start_pipe, &ready, 1) != 1) {
+        perror("[Main] Failed to release container");
+    }
+    close(launch.start_pipe);
+    launch.start_pipe = -1;
+}
+
+// 等待容器完成exec：在就绪管道和pidfd上进行事件循环。
+// 就绪管道读到EOF表示exec成功（O_CLOEXEC写端随exec关闭），读到errno表示exec失败；
+// pidfd可读表示进程已退出（可能在exec之前），此时管道写端也已关闭，继续读取管道即可区分
+static bool wait_container_ready(ContainerLaunch& launch) {
+    struct pollfd fds[2] = {{launch.ready_pipe, POLLIN, 0}, {launch.pidfd, POLLIN, 0}};
+    int exec_errno = 0;
+    bool exited = false;
+    ssize_t n = -1;
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("[Main] poll failed");
+            break;
+        }
+        if (fds[1].revents != 0) {
+            exited = true;
+            fds[1].fd = -1; // 不再关注pidfd，只等待管道结果
+        }
+        if (fds[0].revents != 0) {
+            do {
+                n = read(launch.ready_pipe, &exec_errno, sizeof(exec_errno));
+            } while (n < 0 && errno == EINTR);
+            break;
+        }
+    }
+    close(launch.ready_pipe);
+    launch.ready_pipe = -1;
+
+    if (n > 0) {
+        std::cerr << "[Main] Container " << launch.name << " failed to execute command: "
+                  << strerror(exec_errno) << std::endl;
+        return false;
+    }
+    launch.ready = std::chrono::steady_clock::now();
+    if (exited) {
+        std::cerr << "[Main] Container " << launch.name << " exited during startup" << std::endl;
+    }
+    return n == 0;
+}
+
+// 通过pidfd等待容器进程退出（无pidfd时使用waitpid），返回退出状态
+static int wait_container(ContainerLaunch& launch) {
+    int status = 0;
+    if (launch.pidfd >= 0) {
+        if (!wait_pidfd(launch.pidfd, status)) {
+            perror("[Main] waitid failed");
+        }
+        close(launch.pidfd);
+        launch.pidfd = -1;
+    } else {
+        waitpid(launch.pid, &status, 0);
+    }
+    return status;
+}
+
+// 各容器独立的步骤：记录信息、cgroup、网络、端口映射
+static void configure_container(const RunOptions& options, const NetworkInfo& network,
+                                ContainerLaunch& launch) {
+    std::string recorded_name = record_container_info(launch.pid, options.command, launch.name, launch.id);
+    if (recorded_name.empty()) {
+        std::cerr << "[Main] Failed to record container info" << std::endl;
+    }
+
+    // clone3无法直接放入cgroup时（cgroup v1或旧内核）再加入
+    if (!launch.in_cgroup) {
+        attach_container_cgroup(launch.id, launch.pid);
+    }
+
+    // 运行时信息（网络、卷、cgroup），配置完成后写回容器记录
+    ContainerInfo runtime_info;
+    runtime_info.volume = options.volume_str;
+    runtime_info.cgroup_path = container_cgroup_path(launch.id);
+    runtime_info.cpuset_cpus = launch.limits.cpuset;
+    runtime_info.cpuset_mems = launch.limits.cpuset_mems;
+
+    // 配置网络（如果指定了网络）
+    if (!network.name.empty()) {
+        std::string container_ip = allocate_ip(network.ip_range);
+        if (!container_ip.empty()) {
+            // 设置容器网络
+            if (setup_container_network(launch.id, network.name, container_ip, launch.pid)) {
+                launch.ip = container_ip;
+                runtime_info.network_name = network.name;
+                runtime_info.ip_address = container_ip;
+                // 配置端口映射
+                if (!options.port_mapping.empty() &&
+                    setup_port_mapping(launch.id, container_ip, options.port_mapping)) {
+                    for (const auto& mapping : options.port_mapping) {
+                        if (!runtime_info.port_mapping.empty()) runtime_info.port_mapping += ",";
+                        runtime_info.port_mapping += mapping;
+                    }
+                }
+                std::cout << "[Network] Container IP: " << container_ip << std::endl;
+            } else {
+                // setup_container_network 失败时已归还该IP，不能再次释放
+                std::cerr << "[Network] Failed to setup container network" << std::endl;
+            }
+        } else {
+            std::cerr << "[Network] Failed to allocate IP address" << std::endl;
+        }
+    }
+
+    if (!recorded_name.empty()) {
+        update_container_runtime_info(launch.name, runtime_info);
+    }
+}
+
+// 构建以nullptr结尾的参数数组
+static std::vector<char*> build_child_args(const RunOptions& options) {
+    std::vector<char*> child_args;
+    for (const auto& arg : options.command) {
+        child_args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    child_args.push_back(nullptr);
+    return child_args;
+}
+
+int run_container(const RunOptions& options) {
+    std::cout << "[Main] Starting SimpleDocker with filesystem isolation..." << std::endl;
+    auto launch_begin = std::chrono::steady_clock::now();
+
+    // 解析volume参数
+    VolumeInfo volume_info;
+    if (!options.volume_str.empty()) {
+        volume_info = parse_volume(options.volume_str);
+    } else {
+        volume_info = {"", "", false};
+    }
+
+    // 生成容器ID和名称
+    ContainerLaunch launch;
+    launch.id = generate_container_id();
+    launch.name = options.container_name.empty() ? launch.id : options.container_name;
+
+    std::cout << "[Main] Container ID: " << launch.id << std::endl;
+    std::cout << "[Main] Container Name: " << launch.name << std::endl;
+
+    // 确定CPU和NUMA内存节点
+    std::vector<std::string> placements;
+    if (options.numa == "auto") {
+        placements = running_numa_placements();
+    }
+    launch.limits = cgroup_limits(options);
+    if (!place_container(options, launch.id, placements, launch.limits)) {
+        return -1;
+    }
+
+    // 准备镜像层并创建容器工作空间（OverlayFS文件系统）
+    std::vector<std::string> layers;
+    if (!prepare_image(options.image, layers)) {
+        release_container_cpus(launch.id);
+        return -1;
+    }
+    Workspace workspace = get_workspace(launch.id);
+    if (!new_workspace(workspace, layer_lower_dirs(layers), volume_info)) {
+        std::cerr << "[Main] Failed to create workspace" << std::endl;
+        release_container_cpus(launch.id);
+        return -1;
+    }
+    save_workspace_layers(workspace.root, layers);
+    NetworkInfo network = prepare_network(options);
+
+    // 先创建并配置容器cgroup，进程创建时直接放入其中
+    if (!create_container_cgroup(launch.id, launch.limits)) {
+        std::cerr << "[Main] Failed to apply some resource limits" << std::endl;
+    }
+
+    // 创建容器进程
+    std::vector<char*> child_args = build_child_args(options);
+    std::cout << "[Main] Creating container process..." << std::endl;
+    if (!clone_container(options, child_args.data(), launch)) {
+        remove_container_cgroup(launch.id);
+        release_container_cpus(launch.id);
+        delete_workspace(workspace, volume_info);
+        return -1;
+    }
+
+    std::cout << "[Main] Container process created with PID: " << launch.pid << std::endl;
+
+    configure_container(options, network, launch);
+    release_container(launch);
+    if (!wait_container_ready(launch)) {
+        // 命令未能执行：回收进程并清理资源
+        wait_container(launch);
+        release_container_network(launch.id, network.name, launch.ip, !options.port_mapping.empty());
+        delete_container_info(launch.name);
+        delete_workspace(workspace, volume_info);
+        remove_container_cgroup(launch.id);
+        release_container_cpus(launch.id);
+        return -1;
+    }
+    printf("[Main] Cold start: container %s started in %.2f ms\n", launch.name.c_str(),
+           std::chrono::duration<double, std::milli>(launch.ready - launch_begin).count());
+    fflush(stdout);
+
+    if (options.detach_mode) {
+        if (launch.pidfd >= 0) close(launch.pidfd);
+        if (options.exec_helper) start_exec_helper(launch.name);
+        report_supervised_container(launch.name);
+        // Detach模式：不等待容器进程结束，直接返回
+        std::cout << "[Main] Container started in detach mode with PID: " << launch.pid << std::endl;
+        std::cout << "[Main] Container Name: " << launch.name << std::endl;
+        std::cout << "[Main] Container is running in background" << std::endl;
+
+        // 在detach模式下不清理资源，让容器继续运行
+        std::cout << "[Main] SimpleDocker detached successfully" << std::endl;
+        std::cout << "[Main] Use 'ps' to list containers and 'logs " << launch.name << "' to view logs" << std::endl;
+        return 0;
+    }
+
+    // 非detach模式：等待容器进程结束
+    std::cout << "[Main] Waiting for container to finish..." << std::endl;
+    int status = wait_container(launch);
+
+    std::cout << "[Main] Container finished with status: " << WEXITSTATUS(status) << std::endl;
+
+    // 如果指定了commit，则保存容器为镜像
+    if (!options.commit_image.empty()) {
+        commit_container(launch.id, options.commit_image, false);
+    }
+
+    // 删除容器信息（非detach模式下容器已结束），先释放IP和端口映射链
+    release_container_network(launch.id, network.name, launch.ip, !options.port_mapping.empty());
+    delete_container_info(launch.name);
+
+    // 清理资源
+    std::cout << "[Main] Cleaning up resources..." << std::endl;
+    delete_workspace(workspace, volume_info);
+    remove_container_cgroup(launch.id);
+    release_container_cpus(launch.id);
+
+    std::cout << "[Main] SimpleDocker finished successfully" << std::endl;
+    return 0;
+}
+
+// 计算百分位数（输入已排序）
+static double percentile(const std::vector<double>& sorted, int percent) {
+    if (sorted.empty()) return 0;
+    size_t index = (sorted.size() - 1) * percent / 100;
+    return sorted[index];
+}
+
+// 使用线程池对 [0, count) 并行执行 task，所有任务完成后返回
+template <typename Task>
+static void parallel_for(int count, unsigned worker_count, Task task) {
+    std::atomic<int> next_index(0);
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&]() {
+            int index;
+            while ((index = next_index.fetch_add(1)) < count) {
+                task(index);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int run_replicas(const RunOptions& options) {
+    std::cout << "[Main] Starting " << options.replicas << " replicas..." << std::endl;
+    if (!options.commit_image.empty()) {
+        std::cerr << "[Main] --commit is ignored in replica mode" << std::endl;
+    }
+    auto launch_begin = std::chrono::steady_clock::now();
+
+    VolumeInfo volume_info;
+    if (!options.volume_str.empty()) {
+        volume_info = parse_volume(options.volume_str);
+    } else {
+        volume_info = {"", "", false};
+    }
+
+    // 共享步骤只执行一次：镜像层、网桥/NAT
+    std::vector<std::string> layers;
+    if (!prepare_image(options.image, layers)) {
+        return -1;
+    }
+    std::vector<std::string> lower_dirs = layer_lower_dirs(layers);
+    NetworkInfo network = prepare_network(options);
+    std::vector<std::string> placements;
+    if (options.numa == "auto") {
+        placements = running_numa_placements();
+    }
+
+    unsigned worker_count = std::max(1u, std::min<unsigned>(options.replicas, std::thread::hardware_concurrency()));
+    std::vector<ContainerLaunch> launches(options.replicas);
+    for (int i = 0; i < options.replicas; ++i) {
+        ContainerLaunch& launch = launches[i];
+        launch.id = generate_container_id();
+        launch.name = options.container_name.empty() ? launch.id
+                                                     : options.container_name + "-" + std::to_string(i);
+        // 依次放置，auto模式下副本按负载分布到各节点
+        launch.limits = cgroup_limits(options);
+        if (!place_container(options, launch.id, placements, launch.limits)) {
+            for (int j = 0; j < i; ++j) {
+                release_container_cpus(launches[j].id);
+            }
+            return -1;
+        }
+    }
+
+    // 阶段一：并行创建工作空间和cgroup。两者都按容器ID独立，线程之间无需加锁；
+    // OverlayFS 必须在 clone 之前挂载，子进程的挂载命名空间才能看到它
+    std::vector<char> workspace_ready(options.replicas, 0);
+    parallel_for(options.replicas, worker_count, [&](int index) {
+        ContainerLaunch& launch = launches[index];
+        launch.begin = std::chrono::steady_clock::now();
+        Workspace workspace = get_workspace(launch.id);
+        workspace_ready[index] = new_workspace(workspace, lower_dirs, volume_info) &&
+                                 save_workspace_layers(workspace.root, layers);
+        if (!workspace_ready[index]) {
+            std::cerr << "[Main] Failed to create workspace for " << launch.name << std::endl;
+            return;
+        }
+        create_container_cgroup(launch.id, launch.limits);
+    });
+
+    // 阶段二：在单线程中依次创建容器进程，子进程阻塞在启动管道上。
+    // 多线程环境中clone可能使子进程继承其他线程持有的锁，因此此时线程池已全部退出
+    std::vector<char*> child_args = build_child_args(options);
+    for (int i = 0; i < options.replicas; ++i) {
+        ContainerLaunch& launch = launches[i];
+        if (!workspace_ready[i]) {
+            remove_container_cgroup(launch.id);
+            release_container_cpus(launch.id);
+            continue;
+        }
+        if (!clone_container(options, child_args.data(), launch)) {
+            std::cerr << "[Main] Failed to create replica " << launch.name << std::endl;
+            remove_container_cgroup(launch.id);
+            release_container_cpus(launch.id);
+            delete_workspace(get_workspace(launch.id), volume_info);
+        }
+    }
+
+    // 阶段三：并行完成各容器的记录、cgroup和网络配置，每个容器配置完成后立即放行
+    parallel_for(options.replicas, worker_count, [&](int index) {
+        ContainerLaunch& launch = launches[index];
+        if (launch.pid == -1) return;
+        configure_container(options, network, launch);
+        release_container(launch);
+        if (!wait_container_ready(launch)) {
+            wait_container(launch);
+            release_container_network(launch.id, network.name, launch.ip, !options.port_mapping.empty());
+            delete_container_info(launch.name);
+            delete_workspace(get_workspace(launch.id), volume_info);
+            remove_container_cgroup(launch.id);
+            release_container_cpus(launch.id);
+            launch.pid = -1;
+        }
+    });
+    auto launch_end = std::chrono::steady_clock::now();
+
+    // 统计启动延迟
+    std::vector<double> latencies;
+    for (const auto& launch : launches) {
+        if (launch.pid == -1) continue;
+        latencies.push_back(std::chrono::duration<double, std::milli>(launch.ready - launch.begin).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total_ms = std::chrono::duration<double, std::milli>(launch_end - launch_begin).count();
+    printf("[Main] Started %zu/%d containers in %.1f ms with %u workers, start latency p50=%.2f ms p99=%.2f ms\n",
+           latencies.size(), options.replicas, total_ms, worker_count,
+           percentile(latencies, 50), percentile(latencies, 99));
+    fflush(stdout);
+
+    if (options.detach_mode) {
+        for (auto& launch : launches) {
+            if (launch.pidfd >= 0) close(launch.pidfd);
+            if (launch.pid == -1) continue;
+            if (options.exec_helper) start_exec_helper(launch.name);
+            report_supervised_container(launch.name);
+        }
+        std::cout << "[Main] Replicas are running in background" << std::endl;
+        return latencies.size() == static_cast<size_t>(options.replicas) ? 0 : 1;
+    }
+
+    // 非detach模式：等待所有副本结束后统一清理
+    std::cout << "[Main] Waiting for replicas to finish..." << std::endl;
+    for (auto& launch : launches) {
+        if (launch.pid == -1) continue;
+        int status = wait_container(launch);
+        std::cout << "[Main] Replica " << launch.name << " finished with status: " << WEXITSTATUS(status) << std::endl;
+        release_container_network(launch.id, network.name, launch.ip, !options.port_mapping.empty());
+        delete_container_info(launch.name);
+        delete_workspace(get_workspace(launch.id), volume_info);
+        remove_container_cgroup(launch.id);
+        release_container_cpus(launch.id);
+    }
+
+    std::cout << "[Main] SimpleDocker finished successfully" << std::endl;
+    return latencies.size() == static_cast<size_t>(options.replicas) ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#ifndef RUN_H
+#define RUN_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "common/constants.h"
+#include "common/structures.h"
+#include "cgroup/cgroup.h"
+#include "logging/logging.h"
+
+// 容器运行参数（由命令行解析得到）
+struct RunOptions {
+    size_t mem_limit = 50 * 1024 * 1024; // 默认50MB
+    size_t mem_high = 0;
+    std::string cpu_shares;
+    std::string cpus;           // CPU带宽上限（核数，如 1.5）
+    std::string cpu_weight;
+    std::string cpuset;
+    std::string numa;           // NUMA放置："auto" 或节点编号
+    bool cpu_exclusive = false; // --cpuset auto 时独占物理核心
+    std::string io_max;         // "<major:minor> rbps=<n> wbps=<n> ..."
+    std::string pids_limit;
+    std::string volume_str;
+    std::string commit_image;
+    std::string container_name;
+    bool detach_mode = false;
+    LogOptions log_options;     // detach模式的日志轮转配置
+    std::vector<std::string> env_vars;
+    std::string network_name;
+    std::string network_backend; // 网络配置后端（netlink/shell），为空时使用 network_backend() 的默认值
+    std::vector<std::string> port_mapping;
+    std::vector<std::string> command;
+    std::string image = DEFAULT_IMAGE;
+    int replicas = 1;
+    bool warm = false;      // 优先从预热容器池启动
+    std::string restart_policy; // 重启策略：no、always、on-failure[:N]（需要 -d）
+    bool exec_helper = false;   // 启动常驻的exec辅助进程（需要 -d）
+};
+
+// 解析运行参数，失败时返回false
+bool parse_run_options(int argc, char* argv[], RunOptions& options, bool require_command = true);
+
+// 由运行参数得到容器的cgroup资源限制
+CgroupLimits cgroup_limits(const RunOptions& options);
+
+// 已运行容器记录的内存节点（cpuset.mems），作为 --numa auto 的节点负载
+std::vector<std::string> running_numa_placements();
+
+// 按 --numa/--cpuset 确定容器的CPU和内存节点，写入 limits.cpuset/cpuset_mems；
+// --cpuset auto 时从全局占用表分配CPU（数量为 --cpus 向上取整，默认1），需用 release_container_cpus 释放。
+// 放置结果追加到 placements，连续放置多个容器时依次计入负载
+bool place_container(const RunOptions& options, const std::string& container_id,
+                     std::vector<std::string>& placements, CgroupLimits& limits);
+
+// 检查网络（默认网桥不存在时创建），返回网络配置
+NetworkInfo prepare_network(const RunOptions& options);
+
+// 启动单个容器
+int run_container(const RunOptions& options);
+
+// 并发启动 options.replicas 个相同的容器：
+// 共享步骤（只读层、工作空间、网桥/NAT）只执行一次，
+// 各容器的记录、cgroup、网络配置在线程池中并行执行，最后输出启动延迟的 p50/p99
+int run_replicas(const RunOptions& options);
+
+#endif // RUN_H
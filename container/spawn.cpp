@@ -0,0 +1,133 @@
+#include "spawn.h"
+#include "common/constants.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/sched.h>
+
+// glibc 未提供clone3包装函数（pidfd相关函数也仅在较新版本中提供），直接使用系统调用。
+// 不设置栈（stack=0）时子进程像fork一样在父进程栈的副本上从系统调用返回，
+// 因为未使用CLONE_VM，不需要为子进程单独分配栈内存。
+static long clone3_spawn(int (*fn)(void*), void* arg, uint64_t flags, int cgroup_fd, int& pidfd) {
+    struct clone_args args = {};
+    args.flags = flags | CLONE_PIDFD;
+    args.pidfd = reinterpret_cast<uint64_t>(&pidfd);
+    args.exit_signal = SIGCHLD;
+    if (cgroup_fd >= 0) {
+        args.flags |= CLONE_INTO_CGROUP;
+        args.cgroup = cgroup_fd;
+    }
+
+    long pid = syscall(SYS_clone3, &args, sizeof(args));
+    if (pid == 0) {
+        _exit(fn(arg));
+    }
+    return pid;
+}
+
+bool spawn_container(int (*fn)(void*), void* arg, int namespace_flags, int cgroup_fd, SpawnedProcess& process) {
+    process = SpawnedProcess();
+    int pidfd = -1;
+    long pid = -1;
+    if (cgroup_fd >= 0) {
+        pid = clone3_spawn(fn, arg, namespace_flags, cgroup_fd, pidfd);
+        process.in_cgroup = pid > 0;
+        if (pid < 0 && errno != ENOSYS) {
+            // 内核不支持CLONE_INTO_CGROUP或cgroup不可用：不放入cgroup重试
+            std::cerr << "[Spawn] clone3(CLONE_INTO_CGROUP) failed: " << strerror(errno)
+                      << ", retrying without it" << std::endl;
+            pid = clone3_spawn(fn, arg, namespace_flags, -1, pidfd);
+        }
+    } else {
+        pid = clone3_spawn(fn, arg, namespace_flags, -1, pidfd);
+    }
+    if (pid > 0) {
+        process.pid = pid;
+        process.pidfd = pidfd;
+        return true;
+    }
+    if (errno != ENOSYS) {
+        return false;
+    }
+
+    // 内核不支持clone3（5.3之前）：回退到clone()，未使用CLONE_VM，
+    // 子进程拥有独立的地址空间副本，返回后即可释放栈内存
+    std::cerr << "[Spawn] clone3 is not supported, falling back to clone" << std::endl;
+    char* stack = new char[STACK_SIZE];
+    process.pid = clone(fn, stack + STACK_SIZE, namespace_flags | SIGCHLD, arg);
+    int saved_errno = errno;
+    delete[] stack;
+    errno = saved_errno;
+    if (process.pid == -1) {
+        return false;
+    }
+    process.pidfd = open_process_pidfd(process.pid);
+    return true;
+}
+
+std::string process_start_time(pid_t pid) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(file, stat);
+    // 第2个字段 (comm) 可能包含空格，从最后一个')'之后开始计数（之后为第3个字段）
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+        return "";
+    }
+    std::string field;
+    int index = 2;
+    for (size_t i = pos + 1; i <= stat.size(); ++i) {
+        if (i == stat.size() || stat[i] == ' ') {
+            if (!field.empty() && ++index == 22) {
+                return field;
+            }
+            field.clear();
+        } else {
+            field += stat[i];
+        }
+    }
+    return "";
+}
+
+int open_process_pidfd(pid_t pid, const std::string& expected_start_time) {
+    if (pid <= 0) {
+        errno = ESRCH;
+        return -1;
+    }
+    int pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd < 0) {
+        return -1;
+    }
+    // pidfd 打开后PID不会再被复用，此时校验启动时间即可确认仍是同一个进程
+    if (!expected_start_time.empty() && process_start_time(pid) != expected_start_time) {
+        close(pidfd);
+        errno = ESRCH;
+        return -1;
+    }
+    return pidfd;
+}
+
+bool send_pidfd_signal(int pidfd, int sig) {
+    return syscall(SYS_pidfd_send_signal, pidfd, sig, nullptr, 0) == 0;
+}
+
+bool wait_pidfd(int pidfd, int& status) {
+    siginfo_t info = {};
+    int result;
+    do {
+        result = waitid(P_PIDFD, pidfd, &info, WEXITED);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+        return false;
+    }
+    // 转换为 waitpid 的状态格式，便于继续使用 WIFEXITED/WEXITSTATUS
+    status = info.si_code == CLD_EXITED ? (info.si_status & 0xff) << 8 : info.si_status & 0x7f;
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <string>
+#include <sys/types.h>
+
+// 创建出的容器进程
+struct SpawnedProcess {
+    pid_t pid = -1;
+    int pidfd = -1;             // 引用该进程的pidfd（O_CLOEXEC），不受PID复用影响；不支持时为-1
+    bool in_cgroup = false;     // 是否已通过 CLONE_INTO_CGROUP 直接创建在目标cgroup中
+};
+
+// 创建容器进程：子进程在新的命名空间中执行 fn(arg) 并以其返回值退出。
+// 优先使用 clone3(CLONE_PIDFD)：不需要为子进程分配栈（像fork一样在父进程栈的副本上返回），
+// 同时得到pidfd；cgroup_fd >= 0 时加上 CLONE_INTO_CGROUP，子进程在创建时即位于目标cgroup中。
+// 内核不支持clone3时回退到 clone()（需要临时栈），调用者需再写入 cgroup.procs。
+bool spawn_container(int (*fn)(void*), void* arg, int namespace_flags, int cgroup_fd, SpawnedProcess& process);
+
+// 打开已有进程的pidfd；expected_start_time 非空时校验进程启动时间，防止PID已被复用
+int open_process_pidfd(pid_t pid, const std::string& expected_start_time = "");
+
+// 通过pidfd发送信号
+bool send_pidfd_signal(int pidfd, int sig);
+
+// 通过 waitid(P_PIDFD) 等待进程退出，返回与 waitpid 相同格式的状态
+bool wait_pidfd(int pidfd, int& status);
+
+// 进程启动时间（/proc/<pid>/stat 第22个字段，系统启动后的时钟滴答数），用于识别PID复用
+std::string process_start_time(pid_t pid);
+
+#endif // SPAWN_H
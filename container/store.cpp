@@ -0,0 +1,685 @@
+#include "store.h"
+#include "container.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+// ==================== 字段转换 ====================
+
+// 字段顺序：新增字段只能追加在末尾，旧记录缺失的字段视为空
+std::vector<std::string> container_info_to_fields(const ContainerInfo& info) {
+    return {
+        info.id, info.name, info.pid, info.command, info.created_time, info.status,
+        info.network_name, info.ip_address, info.port_mapping, info.volume, info.cgroup_path,
+        info.cpuset_cpus, info.cpuset_mems, info.pid_start_time, info.exit_code, info.restart_count
+    };
+}
+
+bool container_info_from_fields(const std::vector<std::string>& fields, ContainerInfo& info) {
+    if (fields.size() < 6 || fields[0].empty()) {
+        return false;
+    }
+    std::string* targets[] = {
+        &info.id, &info.name, &info.pid, &info.command, &info.created_time, &info.status,
+        &info.network_name, &info.ip_address, &info.port_mapping, &info.volume, &info.cgroup_path,
+        &info.cpuset_cpus, &info.cpuset_mems, &info.pid_start_time, &info.exit_code,
+        &info.restart_count
+    };
+    const size_t target_count = sizeof(targets) / sizeof(targets[0]);
+    for (size_t i = 0; i < target_count; ++i) {
+        *targets[i] = i < fields.size() ? fields[i] : "";
+    }
+    return true;
+}
+
+// ==================== 文件格式 ====================
+
+static const char RECORD_MAGIC[8] = {'M', 'Y', 'D', 'R', 'E', 'C', '0', '1'};
+static const char INDEX_MAGIC[8] = {'M', 'Y', 'D', 'I', 'D', 'X', '0', '1'};
+static const uint32_t RECORD_ENTRY_MAGIC = 0x44434552; // "RECD"
+static const uint32_t RECORD_TOMBSTONE = 1;
+static const size_t STORE_PAGE_SIZE = 4096;
+static const uint64_t INDEX_MIN_CAPACITY = 1024;
+// 记录文件超过该大小且垃圾过半时压缩
+static const uint64_t COMPACT_THRESHOLD = 1 << 20;
+
+// 索引槽位的特殊偏移量
+static const uint64_t SLOT_EMPTY = 0;
+static const uint64_t SLOT_DELETED = 1;
+
+// 字段下标
+static const size_t FIELD_ID = 0;
+static const size_t FIELD_NAME = 1;
+
+struct RecordFileHeader {
+    char magic[8];
+    uint64_t used;          // 已写入数据的末尾偏移
+    uint64_t live;          // 最新版本记录占用的字节数
+    uint64_t reserved[5];
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t length;        // 整条记录长度（含记录头，8字节对齐）
+    uint32_t flags;
+    uint16_t field_count;
+    uint16_t reserved;
+};
+
+struct IndexFileHeader {
+    char magic[8];
+    uint64_t capacity;      // 每张哈希表的槽位数（2的幂）
+    uint64_t count;         // 有效条目数
+    uint64_t records_used;  // 索引对应的记录文件末尾，不一致时说明索引过期需重建
+    uint64_t tombstones[2]; // 名称表、ID表中的删除标记数，与有效条目一起计入负载
+    uint64_t reserved[2];
+};
+
+struct IndexSlot {
+    uint64_t hash;
+    uint64_t offset;
+};
+
+// 已加锁并映射的存储
+struct ContainerStore {
+    int lock_fd = -1;
+    int record_fd = -1;
+    int index_fd = -1;
+    char* records = nullptr;
+    size_t records_length = 0;
+    char* index = nullptr;
+    size_t index_length = 0;
+
+    RecordFileHeader* record_header() { return reinterpret_cast<RecordFileHeader*>(records); }
+    IndexFileHeader* index_header() { return reinterpret_cast<IndexFileHeader*>(index); }
+    IndexSlot* name_table() { return reinterpret_cast<IndexSlot*>(index + sizeof(IndexFileHeader)); }
+    IndexSlot* id_table() { return name_table() + index_header()->capacity; }
+    uint64_t& tombstones(IndexSlot* table) { return index_header()->tombstones[table == name_table() ? 0 : 1]; }
+};
+
+static std::string record_file_path() { return CONTAINER_INFO_PATH + "containers.db"; }
+static std::string index_file_path() { return CONTAINER_INFO_PATH + "containers.idx"; }
+static std::string lock_file_path() { return CONTAINER_INFO_PATH + "containers.lock"; }
+
+// FNV-1a 64位哈希，保留0和1作为槽位标记无关（哈希值本身可以是任意值）
+static uint64_t hash_key(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t align8(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+static size_t round_page(size_t value) {
+    return (value + STORE_PAGE_SIZE - 1) / STORE_PAGE_SIZE * STORE_PAGE_SIZE;
+}
+
+// 重新映射文件（文件大小变化后调用）
+static bool remap_file(int fd, char*& base, size_t& length, size_t new_length) {
+    if (base != nullptr) {
+        munmap(base, length);
+        base = nullptr;
+    }
+    void* address = mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        perror("[Store] mmap failed");
+        return false;
+    }
+    base = static_cast<char*>(address);
+    length = new_length;
+    return true;
+}
+
+// 解析一条记录的全部字段
+static bool decode_record(ContainerStore& store, uint64_t offset, std::vector<std::string>& fields,
+                          uint32_t* flags = nullptr) {
+    if (offset + sizeof(RecordHeader) > store.record_header()->used) {
+        return false;
+    }
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(store.records + offset);
+    if (header->magic != RECORD_ENTRY_MAGIC || offset + header->length > store.record_header()->used) {
+        return false;
+    }
+    if (flags != nullptr) {
+        *flags = header->flags;
+    }
+
+    fields.clear();
+    const char* cursor = store.records + offset + sizeof(RecordHeader);
+    const char* end = store.records + offset + header->length;
+    for (uint16_t i = 0; i < header->field_count; ++i) {
+        uint16_t field_length;
+        if (cursor + sizeof(field_length) > end) return false;
+        memcpy(&field_length, cursor, sizeof(field_length));
+        cursor += sizeof(field_length);
+        if (cursor + field_length > end) return false;
+        fields.emplace_back(cursor, field_length);
+        cursor += field_length;
+    }
+    return true;
+}
+
+// 在哈希表中查找key，返回槽位指针（未找到返回nullptr）。
+// insert_slot 非空时返回未找到情况下的插入位置：探测路径上的第一个删除标记，没有则为终止探测的空槽位
+static IndexSlot* index_probe(ContainerStore& store, IndexSlot* table, size_t field, const std::string& key,
+                              IndexSlot** insert_slot) {
+    uint64_t capacity = store.index_header()->capacity;
+    uint64_t hash = hash_key(key);
+    IndexSlot* first_deleted = nullptr;
+    std::vector<std::string> fields;
+    for (uint64_t probe = 0; probe < capacity; ++probe) {
+        IndexSlot* slot = &table[(hash + probe) & (capacity - 1)];
+        if (slot->offset == SLOT_EMPTY) {
+            if (insert_slot != nullptr) *insert_slot = first_deleted != nullptr ? first_deleted : slot;
+            return nullptr;
+        }
+        if (slot->offset == SLOT_DELETED) {
+            if (first_deleted == nullptr) first_deleted = slot;
+        } else if (slot->hash == hash && decode_record(store, slot->offset, fields) && fields.size() > field &&
+                   fields[field] == key) {
+            return slot;
+        }
+    }
+    if (insert_slot != nullptr) *insert_slot = first_deleted;
+    return nullptr;
+}
+
+static IndexSlot* index_find(ContainerStore& store, IndexSlot* table, size_t field, const std::string& key) {
+    return index_probe(store, table, field, key, nullptr);
+}
+
+// 插入或更新key对应的槽位，查找与插入共用一次探测
+static void index_upsert(ContainerStore& store, IndexSlot* table, size_t field, const std::string& key,
+                         uint64_t offset) {
+    IndexSlot* slot = nullptr;
+    IndexSlot* existing = index_probe(store, table, field, key, &slot);
+    if (existing != nullptr) {
+        existing->offset = offset;
+        return;
+    }
+    if (slot == nullptr) {
+        return; // 表已满（负载检查保证不会发生）
+    }
+    if (slot->offset == SLOT_DELETED) {
+        store.tombstones(table)--;
+    }
+    slot->hash = hash_key(key);
+    slot->offset = offset;
+    if (table == store.name_table()) {
+        store.index_header()->count++;
+    }
+}
+
+static void index_erase(ContainerStore& store, IndexSlot* table, size_t field, const std::string& key) {
+    IndexSlot* slot = index_find(store, table, field, key);
+    if (slot == nullptr) {
+        return;
+    }
+    // 下一个槽位为空时没有探测链经过这里，可以直接置空，不留删除标记
+    uint64_t capacity = store.index_header()->capacity;
+    IndexSlot* next = &table[(slot - table + 1) & (capacity - 1)];
+    if (next->offset == SLOT_EMPTY) {
+        slot->offset = SLOT_EMPTY;
+    } else {
+        slot->offset = SLOT_DELETED;
+        store.tombstones(table)++;
+    }
+    if (table == store.name_table() && store.index_header()->count > 0) {
+        store.index_header()->count--;
+    }
+}
+
+// 按容量创建空索引
+static bool reset_index(ContainerStore& store, uint64_t capacity) {
+    size_t length = round_page(sizeof(IndexFileHeader) + 2 * capacity * sizeof(IndexSlot));
+    if (ftruncate(store.index_fd, 0) != 0 || ftruncate(store.index_fd, length) != 0) {
+        perror("[Store] ftruncate index failed");
+        return false;
+    }
+    if (!remap_file(store.index_fd, store.index, store.index_length, length)) {
+        return false;
+    }
+    memcpy(store.index_header()->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    store.index_header()->capacity = capacity;
+    store.index_header()->count = 0;
+    store.index_header()->records_used = 0;
+    store.index_header()->tombstones[0] = 0;
+    store.index_header()->tombstones[1] = 0;
+    return true;
+}
+
+// 顺序扫描记录文件重建索引，同时重新统计存活字节数
+static bool rebuild_index(ContainerStore& store, uint64_t min_capacity) {
+    // 先统计记录数以确定容量（负载因子不超过0.5）
+    uint64_t record_count = 0;
+    uint64_t offset = sizeof(RecordFileHeader);
+    while (offset < store.record_header()->used) {
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(store.records + offset);
+        if (header->magic != RECORD_ENTRY_MAGIC || header->length == 0) break;
+        record_count++;
+        offset += header->length;
+    }
+    uint64_t capacity = INDEX_MIN_CAPACITY;
+    while (capacity < min_capacity || capacity < record_count * 2) {
+        capacity *= 2;
+    }
+    if (!reset_index(store, capacity)) {
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    offset = sizeof(RecordFileHeader);
+    while (offset < store.record_header()->used) {
+        uint32_t flags = 0;
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(store.records + offset);
+        if (header->magic != RECORD_ENTRY_MAGIC || header->length == 0 ||
+            !decode_record(store, offset, fields, &flags) || fields.size() <= FIELD_NAME) {
+            // 末尾的不完整记录（写入时崩溃）直接截断
+            store.record_header()->used = offset;
+            break;
+        }
+        if (flags & RECORD_TOMBSTONE) {
+            IndexSlot* slot = index_find(store, store.name_table(), FIELD_NAME, fields[FIELD_NAME]);
+            std::vector<std::string> old_fields;
+            if (slot != nullptr && decode_record(store, slot->offset, old_fields)) {
+                index_erase(store, store.id_table(), FIELD_ID, old_fields[FIELD_ID]);
+            }
+            index_erase(store, store.name_table(), FIELD_NAME, fields[FIELD_NAME]);
+        } else {
+            index_upsert(store, store.name_table(), FIELD_NAME, fields[FIELD_NAME], offset);
+            index_upsert(store, store.id_table(), FIELD_ID, fields[FIELD_ID], offset);
+        }
+        offset += header->length;
+    }
+
+    // 重新统计存活字节数
+    uint64_t live = 0;
+    for (uint64_t i = 0; i < store.index_header()->capacity; ++i) {
+        uint64_t slot_offset = store.name_table()[i].offset;
+        if (slot_offset != SLOT_EMPTY && slot_offset != SLOT_DELETED) {
+            live += reinterpret_cast<const RecordHeader*>(store.records + slot_offset)->length;
+        }
+    }
+    store.record_header()->live = live;
+    store.index_header()->records_used = store.record_header()->used;
+    return true;
+}
+
+static void close_store(ContainerStore& store) {
+    if (store.records != nullptr) munmap(store.records, store.records_length);
+    if (store.index != nullptr) munmap(store.index, store.index_length);
+    if (store.record_fd >= 0) close(store.record_fd);
+    if (store.index_fd >= 0) close(store.index_fd);
+    if (store.lock_fd >= 0) {
+        flock(store.lock_fd, LOCK_UN);
+        close(store.lock_fd);
+    }
+    store = ContainerStore();
+}
+
+static bool put_locked(ContainerStore& store, const ContainerInfo& info);
+
+// 从 config.json 目录导入（调用者已持有排他锁）
+static int migrate_locked(ContainerStore& store) {
+    int imported = 0;
+    DIR* dir = opendir(CONTAINER_INFO_PATH.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        std::string config_file = CONTAINER_INFO_PATH + entry->d_name + "/" + CONFIG_NAME;
+        if (!path_exists(config_file)) continue;
+        ContainerInfo info = parse_container_config(config_file);
+        if (!info.id.empty() && put_locked(store, info)) {
+            imported++;
+        }
+    }
+    closedir(dir);
+    return imported;
+}
+
+// 打开存储并加锁；exclusive 为 false 时加共享锁（索引过期时会升级为排他锁重建）
+static bool open_store(ContainerStore& store, bool exclusive) {
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+
+    store.lock_fd = open(lock_file_path().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store.lock_fd < 0 || flock(store.lock_fd, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+        perror("[Store] Failed to lock container store");
+        close_store(store);
+        return false;
+    }
+
+    store.record_fd = open(record_file_path().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    store.index_fd = open(index_file_path().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store.record_fd < 0 || store.index_fd < 0) {
+        perror("[Store] Failed to open container store");
+        close_store(store);
+        return false;
+    }
+
+    struct stat record_stat, index_stat;
+    fstat(store.record_fd, &record_stat);
+    fstat(store.index_fd, &index_stat);
+
+    bool created = record_stat.st_size == 0;
+    if (created || index_stat.st_size == 0) {
+        // 需要初始化，升级为排他锁后重新检查
+        if (!exclusive) {
+            close_store(store);
+            return open_store(store, true);
+        }
+    }
+
+    if (created) {
+        if (ftruncate(store.record_fd, STORE_PAGE_SIZE) != 0 ||
+            !remap_file(store.record_fd, store.records, store.records_length, STORE_PAGE_SIZE)) {
+            close_store(store);
+            return false;
+        }
+        memcpy(store.record_header()->magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+        store.record_header()->used = sizeof(RecordFileHeader);
+        store.record_header()->live = 0;
+        if (!reset_index(store, INDEX_MIN_CAPACITY)) {
+            close_store(store);
+            return false;
+        }
+        store.index_header()->records_used = store.record_header()->used;
+
+        // 首次创建时导入已有的 config.json
+        int imported = migrate_locked(store);
+        if (imported > 0) {
+            std::cout << "[Store] Migrated " << imported << " containers from config.json" << std::endl;
+        }
+        return true;
+    }
+
+    if (!remap_file(store.record_fd, store.records, store.records_length, record_stat.st_size)) {
+        close_store(store);
+        return false;
+    }
+    if (memcmp(store.record_header()->magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0) {
+        std::cerr << "[Store] Corrupted record file: " << record_file_path() << std::endl;
+        close_store(store);
+        return false;
+    }
+
+    bool index_valid = index_stat.st_size >= static_cast<off_t>(sizeof(IndexFileHeader)) &&
+                       remap_file(store.index_fd, store.index, store.index_length, index_stat.st_size) &&
+                       memcmp(store.index_header()->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                       store.index_header()->records_used == store.record_header()->used;
+    if (!index_valid) {
+        if (!exclusive) {
+            close_store(store);
+            return open_store(store, true);
+        }
+        std::cout << "[Store] Rebuilding container index..." << std::endl;
+        if (!rebuild_index(store, INDEX_MIN_CAPACITY)) {
+            close_store(store);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 追加一条记录，返回其偏移量（失败返回0）
+static uint64_t append_record(ContainerStore& store, const std::vector<std::string>& fields, uint32_t flags) {
+    size_t length = sizeof(RecordHeader);
+    for (const auto& field : fields) {
+        length += sizeof(uint16_t) + std::min<size_t>(field.size(), UINT16_MAX);
+    }
+    length = align8(length);
+
+    uint64_t offset = store.record_header()->used;
+    if (offset + length > store.records_length) {
+        size_t new_length = round_page(std::max(store.records_length * 2, offset + length));
+        if (ftruncate(store.record_fd, new_length) != 0 ||
+            !remap_file(store.record_fd, store.records, store.records_length, new_length)) {
+            return 0;
+        }
+    }
+
+    char* cursor = store.records + offset + sizeof(RecordHeader);
+    for (const auto& field : fields) {
+        uint16_t field_length = std::min<size_t>(field.size(), UINT16_MAX);
+        memcpy(cursor, &field_length, sizeof(field_length));
+        cursor += sizeof(field_length);
+        memcpy(cursor, field.data(), field_length);
+        cursor += field_length;
+    }
+    memset(cursor, 0, store.records + offset + length - cursor);
+
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(store.records + offset);
+    header->length = length;
+    header->flags = flags;
+    header->field_count = fields.size();
+    header->reserved = 0;
+    header->magic = RECORD_ENTRY_MAGIC; // 最后写入magic，使记录完整后才可见
+
+    store.record_header()->used = offset + length;
+    return offset;
+}
+
+// 当前最新版本记录的长度（不存在返回0）
+static uint64_t current_record_length(ContainerStore& store, const std::string& name) {
+    IndexSlot* slot = index_find(store, store.name_table(), FIELD_NAME, name);
+    if (slot == nullptr) return 0;
+    return reinterpret_cast<const RecordHeader*>(store.records + slot->offset)->length;
+}
+
+// 索引负载（有效条目 + 删除标记）过高时重建：有效条目过多时扩容，
+// 否则是创建/删除交替留下的删除标记占满了表，按原容量重建即可清除
+static bool maybe_grow_index(ContainerStore& store) {
+    IndexFileHeader* header = store.index_header();
+    uint64_t tombstones = std::max(header->tombstones[0], header->tombstones[1]);
+    if ((header->count + tombstones + 1) * 2 <= header->capacity) {
+        return true;
+    }
+    bool grow = (header->count + 1) * 2 > header->capacity;
+    return rebuild_index(store, grow ? header->capacity * 2 : header->capacity);
+}
+
+static bool put_locked(ContainerStore& store, const ContainerInfo& info) {
+    if (!maybe_grow_index(store)) {
+        return false;
+    }
+
+    // 名称被重新使用时，清除旧ID的索引
+    IndexSlot* old_slot = index_find(store, store.name_table(), FIELD_NAME, info.name);
+    if (old_slot != nullptr) {
+        std::vector<std::string> old_fields;
+        if (decode_record(store, old_slot->offset, old_fields) && old_fields.size() > FIELD_ID &&
+            old_fields[FIELD_ID] != info.id) {
+            index_erase(store, store.id_table(), FIELD_ID, old_fields[FIELD_ID]);
+        }
+    }
+    uint64_t old_length = current_record_length(store, info.name);
+
+    uint64_t offset = append_record(store, container_info_to_fields(info), 0);
+    if (offset == 0) {
+        return false;
+    }
+    index_upsert(store, store.name_table(), FIELD_NAME, info.name, offset);
+    index_upsert(store, store.id_table(), FIELD_ID, info.id, offset);
+
+    RecordFileHeader* header = store.record_header();
+    header->live = header->live - old_length + reinterpret_cast<RecordHeader*>(store.records + offset)->length;
+    store.index_header()->records_used = header->used;
+    return true;
+}
+
+// 垃圾超过一半时压缩：把最新版本记录写入新文件后原子替换
+static void maybe_compact(ContainerStore& store) {
+    RecordFileHeader* header = store.record_header();
+    if (header->used < COMPACT_THRESHOLD || header->live * 2 > header->used) {
+        return;
+    }
+
+    std::string tmp_path = record_file_path() + ".tmp";
+    int tmp_fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (tmp_fd < 0) {
+        return;
+    }
+    size_t new_length = round_page(sizeof(RecordFileHeader) + header->live);
+    if (ftruncate(tmp_fd, new_length) != 0) {
+        close(tmp_fd);
+        unlink(tmp_path.c_str());
+        return;
+    }
+    char* tmp = static_cast<char*>(mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, tmp_fd, 0));
+    if (tmp == MAP_FAILED) {
+        close(tmp_fd);
+        unlink(tmp_path.c_str());
+        return;
+    }
+
+    // 按原文件顺序复制最新版本记录
+    RecordFileHeader* tmp_header = reinterpret_cast<RecordFileHeader*>(tmp);
+    memcpy(tmp_header->magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    uint64_t write_offset = sizeof(RecordFileHeader);
+    std::vector<std::string> fields;
+    uint64_t offset = sizeof(RecordFileHeader);
+    while (offset < header->used) {
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(store.records + offset);
+        uint32_t flags = 0;
+        if (!(decode_record(store, offset, fields, &flags)) || fields.size() <= FIELD_NAME) break;
+        IndexSlot* slot = (flags & RECORD_TOMBSTONE) ? nullptr
+                              : index_find(store, store.name_table(), FIELD_NAME, fields[FIELD_NAME]);
+        if (slot != nullptr && slot->offset == offset) {
+            memcpy(tmp + write_offset, record, record->length);
+            write_offset += record->length;
+        }
+        offset += record->length;
+    }
+    tmp_header->used = write_offset;
+    tmp_header->live = write_offset - sizeof(RecordFileHeader);
+    msync(tmp, new_length, MS_SYNC);
+    munmap(tmp, new_length);
+
+    if (rename(tmp_path.c_str(), record_file_path().c_str()) != 0) {
+        close(tmp_fd);
+        unlink(tmp_path.c_str());
+        return;
+    }
+
+    // 切换到新文件并重建索引
+    close(store.record_fd);
+    store.record_fd = tmp_fd;
+    remap_file(store.record_fd, store.records, store.records_length, new_length);
+    rebuild_index(store, INDEX_MIN_CAPACITY);
+    std::cout << "[Store] Compacted container records" << std::endl;
+}
+
+// ==================== 对外接口 ====================
+
+bool store_put(const ContainerInfo& info) {
+    ContainerStore store;
+    if (!open_store(store, true)) {
+        return false;
+    }
+    bool ok = put_locked(store, info);
+    if (ok) {
+        maybe_compact(store);
+    }
+    close_store(store);
+    return ok;
+}
+
+bool store_get(const std::string& name_or_id, ContainerInfo& info) {
+    ContainerStore store;
+    if (!open_store(store, false)) {
+        return false;
+    }
+    IndexSlot* slot = index_find(store, store.name_table(), FIELD_NAME, name_or_id);
+    if (slot == nullptr) {
+        slot = index_find(store, store.id_table(), FIELD_ID, name_or_id);
+    }
+    std::vector<std::string> fields;
+    bool found = slot != nullptr && decode_record(store, slot->offset, fields) &&
+                 container_info_from_fields(fields, info);
+    close_store(store);
+    return found;
+}
+
+bool store_delete(const std::string& container_name) {
+    ContainerStore store;
+    if (!open_store(store, true)) {
+        return false;
+    }
+    IndexSlot* slot = index_find(store, store.name_table(), FIELD_NAME, container_name);
+    if (slot != nullptr) {
+        // 索引指向的记录无法解析时不能得到容器ID，报告后放弃删除
+        std::vector<std::string> fields;
+        if (!decode_record(store, slot->offset, fields) || fields.size() <= FIELD_NAME) {
+            std::cerr << "[Store] Corrupted record for " << container_name << " in " << record_file_path()
+                      << std::endl;
+            close_store(store);
+            return false;
+        }
+        uint64_t old_length = current_record_length(store, container_name);
+
+        // 追加墓碑记录，保证从记录文件重建索引时删除仍然生效
+        std::vector<std::string> tombstone = {fields[FIELD_ID], container_name};
+        if (append_record(store, tombstone, RECORD_TOMBSTONE) != 0) {
+            index_erase(store, store.id_table(), FIELD_ID, fields[FIELD_ID]);
+            index_erase(store, store.name_table(), FIELD_NAME, container_name);
+            store.record_header()->live -= old_length;
+            store.index_header()->records_used = store.record_header()->used;
+            maybe_compact(store);
+        }
+    }
+    close_store(store);
+    return true;
+}
+
+std::vector<ContainerInfo> store_list() {
+    std::vector<ContainerInfo> containers;
+    ContainerStore store;
+    if (!open_store(store, false)) {
+        return containers;
+    }
+
+    // 顺序扫描记录内存，只输出索引指向的最新版本
+    std::vector<std::string> fields;
+    uint64_t offset = sizeof(RecordFileHeader);
+    while (offset < store.record_header()->used) {
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(store.records + offset);
+        uint32_t flags = 0;
+        if (!decode_record(store, offset, fields, &flags) || fields.size() <= FIELD_NAME) break;
+        if (!(flags & RECORD_TOMBSTONE)) {
+            IndexSlot* slot = index_find(store, store.name_table(), FIELD_NAME, fields[FIELD_NAME]);
+            ContainerInfo info;
+            if (slot != nullptr && slot->offset == offset && container_info_from_fields(fields, info)) {
+                containers.push_back(info);
+            }
+        }
+        offset += record->length;
+    }
+    close_store(store);
+    return containers;
+}
+
+int store_migrate_from_json() {
+    ContainerStore store;
+    if (!open_store(store, true)) {
+        return -1;
+    }
+    int imported = migrate_locked(store);
+    close_store(store);
+    return imported;
+}
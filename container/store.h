@@ -0,0 +1,26 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <string>
+#include <vector>
+#include "common/structures.h"
+
+// ==================== 二进制容器元数据存储 ====================
+// containers.db：只追加的记录文件（内存映射），每次更新追加一条新版本记录
+// containers.idx：按名称和ID的哈希索引（开放寻址），指向记录的最新版本
+// 按名称/ID查找为O(1)，ps 顺序扫描连续的记录内存；
+// 垃圾记录超过一半时整体压缩并重建索引。
+
+// 容器信息与字段列表互转（记录文件、守护进程协议共用）
+std::vector<std::string> container_info_to_fields(const ContainerInfo& info);
+bool container_info_from_fields(const std::vector<std::string>& fields, ContainerInfo& info);
+
+bool store_put(const ContainerInfo& info);
+bool store_get(const std::string& name_or_id, ContainerInfo& info);
+bool store_delete(const std::string& container_name);
+std::vector<ContainerInfo> store_list();
+
+// 从 config.json 目录导入到二进制存储（存储文件不存在时自动执行）
+int store_migrate_from_json();
+
+#endif // STORE_H
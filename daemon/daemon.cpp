@@ -0,0 +1,314 @@
+#include "daemon.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include "container/container.h"
+#include "container/store.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// ==================== 记录序列化 ====================
+
+// 字段中的分隔符替换为空格
+static std::string sanitize_field(const std::string& value) {
+    std::string result = value;
+    for (char& c : result) {
+        if (c == '\t' || c == '\n') c = ' ';
+    }
+    return result;
+}
+
+std::string serialize_container_info(const ContainerInfo& info) {
+    std::vector<std::string> fields = container_info_to_fields(info);
+    std::string record;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) record += '\t';
+        record += sanitize_field(fields[i]);
+    }
+    return record;
+}
+
+bool deserialize_container_info(const std::string& record, ContainerInfo& info) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t pos = record.find('\t', start);
+        fields.push_back(record.substr(start, pos - start));
+        if (pos == std::string::npos) break;
+        start = pos + 1;
+    }
+    return container_info_from_fields(fields, info);
+}
+
+// ==================== 客户端 ====================
+
+static int connect_daemon() {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, CONTAINER_DAEMON_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 读取对端写入的全部数据直到EOF；读取出错或超时返回false
+static bool read_all(int fd, std::string& data) {
+    char buffer[4096];
+    while (true) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) return true;
+        data.append(buffer, n);
+    }
+}
+
+// 服务端读取一个请求（以换行结束，或对端关闭写端）。
+// 守护进程是单线程的，整个请求须在 CLIENT_REQUEST_TIMEOUT_MS 内到达，停滞的客户端不能阻塞其他请求
+static bool read_request(int fd, std::string& request) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CLIENT_REQUEST_TIMEOUT_MS);
+    char buffer[4096];
+    size_t newline;
+    while ((newline = request.find('\n')) == std::string::npos) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int rc = poll(&pfd, 1, static_cast<int>(remaining));
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc <= 0) {
+            return false;
+        }
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        request.append(buffer, n);
+    }
+    request.erase(newline);
+    return true;
+}
+
+static bool write_all(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += n;
+    }
+    return true;
+}
+
+bool daemon_request(const std::string& request, std::vector<std::string>& response_lines) {
+    int fd = connect_daemon();
+    if (fd < 0) {
+        return false; // 守护进程未运行
+    }
+    // 守护进程卡住时不能让客户端一直阻塞：收发超时后返回false，由调用者回退到直接读写存储
+    struct timeval timeout = {CLIENT_REQUEST_TIMEOUT_MS / 1000, (CLIENT_REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    std::string response;
+    bool ok = write_all(fd, request + "\n") && shutdown(fd, SHUT_WR) == 0 && read_all(fd, response);
+    close(fd);
+    if (!ok) {
+        std::cerr << "[Daemon] No response from " << CONTAINER_DAEMON_SOCKET << ", falling back to the store"
+                  << std::endl;
+        return false;
+    }
+
+    response_lines.clear();
+    std::istringstream iss(response);
+    std::string line;
+    while (std::getline(iss, line)) {
+        response_lines.push_back(line);
+    }
+    return true;
+}
+
+bool daemon_list(std::vector<ContainerInfo>& containers) {
+    std::vector<std::string> lines;
+    if (!daemon_request("LIST", lines)) {
+        return false;
+    }
+    containers.clear();
+    for (const auto& line : lines) {
+        ContainerInfo info;
+        if (deserialize_container_info(line, info)) {
+            containers.push_back(info);
+        }
+    }
+    return true;
+}
+
+bool daemon_get(const std::string& name_or_id, ContainerInfo& info, bool& found) {
+    std::vector<std::string> lines;
+    if (!daemon_request("GET " + name_or_id, lines) || lines.empty()) {
+        return false;
+    }
+    found = lines[0].compare(0, 3, "OK ") == 0 && deserialize_container_info(lines[0].substr(3), info);
+    return true;
+}
+
+bool daemon_put(const ContainerInfo& info) {
+    std::vector<std::string> lines;
+    return daemon_request("PUT " + serialize_container_info(info), lines) &&
+           !lines.empty() && lines[0] == "OK";
+}
+
+bool daemon_delete(const std::string& container_name) {
+    std::vector<std::string> lines;
+    return daemon_request("DEL " + container_name, lines) && !lines.empty() && lines[0] == "OK";
+}
+
+// ==================== 守护进程 ====================
+
+// 内存中的容器表
+struct ContainerTable {
+    std::unordered_map<std::string, ContainerInfo> by_name;
+    std::unordered_map<std::string, std::string> id_to_name;
+
+    void put(const ContainerInfo& info) {
+        auto it = by_name.find(info.name);
+        if (it != by_name.end() && it->second.id != info.id) {
+            id_to_name.erase(it->second.id);
+        }
+        by_name[info.name] = info;
+        id_to_name[info.id] = info.name;
+    }
+
+    void remove(const std::string& name) {
+        auto it = by_name.find(name);
+        if (it == by_name.end()) return;
+        id_to_name.erase(it->second.id);
+        by_name.erase(it);
+    }
+
+    const ContainerInfo* find(const std::string& name_or_id) const {
+        auto it = by_name.find(name_or_id);
+        if (it != by_name.end()) return &it->second;
+        auto id_it = id_to_name.find(name_or_id);
+        if (id_it != id_to_name.end()) return &by_name.at(id_it->second);
+        return nullptr;
+    }
+};
+
+static volatile sig_atomic_t daemon_stop_requested = 0;
+
+static void handle_daemon_signal(int) {
+    daemon_stop_requested = 1;
+}
+
+// 处理单个请求，返回响应内容
+static std::string handle_request(ContainerTable& table, const std::string& request) {
+    std::string command = request.substr(0, request.find(' '));
+    std::string argument = request.find(' ') == std::string::npos ? "" : request.substr(request.find(' ') + 1);
+
+    if (command == "LIST") {
+        std::string response;
+        for (const auto& pair : table.by_name) {
+            response += serialize_container_info(pair.second) + "\n";
+        }
+        return response;
+    }
+    if (command == "GET") {
+        const ContainerInfo* info = table.find(argument);
+        return info ? "OK " + serialize_container_info(*info) + "\n" : "ERR\n";
+    }
+    if (command == "PUT") {
+        ContainerInfo info;
+        if (!deserialize_container_info(argument, info) || !persist_container_info(info)) {
+            return "ERR\n";
+        }
+        table.put(info);
+        return "OK\n";
+    }
+    if (command == "DEL") {
+        table.remove(argument);
+        return "OK\n";
+    }
+    return "ERR\n";
+}
+
+int run_daemon() {
+    std::cout << "[Daemon] Starting container state daemon..." << std::endl;
+
+    // 启动时从磁盘加载全部容器
+    ContainerTable table;
+    for (const auto& info : load_all_container_infos()) {
+        table.put(info);
+    }
+    std::cout << "[Daemon] Loaded " << table.by_name.size() << " containers" << std::endl;
+
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        perror("[Daemon] socket failed");
+        return 1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, CONTAINER_DAEMON_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(CONTAINER_DAEMON_SOCKET.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        perror("[Daemon] Failed to listen on socket");
+        close(listen_fd);
+        return 1;
+    }
+
+    // 不使用SA_RESTART，使accept在收到信号时返回
+    struct sigaction sa = {};
+    sa.sa_handler = handle_daemon_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "[Daemon] Listening on " << CONTAINER_DAEMON_SOCKET << std::endl;
+    while (!daemon_stop_requested) {
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            perror("[Daemon] accept failed");
+            break;
+        }
+
+        // 不读取响应的客户端同样不能阻塞守护进程
+        struct timeval timeout = {CLIENT_REQUEST_TIMEOUT_MS / 1000, (CLIENT_REQUEST_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        if (!read_request(client_fd, request)) {
+            std::cerr << "[Daemon] Dropped a client that did not finish its request in time" << std::endl;
+            close(client_fd);
+            continue;
+        }
+        write_all(client_fd, handle_request(table, request));
+        close(client_fd);
+    }
+
+    close(listen_fd);
+    unlink(CONTAINER_DAEMON_SOCKET.c_str());
+    std::cout << "[Daemon] Stopped" << std::endl;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include <vector>
+#include "common/structures.h"
+
+// ==================== 容器状态守护进程 ====================
+// 守护进程在内存中维护按名称和ID索引的容器表，通过本地Unix socket
+// 响应CLI请求，并负责将变更持久化到磁盘。
+// 协议：每个连接一个请求，请求和响应均为以'\n'结尾的文本行
+//   LIST                -> 每行一个容器记录
+//   GET <name|id>       -> "OK <record>" 或 "ERR"
+//   PUT <record>        -> "OK" 或 "ERR"（守护进程写入持久化存储）
+//   DEL <name>          -> "OK"
+
+// 以前台方式运行守护进程
+int run_daemon();
+
+// 容器记录序列化（字段以'\t'分隔）
+std::string serialize_container_info(const ContainerInfo& info);
+bool deserialize_container_info(const std::string& record, ContainerInfo& info);
+
+// 客户端：向守护进程发送请求，守护进程未运行时返回false
+bool daemon_request(const std::string& request, std::vector<std::string>& response_lines);
+
+// 客户端便捷接口
+bool daemon_list(std::vector<ContainerInfo>& containers);
+bool daemon_get(const std::string& name_or_id, ContainerInfo& info, bool& found);
+bool daemon_put(const ContainerInfo& info);
+bool daemon_delete(const std::string& container_name);
+
+#endif // DAEMON_H
@@ -6,64 +6,76 @@
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <cstring>
+#include <cerrno>
 #include "common/constants.h"
 #include "common/utils.h"
+#include "snapshot.h"
 
-// 创建工作空间（OverlayFS文件系统）
-void new_workspace(const VolumeInfo& volume_info) {
-    std::cout << "[FileSystem] Setting up container workspace..." << std::endl;
-    create_readonly_layer();
-    create_write_layer();
-    create_mount_point();
-    
-    // 如果有volume，则挂载volume
-    if (volume_info.valid) {
-        mount_volume(volume_info);
-    }
+// 获取容器的工作空间路径
+Workspace get_workspace(const std::string& container_id) {
+    Workspace workspace;
+    workspace.root = WORKSPACE_ROOT + container_id + "/";
+    workspace.mount_point = workspace.root + "mnt/";
+    workspace.upper_dir = workspace.root + "upper/";
+    workspace.work_dir = workspace.root + "work/";
+    return workspace;
 }
 
-// 删除挂载点
-void delete_mount_point() {
-    std::cout << "[FileSystem] Cleaning up mount point..." << std::endl;
-    
-    // 卸载OverlayFS
-    std::string umount_cmd = "umount " + MNT_URL;
-    if (system(umount_cmd.c_str()) != 0) {
-        std::cerr << "[FileSystem] Failed to unmount OverlayFS" << std::endl;
+// 创建工作空间（OverlayFS文件系统），lower_dirs 为镜像的只读层目录（自底向上）
+bool new_workspace(const Workspace& workspace, const std::vector<std::string>& lower_dirs,
+                   const VolumeInfo& volume_info) {
+    std::cout << "[FileSystem] Setting up container workspace: " << workspace.root << std::endl;
+    
+    // 每个容器独占 <root>/<id>/，mkdir 的原子性保证不同容器互不干扰，无需加锁
+    if (!create_directory_if_not_exists(WORKSPACE_ROOT)) {
+        return false;
+    }
+    if (mkdir(workspace.root.c_str(), 0755) != 0) {
+        perror("[FileSystem] mkdir workspace failed");
+        return false;
+    }
+    if (!create_write_layer(workspace) || !create_mount_point(workspace, lower_dirs)) {
+        remove_directory_recursive(workspace.root);
+        return false;
     }
     
-    // 删除挂载目录
-    if (rmdir(MNT_URL.c_str()) != 0) {
-        perror("rmdir mount point failed");
+    // 如果有volume，则挂载volume
+    if (volume_info.valid) {
+        mount_volume(workspace, volume_info);
     }
+    return true;
 }
 
-// 删除写入层和工作目录
-void delete_write_layer() {
-    std::cout << "[FileSystem] Cleaning up write layer..." << std::endl;
-    
-    std::string rm_write_cmd = "rm -rf " + WRITE_LAYER_URL;
-    if (system(rm_write_cmd.c_str()) != 0) {
-        std::cerr << "[FileSystem] Failed to remove write layer" << std::endl;
-    }
+// 删除挂载点，成功卸载后返回true
+bool delete_mount_point(const Workspace& workspace) {
+    std::cout << "[FileSystem] Cleaning up mount point..." << std::endl;
     
-    std::string rm_work_cmd = "rm -rf " + WORK_DIR_URL;
-    if (system(rm_work_cmd.c_str()) != 0) {
-        std::cerr << "[FileSystem] Failed to remove work directory" << std::endl;
+    // 卸载OverlayFS，忙碌时延迟卸载
+    if (umount(workspace.mount_point.c_str()) != 0 && errno != EINVAL &&
+        umount2(workspace.mount_point.c_str(), MNT_DETACH) != 0) {
+        perror("[FileSystem] Failed to unmount OverlayFS");
+        return false;
     }
+    return true;
 }
 
 // 删除工作空间
-void delete_workspace(const VolumeInfo& volume_info) {
+void delete_workspace(const Workspace& workspace, const VolumeInfo& volume_info) {
     std::cout << "[FileSystem] Cleaning up workspace..." << std::endl;
     
     // 如果有volume，先卸载volume
     if (volume_info.valid) {
-        umount_volume(volume_info);
+        umount_volume(workspace, volume_info);
     }
     
-    delete_mount_point();
-    delete_write_layer();
+    // 挂载点仍然存在时不删除目录，避免删除到挂载进来的内容
+    if (!delete_mount_point(workspace)) {
+        std::cerr << "[FileSystem] Keeping workspace because it is still mounted: " << workspace.root << std::endl;
+        return;
+    }
+    if (!remove_directory_recursive(workspace.root)) {
+        std::cerr << "[FileSystem] Failed to remove workspace: " << workspace.root << std::endl;
+    }
 }
 
 // pivot_root系统调用包装
@@ -114,7 +126,7 @@ void setup_pivot_root(const std::string& root) {
 }
 
 // 设置容器内的文件系统挂载
-void setup_mount() {
+void setup_mount(const std::string& root) {
     
     std::cout << "[FileSystem] Isolating mount propagation..." << std::endl;
     if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) != 0) {
@@ -125,8 +137,8 @@ void setup_mount() {
     std::cout << "[FileSystem] Setting up container mounts..." << std::endl;
     
     // 使用OverlayFS挂载点作为新的根目录
-    std::cout << "[FileSystem] Using mount point: " << MNT_URL << std::endl;
-    setup_pivot_root(MNT_URL);
+    std::cout << "[FileSystem] Using mount point: " << root << std::endl;
+    setup_pivot_root(root);
     
     // 切换到容器根目录
     if (chdir("/") != 0) {
@@ -184,7 +196,7 @@ VolumeInfo parse_volume(const std::string& volume_str) {
 }
 
 // 挂载volume
-void mount_volume(const VolumeInfo& volume_info) {
+void mount_volume(const Workspace& workspace, const VolumeInfo& volume_info) {
     if (!volume_info.valid) {
         return;
     }
@@ -201,7 +213,7 @@ void mount_volume(const VolumeInfo& volume_info) {
     }
     
     // 创建容器内目录
-    std::string container_volume_path = MNT_URL + volume_info.container_path;
+    std::string container_volume_path = workspace.mount_point + volume_info.container_path;
     if (mkdir(container_volume_path.c_str(), 0777) != 0) {
         if (errno != EEXIST) {
             perror("mkdir container volume dir failed");
@@ -219,12 +231,12 @@ void mount_volume(const VolumeInfo& volume_info) {
 }
 
 // 卸载volume
-void umount_volume(const VolumeInfo& volume_info) {
+void umount_volume(const Workspace& workspace, const VolumeInfo& volume_info) {
     if (!volume_info.valid) {
         return;
     }
     
-    std::string container_volume_path = MNT_URL + volume_info.container_path;
+    std::string container_volume_path = workspace.mount_point + volume_info.container_path;
     std::cout << "[Volume] Unmounting volume: " << container_volume_path << std::endl;
     
     if (umount(container_volume_path.c_str()) != 0) {
@@ -236,65 +248,53 @@ void umount_volume(const VolumeInfo& volume_info) {
 
 // ==================== 文件系统管理 ====================
 
-// 创建只读层（解压busybox）
-void create_readonly_layer() {
-    std::cout << "[FileSystem] Creating readonly layer..." << std::endl;
-    
-    if (!path_exists(BUSYBOX_URL)) {
-        // 创建busybox目录
-        if (mkdir(BUSYBOX_URL.c_str(), 0777) != 0) {
-            perror("mkdir busybox failed");
-            return;
-        }
-        
-        // 解压busybox.tar到busybox目录
-        std::string tar_cmd = "sudo tar -xf " + BUSYBOX_TAR_URL + " -C " + BUSYBOX_URL;
-        if (system(tar_cmd.c_str()) != 0) {
-            std::cerr << "[FileSystem] Failed to extract busybox.tar" << std::endl;
-        } else {
-            std::cout << "[FileSystem] Busybox extracted successfully" << std::endl;
-        }
-    } else {
-        std::cout << "[FileSystem] Busybox layer already exists" << std::endl;
-    }
-}
-
 // 创建写入层和工作目录
-void create_write_layer() {
+bool create_write_layer(const Workspace& workspace) {
     std::cout << "[FileSystem] Creating write layer..." << std::endl;
     
-    if (mkdir(WRITE_LAYER_URL.c_str(), 0777) != 0) {
-        if (errno != EEXIST) {
-            perror("mkdir write layer failed");
-        }
+    // btrfs上写入层创建为子卷，commit时可直接快照
+    if (!create_upper_volume(workspace.upper_dir)) {
+        perror("mkdir write layer failed");
+        return false;
     }
     
     // 创建OverlayFS工作目录
-    if (mkdir(WORK_DIR_URL.c_str(), 0777) != 0) {
-        if (errno != EEXIST) {
-            perror("mkdir work dir failed");
-        }
+    if (mkdir(workspace.work_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror("mkdir work dir failed");
+        return false;
     }
+    return true;
 }
 
 // 创建OverlayFS挂载点
-void create_mount_point() {
+bool create_mount_point(const Workspace& workspace, const std::vector<std::string>& lower_dirs) {
     std::cout << "[FileSystem] Creating OverlayFS mount point..." << std::endl;
     
     // 创建挂载目录
-    if (mkdir(MNT_URL.c_str(), 0777) != 0) {
-        if (errno != EEXIST) {
-            perror("mkdir mount point failed");
-        }
+    if (mkdir(workspace.mount_point.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror("mkdir mount point failed");
+        return false;
+    }
+    
+    if (lower_dirs.empty()) {
+        std::cerr << "[FileSystem] No image layers for OverlayFS" << std::endl;
+        return false;
     }
     
-    // 构建OverlayFS挂载命令
-    std::string overlay_opts = "lowerdir=" + BUSYBOX_URL + ",upperdir=" + WRITE_LAYER_URL + ",workdir=" + WORK_DIR_URL;
-    std::string mount_cmd = "sudo mount -t overlay overlay -o " + overlay_opts + " " + MNT_URL;
+    // 多个只读层叠加：lowerdir 中越靠前的层越在上面
+    std::string lower_opt;
+    for (auto it = lower_dirs.rbegin(); it != lower_dirs.rend(); ++it) {
+        if (!lower_opt.empty()) lower_opt += ":";
+        lower_opt += *it;
+    }
     
-    if (system(mount_cmd.c_str()) != 0) {
-        std::cerr << "[FileSystem] OverlayFS mount failed" << std::endl;
-    } else {
-        std::cout << "[FileSystem] OverlayFS mounted successfully" << std::endl;
+    // 直接调用mount系统调用挂载OverlayFS
+    std::string overlay_opts = "lowerdir=" + lower_opt + ",upperdir=" + workspace.upper_dir +
+                               ",workdir=" + workspace.work_dir;
+    if (mount("overlay", workspace.mount_point.c_str(), "overlay", 0, overlay_opts.c_str()) != 0) {
+        perror("[FileSystem] OverlayFS mount failed");
+        return false;
     }
-}
\ No newline at end of file
+    std::cout << "[FileSystem] OverlayFS mounted successfully" << std::endl;
+    return true;
+}
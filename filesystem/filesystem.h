@@ -2,40 +2,39 @@
 #define FILESYSTEM_H
 
 #include <string>
+#include <vector>
 #include "common/structures.h"
 
-// OverlayFS工作空间管理
-void new_workspace(const VolumeInfo& volume_info = {});
-void delete_mount_point();
-void delete_write_layer();
-void delete_workspace(const VolumeInfo& volume_info = {});
+// OverlayFS工作空间管理（每个容器独立的工作空间）
+Workspace get_workspace(const std::string& container_id);
+bool new_workspace(const Workspace& workspace, const std::vector<std::string>& lower_dirs,
+                   const VolumeInfo& volume_info = {});
+bool delete_mount_point(const Workspace& workspace);
+void delete_workspace(const Workspace& workspace, const VolumeInfo& volume_info = {});
 
 // pivot_root操作
 int pivot_root(const char* new_root, const char* old_root);
 void setup_pivot_root(const std::string& root);
 
 // 容器内文件系统挂载
-void setup_mount();
+void setup_mount(const std::string& root);
 // ==================== Volume管理 ====================
 
 // 解析volume参数 (格式: host_path:container_path)
 VolumeInfo parse_volume(const std::string& volume_str);
 
 // 挂载volume
-void mount_volume(const VolumeInfo& volume_info);
+void mount_volume(const Workspace& workspace, const VolumeInfo& volume_info);
 
 // 卸载volume
-void umount_volume(const VolumeInfo& volume_info);
+void umount_volume(const Workspace& workspace, const VolumeInfo& volume_info);
 
 // ==================== 文件系统管理 ====================
 
-// 创建只读层（解压busybox）
-void create_readonly_layer();
-
 // 创建写入层和工作目录
-void create_write_layer();
+bool create_write_layer(const Workspace& workspace);
 
 // 创建OverlayFS挂载点
-void create_mount_point();
+bool create_mount_point(const Workspace& workspace, const std::vector<std::string>& lower_dirs);
 
 #endif // FILESYSTEM_H
\ No newline at end of file
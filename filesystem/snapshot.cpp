@@ -0,0 +1,256 @@
+#include "snapshot.h"
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/xattr.h>
+#include <linux/btrfs.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include "common/utils.h"
+
+// btrfs子卷根目录的inode号（BTRFS_FIRST_FREE_OBJECTID）
+static const ino_t BTRFS_SUBVOLUME_INODE = 256;
+
+const char* snapshot_driver_name(SnapshotDriver driver) {
+    switch (driver) {
+        case SnapshotDriver::Overlay: return "overlay";
+        case SnapshotDriver::Btrfs: return "btrfs";
+        case SnapshotDriver::Reflink: return "reflink";
+        default: return "none";
+    }
+}
+
+// 去掉末尾的'/'，拆分为父目录和名称
+static void split_parent(const std::string& path, std::string& parent, std::string& name) {
+    std::string trimmed = path;
+    while (trimmed.size() > 1 && trimmed.back() == '/') {
+        trimmed.pop_back();
+    }
+    size_t pos = trimmed.rfind('/');
+    parent = pos == std::string::npos ? "." : (pos == 0 ? "/" : trimmed.substr(0, pos));
+    name = trimmed.substr(pos + 1);
+}
+
+static bool on_btrfs(const std::string& path) {
+    struct statfs fs;
+    return statfs(path.c_str(), &fs) == 0 && fs.f_type == BTRFS_SUPER_MAGIC;
+}
+
+bool create_upper_volume(const std::string& path) {
+    std::string parent, name;
+    split_parent(path, parent, name);
+    if (on_btrfs(parent) && name.size() < BTRFS_PATH_NAME_MAX) {
+        int parent_fd = open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        struct btrfs_ioctl_vol_args args;
+        memset(&args, 0, sizeof(args));
+        strncpy(args.name, name.c_str(), BTRFS_PATH_NAME_MAX);
+        bool created = parent_fd >= 0 && ioctl(parent_fd, BTRFS_IOC_SUBVOL_CREATE, &args) == 0;
+        if (parent_fd >= 0) {
+            close(parent_fd);
+        }
+        if (created) {
+            return true;
+        }
+        // 无法创建子卷（如权限不足）时退回普通目录，提交时改用其他驱动
+    }
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+// btrfs：对子卷创建只读快照
+static bool btrfs_snapshot(const std::string& upper_dir, const std::string& target_dir) {
+    struct stat st;
+    if (!on_btrfs(upper_dir) || stat(upper_dir.c_str(), &st) != 0 || st.st_ino != BTRFS_SUBVOLUME_INODE) {
+        return false;
+    }
+    std::string parent, name;
+    split_parent(target_dir, parent, name);
+    int source_fd = open(upper_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int parent_fd = open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    bool ok = false;
+    if (source_fd >= 0 && parent_fd >= 0 && name.size() < BTRFS_SUBVOL_NAME_MAX) {
+        struct btrfs_ioctl_vol_args_v2 args;
+        memset(&args, 0, sizeof(args));
+        args.fd = source_fd;
+        args.flags = BTRFS_SUBVOL_RDONLY;
+        strncpy(args.name, name.c_str(), BTRFS_SUBVOL_NAME_MAX);
+        ok = ioctl(parent_fd, BTRFS_IOC_SNAP_CREATE_V2, &args) == 0;
+        if (!ok) {
+            perror("[Snapshot] btrfs snapshot failed");
+        }
+    }
+    if (source_fd >= 0) close(source_fd);
+    if (parent_fd >= 0) close(parent_fd);
+    return ok;
+}
+
+// reflink复制目录树：元数据逐项复制，文件数据共享存储块
+class ReflinkCopier {
+public:
+    bool copy_tree(const std::string& source, const std::string& target);
+    std::string error;
+
+private:
+    bool copy_entry(const std::string& source, const std::string& target, const struct stat& st);
+    bool copy_metadata(const std::string& source, const std::string& target, const struct stat& st);
+    bool clone_file(const std::string& source, const std::string& target);
+
+    // 多个硬链接只复制一次：(设备, inode) -> 第一个副本的路径
+    std::map<std::pair<dev_t, ino_t>, std::string> links;
+};
+
+bool ReflinkCopier::clone_file(const std::string& source, const std::string& target) {
+    int in_fd = open(source.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (in_fd < 0) {
+        error = source + ": " + strerror(errno);
+        return false;
+    }
+    int out_fd = open(target.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    bool ok = out_fd >= 0 && ioctl(out_fd, FICLONE, in_fd) == 0;
+    if (!ok) {
+        error = std::string("FICLONE ") + source + ": " + strerror(errno);
+    }
+    if (out_fd >= 0) close(out_fd);
+    close(in_fd);
+    return ok;
+}
+
+// 属主、权限、扩展属性（包括 OverlayFS 的 opaque 等 trusted.* 标记）和时间
+bool ReflinkCopier::copy_metadata(const std::string& source, const std::string& target, const struct stat& st) {
+    if (lchown(target.c_str(), st.st_uid, st.st_gid) != 0) {
+        error = target + ": " + strerror(errno);
+        return false;
+    }
+    if (!S_ISLNK(st.st_mode) && chmod(target.c_str(), st.st_mode & 07777) != 0) {
+        error = target + ": " + strerror(errno);
+        return false;
+    }
+    ssize_t list_size = llistxattr(source.c_str(), nullptr, 0);
+    if (list_size > 0) {
+        std::vector<char> names(list_size);
+        list_size = llistxattr(source.c_str(), names.data(), names.size());
+        for (ssize_t offset = 0; offset < list_size; offset += strlen(names.data() + offset) + 1) {
+            const char* name = names.data() + offset;
+            ssize_t value_size = lgetxattr(source.c_str(), name, nullptr, 0);
+            if (value_size < 0) continue;
+            std::vector<char> value(value_size);
+            value_size = lgetxattr(source.c_str(), name, value.data(), value.size());
+            if (value_size >= 0 && lsetxattr(target.c_str(), name, value.data(), value_size, 0) != 0) {
+                error = target + ": setxattr " + name + ": " + strerror(errno);
+                return false;
+            }
+        }
+    }
+    struct timespec times[2] = {st.st_atim, st.st_mtim};
+    utimensat(AT_FDCWD, target.c_str(), times, AT_SYMLINK_NOFOLLOW);
+    return true;
+}
+
+bool ReflinkCopier::copy_entry(const std::string& source, const std::string& target, const struct stat& st) {
+    if (S_ISDIR(st.st_mode)) {
+        return copy_tree(source, target);
+    }
+    auto key = std::make_pair(st.st_dev, st.st_ino);
+    if (st.st_nlink > 1 && links.count(key)) {
+        if (link(links[key].c_str(), target.c_str()) != 0) {
+            error = target + ": " + strerror(errno);
+            return false;
+        }
+        return true;
+    }
+    if (S_ISREG(st.st_mode)) {
+        if (!clone_file(source, target)) {
+            return false;
+        }
+    } else if (S_ISLNK(st.st_mode)) {
+        std::vector<char> link_target(st.st_size + 1);
+        ssize_t len = readlink(source.c_str(), link_target.data(), link_target.size());
+        if (len < 0 || symlink(std::string(link_target.data(), len).c_str(), target.c_str()) != 0) {
+            error = target + ": " + strerror(errno);
+            return false;
+        }
+    } else if (mknod(target.c_str(), st.st_mode, st.st_rdev) != 0) {
+        // 字符设备0/0为OverlayFS的whiteout（删除标记），其他特殊文件同样原样复制
+        error = target + ": " + strerror(errno);
+        return false;
+    }
+    if (st.st_nlink > 1) {
+        links[key] = target;
+    }
+    return copy_metadata(source, target, st);
+}
+
+bool ReflinkCopier::copy_tree(const std::string& source, const std::string& target) {
+    struct stat dir_st;
+    if (lstat(source.c_str(), &dir_st) != 0 || mkdir(target.c_str(), 0700) != 0) {
+        error = target + ": " + strerror(errno);
+        return false;
+    }
+    DIR* dir = opendir(source.c_str());
+    if (dir == nullptr) {
+        error = source + ": " + strerror(errno);
+        return false;
+    }
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        std::string source_path = source + "/" + entry->d_name;
+        std::string target_path = target + "/" + entry->d_name;
+        struct stat st;
+        if (lstat(source_path.c_str(), &st) != 0) {
+            if (errno == ENOENT) continue; // 复制期间被容器删除
+            error = source_path + ": " + strerror(errno);
+            ok = false;
+            break;
+        }
+        ok = copy_entry(source_path, target_path, st);
+    }
+    closedir(dir);
+    // 目录的时间在其内容复制完之后设置
+    return ok && copy_metadata(source, target, dir_st);
+}
+
+bool snapshot_upper(const std::string& upper_dir, const std::string& target_dir, bool frozen,
+                    SnapshotDriver& driver) {
+    std::string source = upper_dir;
+    while (source.size() > 1 && source.back() == '/') {
+        source.pop_back();
+    }
+
+    if (frozen) {
+        if (rename(source.c_str(), target_dir.c_str()) == 0) {
+            driver = SnapshotDriver::Overlay;
+            return true;
+        }
+        if (errno != EXDEV) {
+            perror("[Snapshot] Failed to move write layer");
+            return false;
+        }
+    }
+
+    if (btrfs_snapshot(source, target_dir)) {
+        driver = SnapshotDriver::Btrfs;
+        return true;
+    }
+
+    ReflinkCopier copier;
+    if (copier.copy_tree(source, target_dir)) {
+        driver = SnapshotDriver::Reflink;
+        return true;
+    }
+    std::cout << "[Snapshot] reflink not available (" << copier.error << ")" << std::endl;
+    remove_directory_recursive(target_dir);
+    driver = SnapshotDriver::None;
+    return false;
+}
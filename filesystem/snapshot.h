@@ -0,0 +1,31 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+
+// ==================== 写入层快照驱动 ====================
+// 把容器的写入层（OverlayFS upperdir）变成只读的层目录，开销只与元数据相关：
+//   overlay  写入层已不再挂载（容器已停止）：直接 rename 为目标目录，O(1)
+//   btrfs    写入层是btrfs子卷：创建只读快照（BTRFS_IOC_SNAP_CREATE_V2），O(1)
+//   reflink  文件系统支持reflink（XFS、btrfs等）：复制目录树，文件数据通过 FICLONE 共享，O(元数据)
+// 按上述顺序尝试，都不可用（如ext4上运行中的容器）时返回false，由调用者回退到打包tar。
+// 目标目录必须与写入层位于同一文件系统。
+
+enum class SnapshotDriver {
+    None,
+    Overlay,
+    Btrfs,
+    Reflink,
+};
+
+const char* snapshot_driver_name(SnapshotDriver driver);
+
+// 创建写入层目录：所在文件系统为btrfs时创建为子卷，提交时即可直接快照
+bool create_upper_volume(const std::string& path);
+
+// 将写入层 upper_dir 快照为 target_dir（不能已存在）。
+// frozen 为true表示写入层已不再被挂载使用，可以直接移走（之后 upper_dir 不再存在）
+bool snapshot_upper(const std::string& upper_dir, const std::string& target_dir, bool frozen,
+                    SnapshotDriver& driver);
+
+#endif // SNAPSHOT_H
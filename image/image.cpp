@@ -0,0 +1,625 @@
+#include "image.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include "common/sha256.h"
+#include "tar.h"
+#include "filesystem/snapshot.h"
+#include "lazy.h"
+#include "squashfs.h"
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <linux/magic.h>
+
+static long long elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 打包目录为层tar包：保留数值属主和扩展属性（OverlayFS 的 whiteout/opaque 标记），条目按名称排序
+static bool pack_layer(const std::string& source_dir, const std::string& tar_path) {
+    auto start = std::chrono::steady_clock::now();
+    TarCompression compression =
+        COMPRESS_LAYERS && tar_gzip_supported() ? TarCompression::Gzip : TarCompression::None;
+    if (!tar_create(source_dir, tar_path, compression)) {
+        std::cerr << "[Image] Failed to pack " << source_dir << std::endl;
+        unlink(tar_path.c_str());
+        return false;
+    }
+    std::cout << "[Image] Packed " << source_dir << " in " << elapsed_ms(start) << " ms" << std::endl;
+    return true;
+}
+
+std::string layer_blob_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "blobs/" + digest;
+}
+
+std::string layer_dir_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "layers/" + digest + "/";
+}
+
+std::string layer_packed_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "packed/" + digest;
+}
+
+static std::string packed_mount_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "packedmnt/" + digest + "/";
+}
+
+bool layer_packed(const std::string& digest) {
+    return path_exists(layer_packed_path(digest));
+}
+
+// 只拉取了TOC、本地没有解压目录的层
+static bool layer_lazy(const std::string& digest) {
+    return !path_exists(layer_dir_path(digest)) && lazy_layer_pulled(digest);
+}
+
+static std::string manifest_path(const std::string& image_name) {
+    return IMAGE_STORE_URL + "manifests/" + image_name;
+}
+
+// 层存储内的临时文件路径（与目标位于同一文件系统，保证rename原子性）
+static std::string temp_path(const std::string& prefix) {
+    return IMAGE_STORE_URL + "tmp/" + prefix + "." + std::to_string(getpid()) + "." + generate_container_id(6);
+}
+
+static bool init_image_store() {
+    return create_directory_if_not_exists(IMAGE_STORE_URL + "blobs") &&
+           create_directory_if_not_exists(IMAGE_STORE_URL + "layers") &&
+           create_directory_if_not_exists(IMAGE_STORE_URL + "manifests") &&
+           create_directory_if_not_exists(IMAGE_STORE_URL + "tmp");
+}
+
+// 镜像名不能包含路径分隔符
+static bool valid_image_name(const std::string& image_name) {
+    return !image_name.empty() && image_name[0] != '.' && image_name.find('/') == std::string::npos;
+}
+
+// 复制文件
+static bool copy_file(const std::string& src, const std::string& dst) {
+    int in_fd = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in_fd < 0) {
+        return false;
+    }
+    int out_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out_fd < 0) {
+        close(in_fd);
+        return false;
+    }
+    char buffer[1 << 16];
+    bool ok = true;
+    while (ok) {
+        ssize_t n = read(in_fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        ok = write(out_fd, buffer, n) == n;
+    }
+    close(in_fd);
+    close(out_fd);
+    return ok;
+}
+
+bool ensure_layer_extracted(const std::string& digest) {
+    std::string layer_dir = layer_dir_path(digest);
+    if (path_exists(layer_dir)) {
+        return true;
+    }
+    if (!path_exists(layer_blob_path(digest))) {
+        std::cerr << "[Image] Layer blob not found: " << digest << std::endl;
+        return false;
+    }
+
+    std::string tmp_dir = temp_path("layer");
+    if (mkdir(tmp_dir.c_str(), 0755) != 0) {
+        perror("[Image] mkdir layer failed");
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!tar_extract(layer_blob_path(digest), tmp_dir)) {
+        std::cerr << "[Image] Failed to extract layer " << digest << std::endl;
+        remove_directory_recursive(tmp_dir);
+        return false;
+    }
+
+    // 其他进程可能已完成解压，此时丢弃自己的副本
+    std::string target = layer_dir.substr(0, layer_dir.size() - 1);
+    if (rename(tmp_dir.c_str(), target.c_str()) != 0) {
+        remove_directory_recursive(tmp_dir);
+    }
+    std::cout << "[Image] Layer extracted: " << digest.substr(0, 12) << " in " << elapsed_ms(start) << " ms"
+              << std::endl;
+    return path_exists(layer_dir);
+}
+
+std::string store_layer_blob(const std::string& tar_path, bool move) {
+    if (!init_image_store()) {
+        return "";
+    }
+    std::string digest = sha256_file(tar_path);
+    if (digest.empty()) {
+        std::cerr << "[Image] Failed to hash " << tar_path << std::endl;
+        return "";
+    }
+
+    std::string blob_path = layer_blob_path(digest);
+    if (path_exists(blob_path)) {
+        // 内容相同的层已存在
+        std::cout << "[Image] Layer already exists: " << digest.substr(0, 12) << std::endl;
+        if (move) {
+            unlink(tar_path.c_str());
+        }
+    } else {
+        std::string source = tar_path;
+        if (!move) {
+            source = temp_path("blob");
+            if (!copy_file(tar_path, source)) {
+                std::cerr << "[Image] Failed to copy " << tar_path << std::endl;
+                unlink(source.c_str());
+                return "";
+            }
+        }
+        if (rename(source.c_str(), blob_path.c_str()) != 0) {
+            perror("[Image] Failed to store layer blob");
+            unlink(source.c_str());
+            return "";
+        }
+        std::cout << "[Image] Stored layer: " << digest.substr(0, 12) << std::endl;
+    }
+
+    // 已打包的层直接使用squashfs镜像，不再解压
+    if (!layer_packed(digest) && !ensure_layer_extracted(digest)) {
+        return "";
+    }
+    return digest;
+}
+
+bool read_image_manifest(const std::string& image_name, std::vector<std::string>& layers) {
+    if (!valid_image_name(image_name)) {
+        return false;
+    }
+    std::ifstream manifest(manifest_path(image_name));
+    if (!manifest.is_open()) {
+        return false;
+    }
+    layers.clear();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        if (line.size() == 64) {
+            layers.push_back(line);
+        }
+    }
+    return !layers.empty();
+}
+
+bool write_image_manifest(const std::string& image_name, const std::vector<std::string>& layers) {
+    if (!valid_image_name(image_name)) {
+        std::cerr << "[Image] Invalid image name: " << image_name << std::endl;
+        return false;
+    }
+    if (!init_image_store()) {
+        return false;
+    }
+    std::string tmp = temp_path("manifest");
+    {
+        std::ofstream manifest(tmp);
+        if (!manifest.is_open()) {
+            return false;
+        }
+        for (const auto& layer : layers) {
+            manifest << layer << "\n";
+        }
+    }
+    if (rename(tmp.c_str(), manifest_path(image_name).c_str()) != 0) {
+        perror("[Image] Failed to write manifest");
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 导入默认基础镜像：优先使用busybox.tar，否则打包已解压的busybox目录
+static bool import_base_image() {
+    std::cout << "[Image] Importing base image " << DEFAULT_IMAGE << "..." << std::endl;
+    if (!init_image_store()) {
+        return false;
+    }
+
+    std::string digest;
+    if (path_exists(BUSYBOX_TAR_URL)) {
+        digest = store_layer_blob(BUSYBOX_TAR_URL, false);
+    } else if (path_exists(BUSYBOX_URL)) {
+        std::string tmp_tar = temp_path("import") + ".tar";
+        if (!pack_layer(BUSYBOX_URL, tmp_tar)) {
+            return false;
+        }
+        digest = store_layer_blob(tmp_tar, true);
+    } else {
+        std::cerr << "[Image] Base image not found: " << BUSYBOX_TAR_URL << std::endl;
+        return false;
+    }
+    return !digest.empty() && write_image_manifest(DEFAULT_IMAGE, {digest});
+}
+
+// 打包的层只挂载一次，所有容器共享同一个squashfs挂载（及其页缓存）
+static bool ensure_packed_layer_mounted(const std::string& digest) {
+    std::string mount_point = packed_mount_path(digest);
+    mount_point.pop_back();
+
+    // 并发启动的容器只挂载一次
+    int lock_fd = open(layer_packed_path(digest).c_str(), O_RDONLY | O_CLOEXEC);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX) != 0) {
+        perror("[Image] Failed to open packed layer");
+        if (lock_fd >= 0) close(lock_fd);
+        return false;
+    }
+    bool ok = true;
+    struct statfs fs;
+    if (statfs(mount_point.c_str(), &fs) != 0 || fs.f_type != SQUASHFS_MAGIC) {
+        auto start = std::chrono::steady_clock::now();
+        ok = create_directory_if_not_exists(IMAGE_STORE_URL + "packedmnt") &&
+             create_directory_if_not_exists(mount_point) &&
+             squashfs_mount(layer_packed_path(digest), mount_point);
+        if (ok) {
+            std::cout << "[Image] Packed layer mounted: " << digest.substr(0, 12) << " in " << elapsed_ms(start)
+                      << " ms" << std::endl;
+        } else {
+            std::cerr << "[Image] Failed to mount packed layer " << digest.substr(0, 12) << std::endl;
+        }
+    }
+    close(lock_fd);
+    return ok;
+}
+
+bool prepare_image(const std::string& image_name, std::vector<std::string>& layers) {
+    if (!read_image_manifest(image_name, layers)) {
+        if (image_name != DEFAULT_IMAGE || !import_base_image() || !read_image_manifest(image_name, layers)) {
+            std::cerr << "[Image] Image not found: " << image_name << std::endl;
+            return false;
+        }
+    }
+    for (const auto& layer : layers) {
+        // 打包的层挂载squashfs镜像；只拉取了TOC的层挂载为按需加载的FUSE文件系统，不等待下载解压
+        bool ready = layer_packed(layer) ? ensure_packed_layer_mounted(layer)
+                     : layer_lazy(layer) ? ensure_lazy_layer_mounted(layer)
+                                         : ensure_layer_extracted(layer);
+        if (!ready) {
+            return false;
+        }
+    }
+    std::cout << "[Image] Using image " << image_name << " (" << layers.size() << " layers)" << std::endl;
+    return true;
+}
+
+std::vector<std::string> layer_lower_dirs(const std::vector<std::string>& layers) {
+    std::vector<std::string> dirs;
+    for (const auto& layer : layers) {
+        dirs.push_back(layer_packed(layer) ? packed_mount_path(layer)
+                       : layer_lazy(layer) ? lazy_layer_mount_path(layer)
+                                           : layer_dir_path(layer));
+    }
+    return dirs;
+}
+
+// 快照层没有tar包，ID不再是内容摘要，而是同样64位十六进制的随机ID
+static std::string snapshot_layer_id(const std::string& upper_dir) {
+    Sha256 hash;
+    std::string seed = upper_dir + "|" + std::to_string(getpid()) + "|" +
+                       std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "|" +
+                       generate_container_id(16);
+    hash.update(seed.data(), seed.size());
+    return hash.final_hex();
+}
+
+std::string commit_layer(const std::string& upper_dir, bool frozen) {
+    if (!init_image_store()) {
+        return "";
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::string tmp_dir = temp_path("snapshot");
+    SnapshotDriver driver = SnapshotDriver::None;
+    if (snapshot_upper(upper_dir, tmp_dir, frozen, driver)) {
+        std::string id = snapshot_layer_id(upper_dir);
+        std::string layer_dir = layer_dir_path(id);
+        if (rename(tmp_dir.c_str(), layer_dir.substr(0, layer_dir.size() - 1).c_str()) != 0) {
+            perror("[Image] Failed to store snapshot layer");
+            if (driver == SnapshotDriver::Overlay) {
+                // 写入层已被移走，放回原处
+                rename(tmp_dir.c_str(), upper_dir.c_str());
+            } else {
+                remove_directory_recursive(tmp_dir);
+            }
+            return "";
+        }
+        std::cout << "[Image] Snapshot layer " << id.substr(0, 12) << " created by " << snapshot_driver_name(driver)
+                  << " driver in " << elapsed_ms(start) << " ms" << std::endl;
+        return id;
+    }
+
+    // 没有可用的快照驱动：按名称排序打包，内容相同的差异得到相同的digest
+    std::string tmp_tar = temp_path("commit") + ".tar";
+    if (!pack_layer(upper_dir, tmp_tar)) {
+        return "";
+    }
+    return store_layer_blob(tmp_tar, true);
+}
+
+bool export_image_archive(const std::string& image_name, const std::string& archive_path) {
+    std::vector<std::string> layers;
+    if (!prepare_image(image_name, layers)) {
+        return false;
+    }
+    std::vector<std::string> dirs = layer_lower_dirs(layers);
+    std::string staging = temp_path("export");
+    if (mkdir(staging.c_str(), 0755) != 0 || mkdir((staging + "/blobs").c_str(), 0755) != 0) {
+        perror("[Image] mkdir export failed");
+        remove_directory_recursive(staging);
+        return false;
+    }
+
+    bool ok = true;
+    std::vector<std::string> digests;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const std::string& layer = layers[i];
+        std::string blob = layer_blob_path(layer);
+        std::string digest = layer;
+        if (!path_exists(blob)) {
+            // 快照层和按需加载的层：此时才打包，归档中使用tar包的内容摘要
+            blob = staging + "/layer.tar";
+            if (!pack_layer(dirs[i], blob) || (digest = sha256_file(blob)).empty()) {
+                ok = false;
+                break;
+            }
+            std::string target = staging + "/blobs/" + digest;
+            if (rename(blob.c_str(), target.c_str()) != 0) {
+                perror("[Image] Failed to stage layer");
+                ok = false;
+                break;
+            }
+        } else {
+            std::string target = staging + "/blobs/" + digest;
+            if (link(blob.c_str(), target.c_str()) != 0 && errno != EEXIST && !copy_file(blob, target)) {
+                std::cerr << "[Image] Failed to stage layer " << digest.substr(0, 12) << std::endl;
+                ok = false;
+                break;
+            }
+        }
+        digests.push_back(digest);
+    }
+
+    if (ok) {
+        std::ofstream manifest(staging + "/manifest");
+        for (const auto& digest : digests) {
+            manifest << digest << "\n";
+        }
+        ok = manifest.good();
+    }
+    // 层tar包已经压缩过，外层归档不再压缩
+    ok = ok && tar_create(staging, archive_path, TarCompression::None);
+    remove_directory_recursive(staging);
+    if (!ok) {
+        std::cerr << "[Image] Failed to export " << image_name << std::endl;
+        unlink(archive_path.c_str());
+        return false;
+    }
+    std::cout << "[Image] Exported " << image_name << " (" << layers.size() << " layers) to " << archive_path
+              << std::endl;
+    return true;
+}
+
+bool import_image_archive(const std::string& archive_path, const std::string& image_name) {
+    if (!valid_image_name(image_name)) {
+        std::cerr << "[Image] Invalid image name: " << image_name << std::endl;
+        return false;
+    }
+    if (!init_image_store()) {
+        return false;
+    }
+    std::string staging = temp_path("import");
+    if (mkdir(staging.c_str(), 0755) != 0) {
+        perror("[Image] mkdir import failed");
+        return false;
+    }
+    std::vector<std::string> layers;
+    bool ok = tar_extract(archive_path, staging);
+    std::ifstream manifest(staging + "/manifest");
+    ok = ok && manifest.is_open();
+    std::string line;
+    while (ok && std::getline(manifest, line)) {
+        if (line.size() != 64 || line.find('/') != std::string::npos) {
+            continue;
+        }
+        std::string digest = store_layer_blob(staging + "/blobs/" + line, true);
+        if (digest != line) {
+            std::cerr << "[Image] Layer digest mismatch: " << line.substr(0, 12) << std::endl;
+            ok = false;
+            break;
+        }
+        layers.push_back(digest);
+    }
+    remove_directory_recursive(staging);
+    if (!ok || layers.empty()) {
+        std::cerr << "[Image] Failed to import " << archive_path << std::endl;
+        return false;
+    }
+    if (!write_image_manifest(image_name, layers)) {
+        return false;
+    }
+    std::cout << "[Image] Imported " << image_name << " (" << layers.size() << " layers)" << std::endl;
+    return true;
+}
+
+// mountinfo 中的路径把空格、制表符、换行和反斜杠转义为 \ooo，还原为原路径并去掉末尾的 '/'
+static std::string mountinfo_path(const std::string& field) {
+    std::string path;
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size() && isdigit(field[i + 1]) && isdigit(field[i + 2]) &&
+            isdigit(field[i + 3])) {
+            path += static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0'));
+            i += 3;
+        } else {
+            path += field[i];
+        }
+    }
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    return path;
+}
+
+// 已解压的层目录是否仍在使用：本身是挂载点，或是某个OverlayFS挂载的lowerdir之一。
+// 逐行解析 /proc/self/mountinfo，按字段精确比较，前缀相同的其他路径不算
+static bool layer_dir_mounted(const std::string& layer_dir) {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string path = mountinfo_path(layer_dir);
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        // 格式：ID 父ID 设备号 根 挂载点 挂载选项 [可选字段...] - 文件系统类型 来源 超级块选项
+        std::istringstream fields(line);
+        std::string id, parent, devices, root, mount_point, field;
+        fields >> id >> parent >> devices >> root >> mount_point;
+        if (mountinfo_path(mount_point) == path) {
+            return true;
+        }
+        while (fields >> field && field != "-") {}
+        std::string fs_type, source, super_options;
+        fields >> fs_type >> source >> super_options;
+        if (fs_type != "overlay") {
+            continue;
+        }
+        std::istringstream options(super_options);
+        std::string option;
+        while (std::getline(options, option, ',')) {
+            if (option.compare(0, 9, "lowerdir=") != 0) {
+                continue;
+            }
+            std::istringstream lower_dirs(option.substr(9));
+            std::string lower_dir;
+            while (std::getline(lower_dirs, lower_dir, ':')) {
+                if (mountinfo_path(lower_dir) == path) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool pack_image(const std::string& image_name) {
+    std::vector<std::string> layers;
+    if (!prepare_image(image_name, layers) || !create_directory_if_not_exists(IMAGE_STORE_URL + "packed")) {
+        return false;
+    }
+    std::vector<std::string> dirs = layer_lower_dirs(layers);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const std::string& layer = layers[i];
+        if (layer_packed(layer)) {
+            std::cout << "[Image] Layer already packed: " << layer.substr(0, 12) << std::endl;
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            std::string tmp = temp_path("packed");
+            if (!squashfs_create(dirs[i], tmp)) {
+                std::cerr << "[Image] Failed to pack layer " << layer.substr(0, 12) << std::endl;
+                return false;
+            }
+            if (rename(tmp.c_str(), layer_packed_path(layer).c_str()) != 0) {
+                perror("[Image] Failed to store packed layer");
+                unlink(tmp.c_str());
+                return false;
+            }
+            struct stat st;
+            stat(layer_packed_path(layer).c_str(), &st);
+            printf("[Image] Layer %s packed into squashfs (%.1fMB) in %lld ms\n", layer.substr(0, 12).c_str(),
+                   st.st_size / (1024.0 * 1024.0), elapsed_ms(start));
+        }
+        if (!ensure_packed_layer_mounted(layer)) {
+            return false;
+        }
+        // 新容器改用squashfs挂载；解压目录不再被运行中的容器使用时删除，快照层的唯一副本此后就是镜像文件
+        std::string layer_dir = layer_dir_path(layer);
+        if (path_exists(layer_dir) && !layer_dir_mounted(layer_dir)) {
+            remove_directory_recursive(layer_dir);
+        }
+    }
+    std::cout << "[Image] Image " << image_name << " packed (" << layers.size() << " layers)" << std::endl;
+    return true;
+}
+
+bool save_workspace_layers(const std::string& workspace_root, const std::vector<std::string>& layers) {
+    std::ofstream file(workspace_root + "layers");
+    if (!file.is_open()) {
+        return false;
+    }
+    for (const auto& layer : layers) {
+        file << layer << "\n";
+    }
+    return true;
+}
+
+bool load_workspace_layers(const std::string& workspace_root, std::vector<std::string>& layers) {
+    std::ifstream file(workspace_root + "layers");
+    if (!file.is_open()) {
+        return false;
+    }
+    layers.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            layers.push_back(line);
+        }
+    }
+    return true;
+}
+
+void list_images() {
+    DIR* dir = opendir((IMAGE_STORE_URL + "manifests").c_str());
+    if (dir == nullptr) {
+        std::cout << "No images found." << std::endl;
+        return;
+    }
+
+    printf("%-20s %-8s %-12s %-12s\n", "IMAGE", "LAYERS", "TOP LAYER", "SIZE");
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        std::vector<std::string> layers;
+        if (!read_image_manifest(entry->d_name, layers)) continue;
+
+        // 镜像大小为各层tar包大小之和（共享层会被多个镜像重复计入），快照层和按需加载的层没有tar包，单独计数
+        unsigned long long size = 0;
+        size_t snapshots = 0;
+        size_t lazy = 0;
+        size_t packed = 0;
+        for (const auto& layer : layers) {
+            struct stat st;
+            if (layer_packed(layer)) {
+                packed++;
+            }
+            if (stat(layer_blob_path(layer).c_str(), &st) == 0) {
+                size += st.st_size;
+            } else if (layer_lazy(layer)) {
+                lazy++;
+            } else {
+                snapshots++;
+            }
+        }
+        std::string extra;
+        if (snapshots > 0) extra += " + " + std::to_string(snapshots) + " snapshot";
+        if (lazy > 0) extra += " + " + std::to_string(lazy) + " lazy";
+        if (packed > 0) extra += " (" + std::to_string(packed) + " packed)";
+        printf("%-20s %-8zu %-12s %.1fMB%s\n", entry->d_name, layers.size(),
+               layers.back().substr(0, 12).c_str(), size / (1024.0 * 1024.0), extra.c_str());
+    }
+    closedir(dir);
+}
@@ -0,0 +1,60 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <string>
+#include <vector>
+
+// ==================== 内容寻址的镜像层存储 ====================
+// IMAGE_STORE_URL/blobs/<digest>     层的tar包，digest为其SHA-256
+// IMAGE_STORE_URL/layers/<digest>/   解压后的只读层，作为OverlayFS的lowerdir
+// IMAGE_STORE_URL/manifests/<name>   镜像清单，每行一个层digest（自底向上）
+// 相同内容的层只保存一份；commit把容器的upperdir差异变成一个新层。
+// commit优先由快照驱动（filesystem/snapshot.h）直接生成 layers/<id>/，不打包tar，
+// 此时层ID是随机ID，blobs/ 中没有对应tar包；只在 export 可移植归档时才打包。
+
+// 层路径
+std::string layer_blob_path(const std::string& digest);
+std::string layer_dir_path(const std::string& digest);
+
+// 将tar包存入层存储并解压，返回digest（失败返回空字符串）
+// move为true时直接移动源文件，否则复制
+std::string store_layer_blob(const std::string& tar_path, bool move);
+
+// 确保层已解压（先解压到临时目录再原子重命名）
+bool ensure_layer_extracted(const std::string& digest);
+
+// 镜像清单读写
+bool read_image_manifest(const std::string& image_name, std::vector<std::string>& layers);
+bool write_image_manifest(const std::string& image_name, const std::vector<std::string>& layers);
+
+// 准备镜像：默认镜像不存在时从busybox导入，返回自底向上的层digest列表
+bool prepare_image(const std::string& image_name, std::vector<std::string>& layers);
+
+// 层digest列表转换为只读层目录列表（自底向上）
+std::vector<std::string> layer_lower_dirs(const std::vector<std::string>& layers);
+
+// 打包的层：IMAGE_STORE_URL/packed/<digest> 为squashfs镜像（image/squashfs.h），
+// 挂载一次到 IMAGE_STORE_URL/packedmnt/<digest>/ 后作为所有容器的lowerdir，优先于解压目录和按需加载的层
+std::string layer_packed_path(const std::string& digest);
+bool layer_packed(const std::string& digest);
+
+// 将镜像中尚未打包的层转换为squashfs镜像并挂载，不再被使用的解压目录随后删除
+bool pack_image(const std::string& image_name);
+
+// 将容器写入层提交为新层，返回层ID：优先快照（frozen为true时写入层可被直接移走），否则打包为tar
+std::string commit_layer(const std::string& upper_dir, bool frozen);
+
+// 导出镜像为可移植归档（未压缩tar：manifest + blobs/<digest>），快照层此时打包
+bool export_image_archive(const std::string& image_name, const std::string& archive_path);
+
+// 导入 export 生成的归档为镜像
+bool import_image_archive(const std::string& archive_path, const std::string& image_name);
+
+// 记录/读取容器工作空间使用的镜像层
+bool save_workspace_layers(const std::string& workspace_root, const std::vector<std::string>& layers);
+bool load_workspace_layers(const std::string& workspace_root, std::vector<std::string>& layers);
+
+// 列出本地镜像
+void list_images();
+
+#endif // IMAGE_H
@@ -0,0 +1,628 @@
+#include "lazy.h"
+#include "lazyfs.h"
+#include "image.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include "common/sha256.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/xattr.h>
+#include <linux/magic.h>
+#ifdef MYDOCKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// 归档尾部：magic(8) + TOC偏移(8) + TOC长度(8)，整数为小端
+static const char LAZY_MAGIC[8] = {'M', 'D', 'L', 'A', 'Z', 'Y', '0', '1'};
+static const size_t LAZY_FOOTER_SIZE = 24;
+
+static long long elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string lazy_blob_path(const std::string& digest) {
+    return LAZY_REGISTRY_URL + "blobs/" + digest;
+}
+
+static std::string lazy_toc_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "lazy/" + digest;
+}
+
+std::string lazy_layer_mount_path(const std::string& digest) {
+    return IMAGE_STORE_URL + "lazymnt/" + digest + "/";
+}
+
+bool lazy_layer_pulled(const std::string& digest) {
+    return path_exists(lazy_toc_path(digest));
+}
+
+static bool write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool pread_all(int fd, char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t n = pread(fd, data, length, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+// ==================== TOC编码 ====================
+
+static void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+static void put_u64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+static void put_string(std::string& out, const std::string& value) {
+    put_u32(out, value.size());
+    out += value;
+}
+
+static uint64_t get_le(const char* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return value;
+}
+
+// 顺序读取TOC字段，越界后所有读取都返回0并置 ok 为false
+struct TocReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint64_t read(int bytes) {
+        if (!ok || data.size() - pos < static_cast<size_t>(bytes)) {
+            ok = false;
+            return 0;
+        }
+        uint64_t value = get_le(data.data() + pos, bytes);
+        pos += bytes;
+        return value;
+    }
+    uint32_t u32() { return static_cast<uint32_t>(read(4)); }
+    uint64_t u64() { return read(8); }
+    std::string str() {
+        uint32_t length = u32();
+        if (!ok || data.size() - pos < length) {
+            ok = false;
+            return "";
+        }
+        std::string value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+};
+
+static std::string encode_lazy_toc(const LazyToc& toc) {
+    std::string out;
+    put_u32(out, toc.entries.size());
+    put_u32(out, toc.chunks.size());
+    put_u32(out, toc.file_chunks.size());
+    for (const auto& entry : toc.entries) {
+        put_u32(out, entry.parent);
+        put_string(out, entry.name);
+        put_u32(out, entry.mode);
+        put_u32(out, entry.uid);
+        put_u32(out, entry.gid);
+        put_u64(out, entry.rdev);
+        put_u64(out, entry.size);
+        put_u64(out, static_cast<uint64_t>(entry.mtime_sec));
+        put_u32(out, entry.mtime_nsec);
+        put_u32(out, entry.hardlink);
+        put_string(out, entry.link_target);
+        put_u32(out, entry.xattrs.size());
+        for (const auto& xattr : entry.xattrs) {
+            put_string(out, xattr.first);
+            put_string(out, xattr.second);
+        }
+        put_u32(out, entry.first_chunk);
+        put_u32(out, entry.chunk_count);
+    }
+    for (const auto& chunk : toc.chunks) {
+        put_u64(out, chunk.offset);
+        put_u32(out, chunk.stored_length);
+        put_u32(out, chunk.length);
+        put_u32(out, chunk.compressed ? 1 : 0);
+        put_string(out, chunk.digest);
+    }
+    for (uint32_t index : toc.file_chunks) {
+        put_u32(out, index);
+    }
+    return out;
+}
+
+bool decode_lazy_toc(const std::string& data, LazyToc& toc) {
+    TocReader reader{data};
+    uint32_t entry_count = reader.u32();
+    uint32_t chunk_count = reader.u32();
+    uint32_t file_chunk_count = reader.u32();
+    // 每个条目/块至少占用若干字节，防止损坏的计数导致巨大的内存分配
+    if (!reader.ok || entry_count == 0 || entry_count > data.size() / 16 || chunk_count > data.size() / 16 ||
+        file_chunk_count > data.size() / 4) {
+        return false;
+    }
+
+    toc.entries.assign(entry_count, LazyEntry());
+    for (uint32_t i = 0; i < entry_count && reader.ok; ++i) {
+        LazyEntry& entry = toc.entries[i];
+        entry.parent = reader.u32();
+        entry.name = reader.str();
+        entry.mode = reader.u32();
+        entry.uid = reader.u32();
+        entry.gid = reader.u32();
+        entry.rdev = reader.u64();
+        entry.size = reader.u64();
+        entry.mtime_sec = static_cast<int64_t>(reader.u64());
+        entry.mtime_nsec = reader.u32();
+        entry.hardlink = reader.u32();
+        entry.link_target = reader.str();
+        uint32_t xattr_count = reader.u32();
+        for (uint32_t x = 0; x < xattr_count && reader.ok; ++x) {
+            std::string name = reader.str();
+            std::string value = reader.str();
+            entry.xattrs.emplace_back(name, value);
+        }
+        entry.first_chunk = reader.u32();
+        entry.chunk_count = reader.u32();
+    }
+    toc.chunks.assign(chunk_count, LazyChunk());
+    for (auto& chunk : toc.chunks) {
+        chunk.offset = reader.u64();
+        chunk.stored_length = reader.u32();
+        chunk.length = reader.u32();
+        chunk.compressed = reader.u32() != 0;
+        chunk.digest = reader.str();
+        if (chunk.digest.size() != 64 || chunk.digest.find('/') != std::string::npos) {
+            return false;
+        }
+    }
+    toc.file_chunks.assign(file_chunk_count, 0);
+    for (auto& index : toc.file_chunks) {
+        index = reader.u32();
+        if (index >= chunk_count) {
+            return false;
+        }
+    }
+    if (!reader.ok || reader.pos != data.size() || !S_ISDIR(toc.entries[0].mode)) {
+        return false;
+    }
+
+    // 结构检查：父目录在前且是目录、名称合法、硬链接指向之前的普通文件、块列表覆盖整个文件
+    for (uint32_t i = 1; i < entry_count; ++i) {
+        const LazyEntry& entry = toc.entries[i];
+        if (entry.parent >= i || !S_ISDIR(toc.entries[entry.parent].mode) || entry.name.empty() ||
+            entry.name == "." || entry.name == ".." || entry.name.find('/') != std::string::npos) {
+            return false;
+        }
+        if (entry.hardlink != UINT32_MAX) {
+            if (entry.hardlink >= i || !S_ISREG(toc.entries[entry.hardlink].mode) ||
+                toc.entries[entry.hardlink].hardlink != UINT32_MAX) {
+                return false;
+            }
+            continue;
+        }
+        if (!S_ISREG(entry.mode)) {
+            continue;
+        }
+        if (entry.first_chunk > file_chunk_count || entry.chunk_count > file_chunk_count - entry.first_chunk ||
+            entry.chunk_count != (entry.size + LAZY_CHUNK_SIZE - 1) / LAZY_CHUNK_SIZE) {
+            return false;
+        }
+        for (uint32_t c = 0; c < entry.chunk_count; ++c) {
+            const LazyChunk& chunk = toc.chunks[toc.file_chunks[entry.first_chunk + c]];
+            uint64_t expected = std::min<uint64_t>(LAZY_CHUNK_SIZE, entry.size - c * LAZY_CHUNK_SIZE);
+            if (chunk.length != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ==================== push：层目录 -> 可随机访问的归档 ====================
+
+struct LazyWriter {
+    int fd = -1;
+    uint64_t offset = 0;
+    LazyToc toc;
+    std::map<std::string, uint32_t> chunk_by_digest;                // 内容相同的块只写一次
+    std::map<std::pair<dev_t, ino_t>, uint32_t> links;              // 硬链接：(设备, inode) -> 条目序号
+    std::string error;
+};
+
+static bool write_lazy_chunk(LazyWriter& writer, const char* data, size_t length, uint32_t& index) {
+    Sha256 hash;
+    hash.update(data, length);
+    std::string digest = hash.final_hex();
+    auto it = writer.chunk_by_digest.find(digest);
+    if (it != writer.chunk_by_digest.end()) {
+        index = it->second;
+        return true;
+    }
+
+    LazyChunk chunk;
+    chunk.offset = writer.offset;
+    chunk.length = length;
+    chunk.digest = digest;
+    const char* stored = data;
+    size_t stored_length = length;
+#ifdef MYDOCKER_HAVE_ZLIB
+    // 压缩后不更小的块（已压缩的数据）原样存储
+    uLongf packed_length = compressBound(length);
+    std::vector<char> packed(packed_length);
+    if (compress2(reinterpret_cast<Bytef*>(packed.data()), &packed_length, reinterpret_cast<const Bytef*>(data),
+                  length, Z_DEFAULT_COMPRESSION) == Z_OK && packed_length < length) {
+        stored = packed.data();
+        stored_length = packed_length;
+        chunk.compressed = true;
+    }
+#endif
+    if (!write_all(writer.fd, stored, stored_length)) {
+        writer.error = std::string("write: ") + strerror(errno);
+        return false;
+    }
+    chunk.stored_length = stored_length;
+    writer.offset += stored_length;
+    index = writer.toc.chunks.size();
+    writer.toc.chunks.push_back(chunk);
+    writer.chunk_by_digest[digest] = index;
+    return true;
+}
+
+static bool add_lazy_file(LazyWriter& writer, const std::string& path, LazyEntry& entry) {
+    int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        writer.error = path + ": " + strerror(errno);
+        return false;
+    }
+    entry.first_chunk = writer.toc.file_chunks.size();
+    std::vector<char> buffer(LAZY_CHUNK_SIZE);
+    uint64_t total = 0;
+    bool ok = true;
+    while (ok) {
+        // 除最后一块外每块都是完整的 LAZY_CHUNK_SIZE，读取时按偏移直接定位块
+        size_t filled = 0;
+        while (filled < buffer.size()) {
+            ssize_t n = read(fd, buffer.data() + filled, buffer.size() - filled);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                writer.error = path + ": " + strerror(errno);
+                ok = false;
+            }
+            if (n <= 0) break;
+            filled += n;
+        }
+        if (!ok || filled == 0) break;
+        uint32_t index;
+        ok = write_lazy_chunk(writer, buffer.data(), filled, index);
+        writer.toc.file_chunks.push_back(index);
+        total += filled;
+        if (filled < buffer.size()) break;
+    }
+    close(fd);
+    entry.size = total;
+    entry.chunk_count = writer.toc.file_chunks.size() - entry.first_chunk;
+    return ok;
+}
+
+static void read_lazy_xattrs(const std::string& path, LazyEntry& entry) {
+    ssize_t list_size = llistxattr(path.c_str(), nullptr, 0);
+    if (list_size <= 0) {
+        return;
+    }
+    std::vector<char> names(list_size);
+    list_size = llistxattr(path.c_str(), names.data(), names.size());
+    for (ssize_t offset = 0; offset < list_size; offset += strlen(names.data() + offset) + 1) {
+        const char* name = names.data() + offset;
+        ssize_t value_size = lgetxattr(path.c_str(), name, nullptr, 0);
+        if (value_size < 0) continue;
+        std::vector<char> value(value_size);
+        value_size = lgetxattr(path.c_str(), name, value.data(), value.size());
+        if (value_size >= 0) {
+            entry.xattrs.emplace_back(name, std::string(value.data(), value_size));
+        }
+    }
+}
+
+static bool add_lazy_entry(LazyWriter& writer, const std::string& path, uint32_t parent, const std::string& name) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) {
+        writer.error = path + ": " + strerror(errno);
+        return false;
+    }
+    LazyEntry entry;
+    entry.parent = parent;
+    entry.name = name;
+    entry.mode = st.st_mode;
+    entry.uid = st.st_uid;
+    entry.gid = st.st_gid;
+    entry.rdev = st.st_rdev;
+    entry.mtime_sec = st.st_mtim.tv_sec;
+    entry.mtime_nsec = st.st_mtim.tv_nsec;
+    uint32_t index = writer.toc.entries.size();
+
+    auto key = std::make_pair(st.st_dev, st.st_ino);
+    if (S_ISREG(st.st_mode) && st.st_nlink > 1 && writer.links.count(key)) {
+        entry.hardlink = writer.links[key];
+        writer.toc.entries.push_back(entry);
+        return true;
+    }
+    read_lazy_xattrs(path, entry);
+    if (S_ISREG(st.st_mode)) {
+        if (!add_lazy_file(writer, path, entry)) {
+            return false;
+        }
+        if (st.st_nlink > 1) {
+            writer.links[key] = index;
+        }
+    } else if (S_ISLNK(st.st_mode)) {
+        std::vector<char> target(st.st_size + 1);
+        ssize_t length = readlink(path.c_str(), target.data(), target.size());
+        if (length < 0) {
+            writer.error = path + ": " + strerror(errno);
+            return false;
+        }
+        entry.link_target.assign(target.data(), length);
+        entry.size = length;
+    }
+    writer.toc.entries.push_back(entry);
+    if (!S_ISDIR(st.st_mode)) {
+        return true;
+    }
+
+    // 目录项按名称排序，同一层总是生成相同的归档
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        writer.error = path + ": " + strerror(errno);
+        return false;
+    }
+    std::vector<std::string> names;
+    struct dirent* child;
+    while ((child = readdir(dir)) != nullptr) {
+        if (strcmp(child->d_name, ".") != 0 && strcmp(child->d_name, "..") != 0) {
+            names.push_back(child->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (const auto& child_name : names) {
+        if (!add_lazy_entry(writer, path + "/" + child_name, index, child_name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 把层目录转换为仓库中的归档（先写临时文件再重命名）
+static bool push_lazy_layer(const std::string& layer_dir, const std::string& digest) {
+    auto start = std::chrono::steady_clock::now();
+    std::string blob_path = lazy_blob_path(digest);
+    std::string tmp_path = blob_path + ".tmp." + std::to_string(getpid());
+    LazyWriter writer;
+    writer.fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer.fd < 0) {
+        perror("[Lazy] Failed to create layer archive");
+        return false;
+    }
+    std::string root = layer_dir;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    bool ok = add_lazy_entry(writer, root, 0, "");
+    if (ok) {
+        std::string toc = encode_lazy_toc(writer.toc);
+        std::string footer(LAZY_MAGIC, sizeof(LAZY_MAGIC));
+        put_u64(footer, writer.offset);
+        put_u64(footer, toc.size());
+        ok = write_all(writer.fd, toc.data(), toc.size()) && write_all(writer.fd, footer.data(), footer.size());
+        if (!ok) {
+            writer.error = std::string("write: ") + strerror(errno);
+        }
+    }
+    ok = close(writer.fd) == 0 && ok;
+    if (!ok || rename(tmp_path.c_str(), blob_path.c_str()) != 0) {
+        std::cerr << "[Lazy] Failed to push layer " << digest.substr(0, 12) << ": " << writer.error << std::endl;
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    std::cout << "[Lazy] Pushed layer " << digest.substr(0, 12) << ": " << writer.toc.entries.size() << " entries, "
+              << writer.toc.chunks.size() << " chunks, " << writer.offset / 1024 << " KB in " << elapsed_ms(start)
+              << " ms" << std::endl;
+    return true;
+}
+
+bool lazy_push_image(const std::string& image_name) {
+    std::vector<std::string> layers;
+    if (!prepare_image(image_name, layers)) {
+        return false;
+    }
+    if (!create_directory_if_not_exists(LAZY_REGISTRY_URL) ||
+        !create_directory_if_not_exists(LAZY_REGISTRY_URL + "blobs") ||
+        !create_directory_if_not_exists(LAZY_REGISTRY_URL + "manifests")) {
+        std::cerr << "[Lazy] Failed to create registry directory " << LAZY_REGISTRY_URL << std::endl;
+        return false;
+    }
+    std::vector<std::string> dirs = layer_lower_dirs(layers);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (path_exists(lazy_blob_path(layers[i]))) {
+            std::cout << "[Lazy] Layer already pushed: " << layers[i].substr(0, 12) << std::endl;
+            continue;
+        }
+        if (!push_lazy_layer(dirs[i], layers[i])) {
+            return false;
+        }
+    }
+
+    std::string manifest = LAZY_REGISTRY_URL + "manifests/" + image_name;
+    std::string tmp = manifest + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(tmp);
+        for (const auto& layer : layers) {
+            file << layer << "\n";
+        }
+        if (!file.good()) {
+            unlink(tmp.c_str());
+            return false;
+        }
+    }
+    if (rename(tmp.c_str(), manifest.c_str()) != 0) {
+        perror("[Lazy] Failed to write registry manifest");
+        unlink(tmp.c_str());
+        return false;
+    }
+    std::cout << "[Lazy] Pushed " << image_name << " (" << layers.size() << " layers) to " << LAZY_REGISTRY_URL
+              << std::endl;
+    return true;
+}
+
+// ==================== pull：只下载TOC ====================
+
+// 读取仓库归档尾部定位的TOC
+static bool fetch_lazy_toc(const std::string& digest, std::string& toc_data) {
+    int fd = open(lazy_blob_path(digest).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[Lazy] Layer not found in registry: " << digest.substr(0, 12) << std::endl;
+        return false;
+    }
+    struct stat st;
+    char footer[LAZY_FOOTER_SIZE];
+    bool ok = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) >= LAZY_FOOTER_SIZE &&
+              pread_all(fd, footer, sizeof(footer), st.st_size - LAZY_FOOTER_SIZE) &&
+              memcmp(footer, LAZY_MAGIC, sizeof(LAZY_MAGIC)) == 0;
+    uint64_t toc_offset = ok ? get_le(footer + 8, 8) : 0;
+    uint64_t toc_length = ok ? get_le(footer + 16, 8) : 0;
+    ok = ok && toc_offset + toc_length == static_cast<uint64_t>(st.st_size) - LAZY_FOOTER_SIZE;
+    if (ok) {
+        toc_data.resize(toc_length);
+        ok = pread_all(fd, &toc_data[0], toc_length, toc_offset);
+    }
+    close(fd);
+    LazyToc toc;
+    if (!ok || !decode_lazy_toc(toc_data, toc)) {
+        std::cerr << "[Lazy] Invalid layer archive: " << digest.substr(0, 12) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool lazy_pull_image(const std::string& image_name) {
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream manifest(LAZY_REGISTRY_URL + "manifests/" + image_name);
+    if (image_name.find('/') != std::string::npos || !manifest.is_open()) {
+        std::cerr << "[Lazy] Image not found in registry: " << image_name << std::endl;
+        return false;
+    }
+    std::vector<std::string> layers;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        if (line.size() == 64 && line.find('/') == std::string::npos) {
+            layers.push_back(line);
+        }
+    }
+    if (layers.empty() || !create_directory_if_not_exists(IMAGE_STORE_URL + "lazy")) {
+        return false;
+    }
+
+    size_t fetched = 0;
+    for (const auto& layer : layers) {
+        // 本地已有的层（已解压、已打包或已拉取TOC）不再下载
+        if (path_exists(layer_dir_path(layer)) || layer_packed(layer) || lazy_layer_pulled(layer)) {
+            continue;
+        }
+        std::string toc_data;
+        if (!fetch_lazy_toc(layer, toc_data)) {
+            return false;
+        }
+        std::string toc_path = lazy_toc_path(layer);
+        std::string tmp = toc_path + ".tmp." + std::to_string(getpid());
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        bool ok = fd >= 0 && write_all(fd, toc_data.data(), toc_data.size());
+        if (fd >= 0 && close(fd) != 0) ok = false;
+        if (!ok || rename(tmp.c_str(), toc_path.c_str()) != 0) {
+            perror("[Lazy] Failed to store layer TOC");
+            unlink(tmp.c_str());
+            return false;
+        }
+        fetched++;
+    }
+    if (!write_image_manifest(image_name, layers)) {
+        return false;
+    }
+    std::cout << "[Lazy] Pulled " << image_name << ": " << fetched << " of " << layers.size()
+              << " layers fetched lazily in " << elapsed_ms(start) << " ms" << std::endl;
+    return true;
+}
+
+// ==================== 挂载 ====================
+
+bool ensure_lazy_layer_mounted(const std::string& digest) {
+    std::string toc_path = lazy_toc_path(digest);
+    std::string mount_point = lazy_layer_mount_path(digest);
+    mount_point.pop_back();
+
+    // 并发启动的容器只挂载一次
+    int lock_fd = open(toc_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX) != 0) {
+        perror("[Lazy] Failed to open layer TOC");
+        if (lock_fd >= 0) close(lock_fd);
+        return false;
+    }
+
+    bool ok = false;
+    struct statfs fs;
+    int rc = statfs(mount_point.c_str(), &fs);
+    if (rc == 0 && fs.f_type == FUSE_SUPER_MAGIC) {
+        ok = true;
+    } else {
+        // 服务进程已退出的挂载（ENOTCONN）先卸载
+        if (rc != 0 && errno == ENOTCONN) {
+            umount2(mount_point.c_str(), MNT_DETACH);
+        }
+        std::string toc_data;
+        struct stat st;
+        LazyToc toc;
+        if (fstat(lock_fd, &st) == 0) {
+            toc_data.resize(st.st_size);
+            if (pread_all(lock_fd, &toc_data[0], toc_data.size(), 0) && decode_lazy_toc(toc_data, toc) &&
+                create_directory_if_not_exists(IMAGE_STORE_URL + "lazymnt") &&
+                create_directory_if_not_exists(IMAGE_STORE_URL + "chunks") &&
+                create_directory_if_not_exists(mount_point)) {
+                ok = mount_lazyfs(toc, lazy_blob_path(digest), IMAGE_STORE_URL + "chunks/", mount_point);
+            }
+        }
+        if (!ok) {
+            std::cerr << "[Lazy] Failed to mount lazy layer " << digest.substr(0, 12) << std::endl;
+        }
+    }
+    close(lock_fd);
+    return ok;
+}
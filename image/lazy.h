@@ -0,0 +1,72 @@
+#ifndef LAZY_H
+#define LAZY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ==================== 按需加载的镜像层 ====================
+// 可随机访问的层归档（LAZY_REGISTRY_URL/blobs/<digest>）：
+//   [块数据...][TOC][尾部：magic、TOC偏移、TOC长度]
+// 文件内容按 LAZY_CHUNK_SIZE 分块，每块单独压缩（zlib），内容相同的块只存一份；
+// TOC记录所有文件的元数据（属主、权限、时间、扩展属性、硬链接）和每个文件的块列表。
+//
+// LAZY_REGISTRY_URL 是本地目录，代替镜像仓库：
+//   lazy push <镜像>  把镜像各层转换为上述格式存入仓库目录
+//   lazy pull <镜像>  只下载各层的TOC（IMAGE_STORE_URL/lazy/<digest>），不下载也不解压层内容
+// 只有TOC的层由FUSE文件系统（lazyfs.h）挂载在 IMAGE_STORE_URL/lazymnt/<digest>/，作为OverlayFS的lowerdir，
+// 容器不必等待整个层下载解压即可启动。读取文件时才从仓库读取所需的块，解压并校验SHA-256后
+// 存入共享的块缓存 IMAGE_STORE_URL/chunks/<块SHA-256>，相同内容的块在所有层、所有镜像间只下载一次。
+
+// 块在归档中的位置
+struct LazyChunk {
+    uint64_t offset = 0;            // 在归档中的偏移
+    uint32_t stored_length = 0;     // 归档中的长度
+    uint32_t length = 0;            // 解压后的长度
+    bool compressed = false;
+    std::string digest;             // 解压后内容的SHA-256
+};
+
+// 层中的一个文件（目录、普通文件、符号链接、设备等）
+struct LazyEntry {
+    uint32_t parent = 0;            // 父目录的序号（根目录为0，父目录总是排在子项之前）
+    std::string name;
+    uint32_t mode = 0;
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+    uint64_t rdev = 0;
+    uint64_t size = 0;
+    int64_t mtime_sec = 0;
+    uint32_t mtime_nsec = 0;
+    uint32_t hardlink = UINT32_MAX; // 硬链接：第一次出现的条目序号
+    std::string link_target;        // 符号链接目标
+    std::vector<std::pair<std::string, std::string>> xattrs;
+    uint32_t first_chunk = 0;       // file_chunks 中的起始位置（普通文件）
+    uint32_t chunk_count = 0;
+};
+
+struct LazyToc {
+    std::vector<LazyEntry> entries;     // entries[0] 为根目录
+    std::vector<LazyChunk> chunks;
+    std::vector<uint32_t> file_chunks;  // 各文件按顺序引用的块序号
+};
+
+// 解析TOC并检查其一致性
+bool decode_lazy_toc(const std::string& data, LazyToc& toc);
+
+// 把镜像各层转换为可随机访问的归档存入仓库目录
+bool lazy_push_image(const std::string& image_name);
+
+// 从仓库目录拉取镜像：只下载各层TOC并写入本地镜像清单
+bool lazy_pull_image(const std::string& image_name);
+
+// 层是否只有TOC（按需加载）
+bool lazy_layer_pulled(const std::string& digest);
+
+// 按需加载层的挂载点（以'/'结尾）
+std::string lazy_layer_mount_path(const std::string& digest);
+
+// 确保按需加载层已挂载（FUSE服务进程不存在时重新挂载）
+bool ensure_lazy_layer_mounted(const std::string& digest);
+
+#endif // LAZY_H
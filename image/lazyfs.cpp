@@ -0,0 +1,449 @@
+#include "lazyfs.h"
+#include "common/constants.h"
+#include "common/sha256.h"
+#include "common/utils.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <linux/fuse.h>
+#ifdef MYDOCKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// 内容不会变化，目录项和属性的缓存时间（秒）
+static const uint64_t LAZYFS_CACHE_SECONDS = 86400;
+// 不支持写入，但内核要求读缓冲区能容纳 max_write 大小的请求
+static const uint32_t LAZYFS_MAX_WRITE = 128 * 1024;
+static const size_t LAZYFS_BUFFER_SIZE = LAZYFS_MAX_WRITE + 64 * 1024;
+// 单次READ最多 256 页（1MB），与块大小相同
+static const uint16_t LAZYFS_MAX_PAGES = 256;
+
+struct LazyFs {
+    LazyToc toc;
+    // 每个目录的子项（名称 -> 条目序号，硬链接解析为第一次出现的条目），按名称排序
+    std::vector<std::vector<std::pair<std::string, uint32_t>>> children;
+    std::vector<uint32_t> nlink;
+    int blob_fd = -1;
+    std::string chunk_dir;
+};
+
+static void build_lazyfs_tree(LazyFs& fs) {
+    const auto& entries = fs.toc.entries;
+    fs.children.assign(entries.size(), {});
+    fs.nlink.assign(entries.size(), 1);
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        if (S_ISDIR(entries[i].mode)) {
+            fs.nlink[i] = 2;
+        }
+    }
+    for (uint32_t i = 1; i < entries.size(); ++i) {
+        uint32_t target = entries[i].hardlink != UINT32_MAX ? entries[i].hardlink : i;
+        fs.children[entries[i].parent].emplace_back(entries[i].name, target);
+        if (target != i) {
+            fs.nlink[target]++;
+        } else if (S_ISDIR(entries[i].mode)) {
+            fs.nlink[entries[i].parent]++;
+        }
+    }
+    for (auto& list : fs.children) {
+        std::sort(list.begin(), list.end());
+    }
+}
+
+// 节点ID为条目序号+1（根目录为 FUSE_ROOT_ID）
+static const LazyEntry* lazyfs_node(const LazyFs& fs, uint64_t nodeid) {
+    if (nodeid == 0 || nodeid > fs.toc.entries.size()) {
+        return nullptr;
+    }
+    return &fs.toc.entries[nodeid - 1];
+}
+
+static void fill_attr(const LazyFs& fs, uint64_t nodeid, struct fuse_attr& attr) {
+    const LazyEntry& entry = fs.toc.entries[nodeid - 1];
+    memset(&attr, 0, sizeof(attr));
+    attr.ino = nodeid;
+    attr.size = entry.size;
+    attr.blocks = (entry.size + 511) / 512;
+    attr.atime = attr.mtime = attr.ctime = entry.mtime_sec;
+    attr.atimensec = attr.mtimensec = attr.ctimensec = entry.mtime_nsec;
+    attr.mode = entry.mode;
+    attr.nlink = fs.nlink[nodeid - 1];
+    attr.uid = entry.uid;
+    attr.gid = entry.gid;
+    // 内核按 new_decode_dev 解析设备号
+    uint32_t major_id = major(entry.rdev);
+    uint32_t minor_id = minor(entry.rdev);
+    attr.rdev = (minor_id & 0xff) | (major_id << 8) | ((minor_id & ~0xffu) << 12);
+    attr.blksize = 4096;
+}
+
+static void reply(int fuse_fd, uint64_t unique, int error, const void* data = nullptr, size_t size = 0) {
+    struct fuse_out_header out;
+    out.unique = unique;
+    out.error = -error;
+    out.len = sizeof(out) + (error == 0 ? size : 0);
+    struct iovec iov[2] = {{&out, sizeof(out)}, {const_cast<void*>(data), size}};
+    // 请求被中断时内核返回ENOENT，忽略即可
+    writev(fuse_fd, iov, error == 0 && size > 0 ? 2 : 1);
+}
+
+// 从仓库归档读取块，解压并校验后写入块缓存
+static bool fetch_chunk(const LazyFs& fs, const LazyChunk& chunk, std::string& data) {
+    std::string stored(chunk.stored_length, '\0');
+    ssize_t n = pread(fs.blob_fd, &stored[0], stored.size(), chunk.offset);
+    if (n != static_cast<ssize_t>(stored.size())) {
+        return false;
+    }
+    if (chunk.compressed) {
+#ifdef MYDOCKER_HAVE_ZLIB
+        data.assign(chunk.length, '\0');
+        uLongf length = chunk.length;
+        if (uncompress(reinterpret_cast<Bytef*>(&data[0]), &length, reinterpret_cast<const Bytef*>(stored.data()),
+                       stored.size()) != Z_OK || length != chunk.length) {
+            return false;
+        }
+#else
+        return false;
+#endif
+    } else {
+        data.swap(stored);
+    }
+    Sha256 hash;
+    hash.update(data.data(), data.size());
+    if (data.size() != chunk.length || hash.final_hex() != chunk.digest) {
+        return false;
+    }
+
+    // 写入失败（如磁盘已满）不影响本次读取，下次重新下载
+    std::string path = fs.chunk_dir + chunk.digest;
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        bool ok = write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+        close(fd);
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+        }
+    }
+    return true;
+}
+
+// 读取块内 [offset, offset+length) 追加到 out
+static bool read_chunk_range(const LazyFs& fs, const LazyChunk& chunk, size_t offset, size_t length,
+                             std::string& out) {
+    int fd = open((fs.chunk_dir + chunk.digest).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::string data;
+        if (!fetch_chunk(fs, chunk, data)) {
+            return false;
+        }
+        out.append(data, offset, length);
+        return true;
+    }
+    size_t old_size = out.size();
+    out.resize(old_size + length);
+    ssize_t n = pread(fd, &out[old_size], length, offset);
+    close(fd);
+    return n == static_cast<ssize_t>(length);
+}
+
+static int read_file(const LazyFs& fs, const LazyEntry& entry, uint64_t offset, uint32_t size, std::string& out) {
+    uint64_t end = std::min<uint64_t>(entry.size, offset + size);
+    while (offset < end) {
+        uint64_t index = offset / LAZY_CHUNK_SIZE;
+        size_t in_chunk = offset % LAZY_CHUNK_SIZE;
+        const LazyChunk& chunk = fs.toc.chunks[fs.toc.file_chunks[entry.first_chunk + index]];
+        size_t length = std::min<uint64_t>(end - offset, chunk.length - in_chunk);
+        if (!read_chunk_range(fs, chunk, in_chunk, length, out)) {
+            return EIO;
+        }
+        offset += length;
+    }
+    return 0;
+}
+
+static void handle_lookup(const LazyFs& fs, int fuse_fd, const fuse_in_header& in, const char* name) {
+    const LazyEntry* parent = lazyfs_node(fs, in.nodeid);
+    if (parent == nullptr || !S_ISDIR(parent->mode)) {
+        reply(fuse_fd, in.unique, ENOTDIR);
+        return;
+    }
+    const auto& list = fs.children[in.nodeid - 1];
+    auto it = std::lower_bound(list.begin(), list.end(), std::make_pair(std::string(name), uint32_t(0)));
+    if (it == list.end() || it->first != name) {
+        reply(fuse_fd, in.unique, ENOENT);
+        return;
+    }
+    struct fuse_entry_out out;
+    memset(&out, 0, sizeof(out));
+    out.nodeid = it->second + 1;
+    out.entry_valid = out.attr_valid = LAZYFS_CACHE_SECONDS;
+    fill_attr(fs, out.nodeid, out.attr);
+    reply(fuse_fd, in.unique, 0, &out, sizeof(out));
+}
+
+static void handle_readdir(const LazyFs& fs, int fuse_fd, const fuse_in_header& in, const fuse_read_in& arg) {
+    const LazyEntry* dir = lazyfs_node(fs, in.nodeid);
+    if (dir == nullptr || !S_ISDIR(dir->mode)) {
+        reply(fuse_fd, in.unique, ENOTDIR);
+        return;
+    }
+    // 偏移0、1为"."和".."，之后为子项
+    const auto& list = fs.children[in.nodeid - 1];
+    std::string out;
+    for (uint64_t offset = arg.offset; offset < list.size() + 2; ++offset) {
+        std::string name = offset == 0 ? "." : offset == 1 ? ".." : list[offset - 2].first;
+        uint64_t ino = offset == 0 ? in.nodeid : offset == 1 ? dir->parent + 1 : list[offset - 2].second + 1;
+        size_t record = FUSE_DIRENT_ALIGN(FUSE_NAME_OFFSET + name.size());
+        if (out.size() + record > arg.size) {
+            break;
+        }
+        size_t pos = out.size();
+        out.resize(pos + record, '\0');
+        struct fuse_dirent* dirent = reinterpret_cast<struct fuse_dirent*>(&out[pos]);
+        dirent->ino = ino;
+        dirent->off = offset + 1;
+        dirent->namelen = name.size();
+        dirent->type = (fs.toc.entries[ino - 1].mode & S_IFMT) >> 12;
+        memcpy(dirent->name, name.data(), name.size());
+    }
+    reply(fuse_fd, in.unique, 0, out.data(), out.size());
+}
+
+// GETXATTR/LISTXATTR：size为0时只返回所需长度
+static void reply_xattr(int fuse_fd, uint64_t unique, const std::string& value, uint32_t size) {
+    if (size == 0) {
+        struct fuse_getxattr_out out;
+        memset(&out, 0, sizeof(out));
+        out.size = value.size();
+        reply(fuse_fd, unique, 0, &out, sizeof(out));
+    } else if (size < value.size()) {
+        reply(fuse_fd, unique, ERANGE);
+    } else {
+        reply(fuse_fd, unique, 0, value.data(), value.size());
+    }
+}
+
+static void handle_request(const LazyFs& fs, int fuse_fd, const char* buffer, size_t length) {
+    const fuse_in_header& in = *reinterpret_cast<const fuse_in_header*>(buffer);
+    const char* arg = buffer + sizeof(fuse_in_header);
+    size_t arg_length = length - sizeof(fuse_in_header);
+    const LazyEntry* node = lazyfs_node(fs, in.nodeid);
+
+    switch (in.opcode) {
+        case FUSE_INIT: {
+            const fuse_init_in& init = *reinterpret_cast<const fuse_init_in*>(arg);
+            struct fuse_init_out out;
+            memset(&out, 0, sizeof(out));
+            out.major = FUSE_KERNEL_VERSION;
+            out.minor = std::min<uint32_t>(init.minor, FUSE_KERNEL_MINOR_VERSION);
+            out.max_readahead = init.max_readahead;
+            out.flags = init.flags & (FUSE_ASYNC_READ | FUSE_MAX_PAGES | FUSE_CACHE_SYMLINKS);
+            out.max_background = 16;
+            out.congestion_threshold = 12;
+            out.max_write = LAZYFS_MAX_WRITE;
+            out.time_gran = 1;
+            out.max_pages = LAZYFS_MAX_PAGES;
+            if (init.major != FUSE_KERNEL_VERSION) {
+                reply(fuse_fd, in.unique, EPROTO);
+            } else {
+                reply(fuse_fd, in.unique, 0, &out, sizeof(out));
+            }
+            return;
+        }
+        case FUSE_FORGET:
+        case FUSE_BATCH_FORGET:
+        case FUSE_INTERRUPT:
+            // 节点在进程生存期内不变，无需处理，也不回复
+            return;
+        case FUSE_DESTROY:
+            reply(fuse_fd, in.unique, 0);
+            return;
+        case FUSE_STATFS: {
+            struct fuse_statfs_out out;
+            memset(&out, 0, sizeof(out));
+            uint64_t bytes = 0;
+            for (const auto& entry : fs.toc.entries) bytes += entry.size;
+            out.st.bsize = out.st.frsize = 4096;
+            out.st.blocks = (bytes + 4095) / 4096;
+            out.st.files = fs.toc.entries.size();
+            out.st.namelen = 255;
+            reply(fuse_fd, in.unique, 0, &out, sizeof(out));
+            return;
+        }
+        default:
+            break;
+    }
+
+    if (node == nullptr) {
+        reply(fuse_fd, in.unique, ENOENT);
+        return;
+    }
+    switch (in.opcode) {
+        case FUSE_LOOKUP:
+            if (arg_length == 0 || arg[arg_length - 1] != '\0') {
+                reply(fuse_fd, in.unique, EINVAL);
+            } else {
+                handle_lookup(fs, fuse_fd, in, arg);
+            }
+            break;
+        case FUSE_GETATTR: {
+            struct fuse_attr_out out;
+            memset(&out, 0, sizeof(out));
+            out.attr_valid = LAZYFS_CACHE_SECONDS;
+            fill_attr(fs, in.nodeid, out.attr);
+            reply(fuse_fd, in.unique, 0, &out, sizeof(out));
+            break;
+        }
+        case FUSE_READLINK:
+            if (!S_ISLNK(node->mode)) {
+                reply(fuse_fd, in.unique, EINVAL);
+            } else {
+                reply(fuse_fd, in.unique, 0, node->link_target.data(), node->link_target.size());
+            }
+            break;
+        case FUSE_OPEN:
+        case FUSE_OPENDIR: {
+            const fuse_open_in& open_in = *reinterpret_cast<const fuse_open_in*>(arg);
+            if ((open_in.flags & O_ACCMODE) != O_RDONLY) {
+                reply(fuse_fd, in.unique, EROFS);
+                break;
+            }
+            struct fuse_open_out out;
+            memset(&out, 0, sizeof(out));
+            out.open_flags = FOPEN_KEEP_CACHE | (in.opcode == FUSE_OPENDIR ? FOPEN_CACHE_DIR : 0);
+            reply(fuse_fd, in.unique, 0, &out, sizeof(out));
+            break;
+        }
+        case FUSE_READ: {
+            const fuse_read_in& read_in = *reinterpret_cast<const fuse_read_in*>(arg);
+            std::string out;
+            int error = S_ISREG(node->mode) ? read_file(fs, *node, read_in.offset, read_in.size, out) : EISDIR;
+            reply(fuse_fd, in.unique, error, out.data(), out.size());
+            break;
+        }
+        case FUSE_READDIR:
+            handle_readdir(fs, fuse_fd, in, *reinterpret_cast<const fuse_read_in*>(arg));
+            break;
+        case FUSE_GETXATTR: {
+            const fuse_getxattr_in& xattr_in = *reinterpret_cast<const fuse_getxattr_in*>(arg);
+            const char* name = arg + sizeof(fuse_getxattr_in);
+            auto it = std::find_if(node->xattrs.begin(), node->xattrs.end(),
+                                   [&](const std::pair<std::string, std::string>& x) { return x.first == name; });
+            if (it == node->xattrs.end()) {
+                reply(fuse_fd, in.unique, ENODATA);
+            } else {
+                reply_xattr(fuse_fd, in.unique, it->second, xattr_in.size);
+            }
+            break;
+        }
+        case FUSE_LISTXATTR: {
+            const fuse_getxattr_in& xattr_in = *reinterpret_cast<const fuse_getxattr_in*>(arg);
+            std::string names;
+            for (const auto& xattr : node->xattrs) {
+                names += xattr.first;
+                names.push_back('\0');
+            }
+            reply_xattr(fuse_fd, in.unique, names, xattr_in.size);
+            break;
+        }
+        case FUSE_RELEASE:
+        case FUSE_RELEASEDIR:
+        case FUSE_FLUSH:
+            reply(fuse_fd, in.unique, 0);
+            break;
+        default:
+            reply(fuse_fd, in.unique, ENOSYS);
+            break;
+    }
+}
+
+static void run_lazyfs(const LazyFs& fs, int fuse_fd) {
+    std::vector<char> buffer(LAZYFS_BUFFER_SIZE);
+    while (true) {
+        ssize_t n = read(fuse_fd, buffer.data(), buffer.size());
+        if (n < 0) {
+            // ENOENT：请求在读取前被中断；ENODEV：文件系统已卸载
+            if (errno == EINTR || errno == EAGAIN || errno == ENOENT) continue;
+            return;
+        }
+        if (static_cast<size_t>(n) < sizeof(fuse_in_header)) {
+            continue;
+        }
+        handle_request(fs, fuse_fd, buffer.data(), n);
+    }
+}
+
+bool mount_lazyfs(const LazyToc& toc, const std::string& blob_path, const std::string& chunk_dir,
+                  const std::string& mount_point) {
+    int blob_fd = open(blob_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (blob_fd < 0) {
+        perror("[Lazy] Failed to open layer archive");
+        return false;
+    }
+    int fuse_fd = open("/dev/fuse", O_RDWR | O_CLOEXEC);
+    if (fuse_fd < 0) {
+        perror("[Lazy] Failed to open /dev/fuse");
+        close(blob_fd);
+        return false;
+    }
+    char options[256];
+    snprintf(options, sizeof(options),
+             "fd=%d,rootmode=%o,user_id=0,group_id=0,allow_other,default_permissions,max_read=%zu", fuse_fd,
+             toc.entries[0].mode & S_IFMT, LAZY_CHUNK_SIZE);
+    if (mount("mydocker-lazy", mount_point.c_str(), "fuse", MS_RDONLY | MS_NOATIME, options) != 0) {
+        perror("[Lazy] Failed to mount lazy layer");
+        close(fuse_fd);
+        close(blob_fd);
+        return false;
+    }
+
+    // 两次fork：服务进程交给init接管，在 run 退出后继续为容器提供文件
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        setsid();
+        if (fork() != 0) {
+            _exit(0);
+        }
+        signal(SIGINT, SIG_IGN);
+        signal(SIGHUP, SIG_IGN);
+        signal(SIGPIPE, SIG_IGN);
+        int null_fd = open("/dev/null", O_RDWR);
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        // 只保留FUSE连接和层归档，避免持有调用者的其他文件（锁、管道等）
+        close_other_fds({fuse_fd, blob_fd});
+        chdir("/");
+
+        LazyFs fs;
+        fs.toc = toc;
+        fs.blob_fd = blob_fd;
+        fs.chunk_dir = chunk_dir;
+        build_lazyfs_tree(fs);
+        run_lazyfs(fs, fuse_fd);
+        _exit(0);
+    }
+    close(fuse_fd);
+    close(blob_fd);
+    if (pid < 0) {
+        perror("[Lazy] fork failed");
+        umount2(mount_point.c_str(), MNT_DETACH);
+        return false;
+    }
+    waitpid(pid, nullptr, 0);
+    std::cout << "[Lazy] Mounted lazy layer at " << mount_point << std::endl;
+    return true;
+}
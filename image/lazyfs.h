@@ -0,0 +1,18 @@
+#ifndef LAZYFS_H
+#define LAZYFS_H
+
+#include <string>
+#include "lazy.h"
+
+// ==================== 按需加载层的FUSE文件系统 ====================
+// 直接读写 /dev/fuse 实现只读文件系统（不依赖libfuse）：
+//   LOOKUP/GETATTR/READDIR/READLINK/GETXATTR/LISTXATTR 只使用内存中的TOC
+//   READ 按偏移找到所需的块：块缓存中有则直接读取，否则从仓库归档读取、解压、校验后写入块缓存
+// 元数据不会变化，内核可以长期缓存目录项、属性和文件页（FOPEN_KEEP_CACHE）。
+// 服务进程是单线程的，与exec辅助进程一样两次fork后在后台运行，文件系统被卸载后退出。
+
+// 挂载 toc 描述的层到 mount_point，并启动服务进程；blob_path 为仓库中的层归档，chunk_dir 为块缓存目录
+bool mount_lazyfs(const LazyToc& toc, const std::string& blob_path, const std::string& chunk_dir,
+                  const std::string& mount_point);
+
+#endif // LAZYFS_H
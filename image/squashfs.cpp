@@ -0,0 +1,679 @@
+#include "squashfs.h"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#include <linux/loop.h>
+#include <linux/magic.h>
+#ifdef MYDOCKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static const uint32_t SQUASHFS_BLOCK_SIZE = 128 * 1024;
+static const uint16_t SQUASHFS_BLOCK_LOG = 17;
+static const size_t SQUASHFS_METADATA_SIZE = 8192;
+static const size_t SQUASHFS_SUPERBLOCK_SIZE = 96;
+// 元数据块头部的最高位、数据块大小的第24位表示未压缩
+static const uint16_t SQUASHFS_METADATA_UNCOMPRESSED = 0x8000;
+static const uint32_t SQUASHFS_DATA_UNCOMPRESSED = 1u << 24;
+static const uint64_t SQUASHFS_INVALID_BLOCK = ~0ULL;
+static const uint32_t SQUASHFS_INVALID_INDEX = 0xFFFFFFFF;
+static const uint16_t SQUASHFS_COMPRESSION_GZIP = 1;
+static const uint16_t SQUASHFS_FLAG_NO_FRAGMENTS = 0x0010;
+static const uint16_t SQUASHFS_FLAG_NO_XATTRS = 0x0200;
+// 目录表中每个头部最多256项，项内inode号相对头部的差值为16位有符号数
+static const size_t SQUASHFS_DIR_HEADER_ENTRIES = 256;
+static const int64_t SQUASHFS_DIR_INODE_DELTA = 32767;
+// 镜像按4KB对齐，满足loop设备 direct I/O 的要求
+static const uint64_t SQUASHFS_IMAGE_ALIGN = 4096;
+
+// inode类型：基本类型 1-7，扩展类型（带nlink/扩展属性/64位大小）为基本类型+7
+enum SquashfsType : uint16_t {
+    SQUASHFS_DIR = 1,
+    SQUASHFS_FILE,
+    SQUASHFS_SYMLINK,
+    SQUASHFS_BLKDEV,
+    SQUASHFS_CHRDEV,
+    SQUASHFS_FIFO,
+    SQUASHFS_SOCKET,
+};
+static const uint16_t SQUASHFS_EXTENDED = 7;
+
+static void put_u16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+static void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+static void put_u64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+static uint16_t basic_type(mode_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFDIR: return SQUASHFS_DIR;
+        case S_IFREG: return SQUASHFS_FILE;
+        case S_IFLNK: return SQUASHFS_SYMLINK;
+        case S_IFBLK: return SQUASHFS_BLKDEV;
+        case S_IFCHR: return SQUASHFS_CHRDEV;
+        case S_IFIFO: return SQUASHFS_FIFO;
+        default: return SQUASHFS_SOCKET;
+    }
+}
+
+// 压缩后更小时返回true；否则调用者原样存储
+static bool compress_block(const char* data, size_t length, std::string& out) {
+#ifdef MYDOCKER_HAVE_ZLIB
+    uLongf packed_length = compressBound(length);
+    out.resize(packed_length);
+    if (compress2(reinterpret_cast<Bytef*>(&out[0]), &packed_length, reinterpret_cast<const Bytef*>(data), length,
+                  Z_DEFAULT_COMPRESSION) == Z_OK && packed_length < length) {
+        out.resize(packed_length);
+        return true;
+    }
+#else
+    (void)data;
+    (void)length;
+    (void)out;
+#endif
+    return false;
+}
+
+// 元数据表：内容按8KB分块单独压缩，每块前有2字节的长度头
+class MetadataWriter {
+public:
+    // 下一个写入位置的引用：(所在块在表中的偏移 << 16) | 块内偏移
+    uint64_t position() const { return (static_cast<uint64_t>(output.size()) << 16) | buffer.size(); }
+
+    void append(const std::string& data) {
+        buffer += data;
+        while (buffer.size() >= SQUASHFS_METADATA_SIZE) {
+            flush_block(SQUASHFS_METADATA_SIZE);
+        }
+    }
+
+    const std::string& finish() {
+        if (!buffer.empty()) {
+            flush_block(buffer.size());
+        }
+        return output;
+    }
+
+    // 各块在表中的偏移（id表、扩展属性id表需要块索引）
+    std::vector<uint64_t> block_offsets;
+
+private:
+    void flush_block(size_t length) {
+        block_offsets.push_back(output.size());
+        std::string packed;
+        if (compress_block(buffer.data(), length, packed)) {
+            put_u16(output, packed.size());
+            output += packed;
+        } else {
+            put_u16(output, length | SQUASHFS_METADATA_UNCOMPRESSED);
+            output.append(buffer, 0, length);
+        }
+        buffer.erase(0, length);
+    }
+
+    std::string buffer;
+    std::string output;
+};
+
+struct SquashNode {
+    std::string path;
+    std::string name;
+    struct stat st;
+    std::vector<std::pair<std::string, std::string>> xattrs;
+    std::vector<uint32_t> children;     // 按名称排序
+    uint32_t parent = 0;
+    uint32_t link = UINT32_MAX;         // 硬链接：第一次出现的节点
+    uint32_t inode_number = 0;
+    uint32_t nlink = 1;
+    uint64_t ref = 0;                   // inode在inode表中的位置
+};
+
+class SquashfsWriter {
+public:
+    bool create(const std::string& source_dir, const std::string& image_path);
+    std::string error;
+
+private:
+    bool scan(const std::string& path, const std::string& name, uint32_t parent);
+    bool write_node(uint32_t index);
+    bool write_file_data(const SquashNode& node, uint64_t& start, uint64_t& sparse, std::string& block_list);
+    void write_directory(const SquashNode& node, uint32_t& start_block, uint16_t& offset, uint32_t& size);
+    uint16_t id_index(uint32_t id);
+    uint32_t xattr_index(const std::vector<std::pair<std::string, std::string>>& xattrs);
+    bool write_out(const std::string& data);
+    const SquashNode& target(uint32_t index) const {
+        return nodes[nodes[index].link != UINT32_MAX ? nodes[index].link : index];
+    }
+
+    std::vector<SquashNode> nodes;
+    std::map<std::pair<dev_t, ino_t>, uint32_t> links;
+    uint32_t inode_count = 0;
+    std::vector<uint32_t> ids;
+    std::map<uint32_t, uint16_t> id_map;
+    std::map<std::string, uint32_t> xattr_sets;     // 相同的扩展属性集合只存一份
+    MetadataWriter inodes;
+    MetadataWriter directories;
+    MetadataWriter xattr_values;
+    MetadataWriter xattr_ids;
+    int fd = -1;
+    uint64_t offset = 0;
+};
+
+bool SquashfsWriter::write_out(const std::string& data) {
+    const char* ptr = data.data();
+    size_t length = data.size();
+    while (length > 0) {
+        ssize_t n = write(fd, ptr, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            error = std::string("write: ") + strerror(errno);
+            return false;
+        }
+        ptr += n;
+        length -= n;
+    }
+    offset += data.size();
+    return true;
+}
+
+uint16_t SquashfsWriter::id_index(uint32_t id) {
+    auto it = id_map.find(id);
+    if (it != id_map.end()) {
+        return it->second;
+    }
+    uint16_t index = ids.size();
+    ids.push_back(id);
+    id_map[id] = index;
+    return index;
+}
+
+// squashfs只支持 user./trusted./security. 前缀，名称中不保存前缀
+uint32_t SquashfsWriter::xattr_index(const std::vector<std::pair<std::string, std::string>>& xattrs) {
+    static const char* prefixes[] = {"user.", "trusted.", "security."};
+    std::string pairs;
+    uint32_t count = 0;
+    for (const auto& xattr : xattrs) {
+        for (uint16_t type = 0; type < 3; ++type) {
+            size_t prefix_length = strlen(prefixes[type]);
+            if (xattr.first.compare(0, prefix_length, prefixes[type]) == 0) {
+                put_u16(pairs, type);
+                put_u16(pairs, xattr.first.size() - prefix_length);
+                pairs.append(xattr.first, prefix_length, std::string::npos);
+                put_u32(pairs, xattr.second.size());
+                pairs += xattr.second;
+                count++;
+                break;
+            }
+        }
+    }
+    if (count == 0) {
+        return SQUASHFS_INVALID_INDEX;
+    }
+    auto it = xattr_sets.find(pairs);
+    if (it != xattr_sets.end()) {
+        return it->second;
+    }
+    std::string entry;
+    put_u64(entry, xattr_values.position());
+    put_u32(entry, count);
+    put_u32(entry, pairs.size());
+    xattr_values.append(pairs);
+    xattr_ids.append(entry);
+    uint32_t index = xattr_sets.size();
+    xattr_sets[pairs] = index;
+    return index;
+}
+
+// 先序遍历：建立节点树、分配inode号、识别硬链接
+bool SquashfsWriter::scan(const std::string& path, const std::string& name, uint32_t parent) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    uint32_t index = nodes.size();
+    nodes.emplace_back();
+    nodes[index].path = path;
+    nodes[index].name = name;
+    nodes[index].st = st;
+    nodes[index].parent = parent;
+    if (index > 0) {
+        nodes[parent].children.push_back(index);
+    }
+
+    auto key = std::make_pair(st.st_dev, st.st_ino);
+    if (!S_ISDIR(st.st_mode) && st.st_nlink > 1) {
+        auto it = links.find(key);
+        if (it != links.end()) {
+            nodes[index].link = it->second;
+            nodes[it->second].nlink++;
+            return true;
+        }
+        links[key] = index;
+    }
+    nodes[index].inode_number = ++inode_count;
+
+    ssize_t list_size = llistxattr(path.c_str(), nullptr, 0);
+    if (list_size > 0) {
+        std::vector<char> names(list_size);
+        list_size = llistxattr(path.c_str(), names.data(), names.size());
+        for (ssize_t pos = 0; pos < list_size; pos += strlen(names.data() + pos) + 1) {
+            const char* xattr_name = names.data() + pos;
+            ssize_t value_size = lgetxattr(path.c_str(), xattr_name, nullptr, 0);
+            if (value_size < 0) continue;
+            std::vector<char> value(value_size);
+            value_size = lgetxattr(path.c_str(), xattr_name, value.data(), value.size());
+            if (value_size >= 0) {
+                nodes[index].xattrs.emplace_back(xattr_name, std::string(value.data(), value_size));
+            }
+        }
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        return true;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    // 内核查找目录项时依赖按名称排序
+    std::sort(names.begin(), names.end());
+    for (const auto& child : names) {
+        if (!scan(path + "/" + child, child, index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SquashfsWriter::write_file_data(const SquashNode& node, uint64_t& start, uint64_t& sparse,
+                                     std::string& block_list) {
+    int in_fd = open(node.path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (in_fd < 0) {
+        error = node.path + ": " + strerror(errno);
+        return false;
+    }
+    start = offset;
+    sparse = 0;
+    std::vector<char> buffer(SQUASHFS_BLOCK_SIZE);
+    std::string packed;
+    uint64_t total = 0;
+    bool ok = true;
+    while (ok) {
+        size_t filled = 0;
+        while (filled < buffer.size()) {
+            ssize_t n = read(in_fd, buffer.data() + filled, buffer.size() - filled);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                error = node.path + ": " + strerror(errno);
+                ok = false;
+            }
+            if (n <= 0) break;
+            filled += n;
+        }
+        if (!ok || filled == 0) break;
+        total += filled;
+
+        if (std::all_of(buffer.begin(), buffer.begin() + filled, [](char c) { return c == 0; })) {
+            // 全零块不存储，读取时由内核填零
+            put_u32(block_list, 0);
+            sparse += filled;
+        } else if (compress_block(buffer.data(), filled, packed)) {
+            put_u32(block_list, packed.size());
+            ok = write_out(packed);
+        } else {
+            put_u32(block_list, filled | SQUASHFS_DATA_UNCOMPRESSED);
+            ok = write_out(std::string(buffer.data(), filled));
+        }
+        if (filled < buffer.size()) break;
+    }
+    close(in_fd);
+    if (ok && total != static_cast<uint64_t>(node.st.st_size)) {
+        error = node.path + ": file changed while packing";
+        ok = false;
+    }
+    return ok;
+}
+
+void SquashfsWriter::write_directory(const SquashNode& node, uint32_t& start_block, uint16_t& offset_in_block,
+                                     uint32_t& size) {
+    std::string listing;
+    const auto& children = node.children;
+    size_t i = 0;
+    while (i < children.size()) {
+        // 同一头部下的项：inode位于同一元数据块，inode号与基准的差值在16位范围内
+        const SquashNode& first = target(children[i]);
+        uint32_t block = first.ref >> 16;
+        uint32_t base = first.inode_number;
+        size_t j = i;
+        while (j < children.size() && j - i < SQUASHFS_DIR_HEADER_ENTRIES) {
+            const SquashNode& child = target(children[j]);
+            int64_t delta = static_cast<int64_t>(child.inode_number) - base;
+            if ((child.ref >> 16) != block || delta > SQUASHFS_DIR_INODE_DELTA || delta < -SQUASHFS_DIR_INODE_DELTA) {
+                break;
+            }
+            j++;
+        }
+        put_u32(listing, j - i - 1);
+        put_u32(listing, block);
+        put_u32(listing, base);
+        for (size_t k = i; k < j; ++k) {
+            const SquashNode& child = target(children[k]);
+            const std::string& name = nodes[children[k]].name;
+            put_u16(listing, child.ref & 0xffff);
+            put_u16(listing, static_cast<uint16_t>(static_cast<int16_t>(child.inode_number - base)));
+            put_u16(listing, basic_type(child.st.st_mode));
+            put_u16(listing, name.size() - 1);
+            listing += name;
+        }
+        i = j;
+    }
+    start_block = directories.position() >> 16;
+    offset_in_block = directories.position() & 0xffff;
+    directories.append(listing);
+    // 目录大小包含内核虚拟的"."和".."（3字节）
+    size = listing.size() + 3;
+}
+
+// 后序遍历：子项的inode先写入，目录项才能引用它们的位置
+bool SquashfsWriter::write_node(uint32_t index) {
+    if (nodes[index].link != UINT32_MAX) {
+        return true;
+    }
+    std::vector<uint32_t> children = nodes[index].children;
+    for (uint32_t child : children) {
+        if (!write_node(child)) {
+            return false;
+        }
+    }
+
+    SquashNode& node = nodes[index];
+    const struct stat& st = node.st;
+    uint32_t xattr = node.xattrs.empty() ? SQUASHFS_INVALID_INDEX : xattr_index(node.xattrs);
+    bool extended = xattr != SQUASHFS_INVALID_INDEX;
+    std::string inode;
+    auto header = [&](uint16_t type) {
+        put_u16(inode, type);
+        put_u16(inode, st.st_mode & 07777);
+        put_u16(inode, id_index(st.st_uid));
+        put_u16(inode, id_index(st.st_gid));
+        put_u32(inode, st.st_mtime);
+        put_u32(inode, node.inode_number);
+    };
+
+    if (S_ISDIR(st.st_mode)) {
+        uint32_t start_block, size;
+        uint16_t offset_in_block;
+        write_directory(node, start_block, offset_in_block, size);
+        uint32_t nlink = 2;
+        for (uint32_t child : children) {
+            if (nodes[child].link == UINT32_MAX && S_ISDIR(nodes[child].st.st_mode)) nlink++;
+        }
+        // 根目录的父inode号按惯例为inode总数+1
+        uint32_t parent_inode = index == 0 ? inode_count + 1 : nodes[node.parent].inode_number;
+        if (!extended && size <= 0xffff) {
+            header(SQUASHFS_DIR);
+            put_u32(inode, start_block);
+            put_u32(inode, nlink);
+            put_u16(inode, size);
+            put_u16(inode, offset_in_block);
+            put_u32(inode, parent_inode);
+        } else {
+            header(SQUASHFS_DIR + SQUASHFS_EXTENDED);
+            put_u32(inode, nlink);
+            put_u32(inode, size);
+            put_u32(inode, start_block);
+            put_u32(inode, parent_inode);
+            put_u16(inode, 0);
+            put_u16(inode, offset_in_block);
+            put_u32(inode, xattr);
+        }
+    } else if (S_ISREG(st.st_mode)) {
+        uint64_t start, sparse;
+        std::string block_list;
+        if (!write_file_data(node, start, sparse, block_list)) {
+            return false;
+        }
+        uint64_t size = st.st_size;
+        if (!extended && node.nlink == 1 && start <= UINT32_MAX && size <= UINT32_MAX) {
+            header(SQUASHFS_FILE);
+            put_u32(inode, start);
+            put_u32(inode, SQUASHFS_INVALID_INDEX);
+            put_u32(inode, 0);
+            put_u32(inode, size);
+        } else {
+            header(SQUASHFS_FILE + SQUASHFS_EXTENDED);
+            put_u64(inode, start);
+            put_u64(inode, size);
+            put_u64(inode, sparse);
+            put_u32(inode, node.nlink);
+            put_u32(inode, SQUASHFS_INVALID_INDEX);
+            put_u32(inode, 0);
+            put_u32(inode, xattr);
+        }
+        inode += block_list;
+    } else if (S_ISLNK(st.st_mode)) {
+        std::vector<char> link_target(st.st_size + 1);
+        ssize_t length = readlink(node.path.c_str(), link_target.data(), link_target.size());
+        if (length < 0) {
+            error = node.path + ": " + strerror(errno);
+            return false;
+        }
+        header(extended ? SQUASHFS_SYMLINK + SQUASHFS_EXTENDED : SQUASHFS_SYMLINK);
+        put_u32(inode, node.nlink);
+        put_u32(inode, length);
+        inode.append(link_target.data(), length);
+        if (extended) put_u32(inode, xattr);
+    } else {
+        // 设备、FIFO、socket；字符设备0/0为OverlayFS的whiteout
+        uint16_t type = basic_type(st.st_mode);
+        header(extended ? type + SQUASHFS_EXTENDED : type);
+        put_u32(inode, node.nlink);
+        if (S_ISBLK(st.st_mode) || S_ISCHR(st.st_mode)) {
+            // 内核按 new_decode_dev 解析设备号
+            uint32_t major_id = major(st.st_rdev);
+            uint32_t minor_id = minor(st.st_rdev);
+            put_u32(inode, (minor_id & 0xff) | (major_id << 8) | ((minor_id & ~0xffu) << 12));
+        }
+        if (extended) put_u32(inode, xattr);
+    }
+    node.ref = inodes.position();
+    inodes.append(inode);
+    return true;
+}
+
+bool SquashfsWriter::create(const std::string& source_dir, const std::string& image_path) {
+    std::string root = source_dir;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    if (!scan(root, "", 0)) {
+        return false;
+    }
+    if (!S_ISDIR(nodes[0].st.st_mode)) {
+        error = root + ": not a directory";
+        return false;
+    }
+    fd = open(image_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = image_path + ": " + strerror(errno);
+        return false;
+    }
+
+    // 布局：超级块、数据块、inode表、目录表、id表、扩展属性表（内核要求各表按此顺序紧邻）
+    bool ok = write_out(std::string(SQUASHFS_SUPERBLOCK_SIZE, '\0')) && write_node(0);
+    uint64_t inode_table_start = offset;
+    ok = ok && write_out(inodes.finish());
+    uint64_t directory_table_start = offset;
+    ok = ok && write_out(directories.finish());
+
+    MetadataWriter id_writer;
+    for (uint32_t id : ids) {
+        std::string value;
+        put_u32(value, id);
+        id_writer.append(value);
+    }
+    uint64_t id_blocks_start = offset;
+    ok = ok && write_out(id_writer.finish());
+    std::string id_index_table;
+    for (uint64_t block : id_writer.block_offsets) {
+        put_u64(id_index_table, id_blocks_start + block);
+    }
+    uint64_t id_table_start = offset;
+    ok = ok && write_out(id_index_table);
+
+    uint64_t xattr_id_table_start = SQUASHFS_INVALID_BLOCK;
+    if (ok && !xattr_sets.empty()) {
+        uint64_t xattr_table_start = offset;
+        ok = write_out(xattr_values.finish());
+        uint64_t xattr_ids_start = offset;
+        ok = ok && write_out(xattr_ids.finish());
+        std::string xattr_table;
+        put_u64(xattr_table, xattr_table_start);
+        put_u32(xattr_table, xattr_sets.size());
+        put_u32(xattr_table, 0);
+        for (uint64_t block : xattr_ids.block_offsets) {
+            put_u64(xattr_table, xattr_ids_start + block);
+        }
+        xattr_id_table_start = offset;
+        ok = ok && write_out(xattr_table);
+    }
+    uint64_t bytes_used = offset;
+    if (ok && offset % SQUASHFS_IMAGE_ALIGN != 0) {
+        ok = write_out(std::string(SQUASHFS_IMAGE_ALIGN - offset % SQUASHFS_IMAGE_ALIGN, '\0'));
+    }
+
+    std::string superblock;
+    put_u32(superblock, SQUASHFS_MAGIC);
+    put_u32(superblock, inode_count);
+    put_u32(superblock, nodes[0].st.st_mtime);
+    put_u32(superblock, SQUASHFS_BLOCK_SIZE);
+    put_u32(superblock, 0);     // 片段数
+    put_u16(superblock, SQUASHFS_COMPRESSION_GZIP);
+    put_u16(superblock, SQUASHFS_BLOCK_LOG);
+    put_u16(superblock, SQUASHFS_FLAG_NO_FRAGMENTS | (xattr_sets.empty() ? SQUASHFS_FLAG_NO_XATTRS : 0));
+    put_u16(superblock, ids.size());
+    put_u16(superblock, 4);     // 版本 4.0
+    put_u16(superblock, 0);
+    put_u64(superblock, nodes[0].ref);
+    put_u64(superblock, bytes_used);
+    put_u64(superblock, id_table_start);
+    put_u64(superblock, xattr_id_table_start);
+    put_u64(superblock, inode_table_start);
+    put_u64(superblock, directory_table_start);
+    put_u64(superblock, SQUASHFS_INVALID_BLOCK);   // 片段表
+    put_u64(superblock, SQUASHFS_INVALID_BLOCK);   // 导出表（不支持NFS导出）
+    if (ok && pwrite(fd, superblock.data(), superblock.size(), 0) != static_cast<ssize_t>(superblock.size())) {
+        error = std::string("write: ") + strerror(errno);
+        ok = false;
+    }
+    if (close(fd) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool squashfs_create(const std::string& source_dir, const std::string& image_path) {
+    SquashfsWriter writer;
+    if (!writer.create(source_dir, image_path)) {
+        std::cerr << "[Image] Failed to create squashfs image: " << writer.error << std::endl;
+        unlink(image_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 取得空闲loop设备并关联镜像文件；其他进程同时取得同一设备时重试
+static int attach_loop_device(int image_fd, const std::string& image_path, std::string& loop_path) {
+    int control_fd = open("/dev/loop-control", O_RDWR | O_CLOEXEC);
+    if (control_fd < 0) {
+        perror("[Image] Failed to open /dev/loop-control");
+        return -1;
+    }
+    int loop_fd = -1;
+    for (int attempt = 0; attempt < 8 && loop_fd < 0; ++attempt) {
+        int number = ioctl(control_fd, LOOP_CTL_GET_FREE);
+        if (number < 0) {
+            perror("[Image] No free loop device");
+            break;
+        }
+        loop_path = "/dev/loop" + std::to_string(number);
+        loop_fd = open(loop_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (loop_fd < 0 && errno == ENOENT) {
+            // 没有devtmpfs自动创建设备节点时自行创建
+            mknod(loop_path.c_str(), S_IFBLK | 0660, makedev(7, number));
+            loop_fd = open(loop_path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (loop_fd < 0) {
+            perror("[Image] Failed to open loop device");
+            break;
+        }
+        struct loop_config config;
+        memset(&config, 0, sizeof(config));
+        config.fd = image_fd;
+        config.block_size = SQUASHFS_IMAGE_ALIGN;
+        config.info.lo_flags = LO_FLAGS_READ_ONLY | LO_FLAGS_AUTOCLEAR | LO_FLAGS_DIRECT_IO;
+        strncpy(reinterpret_cast<char*>(config.info.lo_file_name), image_path.c_str(), LO_NAME_SIZE - 1);
+        if (ioctl(loop_fd, LOOP_CONFIGURE, &config) != 0) {
+            int saved = errno;
+            close(loop_fd);
+            loop_fd = -1;
+            if (saved != EBUSY) {
+                errno = saved;
+                perror("[Image] Failed to configure loop device");
+                break;
+            }
+        }
+    }
+    close(control_fd);
+    return loop_fd;
+}
+
+bool squashfs_mount(const std::string& image_path, const std::string& mount_point) {
+    int image_fd = open(image_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (image_fd < 0) {
+        perror("[Image] Failed to open squashfs image");
+        return false;
+    }
+    std::string loop_path;
+    int loop_fd = attach_loop_device(image_fd, image_path, loop_path);
+    close(image_fd);
+    if (loop_fd < 0) {
+        return false;
+    }
+    bool ok = mount(loop_path.c_str(), mount_point.c_str(), "squashfs", MS_RDONLY, nullptr) == 0;
+    if (!ok) {
+        perror("[Image] Failed to mount squashfs image");
+    }
+    // 自动释放：挂载持有loop设备；挂载失败或卸载后关闭最后一个引用时设备被释放
+    close(loop_fd);
+    return ok;
+}
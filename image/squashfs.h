@@ -0,0 +1,22 @@
+#ifndef SQUASHFS_H
+#define SQUASHFS_H
+
+#include <string>
+
+// ==================== squashfs 层镜像 ====================
+// 把层目录打包为单个压缩的只读文件系统镜像（squashfs 4.0），由内核直接挂载，不需要mksquashfs：
+//   - 文件数据按 128KB 分块单独压缩（zlib，即squashfs的gzip格式），压缩后不更小的块原样存储，全零块记为稀疏块；
+//     不使用片段（fragment），每个文件的最后一块单独存储
+//   - inode表、目录表、uid/gid表和扩展属性表为8KB的元数据块，同样单独压缩
+//   - 保留属主、权限、时间、扩展属性（OverlayFS 的 opaque 等 trusted.* 标记）、硬链接、符号链接和设备文件
+// 挂载使用loop设备（LOOP_CONFIGURE：只读、卸载后自动释放、direct I/O）。
+// direct I/O 使镜像文件本身不进入页缓存，只有squashfs解压后的页被缓存一份，
+// 所有以该层为lowerdir的容器共享这些页。
+
+// 将 source_dir 打包为 image_path（整个文件重写）
+bool squashfs_create(const std::string& source_dir, const std::string& image_path);
+
+// 通过loop设备只读挂载镜像
+bool squashfs_mount(const std::string& image_path, const std::string& mount_point);
+
+#endif // SQUASHFS_H
@@ -0,0 +1,1218 @@
+#include "tar.h"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#ifdef MYDOCKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef MYDOCKER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const size_t TAR_BLOCK_SIZE = 512;
+// 每个gzip成员压缩前的大小，也是并行解压的粒度
+static const size_t GZIP_MEMBER_SIZE = 1 << 20;
+// gzip成员头：10字节固定头 + 2字节XLEN + 12字节"MD"子字段（成员总长度、解压后长度）
+static const size_t GZIP_MEMBER_HEADER_SIZE = 24;
+static const size_t GZIP_MEMBER_TRAILER_SIZE = 8;
+
+static unsigned worker_count() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static void put_le32(unsigned char* p, uint32_t value) {
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+    p[2] = (value >> 16) & 0xff;
+    p[3] = (value >> 24) & 0xff;
+}
+
+static uint32_t get_le32(const unsigned char* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// 完整读取len字节，返回实际读取的字节数（小于len表示EOF）
+static size_t read_full(int fd, void* buffer, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = read(fd, static_cast<char*>(buffer) + total, len - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += n;
+    }
+    return total;
+}
+
+static bool write_full(int fd, const void* buffer, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = write(fd, static_cast<const char*>(buffer) + total, len - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        total += n;
+    }
+    return true;
+}
+
+// ==================== 输入流 ====================
+
+class ArchiveInput {
+public:
+    virtual ~ArchiveInput() {}
+    // 读取最多len字节，返回0表示结束，-1表示错误
+    virtual ssize_t read(void* buffer, size_t len) = 0;
+};
+
+// 未压缩的tar
+class FileInput : public ArchiveInput {
+public:
+    explicit FileInput(int fd) : fd(fd) {}
+    ssize_t read(void* buffer, size_t len) override {
+        ssize_t n;
+        do {
+            n = ::read(fd, buffer, len);
+        } while (n < 0 && errno == EINTR);
+        return n;
+    }
+private:
+    int fd;
+};
+
+#ifdef MYDOCKER_HAVE_ZLIB
+// 普通gzip（可能包含多个成员），顺序流式解压
+class GzipInput : public ArchiveInput {
+public:
+    explicit GzipInput(int fd) : fd(fd), input(1 << 16), finished(false) {
+        memset(&stream, 0, sizeof(stream));
+        valid = inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK;
+    }
+    ~GzipInput() override {
+        inflateEnd(&stream);
+    }
+    ssize_t read(void* buffer, size_t len) override {
+        if (!valid) return -1;
+        stream.next_out = static_cast<Bytef*>(buffer);
+        stream.avail_out = len;
+        while (stream.avail_out == len && !finished) {
+            if (stream.avail_in == 0) {
+                ssize_t n = read_full(fd, input.data(), input.size());
+                if (n == 0) {
+                    finished = true;
+                    break;
+                }
+                stream.next_in = input.data();
+                stream.avail_in = n;
+            }
+            int ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // 多成员gzip：继续解压下一个成员
+                inflateReset(&stream);
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                std::cerr << "[Tar] gzip data error: " << (stream.msg ? stream.msg : "") << std::endl;
+                return -1;
+            }
+        }
+        return len - stream.avail_out;
+    }
+private:
+    int fd;
+    z_stream stream;
+    std::vector<Bytef> input;
+    bool valid;
+    bool finished;
+};
+
+// 分块gzip：按成员批量读取，在多个线程中并行解压，再按顺序输出
+class ParallelGzipInput : public ArchiveInput {
+public:
+    explicit ParallelGzipInput(int fd) : fd(fd), current(0), offset(0), finished(false) {}
+
+    ssize_t read(void* buffer, size_t len) override {
+        while (current >= batch.size() || offset >= batch[current].output.size()) {
+            if (current < batch.size()) {
+                current++;
+                offset = 0;
+                continue;
+            }
+            if (finished) return 0;
+            if (!fill_batch()) return -1;
+            if (batch.empty()) return 0;
+        }
+        Member& member = batch[current];
+        size_t n = std::min(len, member.output.size() - offset);
+        memcpy(buffer, member.output.data() + offset, n);
+        offset += n;
+        return n;
+    }
+
+private:
+    struct Member {
+        std::vector<unsigned char> compressed;
+        std::vector<unsigned char> output;
+        bool ok = false;
+    };
+
+    // 读取一个成员的压缩数据，返回false表示格式错误，EOF时compressed为空
+    bool read_member(Member& member) {
+        unsigned char header[GZIP_MEMBER_HEADER_SIZE];
+        size_t n = read_full(fd, header, sizeof(header));
+        if (n == 0) {
+            return true;
+        }
+        if (n != sizeof(header) || header[0] != 0x1f || header[1] != 0x8b || !(header[3] & 0x04) ||
+            header[12] != 'M' || header[13] != 'D') {
+            std::cerr << "[Tar] Invalid gzip member header" << std::endl;
+            return false;
+        }
+        uint32_t member_size = get_le32(header + 16);
+        uint32_t raw_size = get_le32(header + 20);
+        if (member_size < GZIP_MEMBER_HEADER_SIZE + GZIP_MEMBER_TRAILER_SIZE) {
+            return false;
+        }
+        member.compressed.resize(member_size);
+        memcpy(member.compressed.data(), header, sizeof(header));
+        size_t rest = member_size - sizeof(header);
+        if (read_full(fd, member.compressed.data() + sizeof(header), rest) != rest) {
+            std::cerr << "[Tar] Truncated gzip member" << std::endl;
+            return false;
+        }
+        member.output.resize(raw_size);
+        return true;
+    }
+
+    static void inflate_member(Member& member) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return;
+        }
+        size_t size = member.compressed.size();
+        stream.next_in = member.compressed.data() + GZIP_MEMBER_HEADER_SIZE;
+        stream.avail_in = size - GZIP_MEMBER_HEADER_SIZE - GZIP_MEMBER_TRAILER_SIZE;
+        stream.next_out = member.output.data();
+        stream.avail_out = member.output.size();
+        int ret = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        const unsigned char* trailer = member.compressed.data() + size - GZIP_MEMBER_TRAILER_SIZE;
+        uint32_t crc = crc32(0, member.output.data(), member.output.size());
+        member.ok = ret == Z_STREAM_END && stream.avail_out == 0 &&
+                    crc == get_le32(trailer) && member.output.size() == get_le32(trailer + 4);
+        member.compressed.clear();
+        member.compressed.shrink_to_fit();
+    }
+
+    bool fill_batch() {
+        batch.clear();
+        current = 0;
+        offset = 0;
+        unsigned workers = worker_count();
+        // 每个线程一次处理两个成员，减少批次之间的等待
+        size_t batch_size = workers * 2;
+        while (batch.size() < batch_size) {
+            Member member;
+            if (!read_member(member)) return false;
+            if (member.compressed.empty()) {
+                finished = true;
+                break;
+            }
+            batch.push_back(std::move(member));
+        }
+
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers && w < batch.size(); ++w) {
+            threads.emplace_back([this, w, workers]() {
+                for (size_t i = w; i < batch.size(); i += workers) {
+                    inflate_member(batch[i]);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& member : batch) {
+            if (!member.ok) {
+                std::cerr << "[Tar] gzip member checksum mismatch" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int fd;
+    std::vector<Member> batch;
+    size_t current;
+    size_t offset;
+    bool finished;
+};
+#endif
+
+#ifdef MYDOCKER_HAVE_ZSTD
+// zstd（可能包含多个帧），顺序流式解压
+class ZstdInput : public ArchiveInput {
+public:
+    explicit ZstdInput(int fd) : fd(fd), input(ZSTD_DStreamInSize()), in_pos(0), in_size(0), finished(false) {
+        stream = ZSTD_createDStream();
+        ZSTD_initDStream(stream);
+    }
+    ~ZstdInput() override {
+        ZSTD_freeDStream(stream);
+    }
+    ssize_t read(void* buffer, size_t len) override {
+        ZSTD_outBuffer out = {buffer, len, 0};
+        while (out.pos == 0 && !finished) {
+            if (in_pos == in_size) {
+                in_size = read_full(fd, input.data(), input.size());
+                in_pos = 0;
+                if (in_size == 0) {
+                    finished = true;
+                    break;
+                }
+            }
+            ZSTD_inBuffer in = {input.data(), in_size, in_pos};
+            size_t ret = ZSTD_decompressStream(stream, &out, &in);
+            in_pos = in.pos;
+            if (ZSTD_isError(ret)) {
+                std::cerr << "[Tar] zstd data error: " << ZSTD_getErrorName(ret) << std::endl;
+                return -1;
+            }
+        }
+        return out.pos;
+    }
+private:
+    int fd;
+    ZSTD_DStream* stream;
+    std::vector<char> input;
+    size_t in_pos;
+    size_t in_size;
+    bool finished;
+};
+#endif
+
+// 根据文件头选择解压方式
+static std::unique_ptr<ArchiveInput> open_archive_input(int fd) {
+    unsigned char magic[16] = {0};
+    ssize_t n = pread(fd, magic, sizeof(magic), 0);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+#ifdef MYDOCKER_HAVE_ZLIB
+        if (n >= 14 && (magic[3] & 0x04) && magic[12] == 'M' && magic[13] == 'D') {
+            return std::unique_ptr<ArchiveInput>(new ParallelGzipInput(fd));
+        }
+        return std::unique_ptr<ArchiveInput>(new GzipInput(fd));
+#else
+        std::cerr << "[Tar] gzip archives require zlib support" << std::endl;
+        return nullptr;
+#endif
+    }
+    if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#ifdef MYDOCKER_HAVE_ZSTD
+        return std::unique_ptr<ArchiveInput>(new ZstdInput(fd));
+#else
+        std::cerr << "[Tar] zstd archives require libzstd support" << std::endl;
+        return nullptr;
+#endif
+    }
+    return std::unique_ptr<ArchiveInput>(new FileInput(fd));
+}
+
+// ==================== 输出流 ====================
+
+class ArchiveOutput {
+public:
+    virtual ~ArchiveOutput() {}
+    virtual bool write(const void* data, size_t len) = 0;
+    virtual bool finish() = 0;
+};
+
+class FileOutput : public ArchiveOutput {
+public:
+    explicit FileOutput(int fd) : fd(fd), buffer() {
+        buffer.reserve(1 << 16);
+    }
+    bool write(const void* data, size_t len) override {
+        const char* bytes = static_cast<const char*>(data);
+        if (buffer.size() + len > buffer.capacity()) {
+            if (!flush()) return false;
+            if (len >= buffer.capacity()) {
+                return write_full(fd, bytes, len);
+            }
+        }
+        buffer.insert(buffer.end(), bytes, bytes + len);
+        return true;
+    }
+    bool finish() override {
+        return flush();
+    }
+private:
+    bool flush() {
+        bool ok = write_full(fd, buffer.data(), buffer.size());
+        buffer.clear();
+        return ok;
+    }
+    int fd;
+    std::vector<char> buffer;
+};
+
+#ifdef MYDOCKER_HAVE_ZLIB
+// 分块gzip：每 GZIP_MEMBER_SIZE 字节压缩为一个独立的gzip成员，多个成员并行压缩
+class ParallelGzipOutput : public ArchiveOutput {
+public:
+    explicit ParallelGzipOutput(int fd) : fd(fd) {}
+
+    bool write(const void* data, size_t len) override {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        while (len > 0) {
+            if (pending.empty() || pending.back().size() == GZIP_MEMBER_SIZE) {
+                if (pending.size() == worker_count() * 2 && !flush_batch()) {
+                    return false;
+                }
+                pending.emplace_back();
+                pending.back().reserve(GZIP_MEMBER_SIZE);
+            }
+            std::vector<unsigned char>& block = pending.back();
+            size_t n = std::min(len, GZIP_MEMBER_SIZE - block.size());
+            block.insert(block.end(), bytes, bytes + n);
+            bytes += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    bool finish() override {
+        return flush_batch();
+    }
+
+private:
+    static bool deflate_member(const std::vector<unsigned char>& block, std::vector<unsigned char>& member) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        size_t bound = deflateBound(&stream, block.size());
+        member.resize(GZIP_MEMBER_HEADER_SIZE + bound + GZIP_MEMBER_TRAILER_SIZE);
+        stream.next_in = const_cast<Bytef*>(block.data());
+        stream.avail_in = block.size();
+        stream.next_out = member.data() + GZIP_MEMBER_HEADER_SIZE;
+        stream.avail_out = bound;
+        int ret = deflate(&stream, Z_FINISH);
+        size_t compressed_size = bound - stream.avail_out;
+        deflateEnd(&stream);
+        if (ret != Z_STREAM_END) {
+            return false;
+        }
+
+        size_t member_size = GZIP_MEMBER_HEADER_SIZE + compressed_size + GZIP_MEMBER_TRAILER_SIZE;
+        member.resize(member_size);
+        unsigned char* header = member.data();
+        memset(header, 0, GZIP_MEMBER_HEADER_SIZE);
+        header[0] = 0x1f;
+        header[1] = 0x8b;
+        header[2] = 8;      // deflate
+        header[3] = 0x04;   // FEXTRA
+        header[9] = 255;    // OS: unknown
+        header[10] = 12;    // XLEN
+        header[12] = 'M';
+        header[13] = 'D';
+        header[14] = 8;     // 子字段长度
+        put_le32(header + 16, member_size);
+        put_le32(header + 20, block.size());
+
+        unsigned char* trailer = member.data() + member_size - GZIP_MEMBER_TRAILER_SIZE;
+        put_le32(trailer, crc32(0, block.data(), block.size()));
+        put_le32(trailer + 4, block.size());
+        return true;
+    }
+
+    bool flush_batch() {
+        std::vector<std::vector<unsigned char>> members(pending.size());
+        std::vector<char> results(pending.size(), 0);
+        unsigned workers = worker_count();
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers && w < pending.size(); ++w) {
+            threads.emplace_back([&, w]() {
+                for (size_t i = w; i < pending.size(); i += workers) {
+                    results[i] = deflate_member(pending[i], members[i]);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        pending.clear();
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (!results[i] || !write_full(fd, members[i].data(), members[i].size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int fd;
+    std::vector<std::vector<unsigned char>> pending;
+};
+#endif
+
+bool tar_gzip_supported() {
+#ifdef MYDOCKER_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ==================== tar头 ====================
+
+struct TarHeader {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char padding[12];
+};
+static_assert(sizeof(TarHeader) == TAR_BLOCK_SIZE, "tar header must be one block");
+
+struct TarEntry {
+    std::string path;
+    std::string linkpath;
+    char type = '0';
+    mode_t mode = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
+    uint64_t size = 0;
+    time_t mtime = 0;
+    unsigned devmajor = 0;
+    unsigned devminor = 0;
+    std::vector<std::pair<std::string, std::string>> xattrs;
+};
+
+// 解析八进制数字段（也支持GNU的base-256编码）
+static uint64_t parse_number(const char* field, size_t len) {
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        uint64_t value = static_cast<unsigned char>(field[0]) & 0x7f;
+        for (size_t i = 1; i < len; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+    uint64_t value = 0;
+    size_t i = 0;
+    while (i < len && (field[i] == ' ' || field[i] == '\0')) i++;
+    for (; i < len && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = value * 8 + (field[i] - '0');
+    }
+    return value;
+}
+
+static std::string field_string(const char* field, size_t len) {
+    return std::string(field, strnlen(field, len));
+}
+
+static unsigned header_checksum(const TarHeader& header) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&header);
+    unsigned sum = 0;
+    for (size_t i = 0; i < TAR_BLOCK_SIZE; ++i) {
+        bool in_checksum = i >= offsetof(TarHeader, checksum) && i < offsetof(TarHeader, checksum) + 8;
+        sum += in_checksum ? ' ' : bytes[i];
+    }
+    return sum;
+}
+
+// 解析PAX扩展头记录："<长度> <key>=<value>\n"
+static void parse_pax(const std::string& data, TarEntry& overrides, bool& has_path, bool& has_link,
+                      bool& has_size) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t space = data.find(' ', pos);
+        if (space == std::string::npos) break;
+        size_t record_len = strtoul(data.c_str() + pos, nullptr, 10);
+        if (record_len == 0 || pos + record_len > data.size()) break;
+        size_t equals = data.find('=', space);
+        if (equals == std::string::npos || equals >= pos + record_len) break;
+        std::string key = data.substr(space + 1, equals - space - 1);
+        std::string value = data.substr(equals + 1, pos + record_len - equals - 2);
+        if (key == "path") {
+            overrides.path = value;
+            has_path = true;
+        } else if (key == "linkpath") {
+            overrides.linkpath = value;
+            has_link = true;
+        } else if (key == "size") {
+            overrides.size = strtoull(value.c_str(), nullptr, 10);
+            has_size = true;
+        } else if (key == "uid") {
+            overrides.uid = strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "gid") {
+            overrides.gid = strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "mtime") {
+            overrides.mtime = strtoll(value.c_str(), nullptr, 10);
+        } else if (key.compare(0, 13, "SCHILY.xattr.") == 0) {
+            overrides.xattrs.emplace_back(key.substr(13), value);
+        }
+        pos += record_len;
+    }
+}
+
+// ==================== 解压 ====================
+
+// 按目录逐级解析路径，只允许普通目录（O_NOFOLLOW），从而拒绝经过符号链接的路径
+class Extractor {
+public:
+    Extractor(int root_fd, ArchiveInput& input) : root_fd(root_fd), input(input), cached_parent_fd(-1) {}
+    ~Extractor() {
+        if (cached_parent_fd >= 0) close(cached_parent_fd);
+    }
+
+    bool run();
+
+private:
+    bool read_exact(void* buffer, size_t len);
+    bool skip(uint64_t len);
+    bool read_data(uint64_t size, std::string& data);
+    int open_parent(const std::vector<std::string>& components, bool create);
+    bool extract_entry(const TarEntry& entry);
+    bool write_file(int parent_fd, const std::string& name, const TarEntry& entry);
+    void apply_xattrs_path(int parent_fd, const std::string& name, const TarEntry& entry);
+    bool apply_directory_attributes();
+
+    int root_fd;
+    ArchiveInput& input;
+    std::string cached_parent_path;
+    int cached_parent_fd;
+    std::vector<TarEntry> directories;   // 目录属性在最后设置，避免子项修改mtime
+    std::vector<char> copy_buffer;
+};
+
+// 拆分并校验路径，拒绝".."
+static bool split_path(const std::string& path, std::vector<std::string>& components) {
+    components.clear();
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        std::string component = path.substr(start, end - start);
+        if (component == "..") {
+            return false;
+        }
+        if (!component.empty() && component != ".") {
+            components.push_back(component);
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool Extractor::read_exact(void* buffer, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = input.read(static_cast<char*>(buffer) + total, len - total);
+        if (n <= 0) return false;
+        total += n;
+    }
+    return true;
+}
+
+bool Extractor::skip(uint64_t len) {
+    char buffer[TAR_BLOCK_SIZE * 16];
+    while (len > 0) {
+        size_t n = std::min<uint64_t>(len, sizeof(buffer));
+        if (!read_exact(buffer, n)) return false;
+        len -= n;
+    }
+    return true;
+}
+
+static uint64_t padded_size(uint64_t size) {
+    return (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+}
+
+bool Extractor::read_data(uint64_t size, std::string& data) {
+    if (size > (64u << 20)) {
+        return false; // 扩展头不应超过64MB
+    }
+    data.resize(size);
+    return read_exact(&data[0], size) && skip(padded_size(size) - size);
+}
+
+// 打开路径的父目录（返回的fd由缓存管理，调用者不关闭）
+int Extractor::open_parent(const std::vector<std::string>& components, bool create) {
+    std::string parent_path;
+    for (size_t i = 0; i + 1 < components.size(); ++i) {
+        parent_path += components[i] + "/";
+    }
+    if (cached_parent_fd >= 0 && parent_path == cached_parent_path) {
+        return cached_parent_fd;
+    }
+
+    int fd = dup(root_fd);
+    for (size_t i = 0; fd >= 0 && i + 1 < components.size(); ++i) {
+        int next = openat(fd, components[i].c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (next < 0 && errno == ENOENT && create) {
+            mkdirat(fd, components[i].c_str(), 0755);
+            next = openat(fd, components[i].c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        close(fd);
+        fd = next;
+    }
+    if (fd < 0) {
+        return -1;
+    }
+    if (cached_parent_fd >= 0) {
+        close(cached_parent_fd);
+    }
+    cached_parent_fd = fd;
+    cached_parent_path = parent_path;
+    return fd;
+}
+
+// 通过 /proc/self/fd 设置不可打开的条目（符号链接、设备节点）的扩展属性
+void Extractor::apply_xattrs_path(int parent_fd, const std::string& name, const TarEntry& entry) {
+    std::string path = "/proc/self/fd/" + std::to_string(parent_fd) + "/" + name;
+    for (const auto& xattr : entry.xattrs) {
+        lsetxattr(path.c_str(), xattr.first.c_str(), xattr.second.data(), xattr.second.size(), 0);
+    }
+}
+
+bool Extractor::write_file(int parent_fd, const std::string& name, const TarEntry& entry) {
+    int fd = openat(parent_fd, name.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        perror(("[Tar] Failed to create " + entry.path).c_str());
+        return skip(padded_size(entry.size));
+    }
+
+    if (copy_buffer.empty()) {
+        copy_buffer.resize(1 << 20);
+    }
+    uint64_t remaining = entry.size;
+    bool ok = true;
+    while (remaining > 0) {
+        size_t n = std::min<uint64_t>(remaining, copy_buffer.size());
+        if (!read_exact(copy_buffer.data(), n)) {
+            close(fd);
+            return false;
+        }
+        if (ok && !write_full(fd, copy_buffer.data(), n)) {
+            perror(("[Tar] Failed to write " + entry.path).c_str());
+            ok = false;
+        }
+        remaining -= n;
+    }
+
+    // 先chown再chmod，chown会清除setuid位
+    if (fchown(fd, entry.uid, entry.gid) != 0 && errno != EPERM) {
+        perror(("[Tar] fchown " + entry.path).c_str());
+    }
+    fchmod(fd, entry.mode & 07777);
+    for (const auto& xattr : entry.xattrs) {
+        fsetxattr(fd, xattr.first.c_str(), xattr.second.data(), xattr.second.size(), 0);
+    }
+    struct timespec times[2] = {{entry.mtime, 0}, {entry.mtime, 0}};
+    futimens(fd, times);
+    close(fd);
+    return skip(padded_size(entry.size) - entry.size);
+}
+
+bool Extractor::extract_entry(const TarEntry& entry) {
+    std::vector<std::string> components;
+    if (!split_path(entry.path, components)) {
+        std::cerr << "[Tar] Rejecting path outside destination: " << entry.path << std::endl;
+        return false;
+    }
+    bool has_data = entry.type == '0' || entry.type == '\0' || entry.type == '7';
+    if (components.empty()) {
+        // 根目录本身
+        if (entry.type == '5') {
+            TarEntry root = entry;
+            root.path = ".";
+            directories.push_back(root);
+        }
+        return skip(has_data ? padded_size(entry.size) : 0);
+    }
+
+    int parent_fd = open_parent(components, true);
+    if (parent_fd < 0) {
+        std::cerr << "[Tar] Rejecting path through non-directory: " << entry.path << std::endl;
+        return false;
+    }
+    const std::string& name = components.back();
+
+    // 替换已有条目（目录除外）
+    struct stat existing;
+    bool exists = fstatat(parent_fd, name.c_str(), &existing, AT_SYMLINK_NOFOLLOW) == 0;
+    if (exists && !(entry.type == '5' && S_ISDIR(existing.st_mode))) {
+        unlinkat(parent_fd, name.c_str(), S_ISDIR(existing.st_mode) ? AT_REMOVEDIR : 0);
+    }
+
+    switch (entry.type) {
+    case '0':
+    case '\0':
+    case '7':
+        return write_file(parent_fd, name, entry);
+
+    case '5':
+        if (mkdirat(parent_fd, name.c_str(), 0700) != 0 && errno != EEXIST) {
+            perror(("[Tar] mkdir " + entry.path).c_str());
+        }
+        directories.push_back(entry);
+        return true;
+
+    case '2': {
+        if (symlinkat(entry.linkpath.c_str(), parent_fd, name.c_str()) != 0) {
+            perror(("[Tar] symlink " + entry.path).c_str());
+            return true;
+        }
+        fchownat(parent_fd, name.c_str(), entry.uid, entry.gid, AT_SYMLINK_NOFOLLOW);
+        apply_xattrs_path(parent_fd, name, entry);
+        struct timespec times[2] = {{entry.mtime, 0}, {entry.mtime, 0}};
+        utimensat(parent_fd, name.c_str(), times, AT_SYMLINK_NOFOLLOW);
+        return true;
+    }
+
+    case '1': {
+        // 硬链接目标同样逐级解析，不能跟随符号链接
+        std::vector<std::string> target;
+        if (!split_path(entry.linkpath, target) || target.empty()) {
+            std::cerr << "[Tar] Rejecting hard link outside destination: " << entry.linkpath << std::endl;
+            return false;
+        }
+        int target_parent = dup(root_fd);
+        for (size_t i = 0; target_parent >= 0 && i + 1 < target.size(); ++i) {
+            int next = openat(target_parent, target[i].c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            close(target_parent);
+            target_parent = next;
+        }
+        if (target_parent < 0 ||
+            linkat(target_parent, target.back().c_str(), parent_fd, name.c_str(), 0) != 0) {
+            perror(("[Tar] link " + entry.path).c_str());
+        }
+        if (target_parent >= 0) close(target_parent);
+        return true;
+    }
+
+    case '3':
+    case '4':
+    case '6': {
+        mode_t type = entry.type == '3' ? S_IFCHR : entry.type == '4' ? S_IFBLK : S_IFIFO;
+        if (mknodat(parent_fd, name.c_str(), type | (entry.mode & 07777),
+                    makedev(entry.devmajor, entry.devminor)) != 0) {
+            perror(("[Tar] mknod " + entry.path).c_str());
+            return true;
+        }
+        fchownat(parent_fd, name.c_str(), entry.uid, entry.gid, AT_SYMLINK_NOFOLLOW);
+        fchmodat(parent_fd, name.c_str(), entry.mode & 07777, 0);
+        apply_xattrs_path(parent_fd, name, entry);
+        struct timespec times[2] = {{entry.mtime, 0}, {entry.mtime, 0}};
+        utimensat(parent_fd, name.c_str(), times, AT_SYMLINK_NOFOLLOW);
+        return true;
+    }
+
+    default:
+        std::cerr << "[Tar] Skipping unsupported entry type '" << entry.type << "': " << entry.path << std::endl;
+        return skip(padded_size(entry.size));
+    }
+}
+
+// 从最深的目录开始设置目录属性
+bool Extractor::apply_directory_attributes() {
+    for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+        const TarEntry& entry = *it;
+        int fd;
+        std::vector<std::string> components;
+        split_path(entry.path, components);
+        if (components.empty()) {
+            fd = openat(root_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        } else {
+            int parent_fd = open_parent(components, false);
+            fd = parent_fd < 0 ? -1 : openat(parent_fd, components.back().c_str(),
+                                             O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        if (fd < 0) continue;
+        if (fchown(fd, entry.uid, entry.gid) != 0 && errno != EPERM) {
+            perror(("[Tar] fchown " + entry.path).c_str());
+        }
+        fchmod(fd, entry.mode & 07777);
+        for (const auto& xattr : entry.xattrs) {
+            fsetxattr(fd, xattr.first.c_str(), xattr.second.data(), xattr.second.size(), 0);
+        }
+        struct timespec times[2] = {{entry.mtime, 0}, {entry.mtime, 0}};
+        futimens(fd, times);
+        close(fd);
+    }
+    return true;
+}
+
+bool Extractor::run() {
+    TarEntry pending;
+    bool pending_path = false, pending_link = false, pending_size = false;
+    TarHeader header;
+
+    while (true) {
+        if (!read_exact(&header, sizeof(header))) {
+            std::cerr << "[Tar] Unexpected end of archive" << std::endl;
+            return false;
+        }
+        const char* bytes = reinterpret_cast<const char*>(&header);
+        if (std::all_of(bytes, bytes + TAR_BLOCK_SIZE, [](char c) { return c == 0; })) {
+            break; // 结束块
+        }
+        if (parse_number(header.checksum, sizeof(header.checksum)) != header_checksum(header)) {
+            std::cerr << "[Tar] Header checksum mismatch" << std::endl;
+            return false;
+        }
+
+        TarEntry entry;
+        entry.type = header.typeflag;
+        entry.path = field_string(header.name, sizeof(header.name));
+        if (memcmp(header.magic, "ustar", 5) == 0 && header.prefix[0] != '\0') {
+            entry.path = field_string(header.prefix, sizeof(header.prefix)) + "/" + entry.path;
+        }
+        entry.linkpath = field_string(header.linkname, sizeof(header.linkname));
+        entry.mode = parse_number(header.mode, sizeof(header.mode));
+        entry.uid = parse_number(header.uid, sizeof(header.uid));
+        entry.gid = parse_number(header.gid, sizeof(header.gid));
+        entry.size = parse_number(header.size, sizeof(header.size));
+        entry.mtime = parse_number(header.mtime, sizeof(header.mtime));
+        entry.devmajor = parse_number(header.devmajor, sizeof(header.devmajor));
+        entry.devminor = parse_number(header.devminor, sizeof(header.devminor));
+
+        if (entry.type == 'x' || entry.type == 'L' || entry.type == 'K') {
+            std::string data;
+            if (!read_data(entry.size, data)) return false;
+            if (entry.type == 'x') {
+                parse_pax(data, pending, pending_path, pending_link, pending_size);
+            } else if (entry.type == 'L') {
+                pending.path = data.c_str();
+                pending_path = true;
+            } else {
+                pending.linkpath = data.c_str();
+                pending_link = true;
+            }
+            continue;
+        }
+        if (entry.type == 'g') {
+            if (!skip(padded_size(entry.size))) return false;
+            continue;
+        }
+
+        // 应用扩展头中的覆盖值
+        if (pending_path) entry.path = pending.path;
+        if (pending_link) entry.linkpath = pending.linkpath;
+        if (pending_size) entry.size = pending.size;
+        if (pending.uid) entry.uid = pending.uid;
+        if (pending.gid) entry.gid = pending.gid;
+        if (pending.mtime) entry.mtime = pending.mtime;
+        entry.xattrs = pending.xattrs;
+        pending = TarEntry();
+        pending_path = pending_link = pending_size = false;
+
+        if (!extract_entry(entry)) {
+            return false;
+        }
+    }
+    return apply_directory_attributes();
+}
+
+bool tar_extract(const std::string& archive_path, const std::string& dest_dir) {
+    int archive_fd = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (archive_fd < 0) {
+        perror(("[Tar] Failed to open " + archive_path).c_str());
+        return false;
+    }
+    int root_fd = open(dest_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) {
+        perror(("[Tar] Failed to open " + dest_dir).c_str());
+        close(archive_fd);
+        return false;
+    }
+
+    bool ok = false;
+    std::unique_ptr<ArchiveInput> input = open_archive_input(archive_fd);
+    if (input) {
+        Extractor extractor(root_fd, *input);
+        ok = extractor.run();
+    }
+    close(root_fd);
+    close(archive_fd);
+    return ok;
+}
+
+// ==================== 打包 ====================
+
+class Archiver {
+public:
+    explicit Archiver(ArchiveOutput& output) : output(output) {}
+    bool add_directory(const std::string& full_path, const std::string& relative_path);
+    bool finish();
+
+private:
+    bool add_entry(const std::string& full_path, const std::string& relative_path, const struct stat& st);
+    bool write_header(const TarEntry& entry);
+    bool write_pax(const TarEntry& entry);
+
+    ArchiveOutput& output;
+    std::map<std::pair<dev_t, ino_t>, std::string> hardlinks;
+};
+
+// 写入 len-1 位八进制数字和结尾的NUL（调用者保证数值放得下，超出时保留低位）
+static void put_octal(char* field, size_t len, uint64_t value) {
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%0*llo", static_cast<int>(len - 1),
+                     static_cast<unsigned long long>(value));
+    memcpy(field, digits + (n - static_cast<int>(len - 1)), len - 1);
+    field[len - 1] = '\0';
+}
+
+// PAX记录的长度字段包含自身，需要迭代计算
+static std::string pax_record(const std::string& key, const std::string& value) {
+    size_t body = key.size() + value.size() + 3; // ' ' '=' '\n'
+    size_t len = body + 1;
+    while (std::to_string(len).size() + body != len) {
+        len = std::to_string(len).size() + body;
+    }
+    return std::to_string(len) + " " + key + "=" + value + "\n";
+}
+
+bool Archiver::write_pax(const TarEntry& entry) {
+    std::string data;
+    if (entry.path.size() >= sizeof(TarHeader::name)) data += pax_record("path", entry.path);
+    if (entry.linkpath.size() >= sizeof(TarHeader::linkname)) data += pax_record("linkpath", entry.linkpath);
+    if (entry.size >= (1ULL << 33)) data += pax_record("size", std::to_string(entry.size));
+    if (entry.uid >= (1u << 21)) data += pax_record("uid", std::to_string(entry.uid));
+    if (entry.gid >= (1u << 21)) data += pax_record("gid", std::to_string(entry.gid));
+    for (const auto& xattr : entry.xattrs) {
+        data += pax_record("SCHILY.xattr." + xattr.first, xattr.second);
+    }
+    if (data.empty()) {
+        return true;
+    }
+
+    TarEntry pax;
+    pax.type = 'x';
+    pax.path = "PaxHeaders/" + entry.path.substr(0, 80);
+    pax.mode = 0644;
+    pax.size = data.size();
+    if (!write_header(pax) || !output.write(data.data(), data.size())) {
+        return false;
+    }
+    static const char zeros[TAR_BLOCK_SIZE] = {0};
+    return output.write(zeros, padded_size(data.size()) - data.size());
+}
+
+bool Archiver::write_header(const TarEntry& entry) {
+    TarHeader header;
+    memset(&header, 0, sizeof(header));
+    // 超长字段已写入PAX头，这里截断即可
+    // ustar的name/linkname字段占满时不需要NUL结尾
+    memcpy(header.name, entry.path.data(), std::min(entry.path.size(), sizeof(header.name)));
+    memcpy(header.linkname, entry.linkpath.data(), std::min(entry.linkpath.size(), sizeof(header.linkname)));
+    put_octal(header.mode, sizeof(header.mode), entry.mode & 07777);
+    put_octal(header.uid, sizeof(header.uid), entry.uid < (1u << 21) ? entry.uid : 0);
+    put_octal(header.gid, sizeof(header.gid), entry.gid < (1u << 21) ? entry.gid : 0);
+    put_octal(header.size, sizeof(header.size), entry.size < (1ULL << 33) ? entry.size : 0);
+    put_octal(header.mtime, sizeof(header.mtime), entry.mtime > 0 ? entry.mtime : 0);
+    header.typeflag = entry.type;
+    memcpy(header.magic, "ustar", 6);
+    memcpy(header.version, "00", 2);
+    put_octal(header.devmajor, sizeof(header.devmajor), entry.devmajor);
+    put_octal(header.devminor, sizeof(header.devminor), entry.devminor);
+    snprintf(header.checksum, sizeof(header.checksum), "%06o", header_checksum(header));
+    header.checksum[7] = ' ';
+    return output.write(&header, sizeof(header));
+}
+
+// 读取条目的全部扩展属性
+static std::vector<std::pair<std::string, std::string>> read_xattrs(const std::string& path) {
+    std::vector<std::pair<std::string, std::string>> xattrs;
+    ssize_t list_size = llistxattr(path.c_str(), nullptr, 0);
+    if (list_size <= 0) {
+        return xattrs;
+    }
+    std::vector<char> names(list_size);
+    list_size = llistxattr(path.c_str(), names.data(), names.size());
+    for (ssize_t pos = 0; pos < list_size; pos += strlen(names.data() + pos) + 1) {
+        const char* name = names.data() + pos;
+        ssize_t value_size = lgetxattr(path.c_str(), name, nullptr, 0);
+        if (value_size < 0) continue;
+        std::string value(value_size, '\0');
+        value_size = lgetxattr(path.c_str(), name, &value[0], value.size());
+        if (value_size < 0) continue;
+        value.resize(value_size);
+        xattrs.emplace_back(name, value);
+    }
+    std::sort(xattrs.begin(), xattrs.end());
+    return xattrs;
+}
+
+bool Archiver::add_entry(const std::string& full_path, const std::string& relative_path, const struct stat& st) {
+    TarEntry entry;
+    entry.path = relative_path;
+    entry.mode = st.st_mode;
+    entry.uid = st.st_uid;
+    entry.gid = st.st_gid;
+    entry.mtime = st.st_mtime;
+    entry.xattrs = read_xattrs(full_path);
+
+    int data_fd = -1;
+    if (S_ISREG(st.st_mode)) {
+        auto key = std::make_pair(st.st_dev, st.st_ino);
+        auto it = st.st_nlink > 1 ? hardlinks.find(key) : hardlinks.end();
+        if (it != hardlinks.end()) {
+            entry.type = '1';
+            entry.linkpath = it->second;
+        } else {
+            if (st.st_nlink > 1) hardlinks[key] = relative_path;
+            entry.type = '0';
+            entry.size = st.st_size;
+            data_fd = open(full_path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+            if (data_fd < 0) {
+                perror(("[Tar] Failed to open " + full_path).c_str());
+                return false;
+            }
+        }
+    } else if (S_ISDIR(st.st_mode)) {
+        entry.type = '5';
+        entry.path += "/";
+    } else if (S_ISLNK(st.st_mode)) {
+        entry.type = '2';
+        std::vector<char> target(st.st_size + 1);
+        ssize_t n = readlink(full_path.c_str(), target.data(), target.size());
+        if (n < 0) return false;
+        entry.linkpath.assign(target.data(), n);
+    } else if (S_ISCHR(st.st_mode) || S_ISBLK(st.st_mode)) {
+        entry.type = S_ISCHR(st.st_mode) ? '3' : '4';
+        entry.devmajor = major(st.st_rdev);
+        entry.devminor = minor(st.st_rdev);
+    } else if (S_ISFIFO(st.st_mode)) {
+        entry.type = '6';
+    } else {
+        return true; // socket等不打包
+    }
+
+    if (!write_pax(entry) || !write_header(entry)) {
+        if (data_fd >= 0) close(data_fd);
+        return false;
+    }
+
+    if (data_fd >= 0) {
+        std::vector<char> buffer(1 << 20);
+        uint64_t remaining = entry.size;
+        while (remaining > 0) {
+            size_t n = read_full(data_fd, buffer.data(), std::min<uint64_t>(remaining, buffer.size()));
+            if (n == 0) {
+                // 文件在打包过程中变短，用0补齐以保持归档结构完整
+                std::fill(buffer.begin(), buffer.end(), 0);
+                n = std::min<uint64_t>(remaining, buffer.size());
+            }
+            if (!output.write(buffer.data(), n)) {
+                close(data_fd);
+                return false;
+            }
+            remaining -= n;
+        }
+        close(data_fd);
+        static const char zeros[TAR_BLOCK_SIZE] = {0};
+        if (!output.write(zeros, padded_size(entry.size) - entry.size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 按名称排序递归打包目录内容，保证相同内容得到相同的归档
+bool Archiver::add_directory(const std::string& full_path, const std::string& relative_path) {
+    DIR* dir = opendir(full_path.c_str());
+    if (dir == nullptr) {
+        perror(("[Tar] Failed to open " + full_path).c_str());
+        return false;
+    }
+    std::vector<std::string> names;
+    struct dirent* item;
+    while ((item = readdir(dir)) != nullptr) {
+        if (strcmp(item->d_name, ".") != 0 && strcmp(item->d_name, "..") != 0) {
+            names.push_back(item->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const auto& name : names) {
+        std::string child_full = full_path + "/" + name;
+        std::string child_relative = relative_path.empty() ? name : relative_path + "/" + name;
+        struct stat st;
+        if (lstat(child_full.c_str(), &st) != 0) {
+            continue;
+        }
+        if (!add_entry(child_full, child_relative, st)) {
+            return false;
+        }
+        if (S_ISDIR(st.st_mode) && !add_directory(child_full, child_relative)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Archiver::finish() {
+    static const char zeros[TAR_BLOCK_SIZE * 2] = {0};
+    return output.write(zeros, sizeof(zeros)) && output.finish();
+}
+
+bool tar_create(const std::string& source_dir, const std::string& archive_path, TarCompression compression) {
+    int fd = open(archive_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror(("[Tar] Failed to create " + archive_path).c_str());
+        return false;
+    }
+
+    std::unique_ptr<ArchiveOutput> output;
+#ifdef MYDOCKER_HAVE_ZLIB
+    if (compression == TarCompression::Gzip) {
+        output.reset(new ParallelGzipOutput(fd));
+    }
+#else
+    if (compression == TarCompression::Gzip) {
+        std::cerr << "[Tar] Built without zlib, writing uncompressed archive" << std::endl;
+    }
+#endif
+    if (!output) {
+        output.reset(new FileOutput(fd));
+    }
+
+    std::string root = source_dir;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    Archiver archiver(*output);
+    bool ok = archiver.add_directory(root, "") && archiver.finish();
+    close(fd);
+    if (!ok) {
+        std::cerr << "[Tar] Failed to create archive " << archive_path << std::endl;
+        unlink(archive_path.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,31 @@
+#ifndef TAR_H
+#define TAR_H
+
+#include <string>
+
+// ==================== 进程内tar读写 ====================
+// 支持 ustar / PAX（长路径、xattr）/ GNU 长文件名，保留属主、权限、时间和扩展属性。
+// 解压时所有操作都相对于目标目录的文件描述符（openat/mkdirat/...），
+// 路径中的".."和经过符号链接的路径会被拒绝，保证不会写到目标目录之外。
+//
+// 压缩格式（按文件头自动识别）：
+//   - 未压缩tar
+//   - gzip：本程序写出的是分块的多成员gzip，每个成员的FEXTRA中记录成员长度，
+//     解压时多个成员在多个CPU核上并行解压；普通gzip按顺序流式解压
+//   - zstd：编译时找到libzstd才支持（MYDOCKER_HAVE_ZSTD）
+
+enum class TarCompression {
+    None,
+    Gzip,
+};
+
+// 将source_dir目录下的内容打包为archive_path（条目按名称排序，mtime等元数据保留）
+bool tar_create(const std::string& source_dir, const std::string& archive_path, TarCompression compression);
+
+// 将archive_path解压到dest_dir（dest_dir必须已存在）
+bool tar_extract(const std::string& archive_path, const std::string& dest_dir);
+
+// 当前构建是否支持gzip压缩
+bool tar_gzip_supported();
+
+#endif // TAR_H
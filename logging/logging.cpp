@@ -1,35 +1,332 @@
 #include "logging.h"
 #include "common/constants.h"
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/sendfile.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
 
-// 显示容器日志
-void show_container_logs(const std::string& container_name) {
-    std::cout << "[Container] Showing logs for container: " << container_name << std::endl;
+static bool write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// 将 [offset, end) 输出到标准输出，优先使用 sendfile 在内核中复制（follow模式的增量输出）
+static bool send_range(int fd, off_t offset, off_t end) {
+    while (offset < end) {
+        ssize_t n = sendfile(STDOUT_FILENO, fd, &offset, end - offset);
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0) return true;
+        break;
+    }
+    // 标准输出不支持sendfile时回退到read/write
+    std::vector<char> buffer(1 << 16);
+    while (offset < end) {
+        ssize_t n = pread(fd, buffer.data(), std::min<off_t>(buffer.size(), end - offset), offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !write_all(STDOUT_FILENO, buffer.data(), n)) {
+            return false;
+        }
+        offset += n;
+    }
+    return true;
+}
+
+// 只映射 [offset, end) 所在的页并输出，不读取文件的其余部分
+static bool write_mapped_range(int fd, off_t offset, off_t end) {
+    if (offset >= end) {
+        return true;
+    }
+    long page_size = sysconf(_SC_PAGESIZE);
+    off_t map_start = offset / page_size * page_size;
+    size_t length = end - map_start;
+    void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, map_start);
+    if (address == MAP_FAILED) {
+        return send_range(fd, offset, end);
+    }
+    madvise(address, length, MADV_SEQUENTIAL);
+    bool ok = write_all(STDOUT_FILENO, static_cast<char*>(address) + (offset - map_start), end - offset);
+    munmap(address, length);
+    return ok;
+}
+
+// 第一条时间戳不早于 since 的数据在日志文件中的偏移：在索引上二分查找。
+// 全部早于 since 时返回文件大小；没有索引（旧格式日志）时返回0
+static off_t log_offset_since(const std::string& path, uint64_t since, off_t size) {
+    int fd = open((path + LOG_INDEX_SUFFIX).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    size_t count = fstat(fd, &st) == 0 ? st.st_size / sizeof(LogIndexEntry) : 0;
+    off_t result = size;
+    if (count > 0) {
+        void* address = mmap(nullptr, count * sizeof(LogIndexEntry), PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            const LogIndexEntry* entries = static_cast<const LogIndexEntry*>(address);
+            const LogIndexEntry* found = std::lower_bound(entries, entries + count, since,
+                [](const LogIndexEntry& entry, uint64_t value) { return entry.timestamp < value; });
+            if (found != entries + count) {
+                result = std::min<off_t>(found->offset, size);
+            }
+            munmap(address, count * sizeof(LogIndexEntry));
+        } else {
+            result = 0;
+        }
+    }
+    close(fd);
+    return result;
+}
+
+// 从 end 向前按块查找，返回 [floor, end) 中最后 lines 行的起始偏移；
+// 不足 lines 行时返回 floor，并从 lines 中扣除已找到的行数
+static off_t log_offset_tail(int fd, off_t floor, off_t end, long& lines) {
+    static const size_t TAIL_BLOCK = 64 * 1024;
+    std::vector<char> buffer(TAIL_BLOCK);
+    off_t position = end;
+    bool skip_last_newline = true;  // 文件末尾的换行结束的是最后一行，不是新的一行
+    while (position > floor) {
+        size_t chunk = std::min<off_t>(TAIL_BLOCK, position - floor);
+        position -= chunk;
+        ssize_t n = pread(fd, buffer.data(), chunk, position);
+        if (n != static_cast<ssize_t>(chunk)) {
+            return floor;
+        }
+        for (ssize_t i = n - 1; i >= 0; --i) {
+            if (buffer[i] != '\n') {
+                skip_last_newline = false;
+                continue;
+            }
+            if (skip_last_newline) {
+                skip_last_newline = false;
+                continue;
+            }
+            if (--lines == 0) {
+                return position + i + 1;
+            }
+        }
+    }
+    // 到达起点：起点处的不完整行也算一行
+    if (end > floor) {
+        --lines;
+    }
+    return floor;
+}
+
+bool parse_logs_options(int argc, char* argv[], LogsOptions& options) {
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) {
+            options.tail = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--follow") == 0 || strcmp(argv[i], "-f") == 0) {
+            options.follow = true;
+        } else if (strcmp(argv[i], "--since") == 0 && i + 1 < argc) {
+            if (!parse_log_time(argv[++i], options.since)) {
+                std::cerr << "[Error] Invalid time: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (options.container_name.empty()) {
+            options.container_name = argv[i];
+        } else {
+            std::cerr << "[Error] Unexpected argument: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    if (options.container_name.empty()) {
+        std::cerr << "[Error] No container specified" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parse_log_time(const std::string& text, uint64_t& timestamp) {
+    char* end;
+    double value = strtod(text.c_str(), &end);
+    if (end != text.c_str() && (*end == '\0' || (end[1] == '\0' && strchr("smhd", *end) != nullptr))) {
+        if (*end == '\0') {
+            // Unix时间戳（秒）
+            timestamp = static_cast<uint64_t>(value * 1e9);
+            return value >= 0;
+        }
+        // 相对时间：10s、5m、2h、1d 之前
+        double unit = *end == 's' ? 1 : *end == 'm' ? 60 : *end == 'h' ? 3600 : 86400;
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double seconds = now.tv_sec + now.tv_nsec / 1e9 - value * unit;
+        timestamp = seconds > 0 ? static_cast<uint64_t>(seconds * 1e9) : 0;
+        return value >= 0;
+    }
+    // 本地时间：2026-01-02T15:04:05 或 2026-01-02 15:04:05
+    struct tm tm = {};
+    const char* rest = strptime(text.c_str(), "%Y-%m-%dT%H:%M:%S", &tm);
+    if (rest == nullptr) {
+        rest = strptime(text.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
+    }
+    if (rest == nullptr || *rest != '\0') {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    time_t seconds = mktime(&tm);
+    if (seconds < 0) {
+        return false;
+    }
+    timestamp = static_cast<uint64_t>(seconds) * 1000000000ull;
+    return true;
+}
+
+// 一个日志文件中需要输出的区间
+struct LogSegment {
+    int fd;
+    off_t start;
+    off_t end;
+};
+
+// 收集进程运行期间对日志目录持有共享锁
+static bool log_collector_running(const std::string& log_file) {
+    std::string dir = log_file.substr(0, log_file.find_last_of('/'));
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool running = flock(fd, LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+    close(fd);
+    return running;
+}
+
+// 跟随当前日志文件：目录上的 inotify 报告写入（IN_MODIFY）和轮转（IN_MOVED_FROM/IN_CREATE），
+// 收集进程退出后输出剩余数据并返回
+static void follow_log(const std::string& log_file, int fd, off_t position) {
+    std::string dir = log_file.substr(0, log_file.find_last_of('/'));
+    std::string name = log_file.substr(log_file.find_last_of('/') + 1);
+    int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0 || inotify_add_watch(inotify_fd, dir.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_FROM) < 0) {
+        perror("[Container] inotify failed");
+        if (inotify_fd >= 0) close(inotify_fd);
+        return;
+    }
+
+    auto drain = [&]() {
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > position) {
+            send_range(fd, position, st.st_size);
+            position = st.st_size;
+        }
+    };
+    auto reopen = [&]() {
+        drain();
+        if (fd >= 0) close(fd);
+        fd = open(log_file.c_str(), O_RDONLY | O_CLOEXEC);
+        position = 0;
+        drain();
+    };
+
+    std::vector<char> events(64 * 1024);
+    bool running = true;
+    while (running) {
+        struct pollfd pfd = {inotify_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 1000);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            // 空闲时检查收集进程是否已退出（容器已结束）
+            if (!log_collector_running(log_file)) {
+                running = false;
+                drain();
+            }
+            continue;
+        }
+        ssize_t n = read(inotify_fd, events.data(), events.size());
+        for (ssize_t i = 0; i < n;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(events.data() + i);
+            i += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0 || name != event->name) continue;
+            if (event->mask & IN_MOVED_FROM) {
+                // 已打开的描述符仍指向轮转后的文件，先读完
+                drain();
+            } else if (event->mask & IN_CREATE) {
+                reopen();
+            } else if (event->mask & IN_MODIFY) {
+                drain();
+            }
+        }
+    }
+    if (fd >= 0) close(fd);
+    close(inotify_fd);
+}
+
+// 显示容器日志：按时间顺序输出仍保留的轮转文件和当前文件
+void show_container_logs(const LogsOptions& options) {
+    std::cout << "[Container] Showing logs for container: " << options.container_name << std::endl;
     
-    std::string log_file = CONTAINER_INFO_PATH + container_name + "/" + CONTAINER_LOG_FILE;
+    std::string log_file = CONTAINER_INFO_PATH + options.container_name + "/" + CONTAINER_LOG_FILE;
     
     if (!path_exists(log_file)) {
         std::cerr << "[Container] Log file not found: " << log_file << std::endl;
         return;
     }
-    
-    std::ifstream log_stream(log_file);
-    if (!log_stream.is_open()) {
-        std::cerr << "[Container] Failed to open log file: " << log_file << std::endl;
-        return;
+
+    // 从当前文件向更早的轮转文件确定输出区间：--since 给出下界，--tail 从末尾向前数行
+    std::vector<LogSegment> segments;
+    long lines = options.tail;
+    for (int generation = 0; lines != 0; ++generation) {
+        std::string path = log_generation_path(log_file, generation);
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            break;
+        }
+        struct stat st;
+        fstat(fd, &st);
+        off_t start = options.since > 0 ? log_offset_since(path, options.since, st.st_size) : 0;
+        if (lines > 0) {
+            start = log_offset_tail(fd, start, st.st_size, lines);
+        }
+        segments.push_back({fd, start, st.st_size});
+        if (start > 0) {
+            break;  // 更早的文件都在范围之外
+        }
     }
-    
-    std::string line;
-    while (std::getline(log_stream, line)) {
-        std::cout << line << std::endl;
+
+    std::cout.flush();
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        if (!write_mapped_range(it->fd, it->start, it->end)) {
+            std::cerr << "[Container] Failed to read log file" << std::endl;
+        }
+    }
+
+    if (options.follow) {
+        // 从当前文件已输出部分的末尾继续（--tail 0 时没有输出区间）
+        int fd = segments.empty() ? open(log_file.c_str(), O_RDONLY | O_CLOEXEC) : dup(segments.front().fd);
+        off_t position = segments.empty() ? lseek(fd, 0, SEEK_END) : segments.front().end;
+        follow_log(log_file, fd, position);
+    }
+    for (const auto& segment : segments) {
+        close(segment.fd);
     }
-    
-    log_stream.close();
 }
 
 // 创建容器日志文件
 bool create_container_log_file(const std::string& dir_path) {
     std::string log_file = dir_path + CONTAINER_LOG_FILE;
-    std::ofstream log_stream(log_file);
+    // 追加模式：按重启策略重新运行的容器沿用原有日志
+    std::ofstream log_stream(log_file, std::ios::app);
     if (log_stream.is_open()) {
         log_stream.close();
         std::cout << "[Container] Log file created: " << log_file << std::endl;
@@ -41,43 +338,22 @@ bool create_container_log_file(const std::string& dir_path) {
 }
 
 // 设置日志重定向（在容器内部使用）
-bool setup_log_redirection(const std::string& log_file_path) {
-    if (log_file_path.empty()) {
+bool setup_log_redirection(int stdout_fd, int stderr_fd) {
+    if (stdout_fd < 0 || stderr_fd < 0) {
         return false;
     }
     
-    std::cout << "[Container] Redirecting output to log file: " << log_file_path << std::endl;
+    std::cout << "[Container] Redirecting output to log collector" << std::endl;
+    std::cout.flush();
     
-    // 确保日志目录存在
-    if (!ensure_log_directory(log_file_path)) {
+    // dup2 得到的描述符不带 O_CLOEXEC，exec 后仍然有效；
+    // 用户进程按自己的缓冲策略写入管道，不再强制无缓冲
+    if (dup2(stdout_fd, STDOUT_FILENO) < 0 || dup2(stderr_fd, STDERR_FILENO) < 0) {
+        perror("Failed to redirect output to log pipe");
         return false;
     }
-    
-    // 确保日志文件存在
-    std::ofstream log_file_check(log_file_path, std::ios::app);
-    if (log_file_check.is_open()) {
-        log_file_check.close();
-    } else {
-        std::cerr << "[Container] Failed to create log file: " << log_file_path << std::endl;
-        return false;
-    }
-    
-    // 重定向标准输出到日志文件
-    if (freopen(log_file_path.c_str(), "a", stdout) == nullptr) {
-        perror("Failed to redirect stdout to log file");
-        return false;
-    }
-    
-    // 重定向标准错误到日志文件
-    if (freopen(log_file_path.c_str(), "a", stderr) == nullptr) {
-        perror("Failed to redirect stderr to log file");
-        return false;
-    }
-    
-    // 设置无缓冲，确保日志实时写入
-    setbuf(stdout, nullptr);
-    setbuf(stderr, nullptr);
-    
+    close(stdout_fd);
+    close(stderr_fd);
     return true;
 }
 
@@ -90,4 +366,217 @@ bool ensure_log_directory(const std::string& log_file_path) {
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+std::string log_generation_path(const std::string& log_file_path, int generation) {
+    return generation == 0 ? log_file_path : log_file_path + "." + std::to_string(generation);
+}
+
+// ==================== 日志收集进程 ====================
+
+// 管道容量：吸收容器的突发输出，减少容器因管道写满而阻塞
+static const int LOG_PIPE_SIZE = 1 << 20;
+// 单次 splice 的最大长度
+static const size_t LOG_SPLICE_MAX = 1 << 20;
+
+// 写入当前日志文件及其索引，超过大小后轮转
+class LogCollector {
+public:
+    LogCollector(const std::string& path, const LogOptions& options) : path(path), options(options) {}
+    ~LogCollector() { close_files(); }
+
+    bool open_files();
+    // 将管道中当前可读的数据移入日志文件，管道关闭时返回false
+    bool drain(int pipe_fd, LogStream stream);
+
+private:
+    void close_files();
+    void rotate();
+    ssize_t move(int pipe_fd);
+    void append_index(uint64_t offset, size_t length, LogStream stream);
+
+    std::string path;
+    LogOptions options;
+    int data_fd = -1;
+    int index_fd = -1;
+    off_t offset = 0;           // 当前日志文件的写入位置
+    bool use_splice = true;
+};
+
+bool LogCollector::open_files() {
+    // splice 不支持 O_APPEND 的目标文件，使用显式偏移写入文件末尾
+    data_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    index_fd = open((path + LOG_INDEX_SUFFIX).c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (data_fd < 0 || index_fd < 0) {
+        perror("[Log] Failed to open log file");
+        return false;
+    }
+    offset = lseek(data_fd, 0, SEEK_END);
+    return offset >= 0;
+}
+
+void LogCollector::close_files() {
+    if (data_fd >= 0) close(data_fd);
+    if (index_fd >= 0) close(index_fd);
+    data_fd = index_fd = -1;
+}
+
+// container.log -> container.log.1 -> ... ，超出保留数量的最旧文件被删除
+void LogCollector::rotate() {
+    close_files();
+    int keep = std::max(1, options.max_files);
+    std::string oldest = log_generation_path(path, keep - 1);
+    unlink(oldest.c_str());
+    unlink((oldest + LOG_INDEX_SUFFIX).c_str());
+    for (int generation = keep - 2; generation >= 0; --generation) {
+        std::string from = log_generation_path(path, generation);
+        std::string to = log_generation_path(path, generation + 1);
+        rename((from + LOG_INDEX_SUFFIX).c_str(), (to + LOG_INDEX_SUFFIX).c_str());
+        rename(from.c_str(), to.c_str());
+    }
+    open_files();
+}
+
+ssize_t LogCollector::move(int pipe_fd) {
+    if (use_splice) {
+        loff_t position = offset;
+        ssize_t n = splice(pipe_fd, nullptr, data_fd, &position, LOG_SPLICE_MAX,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n >= 0 || errno != EINVAL) {
+            return n;
+        }
+        // 文件系统不支持splice时回退到read/write
+        use_splice = false;
+    }
+    static std::vector<char> buffer(LOG_SPLICE_MAX);
+    ssize_t n = read(pipe_fd, buffer.data(), buffer.size());
+    if (n > 0 && pwrite(data_fd, buffer.data(), n, offset) != n) {
+        return -1;
+    }
+    return n;
+}
+
+void LogCollector::append_index(uint64_t chunk_offset, size_t length, LogStream stream) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    LogIndexEntry entry = {chunk_offset, static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec,
+                           static_cast<uint32_t>(length), stream};
+    if (write(index_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+        perror("[Log] Failed to write log index");
+    }
+}
+
+bool LogCollector::drain(int pipe_fd, LogStream stream) {
+    while (true) {
+        ssize_t n = move(pipe_fd);
+        if (n == 0) {
+            return false;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN;
+        }
+        // 数据先于索引写入，读者按索引读取时数据一定已经可见
+        append_index(offset, n, stream);
+        offset += n;
+        if (static_cast<size_t>(offset) >= options.max_size) {
+            rotate();
+        }
+    }
+}
+
+static void run_log_collector(const std::string& path, const LogOptions& options, int stdout_fd, int stderr_fd) {
+    LogCollector collector(path, options);
+    if (!collector.open_files()) {
+        return;
+    }
+    // 运行期间持有日志目录的共享锁，logs --follow 据此判断是否还有新数据
+    int dir_fd = open(path.substr(0, path.find_last_of('/')).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        flock(dir_fd, LOCK_SH);
+    }
+    struct pollfd fds[2] = {{stdout_fd, POLLIN, 0}, {stderr_fd, POLLIN, 0}};
+    const LogStream streams[2] = {LOG_STDOUT, LOG_STDERR};
+    int open_count = 2;
+    while (open_count > 0) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("[Log] poll failed");
+            return;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (fds[i].fd < 0 || fds[i].revents == 0) continue;
+            if (!collector.drain(fds[i].fd, streams[i])) {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                --open_count;
+            }
+        }
+    }
+}
+
+bool start_log_collector(const std::string& log_file_path, const LogOptions& options,
+                         int& stdout_fd, int& stderr_fd) {
+    if (!ensure_log_directory(log_file_path)) {
+        return false;
+    }
+    int out_pipe[2], err_pipe[2];
+    if (pipe2(out_pipe, O_CLOEXEC) != 0) {
+        perror("[Log] pipe failed");
+        return false;
+    }
+    if (pipe2(err_pipe, O_CLOEXEC) != 0) {
+        perror("[Log] pipe failed");
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return false;
+    }
+    fcntl(out_pipe[1], F_SETPIPE_SZ, LOG_PIPE_SIZE);
+    fcntl(err_pipe[1], F_SETPIPE_SZ, LOG_PIPE_SIZE);
+
+    // 两次fork：收集进程交给init接管，调用者（run -d 或 pool）退出不影响日志收集，
+    // 也不会收到它的SIGCHLD
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        setsid();
+        if (fork() != 0) {
+            _exit(0);
+        }
+        signal(SIGINT, SIG_IGN);
+        signal(SIGTERM, SIG_IGN);
+        signal(SIGHUP, SIG_IGN);
+        signal(SIGPIPE, SIG_IGN);
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+        // 只保留两个管道读端：继承的其他描述符（如其他容器的管道写端）会阻止对应收集进程看到EOF
+        int null_fd = open("/dev/null", O_RDWR);
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        int out_fd = fcntl(out_pipe[0], F_DUPFD_CLOEXEC, 3);
+        int err_fd = fcntl(err_pipe[0], F_DUPFD_CLOEXEC, out_fd + 1);
+        close_range(err_fd + 1, ~0U, 0);
+        for (int fd = 3; fd < out_fd; ++fd) close(fd);
+        for (int fd = out_fd + 1; fd < err_fd; ++fd) close(fd);
+        fcntl(out_fd, F_SETFL, O_NONBLOCK);
+        fcntl(err_fd, F_SETFL, O_NONBLOCK);
+
+        run_log_collector(log_file_path, options, out_fd, err_fd);
+        _exit(0);
+    }
+    close(out_pipe[0]);
+    close(err_pipe[0]);
+    if (pid < 0) {
+        perror("[Log] fork failed");
+        close(out_pipe[1]);
+        close(err_pipe[1]);
+        return false;
+    }
+    waitpid(pid, nullptr, 0);
+    stdout_fd = out_pipe[1];
+    stderr_fd = err_pipe[1];
+    return true;
+}
@@ -2,6 +2,8 @@
 #define LOGGING_H
 
 #include <string>
+#include <cstdint>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include "common/constants.h"
@@ -10,11 +12,34 @@
 
 // 日志管理相关函数声明
 
+// logs 命令参数
+struct LogsOptions {
+    std::string container_name;
+    long tail = -1;             // 只输出最后N行，-1表示全部
+    bool follow = false;        // 输出后继续跟随新日志，直到日志收集进程退出
+    uint64_t since = 0;         // 只输出该时间（CLOCK_REALTIME 纳秒）之后收集的日志
+};
+
+/**
+ * 解析 logs 命令参数：<container> [--tail N] [--follow|-f] [--since <time>]
+ * @return 是否解析成功
+ */
+bool parse_logs_options(int argc, char* argv[], LogsOptions& options);
+
+/**
+ * 解析时间：Unix时间戳（秒）、相对时间（10s/5m/2h/1d）或本地时间（2026-01-02T15:04:05）
+ * @param text 时间字符串
+ * @param timestamp 返回 CLOCK_REALTIME 纳秒
+ * @return 是否解析成功
+ */
+bool parse_log_time(const std::string& text, uint64_t& timestamp);
+
 /**
- * 显示容器日志
- * @param container_name 容器名称
+ * 显示容器日志：--tail 从文件末尾按块向前查找换行，只映射需要输出的区域；
+ * --since 在索引上二分查找起始位置；--follow 通过 inotify 等待新数据
+ * @param options logs 命令参数
  */
-void show_container_logs(const std::string& container_name);
+void show_container_logs(const LogsOptions& options);
 
 /**
  * 创建容器日志文件
@@ -24,11 +49,54 @@ void show_container_logs(const std::string& container_name);
 bool create_container_log_file(const std::string& dir_path);
 
 /**
- * 设置日志重定向（在容器内部使用）
- * @param log_file_path 日志文件路径
+ * 设置日志重定向（在容器内部使用）：将标准输出和标准错误指向日志管道
+ * @param stdout_fd 标准输出管道写端
+ * @param stderr_fd 标准错误管道写端
  * @return 是否设置成功
  */
-bool setup_log_redirection(const std::string& log_file_path);
+bool setup_log_redirection(int stdout_fd, int stderr_fd);
+
+// ==================== 日志收集 ====================
+// detach模式下容器的标准输出/错误写入两个管道，由独立的收集进程用 splice 零拷贝写入日志文件，
+// 容器一侧没有额外的系统调用。收集进程为每次写入的数据块追加一条固定大小的索引记录
+// （偏移、时间戳、流），日志文件超过 max_size 后轮转为 container.log.1、.2 ...，
+// 最多保留 max_files 个文件（含当前文件）。
+
+// 日志轮转配置
+struct LogOptions {
+    size_t max_size = LOG_MAX_SIZE;
+    int max_files = LOG_MAX_FILES;
+};
+
+// 日志流
+enum LogStream : uint32_t {
+    LOG_STDOUT = 1,
+    LOG_STDERR = 2,
+};
+
+// 索引记录：对应日志文件中 [offset, offset + length) 的一段数据
+struct LogIndexEntry {
+    uint64_t offset;
+    uint64_t timestamp;     // 收集时间，CLOCK_REALTIME 纳秒
+    uint32_t length;
+    uint32_t stream;        // LogStream
+};
+
+/**
+ * 创建日志管道并启动日志收集进程（与调用者脱离，容器关闭管道后自动退出）
+ * @param log_file_path 日志文件路径
+ * @param options 轮转配置
+ * @param stdout_fd 返回标准输出管道写端（O_CLOEXEC）
+ * @param stderr_fd 返回标准错误管道写端（O_CLOEXEC）
+ * @return 是否启动成功
+ */
+bool start_log_collector(const std::string& log_file_path, const LogOptions& options,
+                         int& stdout_fd, int& stderr_fd);
+
+/**
+ * 第 generation 代日志文件路径：0为当前文件，n为 <log>.n
+ */
+std::string log_generation_path(const std::string& log_file_path, int generation);
 
 /**
  * 确保日志目录存在
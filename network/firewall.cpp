@@ -0,0 +1,203 @@
+#include "firewall.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <sys/wait.h>
+
+// iptables 链名最长28个字符
+static const size_t MAX_CHAIN_NAME = 28;
+
+// 放不下时截断名称并追加完整名称的FNV-1a哈希（8位十六进制），前缀相同的长名称不会得到同一条链。
+// 链名需要在不同版本的程序之间保持一致（清理时按名称查找），因此不使用 std::hash
+static std::string make_chain_name(const std::string& prefix, const std::string& name) {
+    std::string chain = prefix + name;
+    if (chain.size() <= MAX_CHAIN_NAME) {
+        return chain;
+    }
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    char suffix[10];
+    snprintf(suffix, sizeof(suffix), "-%08x", hash);
+    return chain.substr(0, MAX_CHAIN_NAME - strlen(suffix)) + suffix;
+}
+
+std::string network_nat_chain(const std::string& bridge_name) {
+    return make_chain_name("MYDOCKER-N-", bridge_name);
+}
+
+std::string network_filter_chain(const std::string& bridge_name) {
+    return make_chain_name("MYDOCKER-F-", bridge_name);
+}
+
+std::string container_nat_chain(const std::string& container_id) {
+    return make_chain_name("MYDOCKER-C-", container_id);
+}
+
+void IptablesBatch::declare_chain(const std::string& table, const std::string& chain) {
+    add_rule(table, ":" + chain + " - [0:0]");
+}
+
+void IptablesBatch::add_rule(const std::string& table, const std::string& rule) {
+    if (rules.find(table) == rules.end()) {
+        table_order.push_back(table);
+    }
+    rules[table].push_back(rule);
+}
+
+bool IptablesBatch::empty() const {
+    return rules.empty();
+}
+
+bool IptablesBatch::commit() const {
+    if (empty()) {
+        return true;
+    }
+
+    std::string payload;
+    for (const auto& table : table_order) {
+        payload += "*" + table + "\n";
+        for (const auto& rule : rules.at(table)) {
+            payload += rule + "\n";
+        }
+        payload += "COMMIT\n";
+    }
+
+    std::string command = quiet ? "iptables-restore -w --noflush 2>/dev/null" : "iptables-restore -w --noflush";
+    FILE* pipe = popen(command.c_str(), "w");
+    if (!pipe) {
+        std::cerr << "[Firewall] Failed to start iptables-restore" << std::endl;
+        return false;
+    }
+    fwrite(payload.data(), 1, payload.size(), pipe);
+    int status = pclose(pipe);
+    if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        if (!quiet) {
+            std::cerr << "[Firewall] iptables-restore failed, rules:\n" << payload;
+        }
+        return false;
+    }
+    return true;
+}
+
+// 创建网络级规则
+bool setup_network_firewall(const std::string& bridge_name, const std::string& subnet) {
+    std::string nat_chain = network_nat_chain(bridge_name);
+    std::string filter_chain = network_filter_chain(bridge_name);
+
+    IptablesBatch batch;
+    // 1. NAT规则用于出站流量
+    batch.declare_chain("nat", nat_chain);
+    batch.add_rule("nat", "-A POSTROUTING -s " + subnet + " -j " + nat_chain);
+    batch.add_rule("nat", "-A " + nat_chain + " ! -o " + bridge_name + " -j MASQUERADE");
+
+    // 2. FORWARD规则允许容器间和容器到外网的流量
+    batch.declare_chain("filter", filter_chain);
+    batch.add_rule("filter", "-A FORWARD -i " + bridge_name + " -j " + filter_chain);
+    batch.add_rule("filter", "-A FORWARD -o " + bridge_name + " -j " + filter_chain);
+    batch.add_rule("filter", "-A " + filter_chain + " -j ACCEPT");
+
+    if (!batch.commit()) {
+        std::cerr << "[Firewall] Failed to setup rules for network: " << bridge_name << std::endl;
+        return false;
+    }
+    std::cout << "[Firewall] Network rules installed: " << nat_chain << ", " << filter_chain << std::endl;
+    return true;
+}
+
+// 删除旧版本直接写入 POSTROUTING/FORWARD 的网络规则（没有独立的链）。
+// 旧版本添加规则时不检查结果，部分规则可能不存在，因此逐条删除，互不影响
+static bool remove_legacy_network_rules(const std::string& bridge_name, const std::string& subnet) {
+    const std::pair<std::string, std::string> legacy_rules[] = {
+        {"nat", "-D POSTROUTING -s " + subnet + " ! -o " + bridge_name + " -j MASQUERADE"},
+        {"filter", "-D FORWARD -i " + bridge_name + " -j ACCEPT"},
+        {"filter", "-D FORWARD -o " + bridge_name + " -j ACCEPT"},
+    };
+    bool removed = false;
+    for (const auto& rule : legacy_rules) {
+        IptablesBatch batch;
+        batch.quiet = true;
+        batch.add_rule(rule.first, rule.second);
+        removed = batch.commit() || removed;
+    }
+    return removed;
+}
+
+// 删除网络级规则：先按独立链删除，旧版本创建的网络没有这些链时改为删除内联规则
+bool remove_network_firewall(const std::string& bridge_name, const std::string& subnet) {
+    std::string nat_chain = network_nat_chain(bridge_name);
+    std::string filter_chain = network_filter_chain(bridge_name);
+
+    IptablesBatch batch;
+    batch.quiet = true;
+    batch.declare_chain("nat", nat_chain);
+    batch.add_rule("nat", "-D POSTROUTING -s " + subnet + " -j " + nat_chain);
+    batch.add_rule("nat", "-X " + nat_chain);
+    batch.declare_chain("filter", filter_chain);
+    batch.add_rule("filter", "-D FORWARD -i " + bridge_name + " -j " + filter_chain);
+    batch.add_rule("filter", "-D FORWARD -o " + bridge_name + " -j " + filter_chain);
+    batch.add_rule("filter", "-X " + filter_chain);
+    if (batch.commit()) {
+        return true;
+    }
+    if (remove_legacy_network_rules(bridge_name, subnet)) {
+        std::cout << "[Firewall] Removed legacy inline rules for network: " << bridge_name << std::endl;
+        return true;
+    }
+    std::cerr << "[Firewall] Failed to remove rules for network: " << bridge_name << std::endl;
+    return false;
+}
+
+// 配置端口映射：所有映射写入容器专属链，一次提交
+bool setup_port_mapping(const std::string& container_id, const std::string& container_ip,
+                        const std::vector<std::string>& port_mapping) {
+    std::string chain = container_nat_chain(container_id);
+
+    IptablesBatch batch;
+    batch.declare_chain("nat", chain);
+    batch.add_rule("nat", "-A PREROUTING -j " + chain);
+
+    for (const auto& mapping : port_mapping) {
+        size_t colon_pos = mapping.find(':');
+        if (colon_pos == std::string::npos) {
+            std::cerr << "[Network] Invalid port mapping format: " << mapping << std::endl;
+            continue;
+        }
+
+        std::string host_port = mapping.substr(0, colon_pos);
+        std::string container_port = mapping.substr(colon_pos + 1);
+        if (host_port.empty() || container_port.empty() ||
+            !std::all_of(host_port.begin(), host_port.end(), ::isdigit) ||
+            !std::all_of(container_port.begin(), container_port.end(), ::isdigit)) {
+            std::cerr << "[Network] Invalid port mapping format: " << mapping << std::endl;
+            continue;
+        }
+
+        batch.add_rule("nat", "-A " + chain + " -p tcp --dport " + host_port +
+                              " -j DNAT --to-destination " + container_ip + ":" + container_port);
+        std::cout << "[Network] Port mapping setup: " << host_port << " -> " << container_ip << ":" << container_port << std::endl;
+    }
+
+    if (!batch.commit()) {
+        std::cerr << "[Network] Failed to setup port mapping for container: " << container_id << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 删除端口映射：删除跳转规则和容器链，与规则数量无关
+// 容器没有端口映射时链不存在，提交失败是正常的，因此静默处理
+bool remove_port_mapping(const std::string& container_id) {
+    std::string chain = container_nat_chain(container_id);
+
+    IptablesBatch batch;
+    batch.quiet = true;
+    batch.declare_chain("nat", chain);
+    batch.add_rule("nat", "-D PREROUTING -j " + chain);
+    batch.add_rule("nat", "-X " + chain);
+    return batch.commit();
+}
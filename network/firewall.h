@@ -0,0 +1,40 @@
+#ifndef FIREWALL_H
+#define FIREWALL_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// ==================== iptables 规则批处理 ====================
+// 累积一组规则，最后通过一次 `iptables-restore --noflush` 原子提交，
+// 避免每条规则都重新加载整张表
+
+struct IptablesBatch {
+    std::vector<std::string> table_order;                   // 表的提交顺序
+    std::map<std::string, std::vector<std::string>> rules;  // table -> 规则行
+    bool quiet = false;                                     // 提交失败时不输出错误
+
+    // 声明自定义链（链已存在时会被清空）
+    void declare_chain(const std::string& table, const std::string& chain);
+    // 追加一条规则，格式与 iptables-save 输出一致，如 "-A PREROUTING -j XXX"
+    void add_rule(const std::string& table, const std::string& rule);
+    bool empty() const;
+    // 一次性提交所有规则
+    bool commit() const;
+};
+
+// 每个网络/容器使用独立的链，删除时只需删除一条跳转规则和整条链
+std::string network_nat_chain(const std::string& bridge_name);
+std::string network_filter_chain(const std::string& bridge_name);
+std::string container_nat_chain(const std::string& container_id);
+
+// 网络级规则：出站MASQUERADE和FORWARD放行
+bool setup_network_firewall(const std::string& bridge_name, const std::string& subnet);
+bool remove_network_firewall(const std::string& bridge_name, const std::string& subnet);
+
+// 容器级规则：端口映射（DNAT）
+bool setup_port_mapping(const std::string& container_id, const std::string& container_ip,
+                        const std::vector<std::string>& port_mapping);
+bool remove_port_mapping(const std::string& container_id);
+
+#endif // FIREWALL_H
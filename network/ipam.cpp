@@ -0,0 +1,448 @@
+#include "ipam.h"
+#include "common/structures.h"
+#include "common/constants.h"
+#include "common/utils.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+// 支持的最大子网（/8 对应 16M 地址，位图约 2MB）
+static const int IPAM_MIN_PREFIX = 8;
+// /31、/32 没有可分配给容器的地址（需保留网络地址、网关和广播地址）
+static const int IPAM_MAX_PREFIX = 30;
+
+// ==================== 地址工具 ====================
+
+bool ipv4_from_string(const std::string& ip, uint32_t& out) {
+    in_addr addr;
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+        return false;
+    }
+    out = ntohl(addr.s_addr);
+    return true;
+}
+
+std::string ipv4_to_string(uint32_t ip) {
+    in_addr addr;
+    addr.s_addr = htonl(ip);
+    char buffer[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
+    return std::string(buffer);
+}
+
+bool parse_cidr(const std::string& cidr, uint32_t& network, int& prefix_len) {
+    size_t slash_pos = cidr.find('/');
+    if (slash_pos == std::string::npos) {
+        return false;
+    }
+    uint32_t ip;
+    if (!ipv4_from_string(cidr.substr(0, slash_pos), ip)) {
+        return false;
+    }
+    try {
+        prefix_len = std::stoi(cidr.substr(slash_pos + 1));
+    } catch (...) {
+        return false;
+    }
+    if (prefix_len < 0 || prefix_len > 32) {
+        return false;
+    }
+    uint32_t mask = prefix_len == 0 ? 0 : (0xFFFFFFFFu << (32 - prefix_len));
+    network = ip & mask;
+    return true;
+}
+
+std::string ipam_gateway(const std::string& subnet) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len)) {
+        return "";
+    }
+    return ipv4_to_string(network + 1);
+}
+
+// ==================== 位图操作 ====================
+
+int64_t bitmap_find_free(const uint64_t* words, size_t word_count, size_t cursor) {
+    if (word_count == 0) {
+        return -1;
+    }
+    size_t start_word = (cursor / 64) % word_count;
+
+    // 起始字中屏蔽游标之前的位
+    uint64_t free_bits = ~words[start_word] & (~0ULL << (cursor % 64));
+    if (free_bits != 0) {
+        return start_word * 64 + __builtin_ctzll(free_bits);
+    }
+
+    // 依次检查后续的字，最后回绕到起始字的低位部分
+    for (size_t i = 1; i <= word_count; ++i) {
+        size_t w = (start_word + i) % word_count;
+        free_bits = ~words[w];
+        if (free_bits != 0) {
+            return w * 64 + __builtin_ctzll(free_bits);
+        }
+    }
+    return -1;
+}
+
+// ==================== IPAM存储 ====================
+// subnet.db 布局：
+//   第0页：文件头 + 子网目录（固定大小的条目数组）
+//   第1页起：位图页，每页4096字节（32768个地址），每个子网占用连续的若干页
+// 所有进程通过 flock 串行化访问；一次分配只修改并 msync 一个位图页。
+// 新建子网时先写好位图页，再在目录中发布条目，崩溃时最多遗留未被引用的页。
+
+static const char IPAM_MAGIC[8] = {'M', 'Y', 'D', 'I', 'P', 'A', 'M', '1'};
+static const size_t IPAM_PAGE_SIZE = 4096;
+static const size_t IPAM_WORDS_PER_PAGE = IPAM_PAGE_SIZE / sizeof(uint64_t);
+
+struct IPAMFileEntry {
+    uint32_t network;     // 网络地址（主机字节序）
+    uint8_t prefix_len;
+    uint8_t in_use;       // 0表示空闲槽位（其页可被复用）
+    uint16_t reserved;
+    uint32_t first_page;  // 位图起始页号
+    uint32_t page_count;
+    uint32_t cursor;      // next-fit 游标
+};
+
+struct IPAMFileHeader {
+    char magic[8];
+    uint32_t page_count;  // 文件总页数（含文件头页）
+    uint32_t entry_count; // 已使用的目录槽位数（含空闲槽位）
+};
+
+static const size_t IPAM_MAX_ENTRIES = (IPAM_PAGE_SIZE - sizeof(IPAMFileHeader)) / sizeof(IPAMFileEntry);
+
+// 已加锁并映射的存储文件
+struct IPAMStore {
+    int fd = -1;
+    char* base = nullptr;
+    size_t length = 0;
+
+    IPAMFileHeader* header() { return reinterpret_cast<IPAMFileHeader*>(base); }
+    IPAMFileEntry* entries() { return reinterpret_cast<IPAMFileEntry*>(base + sizeof(IPAMFileHeader)); }
+    uint64_t* page_words(uint32_t page) { return reinterpret_cast<uint64_t*>(base + page * IPAM_PAGE_SIZE); }
+};
+
+// 将修改过的区域同步到文件（按页对齐）
+static void ipam_sync(IPAMStore& store, const void* address, size_t length) {
+    size_t offset = static_cast<const char*>(address) - store.base;
+    size_t start = offset / IPAM_PAGE_SIZE * IPAM_PAGE_SIZE;
+    size_t end = (offset + length + IPAM_PAGE_SIZE - 1) / IPAM_PAGE_SIZE * IPAM_PAGE_SIZE;
+    if (msync(store.base + start, end - start, MS_SYNC) != 0) {
+        perror("[IPAM] msync failed");
+    }
+}
+
+static bool ipam_map(IPAMStore& store, size_t length) {
+    void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, store.fd, 0);
+    if (address == MAP_FAILED) {
+        perror("[IPAM] mmap failed");
+        return false;
+    }
+    store.base = static_cast<char*>(address);
+    store.length = length;
+    return true;
+}
+
+static void ipam_close(IPAMStore& store) {
+    if (store.base != nullptr) {
+        munmap(store.base, store.length);
+        store.base = nullptr;
+    }
+    if (store.fd >= 0) {
+        flock(store.fd, LOCK_UN);
+        close(store.fd);
+        store.fd = -1;
+    }
+}
+
+// 打开存储文件并加排他锁，不存在时初始化
+static bool ipam_open(const std::string& path, IPAMStore& store) {
+    std::string dir = path.substr(0, path.find_last_of('/'));
+    create_directory_if_not_exists(dir);
+
+    store.fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store.fd < 0) {
+        perror("[IPAM] Failed to open subnet store");
+        return false;
+    }
+    if (flock(store.fd, LOCK_EX) != 0) {
+        perror("[IPAM] flock failed");
+        ipam_close(store);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(store.fd, &st) != 0) {
+        perror("[IPAM] fstat failed");
+        ipam_close(store);
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        // 新文件：写入文件头页
+        if (ftruncate(store.fd, IPAM_PAGE_SIZE) != 0 || !ipam_map(store, IPAM_PAGE_SIZE)) {
+            ipam_close(store);
+            return false;
+        }
+        memcpy(store.header()->magic, IPAM_MAGIC, sizeof(IPAM_MAGIC));
+        store.header()->page_count = 1;
+        store.header()->entry_count = 0;
+        ipam_sync(store, store.base, IPAM_PAGE_SIZE);
+        return true;
+    }
+
+    if (!ipam_map(store, st.st_size)) {
+        ipam_close(store);
+        return false;
+    }
+    if (memcmp(store.header()->magic, IPAM_MAGIC, sizeof(IPAM_MAGIC)) != 0 ||
+        store.header()->page_count * IPAM_PAGE_SIZE > store.length) {
+        std::cerr << "[IPAM] Corrupted subnet store: " << path << std::endl;
+        ipam_close(store);
+        return false;
+    }
+    return true;
+}
+
+// 扩展文件并重新映射
+static bool ipam_grow(IPAMStore& store, uint32_t page_count) {
+    size_t new_length = static_cast<size_t>(page_count) * IPAM_PAGE_SIZE;
+    if (new_length <= store.length) {
+        return true;
+    }
+    if (ftruncate(store.fd, new_length) != 0) {
+        perror("[IPAM] ftruncate failed");
+        return false;
+    }
+    munmap(store.base, store.length);
+    store.base = nullptr;
+    return ipam_map(store, new_length);
+}
+
+static IPAMFileEntry* ipam_find(IPAMStore& store, uint32_t network, int prefix_len) {
+    IPAMFileEntry* entries = store.entries();
+    for (uint32_t i = 0; i < store.header()->entry_count; ++i) {
+        if (entries[i].in_use && entries[i].network == network && entries[i].prefix_len == prefix_len) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+// 子网地址总数
+static uint32_t entry_size(const IPAMFileEntry* entry) {
+    return 1u << (32 - entry->prefix_len);
+}
+
+// 子网位图的字数
+static size_t entry_word_count(const IPAMFileEntry* entry) {
+    return (entry_size(entry) + 63) / 64;
+}
+
+// 创建子网：分配位图页、初始化保留地址，最后发布目录条目
+static IPAMFileEntry* ipam_create(IPAMStore& store, const std::string& cidr) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(cidr, network, prefix_len)) {
+        std::cerr << "[IPAM] Invalid subnet: " << cidr << std::endl;
+        return nullptr;
+    }
+    if (prefix_len < IPAM_MIN_PREFIX || prefix_len > IPAM_MAX_PREFIX) {
+        std::cerr << "[IPAM] Unsupported prefix length /" << prefix_len << " (supported: /"
+                  << IPAM_MIN_PREFIX << " - /" << IPAM_MAX_PREFIX << ")" << std::endl;
+        return nullptr;
+    }
+
+    uint32_t size = 1u << (32 - prefix_len);
+    size_t word_count = (size + 63) / 64;
+    uint32_t pages_needed = (word_count + IPAM_WORDS_PER_PAGE - 1) / IPAM_WORDS_PER_PAGE;
+
+    // 优先复用已删除子网的槽位和页
+    IPAMFileEntry* entries = store.entries();
+    int slot = -1;
+    for (uint32_t i = 0; i < store.header()->entry_count; ++i) {
+        if (!entries[i].in_use && entries[i].page_count >= pages_needed) {
+            slot = i;
+            break;
+        }
+    }
+
+    IPAMFileEntry entry = {};
+    entry.network = network;
+    entry.prefix_len = prefix_len;
+    entry.in_use = 1;
+    entry.cursor = 0;
+
+    if (slot >= 0) {
+        entry.first_page = entries[slot].first_page;
+        entry.page_count = entries[slot].page_count;
+    } else {
+        if (store.header()->entry_count >= IPAM_MAX_ENTRIES) {
+            std::cerr << "[IPAM] Too many subnets (max " << IPAM_MAX_ENTRIES << ")" << std::endl;
+            return nullptr;
+        }
+        entry.first_page = store.header()->page_count;
+        entry.page_count = pages_needed;
+        if (!ipam_grow(store, entry.first_page + entry.page_count)) {
+            return nullptr;
+        }
+        slot = store.header()->entry_count;
+    }
+
+    // 初始化位图：超出子网大小的尾部位置1，保留网络地址、网关和广播地址
+    uint64_t* words = store.page_words(entry.first_page);
+    memset(words, 0, entry.page_count * IPAM_PAGE_SIZE);
+    for (size_t i = size; i < word_count * 64; ++i) {
+        bitmap_set(words, i);
+    }
+    bitmap_set(words, 0);
+    bitmap_set(words, 1);
+    bitmap_set(words, size - 1);
+    ipam_sync(store, words, entry.page_count * IPAM_PAGE_SIZE);
+
+    // 发布条目
+    entries = store.entries();
+    entries[slot] = entry;
+    if (static_cast<uint32_t>(slot) == store.header()->entry_count) {
+        store.header()->entry_count++;
+    }
+    store.header()->page_count = std::max(store.header()->page_count, entry.first_page + entry.page_count);
+    ipam_sync(store, store.base, IPAM_PAGE_SIZE);
+    return &entries[slot];
+}
+
+// ==================== IPAM分配器 ====================
+
+// 全局分配器在静态初始化阶段构造，此时本编译单元的路径常量可能尚未初始化，因此默认路径在使用时才取
+const std::string& IPAMAllocator::store_path() const {
+    return subnet_file_path.empty() ? IPAM_DEFAULT_ALLOCATOR_PATH : subnet_file_path;
+}
+
+// 初始化子网的分配位图（已存在时保持不变）
+bool IPAMAllocator::init_subnet(const std::string& subnet) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len)) {
+        std::cerr << "[IPAM] Invalid subnet: " << subnet << std::endl;
+        return false;
+    }
+
+    IPAMStore store;
+    if (!ipam_open(store_path(), store)) {
+        return false;
+    }
+    bool ok = ipam_find(store, network, prefix_len) != nullptr || ipam_create(store, subnet) != nullptr;
+    ipam_close(store);
+    return ok;
+}
+
+// 删除子网及其全部分配：只需清除目录条目，位图页留给后续子网复用
+bool IPAMAllocator::remove_subnet(const std::string& subnet) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len)) {
+        return false;
+    }
+
+    IPAMStore store;
+    if (!ipam_open(store_path(), store)) {
+        return false;
+    }
+    IPAMFileEntry* entry = ipam_find(store, network, prefix_len);
+    if (entry != nullptr) {
+        entry->in_use = 0;
+        ipam_sync(store, entry, sizeof(IPAMFileEntry));
+    }
+    ipam_close(store);
+    return true;
+}
+
+std::string IPAMAllocator::allocate(const std::string& subnet) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len)) {
+        std::cerr << "[IPAM] Invalid subnet: " << subnet << std::endl;
+        return "";
+    }
+
+    IPAMStore store;
+    if (!ipam_open(store_path(), store)) {
+        return "";
+    }
+
+    // 初始化分配位图
+    IPAMFileEntry* entry = ipam_find(store, network, prefix_len);
+    if (entry == nullptr) {
+        entry = ipam_create(store, subnet);
+        if (entry == nullptr) {
+            ipam_close(store);
+            return "";
+        }
+    }
+
+    // 从游标开始查找第一个空闲位（next-fit），均摊O(1)
+    uint64_t* words = store.page_words(entry->first_page);
+    int64_t index = bitmap_find_free(words, entry_word_count(entry), entry->cursor);
+    if (index < 0) {
+        std::cerr << "[IPAM] No available IP in subnet: " << subnet << std::endl;
+        ipam_close(store);
+        return "";
+    }
+
+    // 只同步被修改的位图页；游标只是查找提示，无需立即落盘
+    bitmap_set(words, index);
+    ipam_sync(store, &words[index / 64], sizeof(uint64_t));
+    entry->cursor = static_cast<uint32_t>(index + 1) % entry_size(entry);
+    std::string ip = ipv4_to_string(network + static_cast<uint32_t>(index));
+    ipam_close(store);
+
+    std::cout << "[IPAM] Allocated IP: " << ip << " for subnet: " << subnet << std::endl;
+    return ip;
+}
+
+bool IPAMAllocator::release(const std::string& subnet, const std::string& ip) {
+    std::cout << "[IPAM] Releasing IP: " << ip << " from subnet: " << subnet << std::endl;
+
+    uint32_t network;
+    int prefix_len;
+    uint32_t address;
+    if (!parse_cidr(subnet, network, prefix_len) || !ipv4_from_string(ip, address)) {
+        return false;
+    }
+
+    IPAMStore store;
+    if (!ipam_open(store_path(), store)) {
+        return false;
+    }
+
+    IPAMFileEntry* entry = ipam_find(store, network, prefix_len);
+    if (entry == nullptr) {
+        ipam_close(store);
+        return true; // 子网不存在，认为已释放
+    }
+
+    // 计算IP在位图中的索引，网络地址、网关和广播地址始终保留
+    uint32_t index = address - network;
+    uint32_t size = entry_size(entry);
+    if (address < network || index >= size || index <= 1 || index == size - 1) {
+        ipam_close(store);
+        return false;
+    }
+
+    uint64_t* words = store.page_words(entry->first_page);
+    bitmap_clear(words, index);
+    ipam_sync(store, &words[index / 64], sizeof(uint64_t));
+    ipam_close(store);
+    return true;
+}
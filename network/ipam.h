@@ -0,0 +1,37 @@
+#ifndef IPAM_H
+#define IPAM_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// ==================== 地址工具 ====================
+
+// 解析 CIDR 格式子网，如 "10.0.0.0/16"，network 为主机字节序且已按前缀对齐
+bool parse_cidr(const std::string& cidr, uint32_t& network, int& prefix_len);
+
+// IPv4地址与字符串互转（主机字节序）
+bool ipv4_from_string(const std::string& ip, uint32_t& out);
+std::string ipv4_to_string(uint32_t ip);
+
+// 子网网关地址（网络地址 + 1），解析失败返回空字符串
+std::string ipam_gateway(const std::string& subnet);
+
+// ==================== 位图操作 ====================
+
+// 从 cursor 开始查找第一个为0的位（到末尾后回绕），找不到返回-1
+int64_t bitmap_find_free(const uint64_t* words, size_t word_count, size_t cursor);
+
+inline void bitmap_set(uint64_t* words, size_t index) {
+    words[index / 64] |= (1ULL << (index % 64));
+}
+
+inline void bitmap_clear(uint64_t* words, size_t index) {
+    words[index / 64] &= ~(1ULL << (index % 64));
+}
+
+inline bool bitmap_test(const uint64_t* words, size_t index) {
+    return (words[index / 64] >> (index % 64)) & 1ULL;
+}
+
+#endif // IPAM_H
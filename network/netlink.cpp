@@ -0,0 +1,388 @@
+#include "netlink.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/veth.h>
+
+// netlink 请求缓冲区
+struct NetlinkRequest {
+    alignas(NLMSG_ALIGNTO) char buf[4096];
+
+    nlmsghdr* header() { return reinterpret_cast<nlmsghdr*>(buf); }
+};
+
+static unsigned int nl_sequence = 0;
+
+// 初始化请求头和协议头（ifinfomsg/ifaddrmsg/rtmsg）
+static void nl_init_request(NetlinkRequest& req, unsigned short type, unsigned short flags,
+                            const void* payload, size_t payload_len) {
+    memset(req.buf, 0, sizeof(req.buf));
+    nlmsghdr* nlh = req.header();
+    nlh->nlmsg_len = NLMSG_LENGTH(payload_len);
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = NLM_F_REQUEST | flags;
+    nlh->nlmsg_seq = ++nl_sequence;
+    memcpy(NLMSG_DATA(nlh), payload, payload_len);
+}
+
+// 追加一个属性，返回属性指针（用于嵌套属性）
+static rtattr* nl_add_attr(NetlinkRequest& req, unsigned short type, const void* data, size_t len) {
+    nlmsghdr* nlh = req.header();
+    size_t attr_len = RTA_LENGTH(len);
+    if (NLMSG_ALIGN(nlh->nlmsg_len) + RTA_ALIGN(attr_len) > sizeof(req.buf)) {
+        std::cerr << "[Netlink] Request buffer overflow" << std::endl;
+        return nullptr;
+    }
+    rtattr* rta = reinterpret_cast<rtattr*>(req.buf + NLMSG_ALIGN(nlh->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = attr_len;
+    if (len > 0) {
+        memcpy(RTA_DATA(rta), data, len);
+    }
+    nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_ALIGN(attr_len);
+    return rta;
+}
+
+static rtattr* nl_add_attr_string(NetlinkRequest& req, unsigned short type, const std::string& value) {
+    return nl_add_attr(req, type, value.c_str(), value.size() + 1);
+}
+
+// 开始嵌套属性
+static rtattr* nl_nest_begin(NetlinkRequest& req, unsigned short type) {
+    return nl_add_attr(req, type, nullptr, 0);
+}
+
+// 结束嵌套属性，回填长度
+static void nl_nest_end(NetlinkRequest& req, rtattr* nest) {
+    if (nest == nullptr) return;
+    nest->rta_len = req.buf + req.header()->nlmsg_len - reinterpret_cast<char*>(nest);
+}
+
+// 发送请求并等待内核ACK
+static bool nl_talk(int nl_fd, NetlinkRequest& req) {
+    sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+
+    nlmsghdr* nlh = req.header();
+    nlh->nlmsg_flags |= NLM_F_ACK;
+    if (sendto(nl_fd, nlh, nlh->nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        perror("[Netlink] sendto failed");
+        return false;
+    }
+
+    alignas(NLMSG_ALIGNTO) char reply[8192];
+    while (true) {
+        ssize_t len = recv(nl_fd, reply, sizeof(reply), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            perror("[Netlink] recv failed");
+            return false;
+        }
+        for (nlmsghdr* msg = reinterpret_cast<nlmsghdr*>(reply); NLMSG_OK(msg, (unsigned int)len);
+             msg = NLMSG_NEXT(msg, len)) {
+            if (msg->nlmsg_seq != nlh->nlmsg_seq) continue;
+            if (msg->nlmsg_type == NLMSG_ERROR) {
+                nlmsgerr* err = static_cast<nlmsgerr*>(NLMSG_DATA(msg));
+                if (err->error != 0) {
+                    errno = -err->error;
+                    return false;
+                }
+                return true;
+            }
+        }
+    }
+}
+
+// 打开 NETLINK_ROUTE socket
+int nl_open_socket() {
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        perror("[Netlink] socket failed");
+        return -1;
+    }
+    sockaddr_nl local = {};
+    local.nl_family = AF_NETLINK;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        perror("[Netlink] bind failed");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 在容器网络命名空间中打开 socket
+int nl_open_socket_in_netns(pid_t pid) {
+    int self_ns = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+    if (self_ns < 0) {
+        perror("[Netlink] Failed to open own netns");
+        return -1;
+    }
+    std::string target_path = "/proc/" + std::to_string(pid) + "/ns/net";
+    int target_ns = open(target_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (target_ns < 0) {
+        perror("[Netlink] Failed to open container netns");
+        close(self_ns);
+        return -1;
+    }
+
+    int fd = -1;
+    if (setns(target_ns, CLONE_NEWNET) == 0) {
+        fd = nl_open_socket();
+        // 切换回宿主机命名空间，socket 仍属于容器命名空间
+        if (setns(self_ns, CLONE_NEWNET) != 0) {
+            perror("[Netlink] Failed to restore netns");
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    } else {
+        perror("[Netlink] setns failed");
+    }
+
+    close(target_ns);
+    close(self_ns);
+    return fd;
+}
+
+// 查询接口索引
+int nl_get_link_index(int nl_fd, const std::string& name) {
+    NetlinkRequest req;
+    ifinfomsg ifi = {};
+    ifi.ifi_family = AF_UNSPEC;
+    nl_init_request(req, RTM_GETLINK, 0, &ifi, sizeof(ifi));
+    nl_add_attr_string(req, IFLA_IFNAME, name);
+
+    sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    nlmsghdr* nlh = req.header();
+    if (sendto(nl_fd, nlh, nlh->nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        perror("[Netlink] sendto failed");
+        return 0;
+    }
+
+    alignas(NLMSG_ALIGNTO) char reply[8192];
+    while (true) {
+        ssize_t len = recv(nl_fd, reply, sizeof(reply), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        for (nlmsghdr* msg = reinterpret_cast<nlmsghdr*>(reply); NLMSG_OK(msg, (unsigned int)len);
+             msg = NLMSG_NEXT(msg, len)) {
+            if (msg->nlmsg_seq != nlh->nlmsg_seq) continue;
+            if (msg->nlmsg_type == NLMSG_ERROR) {
+                return 0; // 接口不存在
+            }
+            if (msg->nlmsg_type == RTM_NEWLINK) {
+                return static_cast<ifinfomsg*>(NLMSG_DATA(msg))->ifi_index;
+            }
+        }
+    }
+}
+
+// 检查网络接口是否存在
+bool nl_link_exists(const std::string& name) {
+    int fd = nl_open_socket();
+    if (fd < 0) return false;
+    bool exists = nl_get_link_index(fd, name) > 0;
+    close(fd);
+    return exists;
+}
+
+// 创建桥接设备
+bool nl_create_bridge(const std::string& name) {
+    int fd = nl_open_socket();
+    if (fd < 0) return false;
+
+    NetlinkRequest req;
+    ifinfomsg ifi = {};
+    ifi.ifi_family = AF_UNSPEC;
+    nl_init_request(req, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL, &ifi, sizeof(ifi));
+    nl_add_attr_string(req, IFLA_IFNAME, name);
+    rtattr* linkinfo = nl_nest_begin(req, IFLA_LINKINFO);
+    nl_add_attr_string(req, IFLA_INFO_KIND, "bridge");
+    nl_nest_end(req, linkinfo);
+
+    bool ok = nl_talk(fd, req);
+    if (!ok) {
+        perror("[Netlink] Failed to create bridge");
+    }
+    close(fd);
+    return ok;
+}
+
+// 删除网络接口
+bool nl_delete_link(const std::string& name) {
+    int fd = nl_open_socket();
+    if (fd < 0) return false;
+
+    NetlinkRequest req;
+    ifinfomsg ifi = {};
+    ifi.ifi_family = AF_UNSPEC;
+    nl_init_request(req, RTM_DELLINK, 0, &ifi, sizeof(ifi));
+    nl_add_attr_string(req, IFLA_IFNAME, name);
+
+    bool ok = nl_talk(fd, req);
+    if (!ok) {
+        perror("[Netlink] Failed to delete link");
+    }
+    close(fd);
+    return ok;
+}
+
+// 启动网络接口
+bool nl_set_link_up(int nl_fd, int ifindex) {
+    NetlinkRequest req;
+    ifinfomsg ifi = {};
+    ifi.ifi_family = AF_UNSPEC;
+    ifi.ifi_index = ifindex;
+    ifi.ifi_flags = IFF_UP;
+    ifi.ifi_change = IFF_UP;
+    nl_init_request(req, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+
+    if (!nl_talk(nl_fd, req)) {
+        perror("[Netlink] Failed to bring up link");
+        return false;
+    }
+    return true;
+}
+
+// 为接口添加IPv4地址
+bool nl_add_address(int nl_fd, int ifindex, const std::string& ip, int prefix_len) {
+    in_addr addr;
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+        std::cerr << "[Netlink] Invalid IP address: " << ip << std::endl;
+        return false;
+    }
+
+    NetlinkRequest req;
+    ifaddrmsg ifa = {};
+    ifa.ifa_family = AF_INET;
+    ifa.ifa_prefixlen = prefix_len;
+    ifa.ifa_scope = RT_SCOPE_UNIVERSE;
+    ifa.ifa_index = ifindex;
+    nl_init_request(req, RTM_NEWADDR, NLM_F_CREATE | NLM_F_EXCL, &ifa, sizeof(ifa));
+    nl_add_attr(req, IFA_LOCAL, &addr, sizeof(addr));
+    nl_add_attr(req, IFA_ADDRESS, &addr, sizeof(addr));
+
+    // 广播地址：主机位全部置1
+    if (prefix_len < 31) {
+        in_addr broadcast;
+        uint32_t host_mask = prefix_len == 0 ? 0xFFFFFFFFu : (0xFFFFFFFFu >> prefix_len);
+        broadcast.s_addr = addr.s_addr | htonl(host_mask);
+        nl_add_attr(req, IFA_BROADCAST, &broadcast, sizeof(broadcast));
+    }
+
+    if (!nl_talk(nl_fd, req)) {
+        perror("[Netlink] Failed to add address");
+        return false;
+    }
+    return true;
+}
+
+// 添加默认路由
+bool nl_add_default_route(int nl_fd, int ifindex, const std::string& gateway) {
+    in_addr gw;
+    if (inet_pton(AF_INET, gateway.c_str(), &gw) != 1) {
+        std::cerr << "[Netlink] Invalid gateway address: " << gateway << std::endl;
+        return false;
+    }
+
+    NetlinkRequest req;
+    rtmsg rtm = {};
+    rtm.rtm_family = AF_INET;
+    rtm.rtm_table = RT_TABLE_MAIN;
+    rtm.rtm_protocol = RTPROT_BOOT;
+    rtm.rtm_scope = RT_SCOPE_UNIVERSE;
+    rtm.rtm_type = RTN_UNICAST;
+    nl_init_request(req, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, &rtm, sizeof(rtm));
+    nl_add_attr(req, RTA_GATEWAY, &gw, sizeof(gw));
+    uint32_t oif = ifindex;
+    nl_add_attr(req, RTA_OIF, &oif, sizeof(oif));
+
+    if (!nl_talk(nl_fd, req)) {
+        perror("[Netlink] Failed to add default route");
+        return false;
+    }
+    return true;
+}
+
+// 解析MAC地址字符串
+static bool parse_mac(const std::string& mac, unsigned char out[6]) {
+    unsigned int b[6];
+    if (sscanf(mac.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; ++i) {
+        out[i] = static_cast<unsigned char>(b[i]);
+    }
+    return true;
+}
+
+// 创建veth pair，一条消息完成：创建、挂桥、peer端命名/设置MAC/移入容器命名空间
+bool nl_create_veth(const std::string& host_name, const std::string& bridge_name,
+                    const std::string& peer_name, const std::string& peer_mac, pid_t pid) {
+    unsigned char mac[6];
+    if (!parse_mac(peer_mac, mac)) {
+        std::cerr << "[Netlink] Invalid MAC address: " << peer_mac << std::endl;
+        return false;
+    }
+
+    int fd = nl_open_socket();
+    if (fd < 0) return false;
+
+    int bridge_index = nl_get_link_index(fd, bridge_name);
+    if (bridge_index <= 0) {
+        std::cerr << "[Netlink] Bridge not found: " << bridge_name << std::endl;
+        close(fd);
+        return false;
+    }
+
+    NetlinkRequest req;
+    ifinfomsg ifi = {};
+    ifi.ifi_family = AF_UNSPEC;
+    nl_init_request(req, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL, &ifi, sizeof(ifi));
+    nl_add_attr_string(req, IFLA_IFNAME, host_name);
+    uint32_t master = bridge_index;
+    nl_add_attr(req, IFLA_MASTER, &master, sizeof(master));
+
+    rtattr* linkinfo = nl_nest_begin(req, IFLA_LINKINFO);
+    nl_add_attr_string(req, IFLA_INFO_KIND, "veth");
+    rtattr* info_data = nl_nest_begin(req, IFLA_INFO_DATA);
+    rtattr* peer = nl_nest_begin(req, VETH_INFO_PEER);
+    // peer 属性以 ifinfomsg 开头
+    ifinfomsg peer_ifi = {};
+    peer_ifi.ifi_family = AF_UNSPEC;
+    nlmsghdr* nlh = req.header();
+    memcpy(req.buf + nlh->nlmsg_len, &peer_ifi, sizeof(peer_ifi));
+    nlh->nlmsg_len += NLMSG_ALIGN(sizeof(peer_ifi));
+    nl_add_attr_string(req, IFLA_IFNAME, peer_name);
+    nl_add_attr(req, IFLA_ADDRESS, mac, sizeof(mac));
+    uint32_t ns_pid = pid;
+    nl_add_attr(req, IFLA_NET_NS_PID, &ns_pid, sizeof(ns_pid));
+    nl_nest_end(req, peer);
+    nl_nest_end(req, info_data);
+    nl_nest_end(req, linkinfo);
+
+    bool ok = nl_talk(fd, req);
+    if (!ok) {
+        perror("[Netlink] Failed to create veth pair");
+        close(fd);
+        return false;
+    }
+
+    // 启动host端
+    int host_index = nl_get_link_index(fd, host_name);
+    ok = host_index > 0 && nl_set_link_up(fd, host_index);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,42 @@
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <string>
+#include <sys/types.h>
+
+// ==================== rtnetlink 网络接口管理 ====================
+// 直接通过 NETLINK_ROUTE socket 与内核通信，替代 fork/exec `ip` 命令
+
+// 打开 NETLINK_ROUTE socket（属于当前线程所在的网络命名空间）
+int nl_open_socket();
+
+// 在指定进程的网络命名空间中打开 NETLINK_ROUTE socket
+// socket 创建后即绑定到该命名空间，调用线程会切换回原命名空间
+int nl_open_socket_in_netns(pid_t pid);
+
+// 查询接口索引，不存在返回0
+int nl_get_link_index(int nl_fd, const std::string& name);
+
+// 检查网络接口是否存在
+bool nl_link_exists(const std::string& name);
+
+// 创建桥接设备
+bool nl_create_bridge(const std::string& name);
+
+// 删除网络接口
+bool nl_delete_link(const std::string& name);
+
+// 启动网络接口
+bool nl_set_link_up(int nl_fd, int ifindex);
+
+// 为接口添加IPv4地址
+bool nl_add_address(int nl_fd, int ifindex, const std::string& ip, int prefix_len);
+
+// 添加默认路由
+bool nl_add_default_route(int nl_fd, int ifindex, const std::string& gateway);
+
+// 创建veth pair：host端挂到bridge上，peer端直接以 peer_name 创建在 pid 的网络命名空间中
+bool nl_create_veth(const std::string& host_name, const std::string& bridge_name,
+                    const std::string& peer_name, const std::string& peer_mac, pid_t pid);
+
+#endif // NETLINK_H
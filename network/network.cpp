@@ -2,13 +2,45 @@
 #include "common/constants.h"
 #include "common/structures.h"
 #include "common/utils.h"
+#include "netlink.h"
+#include "ipam.h"
+#include "filesystem/filesystem.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <unistd.h>
 
 // 全局IPAM分配器
 IPAMAllocator ipam_allocator;
 
+// 当前进程使用的网络配置后端，空表示尚未确定
+static std::string current_backend;
+
+static bool valid_backend(const std::string& backend) {
+    return backend == "netlink" || backend == "shell";
+}
+
+const std::string& network_backend() {
+    if (current_backend.empty()) {
+        const char* env = getenv(NETWORK_BACKEND_ENV.c_str());
+        if (env && *env && !valid_backend(env)) {
+            std::cerr << "[Network] Ignoring invalid " << NETWORK_BACKEND_ENV << ": " << env << std::endl;
+        }
+        current_backend = (env && valid_backend(env)) ? env : DEFAULT_NETWORK_BACKEND;
+    }
+    return current_backend;
+}
+
+bool set_network_backend(const std::string& backend) {
+    if (!valid_backend(backend)) {
+        std::cerr << "[Network] Unknown network backend: " << backend << " (expected netlink or shell)" << std::endl;
+        return false;
+    }
+    current_backend = backend;
+    return true;
+}
+
 // 执行系统命令并返回输出
 std::string execute_command(const std::string& command) {
     std::string result = "";
@@ -28,11 +60,51 @@ std::string execute_command(const std::string& command) {
 
 // 检查网络接口是否存在
 bool interface_exists(const std::string& interface_name) {
+    if (network_backend() == "netlink") {
+        return nl_link_exists(interface_name);
+    }
     std::string command = "ip link show " + interface_name + " 2>/dev/null";
     std::string output = execute_command(command);
     return !output.empty();
 }
 
+// 删除网络接口
+bool delete_interface(const std::string& interface_name) {
+    if (network_backend() == "netlink") {
+        return nl_delete_link(interface_name);
+    }
+    std::string delete_cmd = "ip link delete " + interface_name;
+    return system(delete_cmd.c_str()) == 0;
+}
+
+// 从子网字符串中获取前缀长度，如 "192.168.1.0/24" -> 24
+static int subnet_prefix_length(const std::string& subnet) {
+    uint32_t network;
+    int prefix_len;
+    if (!parse_cidr(subnet, network, prefix_len)) return 24;
+    return prefix_len;
+}
+
+// 使用rtnetlink创建并配置桥接设备
+static bool create_bridge_netlink(const std::string& bridge_name, const std::string& subnet) {
+    if (!nl_create_bridge(bridge_name)) {
+        std::cerr << "[Network] Failed to create bridge: " << bridge_name << std::endl;
+        return false;
+    }
+
+    int fd = nl_open_socket();
+    if (fd < 0) return false;
+    int index = nl_get_link_index(fd, bridge_name);
+    bool ok = index > 0 &&
+              nl_add_address(fd, index, ipam_gateway(subnet), subnet_prefix_length(subnet)) &&
+              nl_set_link_up(fd, index);
+    close(fd);
+    if (!ok) {
+        std::cerr << "[Network] Failed to configure bridge: " << bridge_name << std::endl;
+    }
+    return ok;
+}
+
 // 创建桥接网络
 bool create_bridge_network(const std::string& bridge_name, const std::string& subnet) {
     std::cout << "[Network] Creating bridge network: " << bridge_name << std::endl;
@@ -43,43 +115,41 @@ bool create_bridge_network(const std::string& bridge_name, const std::string& su
         return true;
     }
     
-    // 创建桥接
-    std::string create_cmd = "ip link add " + bridge_name + " type bridge";
-    if (system(create_cmd.c_str()) != 0) {
-        std::cerr << "[Network] Failed to create bridge: " << bridge_name << std::endl;
-        return false;
-    }
-    
-    // 设置桥接IP地址（网关地址）
-    std::string gateway_ip = subnet.substr(0, subnet.find_last_of('.')) + ".1/24";
-    std::string ip_cmd = "ip addr add " + gateway_ip + " dev " + bridge_name;
-    if (system(ip_cmd.c_str()) != 0) {
-        std::cerr << "[Network] Failed to set bridge IP: " << gateway_ip << std::endl;
-        return false;
-    }
-    
-    // 启动桥接
-    std::string up_cmd = "ip link set " + bridge_name + " up";
-    if (system(up_cmd.c_str()) != 0) {
-        std::cerr << "[Network] Failed to bring up bridge: " << bridge_name << std::endl;
-        return false;
+    if (network_backend() == "netlink") {
+        if (!create_bridge_netlink(bridge_name, subnet)) {
+            return false;
+        }
+    } else {
+        // 创建桥接
+        std::string create_cmd = "ip link add " + bridge_name + " type bridge";
+        if (system(create_cmd.c_str()) != 0) {
+            std::cerr << "[Network] Failed to create bridge: " << bridge_name << std::endl;
+            return false;
+        }
+        
+        // 设置桥接IP地址（网关地址）
+        std::string gateway_ip = ipam_gateway(subnet) + "/" + std::to_string(subnet_prefix_length(subnet));
+        std::string ip_cmd = "ip addr add " + gateway_ip + " dev " + bridge_name;
+        if (system(ip_cmd.c_str()) != 0) {
+            std::cerr << "[Network] Failed to set bridge IP: " << gateway_ip << std::endl;
+            return false;
+        }
+        
+        // 启动桥接
+        std::string up_cmd = "ip link set " + bridge_name + " up";
+        if (system(up_cmd.c_str()) != 0) {
+            std::cerr << "[Network] Failed to bring up bridge: " << bridge_name << std::endl;
+            return false;
+        }
     }
     
     // 启用IP转发
-    std::string enable_forward_cmd = "echo 1 > /proc/sys/net/ipv4/ip_forward";
-    system(enable_forward_cmd.c_str());
-    
-    // 设置iptables规则
-    // 1. NAT规则用于出站流量
-    std::string iptables_nat_cmd = "iptables -t nat -A POSTROUTING -s " + subnet + " ! -o " + bridge_name + " -j MASQUERADE";
-    system(iptables_nat_cmd.c_str());
-    
-    // 2. FORWARD规则允许容器间和容器到外网的流量
-    std::string iptables_forward_in_cmd = "iptables -A FORWARD -i " + bridge_name + " -j ACCEPT";
-    system(iptables_forward_in_cmd.c_str());
+    std::ofstream ip_forward("/proc/sys/net/ipv4/ip_forward");
+    ip_forward << "1";
+    ip_forward.close();
     
-    std::string iptables_forward_out_cmd = "iptables -A FORWARD -o " + bridge_name + " -j ACCEPT";
-    system(iptables_forward_out_cmd.c_str());
+    // 设置iptables规则（NAT和FORWARD规则一次提交）
+    setup_network_firewall(bridge_name, subnet);
     
     std::cout << "[Network] Bridge network created successfully" << std::endl;
     return true;
@@ -95,8 +165,7 @@ bool delete_bridge_network(const std::string& bridge_name) {
     }
     
     // 删除桥接
-    std::string delete_cmd = "ip link delete " + bridge_name;
-    if (system(delete_cmd.c_str()) != 0) {
+    if (!delete_interface(bridge_name)) {
         std::cerr << "[Network] Failed to delete bridge: " << bridge_name << std::endl;
         return false;
     }
@@ -171,137 +240,6 @@ bool remove_network_config(const std::string& network_name) {
     return true;
 }
 
-// IP分配管理结构实现
-IPAMAllocator::IPAMAllocator() : subnet_file_path("/var/run/mydocker/network/ipam/subnet.json") {}
-
-bool IPAMAllocator::load() {
-    std::ifstream file(subnet_file_path);
-    if (!file.is_open()) {
-        return true; // 文件不存在是正常的
-    }
-    
-    std::string line, content;
-    while (std::getline(file, line)) {
-        content += line;
-    }
-    file.close();
-    
-    // 简单的JSON解析（仅支持我们的格式）
-    size_t start = 0;
-    while ((start = content.find('"', start)) != std::string::npos) {
-        size_t key_start = start + 1;
-        size_t key_end = content.find('"', key_start);
-        if (key_end == std::string::npos) break;
-        
-        std::string key = content.substr(key_start, key_end - key_start);
-        
-        start = content.find('"', key_end + 1);
-        if (start == std::string::npos) break;
-        
-        size_t value_start = start + 1;
-        size_t value_end = content.find('"', value_start);
-        if (value_end == std::string::npos) break;
-        
-        std::string value = content.substr(value_start, value_end - value_start);
-        subnets[key] = value;
-        
-        start = value_end + 1;
-    }
-    
-    return true;
-}
-
-bool IPAMAllocator::save() {
-    // 创建目录
-    std::string dir_cmd = "mkdir -p /var/run/mydocker/network/ipam";
-    system(dir_cmd.c_str());
-    
-    std::ofstream file(subnet_file_path);
-    if (!file.is_open()) {
-        std::cerr << "[IPAM] Failed to open subnet file for writing" << std::endl;
-        return false;
-    }
-    
-    file << "{\n";
-    bool first = true;
-    for (const auto& pair : subnets) {
-        if (!first) file << ",\n";
-        file << "  \"" << pair.first << "\": \"" << pair.second << "\"";
-        first = false;
-    }
-    file << "\n}\n";
-    file.close();
-    
-    return true;
-}
-
-std::string IPAMAllocator::allocate(const std::string& subnet) {
-    load();
-    
-    // 计算可用IP数量（简化版本，假设/24网络）
-    size_t slash_pos = subnet.find('/');
-    if (slash_pos == std::string::npos) return "";
-    
-    int prefix_len = std::stoi(subnet.substr(slash_pos + 1));
-    int available_ips = (prefix_len == 24) ? 254 : 30; // /24有254个可用IP，其他默认30个
-    
-    // 初始化分配位图
-    if (subnets.find(subnet) == subnets.end()) {
-        subnets[subnet] = std::string(available_ips, '0');
-    }
-    
-    std::string& allocation_map = subnets[subnet];
-    
-    // 查找第一个可用的IP（从索引1开始，跳过网关IP）
-    for (int i = 1; i < available_ips; ++i) {
-        if (allocation_map[i] == '0') {
-            allocation_map[i] = '1';
-            
-            // 计算IP地址
-            std::string network = subnet.substr(0, slash_pos);
-            std::string base_ip = network.substr(0, network.rfind('.'));
-            std::string ip = base_ip + "." + std::to_string(i + 1); // +1因为.1是网关
-            
-            // 保存分配信息
-            save();
-            
-            std::cout << "[IPAM] Allocated IP: " << ip << " for subnet: " << subnet << std::endl;
-            return ip;
-        }
-    }
-    
-    std::cerr << "[IPAM] No available IP in subnet: " << subnet << std::endl;
-    return "";
-}
-
-bool IPAMAllocator::release(const std::string& subnet, const std::string& ip) {
-    std::cout << "[IPAM] Releasing IP: " << ip << " from subnet: " << subnet << std::endl;
-    
-    load();
-    
-    if (subnets.find(subnet) == subnets.end()) {
-        return true; // 子网不存在，认为已释放
-    }
-    
-    // 计算IP在位图中的索引
-    std::string network = subnet.substr(0, subnet.find('/'));
-    std::string base_ip = network.substr(0, network.rfind('.'));
-    
-    size_t last_dot = ip.rfind('.');
-    if (last_dot == std::string::npos) return false;
-    
-    int ip_suffix = std::stoi(ip.substr(last_dot + 1));
-    int index = ip_suffix - 2; // -2因为索引0对应.2（.1是网关）
-    
-    if (index >= 0 && index < (int)subnets[subnet].length()) {
-        subnets[subnet][index] = '0';
-        save();
-        return true;
-    }
-    
-    return false;
-}
-
 // 改进的IP分配算法
 std::string allocate_ip(const std::string& subnet) {
     std::cout << "[Network] Allocating IP for subnet: " << subnet << std::endl;
@@ -313,39 +251,35 @@ bool release_ip(const std::string& subnet, const std::string& ip) {
     return ipam_allocator.release(subnet, ip);
 }
 
-// 创建veth pair并连接到容器（改进版本，使用IPAM分配IP）
-bool setup_container_network(const std::string& container_id, const std::string& network_name, 
-                           std::string& container_ip, pid_t container_pid) {
-    std::cout << "[Network] Setting up network for container: " << container_id << std::endl;
-    
-    // 加载网络配置
+// 按网络名称释放容器IP地址
+bool release_container_ip(const std::string& network_name, const std::string& ip) {
     NetworkInfo network = load_network_config(network_name);
-    if (network.name.empty()) {
-        std::cerr << "[Network] Network not found: " << network_name << std::endl;
+    if (network.ip_range.empty()) {
         return false;
     }
-    
-    // 如果没有指定IP，则通过IPAM分配
-    if (container_ip.empty()) {
-        container_ip = ipam_allocator.allocate(network.ip_range);
-        if (container_ip.empty()) {
-            std::cerr << "[Network] Failed to allocate IP for container in network: " << network_name << std::endl;
-            return false;
-        }
-        std::cout << "[Network] Allocated IP: " << container_ip << " for container: " << container_id << std::endl;
-    }
-    // Todo: 检查IP是否已分配
-    
+    return release_ip(network.ip_range, ip);
+}
+
+void release_container_network(const std::string& container_id, const std::string& network_name,
+                               const std::string& ip, bool port_mapping) {
+    // 容器网络命名空间销毁时对端随之删除，宿主机侧可能已不存在
     std::string veth_host = "veth" + container_id.substr(0, 5);
-    std::string veth_container = "vethpeer0";
-    
-    // 检查并清理已存在的veth设备
     if (interface_exists(veth_host)) {
-        std::cout << "[Network] Cleaning up existing veth interface: " << veth_host << std::endl;
-        std::string delete_veth_cmd = "ip link delete " + veth_host;
-        system(delete_veth_cmd.c_str());
+        delete_interface(veth_host);
     }
-    
+    if (port_mapping) {
+        remove_port_mapping(container_id);
+    }
+    if (!network_name.empty() && !ip.empty()) {
+        release_container_ip(network_name, ip);
+    }
+}
+
+// 使用ip/nsenter命令配置容器网络
+static bool setup_veth_shell(const std::string& veth_host, const std::string& veth_container,
+                             const std::string& network_name, pid_t container_pid,
+                             const std::string& mac_address, const std::string& container_ip,
+                             int prefix_len, const std::string& gateway) {
     // 创建veth pair
     std::string create_veth_cmd = "ip link add " + veth_host + " type veth peer name " + veth_container;
     std::cout<<create_veth_cmd<<std::endl;
@@ -379,32 +313,20 @@ bool setup_container_network(const std::string& container_id, const std::string&
     std::string rename_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip link set " + veth_container + " name eth0";
     if (system(rename_cmd.c_str()) != 0) {
         std::cerr << "[Network] Failed to rename container interface to eth0" << std::endl;
-        // 清理已创建的veth设备
-        std::string cleanup_cmd = "ip link delete " + veth_host;
-        system(cleanup_cmd.c_str());
         return false;
     }
 
-    // 生成唯一的MAC地址
-    std::string mac_address = generate_unique_mac(container_id);
+    // 设置MAC地址
     std::string set_mac_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip link set eth0 address " + mac_address;
     if (system(set_mac_cmd.c_str()) != 0) {
         std::cerr << "[Network] Failed to set MAC address: " << mac_address << std::endl;
-        // 清理已创建的veth设备
-        std::string cleanup_cmd = "ip link delete " + veth_host;
-        system(cleanup_cmd.c_str());
         return false;
     }
-    std::cout << "[Network] Set MAC address: " << mac_address << " for container: " << container_id << std::endl;
 
     // 在容器命名空间中配置网络
-    std::string set_ip_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip addr add " + container_ip + "/24 dev eth0";
+    std::string set_ip_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip addr add " + container_ip + "/" + std::to_string(prefix_len) + " dev eth0";
     if (system(set_ip_cmd.c_str()) != 0) {
         std::cerr << "[Network] Failed to set container IP" << std::endl;
-        // 清理已创建的veth设备和释放IP
-        std::string cleanup_cmd = "ip link delete " + veth_host;
-        system(cleanup_cmd.c_str());
-        ipam_allocator.release(network.ip_range, container_ip);
         return false;
     }
     
@@ -412,10 +334,6 @@ bool setup_container_network(const std::string& container_id, const std::string&
     std::string up_container_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip link set eth0 up";
     if (system(up_container_cmd.c_str()) != 0) {
         std::cerr << "[Network] Failed to bring up container veth" << std::endl;
-        // 清理已创建的veth设备和释放IP
-        std::string cleanup_cmd = "ip link delete " + veth_host;
-        system(cleanup_cmd.c_str());
-        ipam_allocator.release(network.ip_range, container_ip);
         return false;
     }
     
@@ -423,64 +341,126 @@ bool setup_container_network(const std::string& container_id, const std::string&
     std::string up_lo_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip link set lo up";
     system(up_lo_cmd.c_str());
     
-    // 设置默认路由 - 动态计算网关地址
-    std::string gateway;
-    if (network_name == DEFAULT_BRIDGE_NAME) {
-        gateway = "192.168.1.1";
-    } else {
-        // 从网络配置中获取子网信息并计算网关
-        NetworkInfo network = load_network_config(network_name);
-        if (!network.ip_range.empty()) {
-            size_t slash_pos = network.ip_range.find('/');
-            if (slash_pos != std::string::npos) {
-                std::string base_ip = network.ip_range.substr(0, slash_pos);
-                size_t last_dot = base_ip.find_last_of('.');
-                gateway = base_ip.substr(0, last_dot + 1) + "1";
-            } else {
-                gateway = "192.168.2.1"; // 默认值
-            }
-        } else {
-            gateway = "192.168.2.1"; // 默认值
-        }
-    }
-    
     std::string route_cmd = "nsenter -t " + std::to_string(container_pid) + " -n ip route add default via " + gateway;
     if (system(route_cmd.c_str()) != 0) {
         std::cerr << "[Network] Failed to set default route via " << gateway << std::endl;
     }
-    
-    // 设置DNS配置
-    std::string dns_cmd = "nsenter -t " + std::to_string(container_pid) + " -m sh -c 'echo \"nameserver 8.8.8.8\" > /etc/resolv.conf'";
-    system(dns_cmd.c_str());
-    
-    std::cout << "[Network] Container network setup completed" << std::endl;
     return true;
 }
 
-// 配置端口映射
-bool setup_port_mapping(const std::string& container_ip, const std::vector<std::string>& port_mapping) {
-    for (const auto& mapping : port_mapping) {
-        size_t colon_pos = mapping.find(':');
-        if (colon_pos == std::string::npos) {
-            std::cerr << "[Network] Invalid port mapping format: " << mapping << std::endl;
-            continue;
+// 使用rtnetlink配置容器网络，整个过程不创建子进程
+static bool setup_veth_netlink(const std::string& veth_host, const std::string& network_name,
+                               pid_t container_pid, const std::string& mac_address,
+                               const std::string& container_ip, int prefix_len,
+                               const std::string& gateway) {
+    // 一条RTM_NEWLINK消息完成veth创建、挂桥，peer端直接以eth0出现在容器命名空间中
+    if (!nl_create_veth(veth_host, network_name, "eth0", mac_address, container_pid)) {
+        std::cerr << "[Network] Failed to create veth pair" << std::endl;
+        return false;
+    }
+
+    // 在容器命名空间中打开netlink socket，后续配置都通过它完成
+    int fd = nl_open_socket_in_netns(container_pid);
+    if (fd < 0) {
+        std::cerr << "[Network] Failed to open netlink socket in container namespace" << std::endl;
+        return false;
+    }
+
+    int eth0 = nl_get_link_index(fd, "eth0");
+    if (eth0 <= 0 || !nl_add_address(fd, eth0, container_ip, prefix_len) || !nl_set_link_up(fd, eth0)) {
+        std::cerr << "[Network] Failed to configure container eth0" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // 启动loopback接口
+    int lo = nl_get_link_index(fd, "lo");
+    if (lo > 0) {
+        nl_set_link_up(fd, lo);
+    }
+
+    if (!nl_add_default_route(fd, eth0, gateway)) {
+        std::cerr << "[Network] Failed to set default route via " << gateway << std::endl;
+    }
+    close(fd);
+    return true;
+}
+
+// 创建veth pair并连接到容器（改进版本，使用IPAM分配IP）
+bool setup_container_network(const std::string& container_id, const std::string& network_name, 
+                           std::string& container_ip, pid_t container_pid) {
+    std::cout << "[Network] Setting up network for container: " << container_id << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    
+    // 加载网络配置
+    NetworkInfo network = load_network_config(network_name);
+    if (network.name.empty()) {
+        std::cerr << "[Network] Network not found: " << network_name << std::endl;
+        return false;
+    }
+    
+    // 如果没有指定IP，则通过IPAM分配
+    if (container_ip.empty()) {
+        container_ip = ipam_allocator.allocate(network.ip_range);
+        if (container_ip.empty()) {
+            std::cerr << "[Network] Failed to allocate IP for container in network: " << network_name << std::endl;
+            return false;
         }
-        
-        std::string host_port = mapping.substr(0, colon_pos);
-        std::string container_port = mapping.substr(colon_pos + 1);
-        
-        // 添加iptables规则进行端口转发
-        std::string iptables_cmd = "iptables -t nat -A PREROUTING -p tcp --dport " + host_port + 
-                                 " -j DNAT --to-destination " + container_ip + ":" + container_port;
-        
-        if (system(iptables_cmd.c_str()) != 0) {
-            std::cerr << "[Network] Failed to setup port mapping: " << mapping << std::endl;
-            continue;
+        std::cout << "[Network] Allocated IP: " << container_ip << " for container: " << container_id << std::endl;
+    }
+    // Todo: 检查IP是否已分配
+    
+    std::string veth_host = "veth" + container_id.substr(0, 5);
+    std::string veth_container = "vethpeer0";
+    
+    // 检查并清理已存在的veth设备
+    if (interface_exists(veth_host)) {
+        std::cout << "[Network] Cleaning up existing veth interface: " << veth_host << std::endl;
+        delete_interface(veth_host);
+    }
+
+    // 生成唯一的MAC地址
+    std::string mac_address = generate_unique_mac(container_id);
+    
+    // 设置默认路由 - 动态计算网关地址
+    std::string gateway = ipam_gateway(network.ip_range);
+    if (gateway.empty()) {
+        gateway = "192.168.2.1"; // 默认值
+    }
+    int prefix_len = subnet_prefix_length(network.ip_range);
+    
+    bool ok;
+    if (network_backend() == "netlink") {
+        ok = setup_veth_netlink(veth_host, network_name, container_pid, mac_address,
+                                container_ip, prefix_len, gateway);
+    } else {
+        ok = setup_veth_shell(veth_host, veth_container, network_name, container_pid,
+                              mac_address, container_ip, prefix_len, gateway);
+    }
+    if (!ok) {
+        // 清理已创建的veth设备和释放IP
+        if (interface_exists(veth_host)) {
+            delete_interface(veth_host);
         }
-        
-        std::cout << "[Network] Port mapping setup: " << host_port << " -> " << container_ip << ":" << container_port << std::endl;
+        ipam_allocator.release(network.ip_range, container_ip);
+        return false;
+    }
+    std::cout << "[Network] Set MAC address: " << mac_address << " for container: " << container_id << std::endl;
+    
+    // 设置DNS配置（直接写入容器的OverlayFS挂载点）
+    std::string resolv_path = get_workspace(container_id).mount_point + "etc/resolv.conf";
+    std::ofstream resolv_conf(resolv_path);
+    if (resolv_conf.is_open()) {
+        resolv_conf << "nameserver 8.8.8.8\n";
+        resolv_conf.close();
+    } else {
+        std::cerr << "[Network] Failed to write " << resolv_path << std::endl;
     }
     
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "[Network] Container network setup completed (" << network_backend()
+              << " backend, " << elapsed << " us)" << std::endl;
     return true;
 }
 
@@ -508,18 +488,17 @@ void network_create(const std::string& driver, const std::string& subnet, const
         return;
     }
     
-    // 通过IPAM分配网关IP（验证子网可用性）
-    std::string gateway_ip = ipam_allocator.allocate(subnet);
-    if (gateway_ip.empty()) {
-        std::cerr << "[Network] Failed to allocate gateway IP for subnet: " << subnet << std::endl;
+    // 初始化IPAM子网（验证子网可用性），网关地址在位图中保留
+    if (!ipam_allocator.init_subnet(subnet)) {
+        std::cerr << "[Network] Failed to initialize IPAM for subnet: " << subnet << std::endl;
         return;
     }
+    std::string gateway_ip = ipam_gateway(subnet);
     
     // 创建桥接网络
     if (!create_bridge_network(name, subnet)) {
         std::cerr << "[Network] Failed to create bridge network" << std::endl;
-        // 释放已分配的网关IP
-        ipam_allocator.release(subnet, gateway_ip);
+        ipam_allocator.remove_subnet(subnet);
         return;
     }
     
@@ -531,10 +510,9 @@ void network_create(const std::string& driver, const std::string& subnet, const
     
     if (!save_network_config(network)) {
         std::cerr << "[Network] Failed to save network config" << std::endl;
-        // 清理：删除桥接和释放IP
-        std::string cleanup_cmd = "ip link delete " + name;
-        system(cleanup_cmd.c_str());
-        ipam_allocator.release(subnet, gateway_ip);
+        // 清理：删除桥接和子网分配
+        delete_interface(name);
+        ipam_allocator.remove_subnet(subnet);
         return;
     }
     
@@ -582,14 +560,15 @@ void network_remove(const std::string& name) {
         return;
     }
     
+    // 删除网络的iptables链
+    if (!network.ip_range.empty()) {
+        remove_network_firewall(name, network.ip_range);
+    }
+    
     // 释放IPAM中的所有IP（简化实现：清空整个子网的分配）
     if (!network.ip_range.empty()) {
         std::cout << "[Network] Releasing IP allocations for subnet: " << network.ip_range << std::endl;
-        ipam_allocator.load();
-        if (ipam_allocator.subnets.find(network.ip_range) != ipam_allocator.subnets.end()) {
-            ipam_allocator.subnets.erase(network.ip_range);
-            ipam_allocator.save();
-        }
+        ipam_allocator.remove_subnet(network.ip_range);
     }
     
     // 删除网络配置
@@ -6,10 +6,17 @@
 #include "common/structures.h"
 #include "common/constants.h"
 #include "common/utils.h"
+#include "firewall.h"
+
+// 网络配置后端：首次调用时读取环境变量 MYDOCKER_NET_BACKEND，未设置时为 DEFAULT_NETWORK_BACKEND
+const std::string& network_backend();
+// 切换本进程的网络配置后端（"netlink" 或 "shell"），名称无效时返回false
+bool set_network_backend(const std::string& backend);
 
 // 网络接口管理
 bool interface_exists(const std::string& interface_name);
 std::string execute_command(const std::string& command);
+bool delete_interface(const std::string& interface_name);
 
 // 桥接网络管理
 bool create_bridge_network(const std::string& bridge_name, const std::string& subnet);
@@ -23,11 +30,16 @@ bool remove_network_config(const std::string& network_name);
 // IP分配管理
 std::string allocate_ip(const std::string& subnet);
 bool release_ip(const std::string& subnet, const std::string& ip);
+bool release_container_ip(const std::string& network_name, const std::string& ip);
+
+// 释放容器的网络资源：宿主机侧veth、端口映射链及其PREROUTING跳转、IP地址。
+// 前台运行、supervisor、容器池和 rm 的退出路径共用；port_mapping 为false时不调用iptables
+void release_container_network(const std::string& container_id, const std::string& network_name,
+                               const std::string& ip, bool port_mapping);
 
-// 容器网络设置
+// 容器网络设置。container_ip 为空时由IPAM分配；veth配置失败时该IP已归还，调用者不能再释放
 bool setup_container_network(const std::string& container_id, const std::string& network_name, 
                            std::string& container_ip, pid_t container_pid);
-bool setup_port_mapping(const std::string& container_ip, const std::vector<std::string>& port_mapping);
 
 // 网络命令处理
 void network_create(const std::string& driver, const std::string& subnet, const std::string& name);
@@ -0,0 +1,1003 @@
+#include "supervisor.h"
+#include "common/constants.h"
+#include "common/structures.h"
+#include "common/utils.h"
+#include "common/message.h"
+#include "container/container.h"
+#include "container/run.h"
+#include "container/spawn.h"
+#include "network/network.h"
+#include "filesystem/filesystem.h"
+#include "cgroup/cgroup.h"
+#include "cgroup/cpualloc.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/file.h>
+
+// 工作进程的标记（监管进程fork工作进程时设置）
+static const char* SUPERVISED_ENV = "MYDOCKER_SUPERVISED";
+// 自动启动监管进程后等待其开始监听的时间
+static const int SUPERVISOR_START_TIMEOUT_MS = 2000;
+
+extern char** environ;
+
+typedef std::chrono::steady_clock Clock;
+
+bool parse_restart_policy(const std::string& value, RestartPolicy& policy) {
+    policy = RestartPolicy();
+    if (value.empty() || value == "no") {
+        return true;
+    }
+    if (value == "always") {
+        policy.mode = RestartPolicy::ALWAYS;
+        return true;
+    }
+    const std::string on_failure = "on-failure";
+    if (value.compare(0, on_failure.size(), on_failure) == 0) {
+        policy.mode = RestartPolicy::ON_FAILURE;
+        if (value.size() == on_failure.size()) {
+            return true;
+        }
+        if (value[on_failure.size()] == ':') {
+            const char* start = value.c_str() + on_failure.size() + 1;
+            char* end;
+            long retries = strtol(start, &end, 10);
+            if (*end == '\0' && end != start && retries >= 0 && retries <= INT_MAX) {
+                policy.max_retries = static_cast<int>(retries);
+                return true;
+            }
+        }
+    }
+    std::cerr << "[Error] Invalid --restart value: " << value << " (expected no, always or on-failure[:N])" << std::endl;
+    return false;
+}
+
+// ==================== 客户端 ====================
+
+static int connect_supervisor() {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SUPERVISOR_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 发送一个请求并等待响应，监管进程未运行时返回false
+static bool supervisor_request(const std::vector<std::string>& fields, std::string& reply) {
+    int fd = connect_supervisor();
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<int> unused;
+    bool ok = send_message(fd, join_fields(fields)) && receive_message(fd, reply, unused);
+    close_fds(unused);
+    close(fd);
+    return ok;
+}
+
+// 在后台启动监管进程：新会话，输出写入 SUPERVISOR_LOG_FILE
+static bool start_supervisor_process() {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("[Supervisor] fork failed");
+        return false;
+    }
+    if (pid == 0) {
+        setsid();
+        int null_fd = open("/dev/null", O_RDONLY);
+        int log_fd = open(SUPERVISOR_LOG_FILE.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (null_fd >= 0) dup2(null_fd, STDIN_FILENO);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+        }
+        execl("/proc/self/exe", "simple", "supervisor", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    return true;
+}
+
+static std::string current_directory() {
+    char cwd[PATH_MAX];
+    return getcwd(cwd, sizeof(cwd)) != nullptr ? cwd : "/";
+}
+
+bool run_supervised(int argc, char* argv[], int& exit_code) {
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+    int fd = connect_supervisor();
+    if (fd < 0) {
+        std::cout << "[Supervisor] Starting supervisor (output in " << SUPERVISOR_LOG_FILE << ")" << std::endl;
+        if (start_supervisor_process()) {
+            for (int waited = 0; fd < 0 && waited < SUPERVISOR_START_TIMEOUT_MS; waited += 10) {
+                usleep(10 * 1000);
+                fd = connect_supervisor();
+            }
+        }
+        if (fd < 0) {
+            std::cerr << "[Supervisor] Supervisor is not available" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<std::string> fields = {"RUN", current_directory()};
+    for (int i = 1; i < argc; ++i) {
+        fields.push_back(argv[i]);
+    }
+    std::string reply;
+    std::vector<int> unused;
+    if (!send_message(fd, join_fields(fields), {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO})) {
+        std::cerr << "[Supervisor] Failed to send request to supervisor" << std::endl;
+        close(fd);
+        return false;
+    }
+    // 工作进程直接输出到客户端的终端，这里只等待退出码
+    if (receive_message(fd, reply, unused) && reply.compare(0, 5, "EXIT ") == 0) {
+        exit_code = atoi(reply.c_str() + 5);
+    } else {
+        std::cerr << "[Supervisor] Lost connection to supervisor" << std::endl;
+        exit_code = 1;
+    }
+    close_fds(unused);
+    close(fd);
+    return true;
+}
+
+bool is_supervised_worker() {
+    static int supervised = -1;
+    if (supervised < 0) {
+        supervised = getenv(SUPERVISED_ENV) != nullptr ? 1 : 0;
+        unsetenv(SUPERVISED_ENV);
+    }
+    return supervised == 1;
+}
+
+// 本进程的命令行参数（不含argv[0]），登记时作为重启参数
+static std::vector<std::string> own_arguments() {
+    std::ifstream file("/proc/self/cmdline");
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::string> args = split_fields(content);
+    if (!args.empty()) {
+        args.erase(args.begin());
+    }
+    return args;
+}
+
+void report_supervised_container(const std::string& container_name) {
+    if (!is_supervised_worker()) {
+        return;
+    }
+    std::vector<std::string> fields = {"WATCH", container_name, current_directory()};
+    std::vector<std::string> args = own_arguments();
+    fields.insert(fields.end(), args.begin(), args.end());
+    std::string reply;
+    if (!supervisor_request(fields, reply) || reply != "OK") {
+        std::cerr << "[Supervisor] Failed to register container " << container_name << " with supervisor: "
+                  << reply << std::endl;
+    }
+}
+
+bool notify_supervisor_stop(const std::string& container_name) {
+    std::string reply;
+    return supervisor_request({"STOP", container_name}, reply) && reply == "OK watched";
+}
+
+// ==================== 监管进程 ====================
+
+namespace {
+
+// 被监管的容器进程
+struct SupervisedContainer {
+    std::string name;
+    std::string id;
+    pid_t pid = -1;
+    int pidfd = -1;
+    std::string cwd;                    // 重启时的工作目录
+    std::vector<std::string> args;      // 重启时的 run 参数
+    RestartPolicy policy;
+    bool stop_requested = false;        // 收到STOP，退出后不重启
+    bool awaiting_reparent = false;     // 已退出但仍是工作进程的子进程，等待被收养后回收
+    Clock::time_point started;
+};
+
+// 执行 run 命令的工作进程
+struct Worker {
+    int client_fd = -1;                 // 客户端连接，工作进程退出后返回退出码；重启时为-1
+    std::string restart_name;           // 重启的容器名
+    std::string cwd;
+    std::vector<std::string> args;
+    RestartPolicy policy;
+};
+
+// 后台清理任务
+struct CleanupJob {
+    std::string name;
+    std::string id;
+    std::string exit_code;              // 无法获取时为空
+    bool stopped = false;
+    bool restart = false;
+    std::string cwd;
+    std::vector<std::string> args;
+    RestartPolicy policy;
+    Clock::duration ran = Clock::duration::zero();
+};
+
+// 等待执行的重启
+struct PendingRestart {
+    std::string name;
+    std::string cwd;
+    std::vector<std::string> args;
+    RestartPolicy policy;
+    Clock::time_point due;
+};
+
+// 各容器跨重启保留的状态
+struct RestartState {
+    int restarts = 0;   // 已重启次数
+    int backoff = 0;    // 连续快速退出次数，决定下次重启的等待时间
+};
+
+// epoll 事件标识：高32位为类型，低32位为PID
+enum EventTag : uint64_t { TAG_LISTEN = 1, TAG_SIGNAL, TAG_CLEANUP, TAG_CONTAINER };
+
+uint64_t event_data(EventTag tag, pid_t pid = 0) {
+    return (static_cast<uint64_t>(tag) << 32) | static_cast<uint32_t>(pid);
+}
+
+class Supervisor {
+public:
+    ~Supervisor();
+    bool init();
+    int serve();
+
+private:
+    void adopt_containers();
+    bool watch_container(const std::string& name, const std::string& cwd, const std::vector<std::string>& args,
+                         std::string& error);
+    void handle_client(int client_fd);
+    bool launch_worker(const Worker& worker, const std::vector<int>& stdio);
+    void reap_children();
+    void check_container(pid_t pid);
+    void container_exited(pid_t pid, const std::string& exit_code);
+    void worker_exited(pid_t pid, const std::string& exit_code);
+    bool should_restart(const RestartPolicy& policy, const std::string& exit_code, const std::string& name);
+    void queue_cleanup(const CleanupJob& job);
+    void cleanup_loop();
+    void finish_cleanups();
+    void launch_due_restarts();
+    int next_timeout() const;
+    void shutdown();
+
+    int lock_fd = -1;
+    int listen_fd = -1;
+    int signal_fd = -1;
+    int cleanup_fd = -1;
+    int epoll_fd = -1;
+
+    std::map<pid_t, SupervisedContainer> containers;
+    std::map<std::string, pid_t> container_pids;   // 名称 -> PID
+    std::map<pid_t, Worker> workers;
+    std::map<std::string, RestartState> restart_states;
+    std::vector<PendingRestart> pending_restarts;
+
+    // 清理线程：卸载、删除cgroup、释放IP等可能阻塞的操作不在事件循环中执行
+    std::thread cleanup_thread;
+    std::mutex cleanup_mutex;
+    std::condition_variable cleanup_cv;
+    std::deque<CleanupJob> cleanup_queue;
+    std::deque<CleanupJob> cleanup_done;
+    bool cleanup_stop = false;
+};
+
+// 进程的父进程PID（/proc/<pid>/stat 第4个字段），读取失败返回-1
+pid_t process_parent(pid_t pid) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(file, stat);
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    std::istringstream fields(stat.substr(pos + 1));
+    std::string state;
+    pid_t parent = -1;
+    fields >> state >> parent;
+    return parent;
+}
+
+std::string exit_code_of(const siginfo_t& info) {
+    int code = info.si_code == CLD_EXITED ? info.si_status : 128 + info.si_status;
+    return std::to_string(code);
+}
+
+// 重启参数：副本中的每个容器单独重启，因此去掉 --replicas 并指定原容器名
+std::vector<std::string> restart_arguments(const std::vector<std::string>& args, const std::string& name) {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if ((args[i] == "--replicas" || args[i] == "--name") && i + 1 < args.size()) {
+            ++i;
+            continue;
+        }
+        result.push_back(args[i]);
+    }
+    result.push_back("--name");
+    result.push_back(name);
+    return result;
+}
+
+bool policy_of(const std::vector<std::string>& args, RestartPolicy& policy) {
+    std::vector<char*> argv = {const_cast<char*>("simple")};
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    RunOptions options;
+    if (!parse_run_options(argv.size(), argv.data(), options)) {
+        return false;
+    }
+    return parse_restart_policy(options.restart_policy, policy);
+}
+
+std::string restart_spec_path(const std::string& name) {
+    return CONTAINER_INFO_PATH + name + "/" + RESTART_SPEC_FILE;
+}
+
+// 启动参数文件：<cwd> <argv...>，字段以'\0'分隔
+bool load_restart_spec(const std::string& name, std::string& cwd, std::vector<std::string>& args) {
+    std::ifstream file(restart_spec_path(name), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    args = split_fields(content);
+    if (args.empty()) {
+        return false;
+    }
+    cwd = args.front();
+    args.erase(args.begin());
+    return true;
+}
+
+void save_restart_spec(const std::string& name, const std::string& cwd, const std::vector<std::string>& args) {
+    std::vector<std::string> fields = {cwd};
+    fields.insert(fields.end(), args.begin(), args.end());
+    std::ofstream file(restart_spec_path(name), std::ios::binary | std::ios::trunc);
+    file << join_fields(fields);
+}
+
+// 释放已退出容器的资源并更新记录（在清理线程中执行）。
+// 重启时删除整个工作空间（重新运行会创建新的），否则只卸载，保留写入层供 commit，由 rm 删除
+void release_exited_container(const CleanupJob& job) {
+    ContainerInfo info;
+    if (!find_container_info(job.name, info) || info.id != job.id) {
+        std::cerr << "[Supervisor] Record of container " << job.name << " is gone, skipping cleanup" << std::endl;
+        return;
+    }
+
+    release_container_network(info.id, info.network_name, info.ip_address, !info.port_mapping.empty());
+
+    VolumeInfo volume_info = {"", "", false};
+    if (!info.volume.empty()) {
+        volume_info = parse_volume(info.volume);
+    }
+    Workspace workspace = get_workspace(info.id);
+    if (job.restart) {
+        delete_workspace(workspace, volume_info);
+    } else {
+        umount_volume(workspace, volume_info);
+        delete_mount_point(workspace);
+    }
+    remove_container_cgroup(info.id);
+    release_container_cpus(info.id);
+
+    // IP和端口映射已释放，清空避免 rm 再次释放（IP可能已分配给其他容器）
+    info.status = job.stopped ? STOPPED : EXITED;
+    info.pid = "";
+    info.pid_start_time = "";
+    info.exit_code = job.exit_code;
+    info.ip_address = "";
+    info.port_mapping = "";
+    if (!save_container_info(info)) {
+        std::cerr << "[Supervisor] Failed to update record of container " << job.name << std::endl;
+    }
+}
+
+Supervisor::~Supervisor() {
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (cleanup_fd >= 0) close(cleanup_fd);
+    if (signal_fd >= 0) close(signal_fd);
+    if (listen_fd >= 0) close(listen_fd);
+    if (lock_fd >= 0) close(lock_fd);
+}
+
+bool Supervisor::init() {
+    create_directory_if_not_exists(CONTAINER_INFO_PATH);
+    // 每台主机只运行一个监管进程
+    lock_fd = open(SUPERVISOR_LOCK_FILE.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "[Supervisor] Another supervisor is already running" << std::endl;
+        return false;
+    }
+    // 成为 child subreaper：工作进程退出后，其创建的容器由本进程收养
+    if (prctl(PR_SET_CHILD_SUBREAPER, 1) != 0) {
+        perror("[Supervisor] prctl(PR_SET_CHILD_SUBREAPER) failed");
+        return false;
+    }
+    if (chdir("/") != 0) {
+        perror("[Supervisor] chdir failed");
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        perror("[Supervisor] socket failed");
+        return false;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SUPERVISOR_SOCKET.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(SUPERVISOR_SOCKET.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        perror("[Supervisor] Failed to listen on socket");
+        return false;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    signal_fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    signal(SIGPIPE, SIG_IGN);
+    cleanup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (signal_fd < 0 || cleanup_fd < 0 || epoll_fd < 0) {
+        perror("[Supervisor] Failed to create event descriptors");
+        return false;
+    }
+
+    struct {
+        int fd;
+        EventTag tag;
+    } sources[] = {{listen_fd, TAG_LISTEN}, {signal_fd, TAG_SIGNAL}, {cleanup_fd, TAG_CLEANUP}};
+    for (const auto& source : sources) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = event_data(source.tag);
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, source.fd, &event) != 0) {
+            perror("[Supervisor] epoll_ctl failed");
+            return false;
+        }
+    }
+
+    cleanup_thread = std::thread(&Supervisor::cleanup_loop, this);
+    adopt_containers();
+    return true;
+}
+
+// 接管上次运行时登记、仍处于running状态的容器。
+// 它们不是本进程的子进程，退出时只能通过pidfd得知，无法取得退出码
+void Supervisor::adopt_containers() {
+    for (const auto& info : load_all_container_infos()) {
+        std::string cwd;
+        std::vector<std::string> args;
+        if (info.status != RUNNING || !load_restart_spec(info.name, cwd, args)) {
+            continue;
+        }
+        std::string error;
+        if (watch_container(info.name, cwd, args, error)) {
+            std::cout << "[Supervisor] Adopted container " << info.name << std::endl;
+            continue;
+        }
+        // 进程已不存在（监管进程未运行期间退出）
+        RestartPolicy policy;
+        policy_of(args, policy);
+        CleanupJob job;
+        job.name = info.name;
+        job.id = info.id;
+        job.cwd = cwd;
+        job.args = args;
+        job.policy = policy;
+        restart_states[info.name].restarts = atoi(info.restart_count.c_str());
+        job.restart = should_restart(policy, "", info.name);
+        std::cout << "[Supervisor] Container " << info.name << " exited while unsupervised" << std::endl;
+        queue_cleanup(job);
+    }
+}
+
+// 登记容器：通过记录中的PID和启动时间打开pidfd，加入epoll
+bool Supervisor::watch_container(const std::string& name, const std::string& cwd,
+                                 const std::vector<std::string>& args, std::string& error) {
+    ContainerInfo info;
+    if (!find_container_info(name, info) || info.pid.empty()) {
+        error = "container not found";
+        return false;
+    }
+    SupervisedContainer container;
+    container.name = name;
+    container.id = info.id;
+    container.pid = atoi(info.pid.c_str());
+    container.cwd = cwd;
+    container.args = args;
+    container.started = Clock::now();
+    if (!policy_of(args, container.policy)) {
+        error = "invalid arguments";
+        return false;
+    }
+    container.pidfd = open_process_pidfd(container.pid, info.pid_start_time);
+    if (container.pidfd < 0) {
+        error = "process has exited";
+        return false;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = event_data(TAG_CONTAINER, container.pid);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, container.pidfd, &event) != 0) {
+        error = strerror(errno);
+        close(container.pidfd);
+        return false;
+    }
+
+    // 重启次数写入记录，供 ps 和下次接管时使用
+    auto state = restart_states.find(name);
+    if (state == restart_states.end()) {
+        restart_states[name].restarts = atoi(info.restart_count.c_str());
+    } else if (std::to_string(state->second.restarts) != info.restart_count) {
+        info.restart_count = std::to_string(state->second.restarts);
+        save_container_info(info);
+    }
+    save_restart_spec(name, cwd, args);
+
+    containers[container.pid] = container;
+    container_pids[name] = container.pid;
+    return true;
+}
+
+void Supervisor::handle_client(int client_fd) {
+    // 在epoll线程中同步读写：连接后不发请求或不读回复的客户端不能卡住整个监管进程
+    struct timeval timeout = {CLIENT_REQUEST_TIMEOUT_MS / 1000, (CLIENT_REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string payload;
+    std::vector<int> fds;
+    if (!receive_message(client_fd, payload, fds)) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            std::cerr << "[Supervisor] Dropped a client that did not send its request in time" << std::endl;
+        }
+        close(client_fd);
+        return;
+    }
+    std::vector<std::string> fields = split_fields(payload);
+    std::string command = fields.empty() ? "" : fields[0];
+
+    if (command == "RUN" && fields.size() >= 3 && fds.size() == 3) {
+        Worker worker;
+        worker.client_fd = client_fd;
+        worker.cwd = fields[1];
+        worker.args.assign(fields.begin() + 2, fields.end());
+        if (!launch_worker(worker, fds)) {
+            send_message(client_fd, "EXIT 1");
+            close(client_fd);
+        }
+        close_fds(fds);
+        return;
+    }
+    close_fds(fds);
+
+    if (command == "WATCH" && fields.size() >= 4) {
+        std::string error;
+        std::vector<std::string> args(fields.begin() + 3, fields.end());
+        if (watch_container(fields[1], fields[2], args, error)) {
+            std::cout << "[Supervisor] Watching container " << fields[1] << " (PID "
+                      << container_pids[fields[1]] << ")" << std::endl;
+            send_message(client_fd, "OK");
+        } else {
+            send_message(client_fd, "ERR " + error);
+        }
+    } else if (command == "STOP" && fields.size() >= 2) {
+        const std::string& name = fields[1];
+        auto it = container_pids.find(name);
+        bool watched = it != container_pids.end();
+        if (watched) {
+            containers[it->second].stop_requested = true;
+        }
+        // 等待中的重启一并取消
+        pending_restarts.erase(std::remove_if(pending_restarts.begin(), pending_restarts.end(),
+                                              [&](const PendingRestart& pending) { return pending.name == name; }),
+                               pending_restarts.end());
+        restart_states.erase(name);
+        send_message(client_fd, watched ? "OK watched" : "OK");
+    } else {
+        send_message(client_fd, "ERR unknown request");
+    }
+    close(client_fd);
+}
+
+// fork并执行 run 命令。fork之前准备好参数和环境变量，
+// 子进程中只调用异步信号安全的函数（清理线程可能持有锁）
+bool Supervisor::launch_worker(const Worker& worker, const std::vector<int>& stdio) {
+    std::vector<std::string> args = {"simple"};
+    args.insert(args.end(), worker.args.begin(), worker.args.end());
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    std::string marker = std::string(SUPERVISED_ENV) + "=1";
+    std::vector<char*> envp;
+    for (char** env = environ; *env != nullptr; ++env) envp.push_back(*env);
+    envp.push_back(const_cast<char*>(marker.c_str()));
+    envp.push_back(nullptr);
+
+    int null_fd = -1;
+    int sources[3];
+    for (int i = 0; i < 3; ++i) {
+        if (i < static_cast<int>(stdio.size())) {
+            sources[i] = stdio[i];
+        } else if (i == STDIN_FILENO) {
+            null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            sources[i] = null_fd;
+        } else {
+            sources[i] = i; // 重启：输出到监管进程自己的输出
+        }
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 先复制到高位，避免dup2时互相覆盖
+        int moved[3];
+        for (int i = 0; i < 3; ++i) moved[i] = fcntl(sources[i], F_DUPFD_CLOEXEC, 10);
+        for (int i = 0; i < 3; ++i) dup2(moved[i], i);
+        sigset_t empty;
+        sigemptyset(&empty);
+        sigprocmask(SIG_SETMASK, &empty, nullptr);
+        signal(SIGPIPE, SIG_DFL);
+        if (chdir(worker.cwd.c_str()) != 0) {
+            (void)chdir("/");
+        }
+        execve("/proc/self/exe", argv.data(), envp.data());
+        _exit(127);
+    }
+    if (null_fd >= 0) close(null_fd);
+    if (pid < 0) {
+        perror("[Supervisor] fork failed");
+        return false;
+    }
+    workers[pid] = worker;
+    return true;
+}
+
+// 回收子进程。先用 WNOWAIT 查看是哪个进程，再分别处理：
+// 工作进程、被收养的容器，以及被收养的其他进程（如日志收集进程）
+void Supervisor::reap_children() {
+    while (true) {
+        siginfo_t info = {};
+        if (waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid == 0) {
+            break;
+        }
+        pid_t pid = info.si_pid;
+        if (waitpid(pid, nullptr, WNOHANG) <= 0) {
+            break;
+        }
+        std::string exit_code = exit_code_of(info);
+        if (workers.count(pid)) {
+            worker_exited(pid, exit_code);
+        } else if (containers.count(pid)) {
+            container_exited(pid, exit_code);
+        }
+    }
+
+    // 工作进程退出后，等待被收养的容器要么已在上面回收，要么不是本进程的子进程
+    std::vector<pid_t> awaiting;
+    for (const auto& pair : containers) {
+        if (pair.second.awaiting_reparent) awaiting.push_back(pair.first);
+    }
+    for (pid_t pid : awaiting) {
+        check_container(pid);
+    }
+}
+
+// 容器的pidfd可读（进程已退出）
+void Supervisor::check_container(pid_t pid) {
+    auto it = containers.find(pid);
+    if (it == containers.end()) {
+        return;
+    }
+    SupervisedContainer& container = it->second;
+    siginfo_t info = {};
+    if (waitid(static_cast<idtype_t>(P_PIDFD), container.pidfd, &info, WEXITED | WNOHANG) == 0) {
+        if (info.si_pid != 0) {
+            container_exited(pid, exit_code_of(info));
+        }
+        return;
+    }
+    if (errno != ECHILD) {
+        return;
+    }
+    // 不是本进程的子进程：仍属于正在运行的工作进程时等待其退出后被收养，否则无法取得退出码
+    if (workers.count(process_parent(pid))) {
+        if (!container.awaiting_reparent) {
+            container.awaiting_reparent = true;
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, container.pidfd, nullptr);
+        }
+        return;
+    }
+    container_exited(pid, "");
+}
+
+bool Supervisor::should_restart(const RestartPolicy& policy, const std::string& exit_code, const std::string& name) {
+    switch (policy.mode) {
+    case RestartPolicy::ALWAYS:
+        return true;
+    case RestartPolicy::ON_FAILURE:
+        // 未知退出码按失败处理
+        return exit_code != "0" &&
+               (policy.max_retries == 0 || restart_states[name].restarts < policy.max_retries);
+    default:
+        return false;
+    }
+}
+
+void Supervisor::container_exited(pid_t pid, const std::string& exit_code) {
+    auto it = containers.find(pid);
+    if (it == containers.end()) {
+        return;
+    }
+    SupervisedContainer container = it->second;
+    containers.erase(it);
+    container_pids.erase(container.name);
+    if (!container.awaiting_reparent) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, container.pidfd, nullptr);
+    }
+    close(container.pidfd);
+
+    CleanupJob job;
+    job.name = container.name;
+    job.id = container.id;
+    job.exit_code = exit_code;
+    job.stopped = container.stop_requested;
+    job.cwd = container.cwd;
+    job.args = container.args;
+    job.policy = container.policy;
+    job.ran = Clock::now() - container.started;
+    job.restart = !container.stop_requested && should_restart(container.policy, exit_code, container.name);
+    if (!job.restart) {
+        restart_states.erase(container.name);
+    }
+    std::cout << "[Supervisor] Container " << container.name << " exited with status: "
+              << (exit_code.empty() ? "unknown" : exit_code) << (job.restart ? ", restarting" : "") << std::endl;
+    queue_cleanup(job);
+}
+
+void Supervisor::worker_exited(pid_t pid, const std::string& exit_code) {
+    Worker worker = workers[pid];
+    workers.erase(pid);
+    if (worker.client_fd >= 0) {
+        send_message(worker.client_fd, "EXIT " + exit_code);
+        close(worker.client_fd);
+    }
+    // 重启失败（容器未登记）：按策略稍后再试
+    if (!worker.restart_name.empty() && !container_pids.count(worker.restart_name) &&
+        restart_states.count(worker.restart_name)) {
+        std::cerr << "[Supervisor] Failed to restart container " << worker.restart_name << std::endl;
+        if (should_restart(worker.policy, "", worker.restart_name)) {
+            CleanupJob retry;
+            retry.name = worker.restart_name;
+            retry.cwd = worker.cwd;
+            retry.args = worker.args;
+            retry.policy = worker.policy;
+            retry.restart = true;
+            std::lock_guard<std::mutex> lock(cleanup_mutex);
+            cleanup_done.push_back(retry); // 无需清理，直接进入重启排队
+            uint64_t one = 1;
+            if (write(cleanup_fd, &one, sizeof(one)) < 0) perror("[Supervisor] eventfd write failed");
+        } else {
+            restart_states.erase(worker.restart_name);
+        }
+    }
+}
+
+void Supervisor::queue_cleanup(const CleanupJob& job) {
+    std::lock_guard<std::mutex> lock(cleanup_mutex);
+    cleanup_queue.push_back(job);
+    cleanup_cv.notify_one();
+}
+
+void Supervisor::cleanup_loop() {
+    std::unique_lock<std::mutex> lock(cleanup_mutex);
+    while (true) {
+        cleanup_cv.wait(lock, [this]() { return cleanup_stop || !cleanup_queue.empty(); });
+        if (cleanup_queue.empty()) {
+            break; // 已请求退出且队列已清空
+        }
+        CleanupJob job = cleanup_queue.front();
+        cleanup_queue.pop_front();
+        lock.unlock();
+        if (!job.id.empty()) {
+            release_exited_container(job);
+        }
+        lock.lock();
+        cleanup_done.push_back(job);
+        uint64_t one = 1;
+        if (write(cleanup_fd, &one, sizeof(one)) < 0) {
+            perror("[Supervisor] eventfd write failed");
+        }
+    }
+}
+
+// 清理完成：需要重启的容器按退避时间排队
+void Supervisor::finish_cleanups() {
+    uint64_t count;
+    if (read(cleanup_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        perror("[Supervisor] eventfd read failed");
+    }
+    std::deque<CleanupJob> done;
+    {
+        std::lock_guard<std::mutex> lock(cleanup_mutex);
+        done.swap(cleanup_done);
+    }
+    for (const auto& job : done) {
+        if (!job.restart || !restart_states.count(job.name)) {
+            continue; // 不重启，或清理期间收到了STOP
+        }
+        RestartState& state = restart_states[job.name];
+        if (job.ran >= std::chrono::seconds(RESTART_RESET_SECONDS)) {
+            state.backoff = 0;
+        }
+        int delay_ms = RESTART_DELAY_MIN_MS << std::min(state.backoff, 16);
+        delay_ms = std::min(delay_ms, RESTART_DELAY_MAX_MS);
+        ++state.backoff;
+
+        PendingRestart pending;
+        pending.name = job.name;
+        pending.cwd = job.cwd;
+        pending.args = job.args;
+        pending.policy = job.policy;
+        pending.due = Clock::now() + std::chrono::milliseconds(delay_ms);
+        pending_restarts.push_back(pending);
+        std::cout << "[Supervisor] Restarting container " << job.name << " in " << delay_ms << " ms" << std::endl;
+    }
+}
+
+void Supervisor::launch_due_restarts() {
+    Clock::time_point now = Clock::now();
+    std::vector<PendingRestart> due;
+    auto split = std::partition(pending_restarts.begin(), pending_restarts.end(),
+                                [&](const PendingRestart& pending) { return pending.due > now; });
+    due.assign(split, pending_restarts.end());
+    pending_restarts.erase(split, pending_restarts.end());
+
+    for (const auto& pending : due) {
+        RestartState& state = restart_states[pending.name];
+        ++state.restarts;
+        Worker worker;
+        worker.restart_name = pending.name;
+        worker.cwd = pending.cwd;
+        worker.args = restart_arguments(pending.args, pending.name);
+        worker.policy = pending.policy;
+        std::cout << "[Supervisor] Restarting container " << pending.name << " (restart #" << state.restarts
+                  << ")" << std::endl;
+        if (!launch_worker(worker, {})) {
+            restart_states.erase(pending.name);
+        }
+    }
+}
+
+int Supervisor::next_timeout() const {
+    if (pending_restarts.empty()) {
+        return -1;
+    }
+    Clock::time_point earliest = pending_restarts.front().due;
+    for (const auto& pending : pending_restarts) {
+        earliest = std::min(earliest, pending.due);
+    }
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(earliest - Clock::now()).count();
+    return static_cast<int>(std::max<long long>(0, wait + 1));
+}
+
+int Supervisor::serve() {
+    std::cout << "[Supervisor] Listening on " << SUPERVISOR_SOCKET << ", supervising " << containers.size()
+              << " containers" << std::endl;
+    const int max_events = 64;
+    struct epoll_event events[max_events];
+    bool stop_requested = false;
+    while (!stop_requested) {
+        int count = epoll_wait(epoll_fd, events, max_events, next_timeout());
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("[Supervisor] epoll_wait failed");
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            EventTag tag = static_cast<EventTag>(events[i].data.u64 >> 32);
+            pid_t pid = static_cast<pid_t>(events[i].data.u64 & 0xffffffff);
+            if (tag == TAG_SIGNAL) {
+                struct signalfd_siginfo info;
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                    if (info.ssi_signo == SIGINT || info.ssi_signo == SIGTERM) {
+                        stop_requested = true;
+                    }
+                }
+                reap_children();
+            } else if (tag == TAG_LISTEN) {
+                int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client_fd >= 0) {
+                    handle_client(client_fd);
+                }
+            } else if (tag == TAG_CLEANUP) {
+                finish_cleanups();
+            } else if (tag == TAG_CONTAINER) {
+                check_container(pid);
+            }
+        }
+        launch_due_restarts();
+    }
+    shutdown();
+    std::cout << "[Supervisor] Stopped" << std::endl;
+    return 0;
+}
+
+// 退出：停止接受请求，完成排队的清理。容器继续运行，下次启动时重新接管
+void Supervisor::shutdown() {
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(SUPERVISOR_SOCKET.c_str());
+    {
+        std::lock_guard<std::mutex> lock(cleanup_mutex);
+        cleanup_stop = true;
+    }
+    cleanup_cv.notify_one();
+    if (cleanup_thread.joinable()) {
+        cleanup_thread.join();
+    }
+    for (auto& pair : workers) {
+        if (pair.second.client_fd >= 0) close(pair.second.client_fd);
+    }
+    for (auto& pair : containers) {
+        close(pair.second.pidfd);
+    }
+    if (!containers.empty()) {
+        std::cout << "[Supervisor] " << containers.size() << " containers are still running" << std::endl;
+    }
+}
+
+} // namespace
+
+int run_supervisor() {
+    std::cout << "[Supervisor] Starting supervisor (PID " << getpid() << ")..." << std::endl;
+    Supervisor supervisor;
+    if (!supervisor.init()) {
+        return 1;
+    }
+    return supervisor.serve();
+}
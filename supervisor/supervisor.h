@@ -0,0 +1,49 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <string>
+
+// ==================== 主机级容器监管进程 ====================
+// 每台主机一个监管进程（不是每个容器一个），单线程事件循环：
+// epoll 同时等待 socket 请求、signalfd（SIGCHLD/SIGINT/SIGTERM）、各容器的 pidfd、
+// 以及后台清理线程的完成通知（eventfd）。
+// 监管进程是 child subreaper：detach 模式的 run 命令转交给监管进程，由它 fork 出的
+// 工作进程执行，工作进程退出后容器被收养为监管进程的子进程，因此能取得真实的退出码。
+// 容器退出后：记录退出码和状态，在后台线程中释放网络/IP/cgroup/CPU并卸载工作空间，
+// 然后按重启策略（--restart）重新运行。
+//
+// 协议（SOCK_SEQPACKET，每个连接一个请求，字段以'\0'分隔）：
+//   RUN <cwd> <argv...>          附带客户端的 stdin/stdout/stderr，工作进程执行 run 命令
+//                                -> 工作进程退出后返回 "EXIT <退出码>"
+//   WATCH <name> <cwd> <argv...> 工作进程启动容器后登记，-> "OK" 或 "ERR <原因>"
+//   STOP <name>                  stop 命令发送信号之前通知，不再重启该容器
+//                                -> 正在监管时为 "OK watched"（退出后由监管进程更新状态），否则 "OK"
+
+// 重启策略
+struct RestartPolicy {
+    enum Mode { NO, ALWAYS, ON_FAILURE };
+    Mode mode = NO;
+    int max_retries = 0;    // on-failure:N 的最大重启次数，0表示不限
+};
+
+// 解析 --restart 参数：no（默认）、always、on-failure[:N]
+bool parse_restart_policy(const std::string& value, RestartPolicy& policy);
+
+// 以前台方式运行监管进程（已有监管进程运行时返回错误）
+int run_supervisor();
+
+// 客户端：通过监管进程执行 detach 模式的 run 命令，监管进程未运行时自动启动。
+// 无法连接监管进程时返回false（调用者直接运行），成功时 exit_code 为 run 命令的退出码
+bool run_supervised(int argc, char* argv[], int& exit_code);
+
+// 当前进程是否为监管进程的工作进程（首次调用时读取并清除环境变量，避免传给容器）
+bool is_supervised_worker();
+
+// 工作进程中：容器启动后向监管进程登记
+void report_supervised_container(const std::string& container_name);
+
+// stop 命令：通知监管进程该容器是主动停止的，不按重启策略重启。
+// 返回true表示监管进程正在监管该容器，会在其退出后更新记录
+bool notify_supervisor_stop(const std::string& container_name);
+
+#endif // SUPERVISOR_H